@@ -20,25 +20,119 @@
 #include "solclient/solClient.h"
 #include "solclient/solClientMsg.h"
 #include "common.h"
+#include "pool.h"
 #include "RRcommon.h"
+#include "getopt.h"
+
+/* Requests after the first RR_PRINT_LIMIT are served without printing them. */
+#define RR_PRINT_LIMIT 10
+
+/* Most requests evaluated in one batch; a multiple of the widest kernel. */
+#define RR_BATCH_MAX 64
+
+/* Batch buffers allocated up front; more are allocated while the flush thread falls behind. */
+#define RR_NUM_BATCH_BUFS 4
+
+/* Wait before retrying replies the API could not take without blocking. */
+#define RR_BATCH_RETRY_US 100
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#define RR_BATCH_X86
+#include <immintrin.h>
+#endif
 
 int msgReplied = 0;
 
+/*
+ * Batch kernel: evaluate n requests given as structure-of-arrays, setting
+ * result[i] and resultOk[i] (1.0 or 0.0). Operations are RR_operation_t
+ * values held as doubles so all lanes have the same width.
+ */
+typedef void    ( *RR_batchKernel_t ) ( const double *operation_p, const double *operand1_p, const double *operand2_p,
+                                        double *result_p, double *resultOk_p, int n );
+
+/*
+ * A batch of requests. The arrays come first so they stay aligned for the
+ * kernels in a buffer from alignedAlloc().
+ */
+typedef struct RR_batchBuf
+{
+    double          operation[RR_BATCH_MAX];
+    double          operand1[RR_BATCH_MAX];
+    double          operand2[RR_BATCH_MAX];
+    double          result[RR_BATCH_MAX];
+    double          resultOk[RR_BATCH_MAX];
+    solClient_opaqueMsg_pt requestMsgs[RR_BATCH_MAX];
+    solClient_opaqueMsg_pt replyMsgs[RR_BATCH_MAX];
+    solClient_uint8_t binaryReplies[RR_BATCH_MAX][RR_BINARY_REPLY_SIZE];
+    char            binary[RR_BATCH_MAX];
+    int             count;
+    UINT64          firstUs;                /* Arrival of the first request. */
+    struct RR_batchBuf *next_p;             /* Free list or full queue. */
+    struct RR_batchBuf *all_p;              /* All buffers, to free them. */
+} RR_batchBuf_t;
+
+/*
+ * Batch mode state. Requests are added to the filling buffer on the Context
+ * thread. A full buffer is queued for the flush thread and replaced with a
+ * free one; the flush thread also takes the filling buffer once its first
+ * request has waited windowUs. Only the flush thread evaluates and sends,
+ * outside the mutex, so the Context thread never sends and a send that
+ * cannot complete at once is retried instead of dropping the replies.
+ */
+typedef struct RR_batch
+{
+    MUTEX_T         mutex;
+    RR_batchBuf_t  *all_p;
+    RR_batchBuf_t  *free_p;
+    RR_batchBuf_t  *fullHead_p;
+    RR_batchBuf_t  *fullTail_p;
+    RR_batchBuf_t  *filling_p;
+    solClient_opaqueSession_pt session_p;
+    RR_batchKernel_t kernel;
+    const char     *kernelName_p;
+    int             windowUs;
+    volatile int    stop;
+    int             numBatches;
+    int             numBatched;
+    int             numBufs;
+    int             numRetries;             /* Sends retried after SOLCLIENT_WOULD_BLOCK. */
+    int             numFailed;              /* Replies the API refused. */
+} RR_batch_t;
+
+
 /*****************************************************************************
- * Received message handling code
+ * decodeRequest
+ *
+ * Get the operation and operands from a request message. Requests in the
+ * binary wire format (see RRcommon.h) are recognized by their size and magic,
+ * and *binary_p is set so they are answered in the binary format; anything
+ * else is decoded as a structured data stream. Returns 0 if the request
+ * could not be decoded.
  *****************************************************************************/
-static          solClient_rxMsgCallback_returnCode_t
-requestMsgReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+static          solClient_bool_t
+decodeRequest ( solClient_opaqueMsg_pt msg_p, char *binary_p, solClient_int8_t * operation_p,
+                solClient_int32_t * operand1_p, solClient_int32_t * operand2_p )
 {
-    solClient_returnCode_t rc = SOLCLIENT_OK;
-    solClient_opaqueMsg_pt replyMsg_p;
+    solClient_returnCode_t rc;
     solClient_opaqueContainer_pt stream_p;
-    solClient_opaqueContainer_pt replyStream_p;
-    solClient_bool_t resultOk = 1;
-    solClient_int8_t operation = -1;
-    solClient_int32_t operand1 = -1;
-    solClient_int32_t operand2 = -1;
-    double result;
+    void           *request_p;
+    solClient_uint32_t requestSize;
+    RR_operation_t  binaryOperation;
+
+    *binary_p = 0;
+    if ( solClient_msg_getBinaryAttachmentPtr ( msg_p, &request_p, &requestSize ) == SOLCLIENT_OK &&
+         ( rc = RR_decodeBinaryRequest ( request_p, requestSize, &binaryOperation,
+                                         operand1_p, operand2_p ) ) != SOLCLIENT_NOT_FOUND ) {
+        *binary_p = 1;
+        if ( rc != SOLCLIENT_OK ) {
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Received binary request of unsupported version %u",
+                            ( unsigned int ) ( ( solClient_uint8_t * ) request_p )[2] );
+            return 0;
+        }
+        *operation_p = ( solClient_int8_t ) binaryOperation;
+        return 1;
+    }
 
     /*
      * Get the operator, operand1 and operand2 from the stream in the binary
@@ -46,46 +140,101 @@ requestMsgReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClien
      */
     if ( ( rc = solClient_msg_getBinaryAttachmentStream ( msg_p, &stream_p ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_msg_getBinaryAttachmentStream()" );
-        goto createReply;
+        return 0;
     }
     /* Get the operation, operand1 and operand2 from the stream. */
-    if ( ( rc = solClient_container_getInt8 ( stream_p, &operation, NULL ) ) != SOLCLIENT_OK ) {
+    if ( ( rc = solClient_container_getInt8 ( stream_p, operation_p, NULL ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_container_getInt8() for operation" );
-        goto createReply;
+        return 0;
     }
-    if ( ( rc = solClient_container_getInt32 ( stream_p, &operand1, NULL ) ) != SOLCLIENT_OK ) {
+    if ( ( rc = solClient_container_getInt32 ( stream_p, operand1_p, NULL ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_container_getInt32() for operand1" );
-        goto createReply;
+        return 0;
     }
-    if ( ( rc = solClient_container_getInt32 ( stream_p, &operand2, NULL ) ) != SOLCLIENT_OK ) {
+    if ( ( rc = solClient_container_getInt32 ( stream_p, operand2_p, NULL ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_container_getInt32() for operand2" );
-        goto createReply;
+        return 0;
     }
-    /* Do the requested calculation. */
+    return 1;
+}
+
+
+/*****************************************************************************
+ * calculate
+ *
+ * Do the requested calculation. Returns 0 for an unknown operation or a
+ * division by zero.
+ *****************************************************************************/
+static          solClient_bool_t
+calculate ( solClient_int8_t operation, solClient_int32_t operand1, solClient_int32_t operand2, double *result_p )
+{
     switch ( operation ) {
         case plusOperation:
-            result = (double)operand1 + (double)operand2;
-            resultOk = 1;
-            break;
+            *result_p = (double)operand1 + (double)operand2;
+            return 1;
         case minusOperation:
-            result = (double)operand1 - (double)operand2;
-            resultOk = 1;
-            break;
+            *result_p = (double)operand1 - (double)operand2;
+            return 1;
         case timesOperation:
-            result = (double)operand1 * (double)operand2;
-            resultOk = 1;
-            break;
+            *result_p = (double)operand1 * (double)operand2;
+            return 1;
         case divideOperation:
             if (operand2 != 0) {
-                result = (double)operand1 / (double)operand2;
-                resultOk = 1;
+                *result_p = (double)operand1 / (double)operand2;
+                return 1;
             }
-            break;
+            return 0;
         default:
-            break;
+            return 0;
+    }
+}
+
+
+/*****************************************************************************
+ * setReply
+ *
+ * Put the status and result into a reply message, in the binary format or in
+ * a stream. For the binary format, the message references binaryReply_p,
+ * which must hold RR_BINARY_REPLY_SIZE bytes and outlive the send.
+ *****************************************************************************/
+static          solClient_returnCode_t
+setReply ( solClient_opaqueMsg_pt replyMsg_p, char binary, solClient_bool_t resultOk, double result,
+           solClient_uint8_t *binaryReply_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueContainer_pt replyStream_p;
+
+    if ( binary ) {
+        RR_encodeBinaryReply ( binaryReply_p, resultOk, result );
+        if ( ( rc = solClient_msg_setBinaryAttachmentPtr ( replyMsg_p, binaryReply_p, RR_BINARY_REPLY_SIZE ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setBinaryAttachmentPtr()" );
+        }
+        return rc;
+    }
+    if ( ( rc = solClient_msg_createBinaryAttachmentStream ( replyMsg_p, &replyStream_p, 32 ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_createBinaryAttachmentStream()" );
+        return rc;
+    }
+    if ( ( rc = solClient_container_addBoolean ( replyStream_p, resultOk, NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_container_addBoolean()" );
+        return rc;
+    }
+    if ( resultOk ) {
+        if ( ( rc = solClient_container_addDouble ( replyStream_p, result, NULL ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_container_addDouble()" );
+        }
     }
+    return rc;
+}
+
 
-  createReply:
+/*****************************************************************************
+ * printRequest
+ *****************************************************************************/
+static void
+printRequest ( solClient_int8_t operation, solClient_int32_t operand1, solClient_int32_t operand2,
+               solClient_bool_t resultOk, double result )
+{
     if ( resultOk ) {
         printf( "  Received request for %d %s %d, sending reply with result %f. \n",
                 operand1, RR_operationToString ( operation ), operand2, result );
@@ -93,42 +242,1079 @@ requestMsgReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClien
         printf( "  Received request for %d %s %d, sending reply with a failure status.\n",
                 operand1, RR_operationToString ( operation ), operand2  );
     }
+}
+
+
+/* Simulated CPU cost of one calculation, in microseconds. */
+static int      rrWorkUs = 0;
+
+
+/*****************************************************************************
+ * doWork
+ *
+ * Burn rrWorkUs of CPU, standing in for a costly calculation.
+ *****************************************************************************/
+static void
+doWork ( void )
+{
+    UINT64          endUs;
+
+    if ( rrWorkUs > 0 ) {
+        endUs = getTimeInUs (  ) + rrWorkUs;
+        while ( getTimeInUs (  ) < endUs ) {
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * Received message handling code
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+requestMsgReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt replyMsg_p;
+    solClient_bool_t resultOk;
+    solClient_int8_t operation = -1;
+    solClient_int32_t operand1 = -1;
+    solClient_int32_t operand2 = -1;
+    double result = 0;
+    char            binary;
+    solClient_uint8_t binaryReply[RR_BINARY_REPLY_SIZE];
+
+    if ( ( resultOk = decodeRequest ( msg_p, &binary, &operation, &operand1, &operand2 ) ) ) {
+        doWork (  );
+        resultOk = calculate ( operation, operand1, operand2, &result );
+    }
+    if ( msgReplied < RR_PRINT_LIMIT ) {
+        printRequest ( operation, operand1, operand2, resultOk, result );
+    }
     /*
-     * Allocate a message to construct the reply, and put in the status and result in a
-     * stream.
+     * Take a message from the message pool to construct the reply, and put in the
+     * status and result. Replies are Direct messages, so the message can be
+     * returned to the pool as soon as it is sent.
      */
-    if ( ( rc = solClient_msg_alloc ( &replyMsg_p ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_msg_alloc()" );
+    if ( ( rc = common_msgPool_get ( &replyMsg_p ) ) != SOLCLIENT_OK ) {
         return SOLCLIENT_CALLBACK_OK;
     }
-    if ( ( rc = solClient_msg_createBinaryAttachmentStream ( replyMsg_p, &replyStream_p, 32 ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_msg_createBinaryAttachmentStream()" );
+    if ( ( rc = setReply ( replyMsg_p, binary, resultOk, result, binaryReply ) ) != SOLCLIENT_OK ) {
         goto freeMsg;
     }
-    if ( ( rc = solClient_container_addBoolean ( replyStream_p, resultOk, NULL ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_container_addBoolean()" );
+    if ( ( rc = solClient_session_sendReply ( opaqueSession_p, msg_p, replyMsg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_sendReply()" );
         goto freeMsg;
     }
-    if ( resultOk ) {
-        if ( ( rc = solClient_container_addDouble ( replyStream_p, result, NULL ) ) != SOLCLIENT_OK ) {
-            common_handleError ( rc, "solClient_container_addDouble()" );
-            goto freeMsg;
+
+  freeMsg:
+    common_msgPool_release ( &replyMsg_p );
+    msgReplied ++;
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * Batch kernels
+ *
+ * All kernels give the same results as calculate(). The vector kernels
+ * evaluate every operation in every lane and select by operation, so a
+ * batch of mixed operations runs without branches.
+ *****************************************************************************/
+static void
+batchKernelScalar ( const double *operation_p, const double *operand1_p, const double *operand2_p,
+                    double *result_p, double *resultOk_p, int n )
+{
+    int             i;
+
+    for ( i = 0; i < n; i++ ) {
+        resultOk_p[i] = calculate ( ( solClient_int8_t ) operation_p[i], ( solClient_int32_t ) operand1_p[i],
+                                    ( solClient_int32_t ) operand2_p[i], &result_p[i] ) ? 1.0 : 0.0;
+        if ( resultOk_p[i] == 0.0 ) {
+            result_p[i] = 0.0;
         }
     }
-    if ( ( rc = solClient_session_sendReply ( opaqueSession_p, msg_p, replyMsg_p ) ) != SOLCLIENT_OK ) {
+}
+
+#if defined(RR_BATCH_X86)
+__attribute__ ( ( target ( "avx" ) ) )
+static void
+batchKernelAvx ( const double *operation_p, const double *operand1_p, const double *operand2_p,
+                 double *result_p, double *resultOk_p, int n )
+{
+    const __m256d   plus = _mm256_set1_pd ( plusOperation );
+    const __m256d   minus = _mm256_set1_pd ( minusOperation );
+    const __m256d   times = _mm256_set1_pd ( timesOperation );
+    const __m256d   divide = _mm256_set1_pd ( divideOperation );
+    const __m256d   zero = _mm256_setzero_pd (  );
+    const __m256d   one = _mm256_set1_pd ( 1.0 );
+    __m256d         operation;
+    __m256d         operand1;
+    __m256d         operand2;
+    __m256d         isDivide;
+    __m256d         ok;
+    __m256d         result;
+    int             i;
+
+    for ( i = 0; i + 4 <= n; i += 4 ) {
+        operation = _mm256_load_pd ( operation_p + i );
+        operand1 = _mm256_load_pd ( operand1_p + i );
+        operand2 = _mm256_load_pd ( operand2_p + i );
+        isDivide = _mm256_cmp_pd ( operation, divide, _CMP_EQ_OQ );
+        result = _mm256_blendv_pd ( zero, _mm256_add_pd ( operand1, operand2 ),
+                                    _mm256_cmp_pd ( operation, plus, _CMP_EQ_OQ ) );
+        result = _mm256_blendv_pd ( result, _mm256_sub_pd ( operand1, operand2 ),
+                                    _mm256_cmp_pd ( operation, minus, _CMP_EQ_OQ ) );
+        result = _mm256_blendv_pd ( result, _mm256_mul_pd ( operand1, operand2 ),
+                                    _mm256_cmp_pd ( operation, times, _CMP_EQ_OQ ) );
+        result = _mm256_blendv_pd ( result, _mm256_div_pd ( operand1, operand2 ), isDivide );
+        /* Valid operation, and not a division by zero. */
+        ok = _mm256_and_pd ( _mm256_cmp_pd ( operation, plus, _CMP_GE_OQ ),
+                             _mm256_cmp_pd ( operation, divide, _CMP_LE_OQ ) );
+        ok = _mm256_andnot_pd ( _mm256_and_pd ( isDivide, _mm256_cmp_pd ( operand2, zero, _CMP_EQ_OQ ) ), ok );
+        _mm256_store_pd ( result_p + i, _mm256_and_pd ( ok, result ) );
+        _mm256_store_pd ( resultOk_p + i, _mm256_and_pd ( ok, one ) );
+    }
+    batchKernelScalar ( operation_p + i, operand1_p + i, operand2_p + i, result_p + i, resultOk_p + i, n - i );
+}
+
+__attribute__ ( ( target ( "sse2" ) ) )
+static          __m128d
+batchSelectSse2 ( __m128d mask, __m128d ifSet, __m128d ifClear )
+{
+    return _mm_or_pd ( _mm_and_pd ( mask, ifSet ), _mm_andnot_pd ( mask, ifClear ) );
+}
+
+__attribute__ ( ( target ( "sse2" ) ) )
+static void
+batchKernelSse2 ( const double *operation_p, const double *operand1_p, const double *operand2_p,
+                  double *result_p, double *resultOk_p, int n )
+{
+    const __m128d   plus = _mm_set1_pd ( plusOperation );
+    const __m128d   minus = _mm_set1_pd ( minusOperation );
+    const __m128d   times = _mm_set1_pd ( timesOperation );
+    const __m128d   divide = _mm_set1_pd ( divideOperation );
+    const __m128d   zero = _mm_setzero_pd (  );
+    const __m128d   one = _mm_set1_pd ( 1.0 );
+    __m128d         operation;
+    __m128d         operand1;
+    __m128d         operand2;
+    __m128d         isDivide;
+    __m128d         ok;
+    __m128d         result;
+    int             i;
+
+    for ( i = 0; i + 2 <= n; i += 2 ) {
+        operation = _mm_load_pd ( operation_p + i );
+        operand1 = _mm_load_pd ( operand1_p + i );
+        operand2 = _mm_load_pd ( operand2_p + i );
+        isDivide = _mm_cmpeq_pd ( operation, divide );
+        result = _mm_and_pd ( _mm_cmpeq_pd ( operation, plus ), _mm_add_pd ( operand1, operand2 ) );
+        result = batchSelectSse2 ( _mm_cmpeq_pd ( operation, minus ), _mm_sub_pd ( operand1, operand2 ), result );
+        result = batchSelectSse2 ( _mm_cmpeq_pd ( operation, times ), _mm_mul_pd ( operand1, operand2 ), result );
+        result = batchSelectSse2 ( isDivide, _mm_div_pd ( operand1, operand2 ), result );
+        /* Valid operation, and not a division by zero. */
+        ok = _mm_and_pd ( _mm_cmpge_pd ( operation, plus ), _mm_cmple_pd ( operation, divide ) );
+        ok = _mm_andnot_pd ( _mm_and_pd ( isDivide, _mm_cmpeq_pd ( operand2, zero ) ), ok );
+        _mm_store_pd ( result_p + i, _mm_and_pd ( ok, result ) );
+        _mm_store_pd ( resultOk_p + i, _mm_and_pd ( ok, one ) );
+    }
+    batchKernelScalar ( operation_p + i, operand1_p + i, operand2_p + i, result_p + i, resultOk_p + i, n - i );
+}
+#endif
+
+
+/*****************************************************************************
+ * batchSelectKernel
+ *
+ * Pick the widest kernel the CPU supports.
+ *****************************************************************************/
+static void
+batchSelectKernel ( RR_batch_t * batch_p )
+{
+#if defined(RR_BATCH_X86)
+    __builtin_cpu_init (  );
+    if ( __builtin_cpu_supports ( "avx" ) ) {
+        batch_p->kernel = batchKernelAvx;
+        batch_p->kernelName_p = "AVX";
+        return;
+    }
+    if ( __builtin_cpu_supports ( "sse2" ) ) {
+        batch_p->kernel = batchKernelSse2;
+        batch_p->kernelName_p = "SSE2";
+        return;
+    }
+#endif
+    batch_p->kernel = batchKernelScalar;
+    batch_p->kernelName_p = "scalar";
+}
+
+
+/*****************************************************************************
+ * batchAllocBuf
+ *
+ * Allocate a batch buffer and add it to the list of all buffers. Must be
+ * called with the batch mutex held, or before the batch is shared.
+ *****************************************************************************/
+static RR_batchBuf_t *
+batchAllocBuf ( RR_batch_t * batch_p )
+{
+    RR_batchBuf_t  *buf_p;
+
+    if ( ( buf_p = ( RR_batchBuf_t * ) alignedAlloc ( sizeof ( RR_batchBuf_t ), COMMON_CACHE_LINE_SIZE ) ) == NULL ) {
+        return NULL;
+    }
+    memset ( buf_p, 0, sizeof ( RR_batchBuf_t ) );
+    buf_p->all_p = batch_p->all_p;
+    batch_p->all_p = buf_p;
+    batch_p->numBufs++;
+    return buf_p;
+}
+
+
+/*****************************************************************************
+ * batchTakeFilling
+ *
+ * Take the filling buffer for flushing, and replace it with a free one,
+ * allocating one if none is free. Must be called with the batch mutex held
+ * and a non-empty filling buffer. Returns NULL, leaving the filling buffer
+ * in place, if no buffer can be allocated.
+ *****************************************************************************/
+static RR_batchBuf_t *
+batchTakeFilling ( RR_batch_t * batch_p )
+{
+    RR_batchBuf_t  *buf_p = batch_p->filling_p;
+    RR_batchBuf_t  *next_p;
+
+    if ( ( next_p = batch_p->free_p ) != NULL ) {
+        batch_p->free_p = next_p->next_p;
+    } else if ( ( next_p = batchAllocBuf ( batch_p ) ) == NULL ) {
+        return NULL;
+    }
+    next_p->count = 0;
+    batch_p->filling_p = next_p;
+    buf_p->next_p = NULL;
+    return buf_p;
+}
+
+
+/*****************************************************************************
+ * batchFlush
+ *
+ * Evaluate a batch taken with batchTakeFilling(), send all replies with
+ * solClient_session_sendMultipleMsg(), free the requests and return the
+ * buffer to the free list. Called on the flush thread, without the batch
+ * mutex held.
+ *****************************************************************************/
+static void
+batchFlush ( RR_batch_t * batch_p, RR_batchBuf_t * buf_p )
+{
+    solClient_returnCode_t rc;
+    solClient_destination_t replyTo;
+    const char     *correlationId_p;
+    solClient_uint32_t numWritten;
+    int             numReplies = 0;
+    int             numSent = 0;
+    int             numRetries = 0;
+    int             numChunk;
+    int             i;
+
+    /* Pad to a whole number of vectors; padding lanes are invalid requests. */
+    for ( i = buf_p->count; i < RR_BATCH_MAX && ( i & 3 ) != 0; i++ ) {
+        buf_p->operation[i] = 0.0;
+        buf_p->operand1[i] = 0.0;
+        buf_p->operand2[i] = 0.0;
+    }
+    batch_p->kernel ( buf_p->operation, buf_p->operand1, buf_p->operand2, buf_p->result, buf_p->resultOk, i );
+
+    /*
+     * Build the replies. solClient_session_sendReply() would address each
+     * reply from its request; here that is done by hand so the replies can
+     * go out together.
+     */
+    for ( i = 0; i < buf_p->count; i++ ) {
+        if ( msgReplied + i < RR_PRINT_LIMIT ) {
+            printRequest ( ( solClient_int8_t ) buf_p->operation[i], ( solClient_int32_t ) buf_p->operand1[i],
+                           ( solClient_int32_t ) buf_p->operand2[i], buf_p->resultOk[i] != 0.0, buf_p->result[i] );
+        }
+        if ( common_msgPool_get ( &buf_p->replyMsgs[numReplies] ) != SOLCLIENT_OK ) {
+            continue;
+        }
+        if ( ( rc = solClient_msg_getReplyTo ( buf_p->requestMsgs[i], &replyTo, sizeof ( replyTo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_getReplyTo()" );
+            goto releaseReply;
+        }
+        if ( ( rc = solClient_msg_setDestination ( buf_p->replyMsgs[numReplies], &replyTo, sizeof ( replyTo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setDestination()" );
+            goto releaseReply;
+        }
+        if ( solClient_msg_getCorrelationId ( buf_p->requestMsgs[i], &correlationId_p ) == SOLCLIENT_OK &&
+             ( rc = solClient_msg_setCorrelationId ( buf_p->replyMsgs[numReplies], correlationId_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setCorrelationId()" );
+            goto releaseReply;
+        }
+        if ( ( rc = solClient_msg_setAsReplyMsg ( buf_p->replyMsgs[numReplies], 1 ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setAsReplyMsg()" );
+            goto releaseReply;
+        }
+        if ( setReply ( buf_p->replyMsgs[numReplies], buf_p->binary[i], buf_p->resultOk[i] != 0.0,
+                        buf_p->result[i], buf_p->binaryReplies[i] ) != SOLCLIENT_OK ) {
+            goto releaseReply;
+        }
+        numReplies++;
+        continue;
+
+      releaseReply:
+        common_msgPool_release ( &buf_p->replyMsgs[numReplies] );
+    }
+
+    /*
+     * Send in chunks of at most SOLCLIENT_SESSION_SEND_MULTIPLE_LIMIT. What
+     * the API could not take without blocking is sent again after a pause;
+     * only replies it refuses for another reason are given up.
+     */
+    while ( numSent < numReplies ) {
+        numChunk = numReplies - numSent;
+        if ( numChunk > SOLCLIENT_SESSION_SEND_MULTIPLE_LIMIT ) {
+            numChunk = SOLCLIENT_SESSION_SEND_MULTIPLE_LIMIT;
+        }
+        numWritten = 0;
+        rc = solClient_session_sendMultipleMsg ( batch_p->session_p, &buf_p->replyMsgs[numSent], numChunk, &numWritten );
+        numSent += numWritten;
+        if ( rc == SOLCLIENT_WOULD_BLOCK ) {
+            numRetries++;
+            sleepInUs ( RR_BATCH_RETRY_US );
+        } else if ( rc != SOLCLIENT_OK && numWritten == 0 ) {
+            common_handleError ( rc, "solClient_session_sendMultipleMsg()" );
+            break;
+        }
+    }
+
+    for ( i = 0; i < numReplies; i++ ) {
+        common_msgPool_release ( &buf_p->replyMsgs[i] );
+    }
+    for ( i = 0; i < buf_p->count; i++ ) {
+        solClient_msg_free ( &buf_p->requestMsgs[i] );
+    }
+
+    mutexLock ( &batch_p->mutex );
+    msgReplied += buf_p->count;
+    batch_p->numBatches++;
+    batch_p->numBatched += buf_p->count;
+    batch_p->numRetries += numRetries;
+    batch_p->numFailed += buf_p->count - numSent;
+    buf_p->count = 0;
+    buf_p->next_p = batch_p->free_p;
+    batch_p->free_p = buf_p;
+    mutexUnlock ( &batch_p->mutex );
+}
+
+
+/*****************************************************************************
+ * batchQueueFull
+ *
+ * Queue a full batch for the flush thread. Must be called with the batch
+ * mutex held.
+ *****************************************************************************/
+static void
+batchQueueFull ( RR_batch_t * batch_p, RR_batchBuf_t * buf_p )
+{
+    if ( batch_p->fullTail_p != NULL ) {
+        batch_p->fullTail_p->next_p = buf_p;
+    } else {
+        batch_p->fullHead_p = buf_p;
+    }
+    batch_p->fullTail_p = buf_p;
+}
+
+
+/*****************************************************************************
+ * batchMsgReceiveCallback
+ *
+ * Batch mode: decode the request into the filling batch and keep the message
+ * until its reply is sent. Queues the batch for the flush thread when it is
+ * full.
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+batchMsgReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    RR_batch_t     *batch_p = ( RR_batch_t * ) user_p;
+    RR_batchBuf_t  *buf_p;
+    RR_batchBuf_t  *full_p;
+    solClient_int8_t operation = -1;
+    solClient_int32_t operand1 = -1;
+    solClient_int32_t operand2 = -1;
+    char            binary;
+    int             i;
+
+    if ( !decodeRequest ( msg_p, &binary, &operation, &operand1, &operand2 ) ) {
+        /* Fails in the kernel, and is answered with a failure status. */
+        operation = -1;
+    }
+
+    mutexLock ( &batch_p->mutex );
+    buf_p = batch_p->filling_p;
+    if ( buf_p->count == RR_BATCH_MAX ) {
+        /* Could not be replaced when it filled up. */
+        if ( ( full_p = batchTakeFilling ( batch_p ) ) == NULL ) {
+            mutexUnlock ( &batch_p->mutex );
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a batch buffer, request not answered" );
+            return SOLCLIENT_CALLBACK_OK;
+        }
+        batchQueueFull ( batch_p, full_p );
+        buf_p = batch_p->filling_p;
+    }
+    i = buf_p->count++;
+    if ( i == 0 ) {
+        buf_p->firstUs = getTimeInUs (  );
+    }
+    buf_p->operation[i] = operation;
+    buf_p->operand1[i] = operand1;
+    buf_p->operand2[i] = operand2;
+    buf_p->binary[i] = binary;
+    buf_p->requestMsgs[i] = msg_p;
+    if ( buf_p->count == RR_BATCH_MAX && ( full_p = batchTakeFilling ( batch_p ) ) != NULL ) {
+        batchQueueFull ( batch_p, full_p );
+    }
+    mutexUnlock ( &batch_p->mutex );
+    return SOLCLIENT_CALLBACK_TAKE_MSG;
+}
+
+
+/*****************************************************************************
+ * batchFlushThread
+ *
+ * Flush the full batches in the order they filled up, and the filling batch
+ * once its first request has waited the window. When stopping, flush
+ * whatever is left.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+batchFlushThread ( void *arg_p )
+{
+    RR_batch_t     *batch_p = ( RR_batch_t * ) arg_p;
+    RR_batchBuf_t  *due_p;
+    int             sleepUs = batch_p->windowUs / 4 > 0 ? batch_p->windowUs / 4 : 1;
+    int             stopping;
+
+    do {
+        stopping = batch_p->stop;
+        mutexLock ( &batch_p->mutex );
+        if ( ( due_p = batch_p->fullHead_p ) != NULL ) {
+            if ( ( batch_p->fullHead_p = due_p->next_p ) == NULL ) {
+                batch_p->fullTail_p = NULL;
+            }
+        } else if ( batch_p->filling_p->count > 0 &&
+                    ( stopping || getTimeInUs (  ) - batch_p->filling_p->firstUs >= ( UINT64 ) batch_p->windowUs ) ) {
+            due_p = batchTakeFilling ( batch_p );
+        }
+        mutexUnlock ( &batch_p->mutex );
+        if ( due_p != NULL ) {
+            batchFlush ( batch_p, due_p );
+        } else if ( !stopping ) {
+            sleepInUs ( sleepUs );
+        }
+    } while ( !stopping || due_p != NULL );
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * batchInit
+ *****************************************************************************/
+static          solClient_returnCode_t
+batchInit ( RR_batch_t * batch_p, int windowUs )
+{
+    RR_batchBuf_t  *buf_p;
+    int             i;
+
+    memset ( batch_p, 0, sizeof ( *batch_p ) );
+    for ( i = 0; i < RR_NUM_BATCH_BUFS; i++ ) {
+        if ( ( buf_p = batchAllocBuf ( batch_p ) ) == NULL ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate batch buffers" );
+            while ( ( buf_p = batch_p->all_p ) != NULL ) {
+                batch_p->all_p = buf_p->all_p;
+                alignedFree ( buf_p );
+            }
+            return SOLCLIENT_FAIL;
+        }
+        buf_p->next_p = batch_p->free_p;
+        batch_p->free_p = buf_p;
+    }
+    batch_p->filling_p = batch_p->free_p;
+    batch_p->free_p = batch_p->filling_p->next_p;
+    batch_p->windowUs = windowUs;
+    batchSelectKernel ( batch_p );
+    mutexInit ( &batch_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * batchDestroy
+ *
+ * Free the batch buffers, and any requests that arrived after the flush
+ * thread stopped.
+ *****************************************************************************/
+static void
+batchDestroy ( RR_batch_t * batch_p )
+{
+    RR_batchBuf_t  *buf_p;
+    int             i;
+
+    for ( buf_p = batch_p->fullHead_p; buf_p != NULL; buf_p = buf_p->next_p ) {
+        for ( i = 0; i < buf_p->count; i++ ) {
+            solClient_msg_free ( &buf_p->requestMsgs[i] );
+        }
+    }
+    for ( i = 0; i < batch_p->filling_p->count; i++ ) {
+        solClient_msg_free ( &batch_p->filling_p->requestMsgs[i] );
+    }
+    while ( ( buf_p = batch_p->all_p ) != NULL ) {
+        batch_p->all_p = buf_p->all_p;
+        alignedFree ( buf_p );
+    }
+    mutexDestroy ( &batch_p->mutex );
+}
+
+
+/*****************************************************************************
+ * Response cache
+ *
+ * Results are cached by request (operation and operands, whatever the wire
+ * format) for a TTL. The table is a flat open-addressing index with linear
+ * probing over a fixed array of entries; the entry array is bounded, and the
+ * least recently used ready entry is evicted to make room. A miss inserts a
+ * pending entry and queues it for the compute thread; identical requests
+ * that arrive while it is pending are coalesced onto it, and all of them are
+ * answered with solClient_session_sendReply() once the result is ready.
+ *****************************************************************************/
+
+/* Index slots, a power of two; at most 3/4 full. */
+#define RR_CACHE_SLOTS          4096
+#define RR_CACHE_MAX_ENTRIES    ( RR_CACHE_SLOTS * 3 / 4 )
+
+/* Requests waiting on pending entries, across all entries. */
+#define RR_CACHE_MAX_WAITERS    4096
+
+#define RR_CACHE_NONE           ( -1 )
+
+typedef enum RR_cacheState
+{
+    RR_CACHE_FREE,
+    RR_CACHE_PENDING,                       /* Queued or being computed. */
+    RR_CACHE_READY
+} RR_cacheState_t;
+
+typedef struct RR_cacheEntry
+{
+    RR_cacheState_t state;
+    solClient_int8_t operation;
+    solClient_int32_t operand1;
+    solClient_int32_t operand2;
+    solClient_uint32_t hash;
+    solClient_bool_t resultOk;
+    double          result;
+    UINT64          expiresUs;
+    int             lruPrev;                /* Ready entries, most recent first. */
+    int             lruNext;                /* Also links the free list. */
+    int             waiters;                /* Head of the waiter list while pending. */
+} RR_cacheEntry_t;
+
+typedef struct RR_cacheWaiter
+{
+    solClient_opaqueMsg_pt msg_p;
+    char            binary;
+    int             next;
+} RR_cacheWaiter_t;
+
+typedef struct RR_cacheStats
+{
+    int             hits;
+    int             misses;
+    int             coalesced;
+    int             expired;                /* Misses on an expired entry. */
+    int             evicted;
+    int             uncached;               /* Computed inline, the cache being full. */
+} RR_cacheStats_t;
+
+typedef struct RR_cache
+{
+    MUTEX_T         mutex;
+    int             slots[RR_CACHE_SLOTS];
+    RR_cacheEntry_t entries[RR_CACHE_MAX_ENTRIES];
+    RR_cacheWaiter_t waiters[RR_CACHE_MAX_WAITERS];
+    int             freeEntries;
+    int             freeWaiters;
+    int             lruHead;
+    int             lruTail;
+    int             work[RR_CACHE_MAX_ENTRIES + 1];   /* Pending entries to compute. */
+    int             workHead;
+    int             workTail;
+    int             numEntries;
+    UINT64          ttlUs;
+    solClient_opaqueSession_pt session_p;
+    volatile int    stop;
+    RR_cacheStats_t stats;
+} RR_cache_t;
+
+/*****************************************************************************
+ * cacheHash
+ *
+ * FNV-1a over the operation and operands.
+ *****************************************************************************/
+static          solClient_uint32_t
+cacheHash ( solClient_int8_t operation, solClient_int32_t operand1, solClient_int32_t operand2 )
+{
+    solClient_uint8_t key[9];
+    solClient_uint32_t hash = 2166136261u;
+    int             i;
+
+    key[0] = ( solClient_uint8_t ) operation;
+    memcpy ( key + 1, &operand1, sizeof ( operand1 ) );
+    memcpy ( key + 5, &operand2, sizeof ( operand2 ) );
+    for ( i = 0; i < ( int ) sizeof ( key ); i++ ) {
+        hash = ( hash ^ key[i] ) * 16777619u;
+    }
+    return hash;
+}
+
+
+/*****************************************************************************
+ * cacheLruUnlink / cacheLruPush
+ *****************************************************************************/
+static void
+cacheLruUnlink ( RR_cache_t * cache_p, int e )
+{
+    RR_cacheEntry_t *entry_p = &cache_p->entries[e];
+
+    if ( entry_p->lruPrev != RR_CACHE_NONE ) {
+        cache_p->entries[entry_p->lruPrev].lruNext = entry_p->lruNext;
+    } else {
+        cache_p->lruHead = entry_p->lruNext;
+    }
+    if ( entry_p->lruNext != RR_CACHE_NONE ) {
+        cache_p->entries[entry_p->lruNext].lruPrev = entry_p->lruPrev;
+    } else {
+        cache_p->lruTail = entry_p->lruPrev;
+    }
+}
+
+static void
+cacheLruPush ( RR_cache_t * cache_p, int e )
+{
+    RR_cacheEntry_t *entry_p = &cache_p->entries[e];
+
+    entry_p->lruPrev = RR_CACHE_NONE;
+    entry_p->lruNext = cache_p->lruHead;
+    if ( cache_p->lruHead != RR_CACHE_NONE ) {
+        cache_p->entries[cache_p->lruHead].lruPrev = e;
+    } else {
+        cache_p->lruTail = e;
+    }
+    cache_p->lruHead = e;
+}
+
+
+/*****************************************************************************
+ * cacheFindSlot
+ *
+ * Returns the index slot holding the entry for the request, or the empty
+ * slot where it would be inserted.
+ *****************************************************************************/
+static int
+cacheFindSlot ( RR_cache_t * cache_p, solClient_uint32_t hash, solClient_int8_t operation,
+                solClient_int32_t operand1, solClient_int32_t operand2 )
+{
+    RR_cacheEntry_t *entry_p;
+    int             slot = ( int ) ( hash & ( RR_CACHE_SLOTS - 1 ) );
+
+    while ( cache_p->slots[slot] != RR_CACHE_NONE ) {
+        entry_p = &cache_p->entries[cache_p->slots[slot]];
+        if ( entry_p->hash == hash && entry_p->operation == operation &&
+             entry_p->operand1 == operand1 && entry_p->operand2 == operand2 ) {
+            break;
+        }
+        slot = ( slot + 1 ) & ( RR_CACHE_SLOTS - 1 );
+    }
+    return slot;
+}
+
+
+/*****************************************************************************
+ * cacheEvict
+ *
+ * Remove the least recently used ready entry, closing the gap in its probe
+ * sequence by shifting later entries back (no tombstones). Returns 0 if no
+ * entry is ready.
+ *****************************************************************************/
+static int
+cacheEvict ( RR_cache_t * cache_p )
+{
+    RR_cacheEntry_t *entry_p;
+    int             e = cache_p->lruTail;
+    int             hole;
+    int             slot;
+    int             home;
+
+    if ( e == RR_CACHE_NONE ) {
+        return 0;
+    }
+    entry_p = &cache_p->entries[e];
+    cacheLruUnlink ( cache_p, e );
+    hole = cacheFindSlot ( cache_p, entry_p->hash, entry_p->operation, entry_p->operand1, entry_p->operand2 );
+    cache_p->slots[hole] = RR_CACHE_NONE;
+    slot = hole;
+    for ( ;; ) {
+        slot = ( slot + 1 ) & ( RR_CACHE_SLOTS - 1 );
+        if ( cache_p->slots[slot] == RR_CACHE_NONE ) {
+            break;
+        }
+        /* Move the entry back unless its home lies cyclically in (hole, slot]. */
+        home = ( int ) ( cache_p->entries[cache_p->slots[slot]].hash & ( RR_CACHE_SLOTS - 1 ) );
+        if ( ( hole <= slot ) ? ( hole < home && home <= slot ) : ( hole < home || home <= slot ) ) {
+            continue;
+        }
+        cache_p->slots[hole] = cache_p->slots[slot];
+        cache_p->slots[slot] = RR_CACHE_NONE;
+        hole = slot;
+    }
+    entry_p->state = RR_CACHE_FREE;
+    entry_p->lruNext = cache_p->freeEntries;
+    cache_p->freeEntries = e;
+    cache_p->numEntries--;
+    cache_p->stats.evicted++;
+    return 1;
+}
+
+
+/*****************************************************************************
+ * cacheAddWaiter
+ *
+ * Add a request to a pending entry's waiters. Returns 0 if there is no room.
+ *****************************************************************************/
+static int
+cacheAddWaiter ( RR_cache_t * cache_p, int e, solClient_opaqueMsg_pt msg_p, char binary )
+{
+    RR_cacheWaiter_t *waiter_p;
+    int             w = cache_p->freeWaiters;
+
+    if ( w == RR_CACHE_NONE ) {
+        return 0;
+    }
+    waiter_p = &cache_p->waiters[w];
+    cache_p->freeWaiters = waiter_p->next;
+    waiter_p->msg_p = msg_p;
+    waiter_p->binary = binary;
+    waiter_p->next = cache_p->entries[e].waiters;
+    cache_p->entries[e].waiters = w;
+    return 1;
+}
+
+
+/*****************************************************************************
+ * cacheSendReply
+ *
+ * Reply to one request from a pooled message.
+ *****************************************************************************/
+static void
+cacheSendReply ( solClient_opaqueSession_pt session_p, solClient_opaqueMsg_pt msg_p, char binary,
+                 solClient_bool_t resultOk, double result )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueMsg_pt replyMsg_p;
+    solClient_uint8_t binaryReply[RR_BINARY_REPLY_SIZE];
+
+    if ( common_msgPool_get ( &replyMsg_p ) != SOLCLIENT_OK ) {
+        return;
+    }
+    if ( setReply ( replyMsg_p, binary, resultOk, result, binaryReply ) == SOLCLIENT_OK &&
+         ( rc = solClient_session_sendReply ( session_p, msg_p, replyMsg_p ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_session_sendReply()" );
-        goto freeMsg;
     }
+    common_msgPool_release ( &replyMsg_p );
+}
 
-  freeMsg:
-    if ( ( rc = solClient_msg_free ( &replyMsg_p ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_msg_free()" );
+
+/*****************************************************************************
+ * cacheMsgReceiveCallback
+ *
+ * Cache mode: answer from the cache, or coalesce onto a pending entry, or
+ * queue a new pending entry for the compute thread. Messages waiting on a
+ * pending entry are kept until they are answered.
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+cacheMsgReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    RR_cache_t     *cache_p = ( RR_cache_t * ) user_p;
+    RR_cacheEntry_t *entry_p;
+    solClient_bool_t resultOk;
+    solClient_int8_t operation = -1;
+    solClient_int32_t operand1 = -1;
+    solClient_int32_t operand2 = -1;
+    double          result = 0;
+    char            binary;
+    solClient_uint32_t hash;
+    UINT64          nowUs;
+    int             slot;
+    int             e;
+
+    if ( !decodeRequest ( msg_p, &binary, &operation, &operand1, &operand2 ) ) {
+        cacheSendReply ( opaqueSession_p, msg_p, binary, 0, 0.0 );
+        goto replied;
     }
-    msgReplied ++;
+    hash = cacheHash ( operation, operand1, operand2 );
+    nowUs = getTimeInUs (  );
+
+    mutexLock ( &cache_p->mutex );
+    if ( cache_p->stop ) {
+        /* The compute thread is draining; answer here so nothing is left pending. */
+        goto uncached;
+    }
+    slot = cacheFindSlot ( cache_p, hash, operation, operand1, operand2 );
+    e = cache_p->slots[slot];
+    if ( e != RR_CACHE_NONE ) {
+        entry_p = &cache_p->entries[e];
+        if ( entry_p->state == RR_CACHE_PENDING ) {
+            if ( cacheAddWaiter ( cache_p, e, msg_p, binary ) ) {
+                cache_p->stats.coalesced++;
+                mutexUnlock ( &cache_p->mutex );
+                return SOLCLIENT_CALLBACK_TAKE_MSG;
+            }
+            goto uncached;
+        }
+        if ( entry_p->expiresUs > nowUs ) {
+            cache_p->stats.hits++;
+            resultOk = entry_p->resultOk;
+            result = entry_p->result;
+            cacheLruUnlink ( cache_p, e );
+            cacheLruPush ( cache_p, e );
+            mutexUnlock ( &cache_p->mutex );
+            cacheSendReply ( opaqueSession_p, msg_p, binary, resultOk, result );
+            goto replied;
+        }
+        /* Expired: compute it again in the same entry. */
+        cache_p->stats.expired++;
+        cacheLruUnlink ( cache_p, e );
+    } else {
+        if ( cache_p->freeEntries == RR_CACHE_NONE && !cacheEvict ( cache_p ) ) {
+            goto uncached;
+        }
+        /* Eviction may have shifted the probe sequence. */
+        slot = cacheFindSlot ( cache_p, hash, operation, operand1, operand2 );
+        e = cache_p->freeEntries;
+        entry_p = &cache_p->entries[e];
+        cache_p->freeEntries = entry_p->lruNext;
+        cache_p->slots[slot] = e;
+        cache_p->numEntries++;
+        entry_p->hash = hash;
+        entry_p->operation = operation;
+        entry_p->operand1 = operand1;
+        entry_p->operand2 = operand2;
+    }
+    entry_p = &cache_p->entries[e];
+    entry_p->state = RR_CACHE_PENDING;
+    entry_p->waiters = RR_CACHE_NONE;
+    if ( !cacheAddWaiter ( cache_p, e, msg_p, binary ) ) {
+        /* Leave a ready entry that has already expired, so it is reused. */
+        entry_p->state = RR_CACHE_READY;
+        entry_p->expiresUs = 0;
+        cacheLruPush ( cache_p, e );
+        goto uncached;
+    }
+    cache_p->stats.misses++;
+    cache_p->work[cache_p->workTail] = e;
+    cache_p->workTail = ( cache_p->workTail + 1 ) % ( RR_CACHE_MAX_ENTRIES + 1 );
+    mutexUnlock ( &cache_p->mutex );
+    return SOLCLIENT_CALLBACK_TAKE_MSG;
+
+  uncached:
+    cache_p->stats.uncached++;
+    mutexUnlock ( &cache_p->mutex );
+    doWork (  );
+    resultOk = calculate ( operation, operand1, operand2, &result );
+    cacheSendReply ( opaqueSession_p, msg_p, binary, resultOk, result );
+
+  replied:
+    mutexLock ( &cache_p->mutex );
+    msgReplied++;
+    mutexUnlock ( &cache_p->mutex );
     return SOLCLIENT_CALLBACK_OK;
 }
 
 
+/*****************************************************************************
+ * cacheComputeThread
+ *
+ * Compute queued entries, make them ready, and answer every request waiting
+ * on them. When stopping, drain the queue before returning, so no request
+ * is left without a reply.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+cacheComputeThread ( void *arg_p )
+{
+    RR_cache_t     *cache_p = ( RR_cache_t * ) arg_p;
+    RR_cacheEntry_t *entry_p;
+    RR_cacheWaiter_t *waiter_p;
+    solClient_bool_t resultOk;
+    solClient_int8_t operation;
+    solClient_int32_t operand1;
+    solClient_int32_t operand2;
+    double          result;
+    int             e;
+    int             w;
+    int             first;
+    int             numReplied;
+    int             stopping;
+
+    for ( ;; ) {
+        mutexLock ( &cache_p->mutex );
+        if ( cache_p->workHead == cache_p->workTail ) {
+            stopping = cache_p->stop;
+            mutexUnlock ( &cache_p->mutex );
+            if ( stopping ) {
+                break;
+            }
+            sleepInUs ( 100 );
+            continue;
+        }
+        e = cache_p->work[cache_p->workHead];
+        cache_p->workHead = ( cache_p->workHead + 1 ) % ( RR_CACHE_MAX_ENTRIES + 1 );
+        entry_p = &cache_p->entries[e];
+        operation = entry_p->operation;
+        operand1 = entry_p->operand1;
+        operand2 = entry_p->operand2;
+        mutexUnlock ( &cache_p->mutex );
+
+        doWork (  );
+        result = 0;
+        resultOk = calculate ( operation, operand1, operand2, &result );
+
+        mutexLock ( &cache_p->mutex );
+        entry_p->resultOk = resultOk;
+        entry_p->result = result;
+        entry_p->expiresUs = getTimeInUs (  ) + cache_p->ttlUs;
+        entry_p->state = RR_CACHE_READY;
+        cacheLruPush ( cache_p, e );
+        first = entry_p->waiters;
+        entry_p->waiters = RR_CACHE_NONE;
+        mutexUnlock ( &cache_p->mutex );
+
+        /* The waiter list is detached, so reply to it unlocked; the entry may be evicted meanwhile. */
+        numReplied = 0;
+        for ( w = first; w != RR_CACHE_NONE; w = cache_p->waiters[w].next ) {
+            waiter_p = &cache_p->waiters[w];
+            if ( msgReplied + numReplied < RR_PRINT_LIMIT ) {
+                printRequest ( operation, operand1, operand2, resultOk, result );
+            }
+            cacheSendReply ( cache_p->session_p, waiter_p->msg_p, waiter_p->binary, resultOk, result );
+            solClient_msg_free ( &waiter_p->msg_p );
+            numReplied++;
+        }
+
+        mutexLock ( &cache_p->mutex );
+        while ( first != RR_CACHE_NONE ) {
+            w = cache_p->waiters[first].next;
+            cache_p->waiters[first].next = cache_p->freeWaiters;
+            cache_p->freeWaiters = first;
+            first = w;
+        }
+        msgReplied += numReplied;
+        mutexUnlock ( &cache_p->mutex );
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * cacheInit
+ *****************************************************************************/
+static          solClient_returnCode_t
+cacheInit ( RR_cache_t ** cache_pp, int ttlMs )
+{
+    RR_cache_t     *cache_p;
+    int             i;
+
+    if ( ( cache_p = ( RR_cache_t * ) calloc ( 1, sizeof ( *cache_p ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate the response cache" );
+        return SOLCLIENT_FAIL;
+    }
+    for ( i = 0; i < RR_CACHE_SLOTS; i++ ) {
+        cache_p->slots[i] = RR_CACHE_NONE;
+    }
+    for ( i = 0; i < RR_CACHE_MAX_ENTRIES; i++ ) {
+        cache_p->entries[i].lruNext = ( i + 1 < RR_CACHE_MAX_ENTRIES ) ? i + 1 : RR_CACHE_NONE;
+    }
+    for ( i = 0; i < RR_CACHE_MAX_WAITERS; i++ ) {
+        cache_p->waiters[i].next = ( i + 1 < RR_CACHE_MAX_WAITERS ) ? i + 1 : RR_CACHE_NONE;
+    }
+    cache_p->freeEntries = 0;
+    cache_p->freeWaiters = 0;
+    cache_p->lruHead = RR_CACHE_NONE;
+    cache_p->lruTail = RR_CACHE_NONE;
+    cache_p->ttlUs = ( UINT64 ) ttlMs * 1000;
+    mutexInit ( &cache_p->mutex );
+    *cache_pp = cache_p;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * cacheDestroy
+ *
+ * Free the cache. The compute thread answers every pending entry before it
+ * stops, so any request still waiting here is only freed as a safeguard.
+ *****************************************************************************/
+static void
+cacheDestroy ( RR_cache_t * cache_p )
+{
+    int             e;
+    int             w;
+
+    for ( e = 0; e < RR_CACHE_MAX_ENTRIES; e++ ) {
+        if ( cache_p->entries[e].state == RR_CACHE_PENDING ) {
+            for ( w = cache_p->entries[e].waiters; w != RR_CACHE_NONE; w = cache_p->waiters[w].next ) {
+                solClient_msg_free ( &cache_p->waiters[w].msg_p );
+            }
+        }
+    }
+    mutexDestroy ( &cache_p->mutex );
+    free ( cache_p );
+}
+
+
+/*****************************************************************************
+ * cachePrintStats
+ *
+ * Print the cache counters since the previous call, as rates over
+ * intervalUs.
+ *****************************************************************************/
+static void
+cachePrintStats ( RR_cache_t * cache_p, RR_cacheStats_t * last_p, UINT64 intervalUs )
+{
+    RR_cacheStats_t stats;
+    int             numEntries;
+    int             lookups;
+    double          seconds = intervalUs > 0 ? ( double ) intervalUs / 1000000.0 : 1.0;
+
+    mutexLock ( &cache_p->mutex );
+    stats = cache_p->stats;
+    numEntries = cache_p->numEntries;
+    mutexUnlock ( &cache_p->mutex );
+
+    lookups = ( stats.hits - last_p->hits ) + ( stats.misses - last_p->misses ) +
+        ( stats.coalesced - last_p->coalesced ) + ( stats.uncached - last_p->uncached );
+    if ( lookups > 0 ) {
+        printf ( "Cache: %.0f hits/s, %.0f misses/s, %.0f coalesced/s, hit ratio %.1f%%, "
+                 "%d entries, %d expired, %d evicted, %d uncached\n",
+                 ( stats.hits - last_p->hits ) / seconds, ( stats.misses - last_p->misses ) / seconds,
+                 ( stats.coalesced - last_p->coalesced ) / seconds,
+                 100.0 * ( stats.hits - last_p->hits + stats.coalesced - last_p->coalesced ) / lookups,
+                 numEntries, stats.expired - last_p->expired, stats.evicted - last_p->evicted,
+                 stats.uncached - last_p->uncached );
+    }
+    *last_p = stats;
+}
+
+
 /*
  * fn main() 
  * param appliance_ip The message backbone IP address.
@@ -153,6 +1339,22 @@ main ( int argc, char *argv[] )
     solClient_session_createFuncInfo_t sessionFuncInfo = SOLCLIENT_SESSION_CREATEFUNC_INITIALIZER;
     const char     *sessionProps[50] = {0, };
     int             propIndex = 0;
+    int             numRequests = 1;
+
+    /*************Batch mode variable definitions************/
+    RR_batch_t      batch;
+    int             batchWindowUs = 0;
+    THREAD_T        flushThread;
+    int             flushThreadStarted = 0;
+
+    /*************Cache mode variable definitions************/
+    RR_cache_t     *cache_p = NULL;
+    int             cacheTtlMs = 0;
+    THREAD_T        computeThread;
+    int             computeThreadStarted = 0;
+    RR_cacheStats_t lastCacheStats;
+    UINT64          lastStatsUs;
+    UINT64          nowUs;
 
     printf ( "\nBasicReplier.c (Copyright 2013-2019 Solace Corporation. All rights reserved.)\n" );
 
@@ -166,8 +1368,34 @@ main ( int argc, char *argv[] )
                                 PASS_PARAM_MASK |
                                 LOG_LEVEL_MASK |
                                 USE_GSS_MASK |
-                                ZIP_LEVEL_MASK));                       /* optional parameters */
-    if ( common_parseCommandOptions ( argc, argv, &commandOpts, NULL ) == 0 ) {
+                                ZIP_LEVEL_MASK |
+                                POOL_TUNING_MASK |
+                                PROFILE_MASK |
+                                METADATA_MASK));                        /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[REQUESTS]    Requests to serve before exiting, 0 to serve until Ctrl-C (default 1).\n"
+            "\t[BATCH_US]    Batch mode: collect requests for up to this many microseconds (or 64\n"
+            "\t              requests), evaluate them together and send the replies in one burst\n"
+            "\t              (default 0, reply to each request as it arrives).\n"
+            "\t[CACHE_TTL_MS] Cache mode: cache results for this many milliseconds and compute\n"
+            "\t              identical pending requests once (default 0, no cache). Not with BATCH_US.\n"
+            "\t[WORK_US]     Simulated CPU cost of each calculation, except in batch mode (default 0).\n" ) == 0 ) {
+        exit (1);
+    }
+    if ( optind < argc ) {
+        numRequests = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        batchWindowUs = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        cacheTtlMs = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        rrWorkUs = atoi ( argv[optind++] );
+    }
+    if ( batchWindowUs > 0 && cacheTtlMs > 0 ) {
+        printf ( "Batch mode and cache mode cannot be combined\n" );
         exit (1);
     }
 
@@ -176,8 +1404,7 @@ main ( int argc, char *argv[] )
      * Initialize the API and setup logging level
      *************************************************************************/
     /* solClient needs to be initialized before any other API calls are made. */
-    if ( ( rc = solClient_initialize ( SOLCLIENT_LOG_DEFAULT_FILTER, NULL ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_initialize()" );
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
         goto cleanup;
     }
 
@@ -211,8 +1438,25 @@ main ( int argc, char *argv[] )
      *************************************************************************/
     solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient sessions." );
 
-    sessionFuncInfo.rxMsgInfo.callback_p = requestMsgReceiveCallback;
-    sessionFuncInfo.rxMsgInfo.user_p = NULL;
+    if ( batchWindowUs > 0 ) {
+        if ( ( rc = batchInit ( &batch, batchWindowUs ) ) != SOLCLIENT_OK ) {
+            goto cleanup;
+        }
+        printf ( "Batch mode: up to %d requests or %d us per batch, %s kernel\n",
+                 RR_BATCH_MAX, batchWindowUs, batch.kernelName_p );
+        sessionFuncInfo.rxMsgInfo.callback_p = batchMsgReceiveCallback;
+        sessionFuncInfo.rxMsgInfo.user_p = &batch;
+    } else if ( cacheTtlMs > 0 ) {
+        if ( ( rc = cacheInit ( &cache_p, cacheTtlMs ) ) != SOLCLIENT_OK ) {
+            goto cleanup;
+        }
+        printf ( "Cache mode: %d ms TTL, up to %d entries\n", cacheTtlMs, RR_CACHE_MAX_ENTRIES );
+        sessionFuncInfo.rxMsgInfo.callback_p = cacheMsgReceiveCallback;
+        sessionFuncInfo.rxMsgInfo.user_p = cache_p;
+    } else {
+        sessionFuncInfo.rxMsgInfo.callback_p = requestMsgReceiveCallback;
+        sessionFuncInfo.rxMsgInfo.user_p = NULL;
+    }
     sessionFuncInfo.eventInfo.callback_p = common_eventCallback;
     sessionFuncInfo.eventInfo.user_p = NULL;;
 
@@ -224,7 +1468,8 @@ main ( int argc, char *argv[] )
     }
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_COMPRESSION_LEVEL;
-    sessionProps[propIndex++] = ( commandOpts.enableCompression ) ? "9" : "0";
+    sessionProps[propIndex++] = ( commandOpts.compressionLevel > 0 ) ?
+            common_zipLevelStrings[commandOpts.compressionLevel] : "0";
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_CONNECT_RETRIES;
     sessionProps[propIndex++] = "3";
@@ -245,17 +1490,20 @@ main ( int argc, char *argv[] )
      * Note: Including meta data fields such as sender timestamp, sender ID, and sequence 
      * number can reduce the maximum attainable throughput as significant extra encoding/
      * decodingis required. This is true whether the fields are autogenerated or manually
-     * added.
+     * added. Each field can be turned off with --metadata.
      */
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SEND_TIMESTAMPS;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commandOpts.genMetadata & COMMON_METADATA_SEND_TIMESTAMP ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SENDER_ID;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commandOpts.genMetadata & COMMON_METADATA_SENDER_ID ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SEQUENCE_NUMBER;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commandOpts.genMetadata & COMMON_METADATA_SEQUENCE_NUMBER ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     if ( commandOpts.vpn[0] ) {
         sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_VPN_NAME;
@@ -283,6 +1531,8 @@ main ( int argc, char *argv[] )
         sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_AUTHENTICATION_SCHEME_GSS_KRB;
     }
 
+    propIndex = common_addTuningSessionProps ( &commandOpts, sessionProps, propIndex );
+
     /*
      * Create a session.
      */
@@ -290,7 +1540,11 @@ main ( int argc, char *argv[] )
                                            context_p,
                                            &session_p, &sessionFuncInfo, sizeof ( sessionFuncInfo ) ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_session_create()" );
-         goto cleanup;
+         goto replyModeCreated;
+    }
+    batch.session_p = session_p;
+    if ( cache_p != NULL ) {
+        cache_p->session_p = session_p;
     }
 
     /*
@@ -298,7 +1552,7 @@ main ( int argc, char *argv[] )
      */
     if ( ( rc = solClient_session_connect ( session_p ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_session_connect()" );
-         goto cleanup;
+         goto replyModeCreated;
     }
 
     /*************************************************************************
@@ -311,23 +1565,79 @@ main ( int argc, char *argv[] )
         goto sessionConnected;
     }
 
+    if ( batchWindowUs > 0 ) {
+        if ( threadCreate ( &flushThread, batchFlushThread, &batch ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not start the batch flush thread" );
+            goto sessionConnected;
+        }
+        flushThreadStarted = 1;
+    }
+    if ( cache_p != NULL ) {
+        if ( threadCreate ( &computeThread, cacheComputeThread, cache_p ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not start the cache compute thread" );
+            goto sessionConnected;
+        }
+        computeThreadStarted = 1;
+    }
+
     /*************************************************************************
      * Serve requests, CTRL-C to stop
      *************************************************************************/
     printf ( "Serving requests on topic '%s', Ctrl-C to stop.....\n", commandOpts.destinationName );
-    while ( msgReplied < 1) {
+    memset ( &lastCacheStats, 0, sizeof ( lastCacheStats ) );
+    lastStatsUs = getTimeInUs (  );
+    while ( numRequests == 0 || msgReplied < numRequests ) {
         SLEEP(1);
+        if ( cache_p != NULL ) {
+            nowUs = getTimeInUs (  );
+            cachePrintStats ( cache_p, &lastCacheStats, nowUs - lastStatsUs );
+            lastStatsUs = nowUs;
+        }
     }
 
     /*************************************************************************
      * CLEANUP
      *************************************************************************/
   sessionConnected:
+    /* Flush the last batch before disconnecting. */
+    if ( flushThreadStarted ) {
+        batch.stop = 1;
+        threadJoin ( flushThread );
+        printf ( "Replied to %d requests in %d batches (%.1f per batch), %d buffers, %d sends retried, %d replies failed\n",
+                 batch.numBatched, batch.numBatches,
+                 batch.numBatches > 0 ? ( double ) batch.numBatched / batch.numBatches : 0.0,
+                 batch.numBufs, batch.numRetries, batch.numFailed );
+    }
+    if ( cache_p != NULL ) {
+        /* Answer every pending entry; drain here if the thread never started. */
+        cache_p->stop = 1;
+        if ( computeThreadStarted ) {
+            threadJoin ( computeThread );
+        } else {
+            cacheComputeThread ( cache_p );
+        }
+        printf ( "Cache totals: %d hits, %d misses, %d coalesced, %d expired, %d evicted, %d uncached\n",
+                 cache_p->stats.hits, cache_p->stats.misses, cache_p->stats.coalesced,
+                 cache_p->stats.expired, cache_p->stats.evicted, cache_p->stats.uncached );
+    }
+
     /* Disconnect the Session. */
     if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_session_disconnect()" );
     }
 
+    /* Report and free the pooled messages. */
+    common_msgPool_printStats (  );
+    common_msgPool_cleanup (  );
+
+  replyModeCreated:
+    if ( batchWindowUs > 0 ) {
+        batchDestroy ( &batch );
+    }
+    if ( cache_p != NULL ) {
+        cacheDestroy ( cache_p );
+    }
+
   cleanup:
     /* Cleanup solClient. */
     if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
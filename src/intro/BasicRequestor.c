@@ -13,6 +13,11 @@
  *  | BasicRequestor |                      | BasicReplier  |
  *  |----------------|  <--ReplyToTopic---- |---------------|
  *
+ * Given REQUESTS and THREADS, it also compares THREADS threads making
+ * requests through the one Session with solClient_session_sendRequest()
+ * against a shared temporary reply topic, where replies are matched to
+ * the waiting threads by correlation ID (see common_replyRouter_init()).
+ *
  * Copyright 2013-2019 Solace Corporation. All rights reserved.
  *
  */
@@ -25,7 +30,96 @@
 #include "solclient/solClient.h"
 #include "solclient/solClientMsg.h"
 #include "common.h"
+#include "pool.h"
+#include "replyrouter.h"
 #include "RRcommon.h"
+#include "getopt.h"
+
+
+/* Requests sent, untimed, before each benchmark run. */
+#define RR_BENCH_WARMUP 1000
+
+/*****************************************************************************
+ * setRequest
+ *
+ * Put the operation and operands into the request message, in the given
+ * wire format. For the binary format, the message references buf_p, which
+ * must hold RR_BINARY_REQUEST_SIZE bytes and outlive the send.
+ *****************************************************************************/
+static          solClient_returnCode_t
+setRequest ( solClient_opaqueMsg_pt msg_p, int wireFormat, RR_operation_t operation,
+             solClient_int32_t operand1, solClient_int32_t operand2, solClient_uint8_t *buf_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueContainer_pt stream_p;
+
+    if ( wireFormat == COMMON_WIRE_BINARY ) {
+        RR_encodeBinaryRequest ( buf_p, operation, operand1, operand2 );
+        if ( ( rc = solClient_msg_setBinaryAttachmentPtr ( msg_p, buf_p, RR_BINARY_REQUEST_SIZE ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setBinaryAttachmentPtr()" );
+        }
+        return rc;
+    }
+    /* Create a stream in the binary attachment part of the message. */
+    if ( ( rc = solClient_msg_createBinaryAttachmentStream ( msg_p, &stream_p, 100 ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_createBinaryAttachmentStream()" );
+        return rc;
+    }
+    /* Put the operation, operand1, operand2 into the stream. */
+    if ( ( rc = solClient_container_addInt8 ( stream_p, ( solClient_int8_t ) operation, NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_container_addInt8()" );
+        return rc;
+    }
+    if ( ( rc = solClient_container_addInt32 ( stream_p, operand1, NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_container_addInt32()" );
+        return rc;
+    }
+    if ( ( rc = solClient_container_addInt32 ( stream_p, operand2, NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_container_addInt32()" );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * getReply
+ *
+ * Get the result status and result (if OK) from a reply message in the
+ * given wire format.
+ *****************************************************************************/
+static          solClient_returnCode_t
+getReply ( solClient_opaqueMsg_pt replyMsg_p, int wireFormat, solClient_bool_t * resultOk_p, double *result_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueContainer_pt replyStream_p;
+    void           *reply_p;
+    solClient_uint32_t replySize;
+
+    if ( wireFormat == COMMON_WIRE_BINARY ) {
+        if ( ( rc = solClient_msg_getBinaryAttachmentPtr ( replyMsg_p, &reply_p, &replySize ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_getBinaryAttachmentPtr()" );
+            return rc;
+        }
+        if ( ( rc = RR_decodeBinaryReply ( reply_p, replySize, resultOk_p, result_p ) ) != SOLCLIENT_OK ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Received malformed binary reply of %u bytes", replySize );
+        }
+        return rc;
+    }
+    if ( ( rc = solClient_msg_getBinaryAttachmentStream ( replyMsg_p, &replyStream_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_getBinaryAttachmentStream()" );
+        return rc;
+    }
+    if ( ( rc = solClient_container_getBoolean ( replyStream_p, resultOk_p, NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_container_getBool()" );
+        return rc;
+    }
+    if ( *resultOk_p ) {
+        if ( ( rc = solClient_container_getDouble ( replyStream_p, result_p, NULL ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_container_getDouble()" );
+        }
+    }
+    return rc;
+}
 
 
 /********************** Send Blocking  Requests********************************
@@ -33,24 +127,22 @@
  * print out the results when the reply is received.
  ******************************************************************************/
 static void
-sendRequests ( solClient_opaqueSession_pt opaqueSession_p, const char *destinationName )
+sendRequests ( solClient_opaqueSession_pt opaqueSession_p, const char *destinationName, int wireFormat )
 {
     solClient_returnCode_t rc;
     solClient_opaqueMsg_pt msg_p;
     solClient_opaqueMsg_pt replyMsg_p;
     solClient_destination_t destination;
-    solClient_opaqueContainer_pt stream_p;
-    solClient_opaqueContainer_pt replyStream_p;
     RR_operation_t     operation;
     solClient_uint32_t operand1 = 9;
     solClient_uint32_t operand2 = 5;
     solClient_bool_t resultOk;
     double result;
+    solClient_uint8_t binaryRequest[RR_BINARY_REQUEST_SIZE];
 
 
-    /* Allocate a message for requests. */
-    if ( ( rc = solClient_msg_alloc ( &msg_p ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_msg_alloc()" );
+    /* Take a message for requests from the message pool. */
+    if ( ( rc = common_msgPool_get ( &msg_p ) ) != SOLCLIENT_OK ) {
         return;
     }
     /* Note: A bad operation is purposely sent in this example (lastOperation + 1). */
@@ -68,47 +160,20 @@ sendRequests ( solClient_opaqueSession_pt opaqueSession_p, const char *destinati
             common_handleError ( rc, "solClient_msg_setDestination()" );
             goto freeMsg;
         }
-        /* Create a stream in the binary attachment part of the message. */
-        if ( ( rc = solClient_msg_createBinaryAttachmentStream ( msg_p, &stream_p, 100 ) ) != SOLCLIENT_OK ) {
-            common_handleError ( rc, "solClient_msg_createBinaryAttachmentStream()" );
-            goto freeMsg;
-        }
-        /* Put the operation, operand1, operand2 into the stream. */
-        if ( ( rc = solClient_container_addInt8 ( stream_p, ( solClient_int8_t ) operation, NULL ) ) != SOLCLIENT_OK ) {
-            common_handleError ( rc, "solClient_container_addInt8()" );
-            goto freeMsg;
-        }
-        if ( ( rc = solClient_container_addInt32 ( stream_p, operand1, NULL ) ) != SOLCLIENT_OK ) {
-            common_handleError ( rc, "solClient_container_addInt32()" );
-            goto freeMsg;
-        }
-        if ( ( rc = solClient_container_addInt32 ( stream_p, operand2, NULL ) ) != SOLCLIENT_OK ) {
-            common_handleError ( rc, "solClient_container_addInt32()" );
+        if ( ( rc = setRequest ( msg_p, wireFormat, operation, operand1, operand2, binaryRequest ) ) != SOLCLIENT_OK ) {
             goto freeMsg;
         }
         /* Send a blocking request. */
         if ( ( rc = solClient_session_sendRequest ( opaqueSession_p,
                                                     msg_p, &replyMsg_p, 5000 /* timeout in milliseconds */  ) ) == SOLCLIENT_OK ) {
 
-            /* Get the result status and result (if OK) from the reply message. */
-            if ( ( rc = solClient_msg_getBinaryAttachmentStream ( replyMsg_p, &replyStream_p ) ) != SOLCLIENT_OK ) {
-                common_handleError ( rc, "solClient_msg_getBinaryAttachmentStream()" );
-                goto freeReplyMsg;
-            }
-            if ( ( rc = solClient_container_getBoolean ( replyStream_p, &resultOk, NULL ) ) != SOLCLIENT_OK ) {
-                common_handleError ( rc, "solClient_container_getBool()" );
-                goto freeReplyMsg;
-            }
-            if ( resultOk ) {
-                if ( ( rc = solClient_container_getDouble ( replyStream_p, (double *)&result, NULL ) ) != SOLCLIENT_OK ) {
-                    common_handleError ( rc, "solClient_container_getDouble()" );
-                    goto freeReplyMsg;
+            if ( getReply ( replyMsg_p, wireFormat, &resultOk, &result ) == SOLCLIENT_OK ) {
+                if ( resultOk ) {
+                    printf ( "Received reply message, result = %f\n", result );
+                } else {
+                    solClient_log ( SOLCLIENT_LOG_ERROR, "Received reply message with failed status." );
                 }
-                printf ( "Received reply message, result = %f\n", result );
-            } else {
-                solClient_log ( SOLCLIENT_LOG_ERROR, "Received reply message with failed status." );
             }
-          freeReplyMsg:
             /* Done with the reply message, so free it */
             if ( ( rc = solClient_msg_free ( &replyMsg_p ) ) != SOLCLIENT_OK ) {
                 common_handleError ( rc, "solClient_msg_free()" );
@@ -124,10 +189,267 @@ sendRequests ( solClient_opaqueSession_pt opaqueSession_p, const char *destinati
     }
 
   freeMsg:
-    /* Finally, free the request message. */
-    if ( ( rc = solClient_msg_free ( &msg_p ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_msg_free()" );
+    /* Finally, return the request message to the pool. */
+    common_msgPool_release ( &msg_p );
+}
+
+
+/*****************************************************************************
+ * benchRequests
+ *
+ * Send numRequests blocking requests, after RR_BENCH_WARMUP untimed ones, in
+ * the given wire format, and print the round-trip time percentiles and the
+ * process CPU time per request. CPU time covers the whole process, including
+ * the Context thread, so it includes receiving as well as sending.
+ *****************************************************************************/
+static          solClient_returnCode_t
+benchRequests ( solClient_opaqueSession_pt opaqueSession_p, const char *destinationName, int wireFormat, int numRequests )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt msg_p;
+    solClient_opaqueMsg_pt replyMsg_p;
+    solClient_destination_t destination;
+    solClient_bool_t resultOk;
+    double          result;
+    solClient_uint8_t binaryRequest[RR_BINARY_REQUEST_SIZE];
+    solClient_uint64_t *rtts_p;
+    UINT64          sendUs;
+    UINT64          startUs;
+    UINT64          elapsedUs;
+    UINT64          userUs;
+    UINT64          systemUs;
+    UINT64          startCpuUs;
+    int             i;
+    int             numTimed = 0;
+    int             numFailed = 0;
+
+    if ( ( rtts_p = ( solClient_uint64_t * ) malloc ( numRequests * sizeof ( *rtts_p ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate %d latency samples", numRequests );
+        return SOLCLIENT_FAIL;
+    }
+    if ( ( rc = common_msgPool_get ( &msg_p ) ) != SOLCLIENT_OK ) {
+        free ( rtts_p );
+        return rc;
+    }
+    destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+    destination.dest = destinationName;
+
+    startUs = 0;
+    startCpuUs = 0;
+    for ( i = -RR_BENCH_WARMUP; i < numRequests; i++ ) {
+        if ( i == 0 ) {
+            getCpuTimesInUs ( &userUs, &systemUs );
+            startCpuUs = userUs + systemUs;
+            startUs = getTimeInUs (  );
+        }
+        sendUs = getTimeInUs (  );
+        if ( ( rc = solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setDestination()" );
+            break;
+        }
+        if ( ( rc = setRequest ( msg_p, wireFormat, ( RR_operation_t ) ( firstOperation + ( i & 3 ) ),
+                                 i, 7, binaryRequest ) ) != SOLCLIENT_OK ) {
+            break;
+        }
+        if ( ( rc = solClient_session_sendRequest ( opaqueSession_p, msg_p, &replyMsg_p, 5000 ) ) == SOLCLIENT_OK ) {
+            if ( getReply ( replyMsg_p, wireFormat, &resultOk, &result ) != SOLCLIENT_OK || !resultOk ) {
+                numFailed++;
+            } else if ( i >= 0 ) {
+                rtts_p[numTimed++] = getTimeInUs (  ) - sendUs;
+            }
+            solClient_msg_free ( &replyMsg_p );
+        } else {
+            common_handleError ( rc, "solClient_session_sendRequest()" );
+            numFailed++;
+        }
+        if ( ( rc = solClient_msg_reset ( msg_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_reset()" );
+            break;
+        }
     }
+    elapsedUs = getTimeInUs (  ) - startUs;
+    getCpuTimesInUs ( &userUs, &systemUs );
+    common_msgPool_release ( &msg_p );
+
+    if ( rc == SOLCLIENT_OK ) {
+        common_sortSamples ( rtts_p, numTimed );
+        printf ( "%-7s %10d %6d %9.1f %9llu %9llu %9llu %11.2f\n",
+                 wireFormat == COMMON_WIRE_BINARY ? "binary" : "sdt", numTimed, numFailed,
+                 numTimed > 0 ? ( double ) elapsedUs / numTimed : 0.0,
+                 ( unsigned long long ) common_getPercentile ( rtts_p, numTimed, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( rtts_p, numTimed, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( rtts_p, numTimed, 100.0 ),
+                 numRequests > 0 ? ( double ) ( userUs + systemUs - startCpuUs ) / numRequests : 0.0 );
+    }
+    free ( rtts_p );
+    return rc;
+}
+
+
+/*
+ * Per-thread state of the multi-threaded benchmark. The requester is only
+ * used with the shared reply router.
+ */
+typedef struct rr_benchThread
+{
+    solClient_opaqueSession_pt session_p;
+    const char     *destinationName;
+    int             wireFormat;
+    int             numRequests;
+    int             useRouter;
+    common_replyRequester_t requester;
+    THREAD_T        thread;
+    solClient_uint64_t *rtts_p;
+    int             numTimed;
+    int             numFailed;
+    UINT64          elapsedUs;
+} rr_benchThread_t;
+
+
+/*****************************************************************************
+ * benchThread
+ *
+ * Send a thread's requests one at a time, through solClient_session_sendRequest()
+ * or the shared reply router.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+benchThread ( void *user_p )
+{
+    rr_benchThread_t *bench_p = ( rr_benchThread_t * ) user_p;
+    solClient_returnCode_t rc;
+    solClient_opaqueMsg_pt msg_p;
+    solClient_opaqueMsg_pt replyMsg_p;
+    solClient_destination_t destination;
+    solClient_bool_t resultOk;
+    double          result;
+    solClient_uint8_t binaryRequest[RR_BINARY_REQUEST_SIZE];
+    UINT64          sendUs;
+    UINT64          startUs;
+    int             i;
+
+    if ( common_msgPool_get ( &msg_p ) != SOLCLIENT_OK ) {
+        bench_p->numFailed = bench_p->numRequests;
+        return THREAD_FUNC_RETURN_VAL;
+    }
+    destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+    destination.dest = bench_p->destinationName;
+    startUs = getTimeInUs (  );
+    for ( i = 0; i < bench_p->numRequests; i++ ) {
+        sendUs = getTimeInUs (  );
+        if ( solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) ) != SOLCLIENT_OK ||
+             setRequest ( msg_p, bench_p->wireFormat, ( RR_operation_t ) ( firstOperation + ( i & 3 ) ),
+                          i, 7, binaryRequest ) != SOLCLIENT_OK ) {
+            bench_p->numFailed++;
+            break;
+        }
+        if ( bench_p->useRouter ) {
+            rc = common_replyRouter_request ( &bench_p->requester, msg_p, &replyMsg_p, 5000 );
+        } else {
+            rc = solClient_session_sendRequest ( bench_p->session_p, msg_p, &replyMsg_p, 5000 );
+        }
+        if ( rc == SOLCLIENT_OK ) {
+            if ( getReply ( replyMsg_p, bench_p->wireFormat, &resultOk, &result ) != SOLCLIENT_OK || !resultOk ) {
+                bench_p->numFailed++;
+            } else {
+                bench_p->rtts_p[bench_p->numTimed++] = getTimeInUs (  ) - sendUs;
+            }
+            solClient_msg_free ( &replyMsg_p );
+        } else {
+            bench_p->numFailed++;
+        }
+        if ( solClient_msg_reset ( msg_p ) != SOLCLIENT_OK ) {
+            break;
+        }
+    }
+    bench_p->elapsedUs = getTimeInUs (  ) - startUs;
+    common_msgPool_release ( &msg_p );
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * benchThreadedRequests
+ *
+ * Send numRequests requests on each of numThreads threads sharing the
+ * Session, and print each thread's request rate and round-trip times and
+ * the total rate. With a router, replies come to its temporary topic and
+ * are matched by correlation ID; otherwise solClient_session_sendRequest()
+ * handles them.
+ *****************************************************************************/
+static          solClient_returnCode_t
+benchThreadedRequests ( solClient_opaqueSession_pt opaqueSession_p, const char *destinationName, int wireFormat,
+                        int numThreads, int numRequests, common_replyRouter_pt router_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    rr_benchThread_t *threads_p;
+    rr_benchThread_t *bench_p;
+    solClient_uint64_t totalRequests = 0;
+    UINT64          startUs;
+    UINT64          elapsedUs;
+    int             numStarted;
+    int             i;
+
+    if ( ( threads_p = ( rr_benchThread_t * ) calloc ( numThreads, sizeof ( rr_benchThread_t ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate %d benchmark threads", numThreads );
+        return SOLCLIENT_FAIL;
+    }
+    for ( i = 0; i < numThreads; i++ ) {
+        bench_p = &threads_p[i];
+        bench_p->session_p = opaqueSession_p;
+        bench_p->destinationName = destinationName;
+        bench_p->wireFormat = wireFormat;
+        bench_p->numRequests = numRequests;
+        bench_p->useRouter = ( router_p != NULL );
+        if ( router_p != NULL ) {
+            common_replyRouter_initRequester ( router_p, &bench_p->requester, ( unsigned int ) i );
+        }
+        if ( ( bench_p->rtts_p = ( solClient_uint64_t * ) malloc ( numRequests * sizeof ( solClient_uint64_t ) ) ) == NULL ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate %d latency samples", numRequests );
+            rc = SOLCLIENT_FAIL;
+            goto freeThreads;
+        }
+    }
+
+    startUs = getTimeInUs (  );
+    for ( numStarted = 0; numStarted < numThreads; numStarted++ ) {
+        if ( threadCreate ( &threads_p[numStarted].thread, benchThread, &threads_p[numStarted] ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not start benchmark thread %d", numStarted );
+            rc = SOLCLIENT_FAIL;
+            break;
+        }
+    }
+    for ( i = 0; i < numStarted; i++ ) {
+        threadJoin ( threads_p[i].thread );
+    }
+    elapsedUs = getTimeInUs (  ) - startUs;
+
+    printf ( "\n%d threads, %s:\n", numStarted,
+             router_p != NULL ? "shared reply topic and correlation table" : "solClient_session_sendRequest()" );
+    printf ( "%6s %10s %6s %9s %9s %9s %9s\n", "Thread", "Requests", "Failed", "Req/s", "p50 us", "p99 us", "Max us" );
+    for ( i = 0; i < numStarted; i++ ) {
+        bench_p = &threads_p[i];
+        common_sortSamples ( bench_p->rtts_p, bench_p->numTimed );
+        printf ( "%6d %10d %6d %9.0f %9llu %9llu %9llu\n", i, bench_p->numTimed, bench_p->numFailed,
+                 bench_p->elapsedUs > 0 ? bench_p->numTimed * 1000000.0 / bench_p->elapsedUs : 0.0,
+                 ( unsigned long long ) common_getPercentile ( bench_p->rtts_p, bench_p->numTimed, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( bench_p->rtts_p, bench_p->numTimed, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( bench_p->rtts_p, bench_p->numTimed, 100.0 ) );
+        totalRequests += bench_p->numTimed;
+        if ( router_p != NULL && ( bench_p->requester.timeouts > 0 || bench_p->requester.claimProbes > 0 ) ) {
+            printf ( "       %llu timed out, %llu slots found in use\n",
+                     ( unsigned long long ) bench_p->requester.timeouts,
+                     ( unsigned long long ) bench_p->requester.claimProbes );
+        }
+    }
+    printf ( "Total: %llu requests in %.3f s, %.0f requests/s\n", ( unsigned long long ) totalRequests,
+             elapsedUs / 1000000.0, elapsedUs > 0 ? totalRequests * 1000000.0 / elapsedUs : 0.0 );
+
+  freeThreads:
+    for ( i = 0; i < numThreads; i++ ) {
+        free ( threads_p[i].rtts_p );
+    }
+    free ( threads_p );
+    return rc;
 }
 
 
@@ -154,6 +476,9 @@ main ( int argc, char *argv[] )
     solClient_session_createFuncInfo_t sessionFuncInfo = SOLCLIENT_SESSION_CREATEFUNC_INITIALIZER;
     const char     *sessionProps[50];
     int             propIndex = 0;
+    int             numBenchRequests = 0;
+    int             numBenchThreads = 0;
+    common_replyRouter_t router;
 
     /************ Basic initialization *********************/
     printf ( "\nBasicRequestor.c (Copyright 2013-2019 Solace Corporation. All rights reserved.)\n" );
@@ -168,18 +493,36 @@ main ( int argc, char *argv[] )
                                 PASS_PARAM_MASK |
                                 LOG_LEVEL_MASK |
                                 USE_GSS_MASK |
-                                ZIP_LEVEL_MASK));                       /* optional parameters */
-    if ( common_parseCommandOptions ( argc, argv, &commandOpts, NULL ) == 0 ) {
+                                ZIP_LEVEL_MASK |
+                                POOL_TUNING_MASK |
+                                PROFILE_MASK |
+                                METADATA_MASK |
+                                WIRE_FORMAT_MASK));                     /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[REQUESTS] [THREADS]   When given, also time this many requests in each wire format, with\n"
+            "\t              the replier started with REQUESTS 0 (default: no benchmark). With THREADS, then\n"
+            "\t              send REQUESTS from each of THREADS threads, through solClient_session_sendRequest()\n"
+            "\t              and through a shared reply topic.\n" ) == 0 ) {
+        exit (1);
+    }
+    if ( optind < argc ) {
+        numBenchRequests = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        numBenchThreads = atoi ( argv[optind++] );
+    }
+    if ( numBenchThreads > 0 && numBenchRequests <= 0 ) {
+        printf ( "THREADS needs REQUESTS\n" );
         exit (1);
     }
+    memset ( &router, 0, sizeof ( router ) );
 
 
     /*************************************************************************
      * Initialize the API and setup logging level
      *************************************************************************/
     /* solClient needs to be initialized before any other API calls are made. */
-    if ( ( rc = solClient_initialize ( SOLCLIENT_LOG_DEFAULT_FILTER, NULL ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_initialize()" );
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
         goto cleanup;
     }
 
@@ -215,6 +558,14 @@ main ( int argc, char *argv[] )
 
     sessionFuncInfo.rxMsgInfo.callback_p = common_messageReceivePrintMsgCallback;
     sessionFuncInfo.rxMsgInfo.user_p = NULL;
+    if ( numBenchThreads > 0 ) {
+        /* Replies to the shared reply topic are routed by correlation ID. */
+        if ( ( rc = common_replyRouter_init ( &router, COMMON_REPLY_DEFAULT_SLOTS ) ) != SOLCLIENT_OK ) {
+            goto cleanup;
+        }
+        sessionFuncInfo.rxMsgInfo.callback_p = common_replyRouter_messageReceiveCallback;
+        sessionFuncInfo.rxMsgInfo.user_p = &router;
+    }
     sessionFuncInfo.eventInfo.callback_p = common_eventCallback;
     sessionFuncInfo.eventInfo.user_p = NULL;;
 
@@ -226,7 +577,8 @@ main ( int argc, char *argv[] )
     }
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_COMPRESSION_LEVEL;
-    sessionProps[propIndex++] = ( commandOpts.enableCompression ) ? "9" : "0";
+    sessionProps[propIndex++] = ( commandOpts.compressionLevel > 0 ) ?
+            common_zipLevelStrings[commandOpts.compressionLevel] : "0";
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_CONNECT_RETRIES;
     sessionProps[propIndex++] = "3";
@@ -247,17 +599,20 @@ main ( int argc, char *argv[] )
      * Note: Including meta data fields such as sender timestamp, sender ID, and sequence 
      * number can reduce the maximum attainable throughput as significant extra encoding/
      * decodingis required. This is true whether the fields are autogenerated or manually
-     * added.
+     * added. Each field can be turned off with --metadata.
      */
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SEND_TIMESTAMPS;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commandOpts.genMetadata & COMMON_METADATA_SEND_TIMESTAMP ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SENDER_ID;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commandOpts.genMetadata & COMMON_METADATA_SENDER_ID ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SEQUENCE_NUMBER;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commandOpts.genMetadata & COMMON_METADATA_SEQUENCE_NUMBER ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     if ( commandOpts.vpn[0] ) {
         sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_VPN_NAME;
@@ -286,6 +641,8 @@ main ( int argc, char *argv[] )
         sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_AUTHENTICATION_SCHEME_GSS_KRB;
     }
 
+    propIndex = common_addTuningSessionProps ( &commandOpts, sessionProps, propIndex );
+
     sessionProps[propIndex] = NULL;
 
     /*
@@ -308,7 +665,32 @@ main ( int argc, char *argv[] )
 
 
     /* Send the requests and wait for the responses. */
-    sendRequests ( session_p,  commandOpts.destinationName);
+    sendRequests ( session_p,  commandOpts.destinationName, commandOpts.wireFormat );
+
+    /*
+     * Compare the wire formats: the structured data stream first, then the
+     * fixed-layout binary payload, against the same replier.
+     */
+    if ( numBenchRequests > 0 ) {
+        printf ( "\n%-7s %10s %6s %9s %9s %9s %9s %11s\n", "Format", "Requests", "Failed",
+                 "Avg us", "p50 us", "p99 us", "Max us", "CPU us/req" );
+        if ( benchRequests ( session_p, commandOpts.destinationName, COMMON_WIRE_SDT, numBenchRequests ) == SOLCLIENT_OK ) {
+            benchRequests ( session_p, commandOpts.destinationName, COMMON_WIRE_BINARY, numBenchRequests );
+        }
+    }
+
+    /*
+     * Compare many threads making requests through the one Session, first
+     * with solClient_session_sendRequest(), then with the shared reply topic.
+     */
+    if ( numBenchThreads > 0 && common_replyRouter_start ( &router, session_p ) == SOLCLIENT_OK ) {
+        if ( benchThreadedRequests ( session_p, commandOpts.destinationName, commandOpts.wireFormat,
+                                     numBenchThreads, numBenchRequests, NULL ) == SOLCLIENT_OK ) {
+            benchThreadedRequests ( session_p, commandOpts.destinationName, commandOpts.wireFormat,
+                                    numBenchThreads, numBenchRequests, &router );
+        }
+        common_replyRouter_printStats ( &router );
+    }
 
     /*************************************************************************
      * CLEANUP
@@ -318,7 +700,13 @@ main ( int argc, char *argv[] )
         common_handleError ( rc, "solClient_session_disconnect()" );
     }
 
+    /* Report and free the pooled messages. */
+    common_msgPool_printStats (  );
+    common_msgPool_cleanup (  );
+
   cleanup:
+    common_replyRouter_destroy ( &router );
+
     /* Cleanup solClient. */
     if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
         common_handleError ( rc, "solClient_cleanup()" );
@@ -0,0 +1,273 @@
+
+/** @example Intro/BulkTopicToQueueMapping.c
+ */
+
+/*
+ * This sample provisions a routing topology: Queues and the Topics mapped
+ * to them, read from a file. Unlike TopicToQueueMapping.c, which waits for
+ * each Queue and Topic in turn, it keeps up to WINDOW operations outstanding
+ * with a provisioner (see common_provisioner_init()) and reports the
+ * provisioning rate. A WINDOW of 1 provisions one step at a time, for
+ * comparison.
+ *
+ * Each line of FILE is "<queue> <topic>" to map the topic to the Queue, or
+ * "<queue>" alone to only provision the Queue. Blank lines and lines
+ * starting with '#' are skipped. Queues are created as common_createQueue()
+ * does; existing Queues and mappings are left as they are.
+ *
+ * Sample Requirements:
+ *  - The message router connection must support adding Topics to Queues
+ *    and endpoint management.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "provisioner.h"
+#include "getopt.h"
+
+#define BULK_DEFAULT_WINDOW     256
+
+
+/*****************************************************************************
+ * bulk_readFile
+ *
+ * Read a whole file into a NUL-terminated buffer, which the caller frees.
+ *****************************************************************************/
+static char    *
+bulk_readFile ( const char *fileName_p )
+{
+    FILE           *file_p;
+    char           *buf_p = NULL;
+    long            size;
+
+    if ( ( file_p = fopen ( fileName_p, "rb" ) ) == NULL ) {
+        printf ( "Could not open '%s'\n", fileName_p );
+        return NULL;
+    }
+    if ( fseek ( file_p, 0, SEEK_END ) == 0 && ( size = ftell ( file_p ) ) >= 0 && fseek ( file_p, 0, SEEK_SET ) == 0 &&
+         ( buf_p = ( char * ) malloc ( ( size_t ) size + 1 ) ) != NULL ) {
+        if ( fread ( buf_p, 1, ( size_t ) size, file_p ) != ( size_t ) size ) {
+            free ( buf_p );
+            buf_p = NULL;
+        } else {
+            buf_p[size] = '\0';
+        }
+    }
+    if ( buf_p == NULL ) {
+        printf ( "Could not read '%s'\n", fileName_p );
+    }
+    fclose ( file_p );
+    return buf_p;
+}
+
+
+/*****************************************************************************
+ * bulk_nextToken
+ *
+ * Terminate and return the next blank-separated token of a line, advancing
+ * *line_pp past it; NULL at the end of the line.
+ *****************************************************************************/
+static char    *
+bulk_nextToken ( char **line_pp )
+{
+    char           *token_p = *line_pp;
+
+    while ( *token_p == ' ' || *token_p == '\t' || *token_p == '\r' ) {
+        token_p++;
+    }
+    if ( *token_p == '\0' ) {
+        *line_pp = token_p;
+        return NULL;
+    }
+    *line_pp = token_p;
+    while ( **line_pp != '\0' && **line_pp != ' ' && **line_pp != '\t' && **line_pp != '\r' ) {
+        ( *line_pp )++;
+    }
+    if ( **line_pp != '\0' ) {
+        *( *line_pp )++ = '\0';
+    }
+    return token_p;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    const char     *fileName_p = NULL;
+    int             window = BULK_DEFAULT_WINDOW;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    common_provisioner_t prov;
+    char           *file_p = NULL;
+    char           *line_p;
+    char           *end_p;
+    char           *queue_p;
+    char           *topic_p;
+    unsigned int    numLines = 1;
+    int             lineNum = 0;
+
+    printf ( "\nBulkTopicToQueueMapping.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\tFILE [WINDOW]             Provision the Queues and topic mappings of FILE, one\n"
+            "\t                          \"<queue> [<topic>]\" per line, with up to WINDOW\n"
+            "\t                          operations outstanding (default 256).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        fileName_p = argv[optind++];
+    }
+    if ( optind < argc ) {
+        window = atoi ( argv[optind++] );
+    }
+    if ( fileName_p == NULL || window < 1 ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    /* The mappings are provisioned once, not reapplied by the API. */
+    commandOpts.reapplySubscriptions = 0;
+
+    /*************************************************************************
+     * Read the mappings
+     *************************************************************************/
+
+    if ( ( file_p = bulk_readFile ( fileName_p ) ) == NULL ) {
+        exit(1);
+    }
+    for ( line_p = file_p; *line_p != '\0'; line_p++ ) {
+        if ( *line_p == '\n' ) {
+            numLines++;
+        }
+    }
+    /* At most a Queue and a mapping per line. */
+    if ( common_provisioner_init ( &prov, numLines * 2, ( unsigned int ) window ) != SOLCLIENT_OK ) {
+        free ( file_p );
+        exit(1);
+    }
+    for ( line_p = file_p; line_p != NULL; line_p = end_p ) {
+        lineNum++;
+        if ( ( end_p = strchr ( line_p, '\n' ) ) != NULL ) {
+            *end_p++ = '\0';
+        }
+        if ( ( queue_p = bulk_nextToken ( &line_p ) ) == NULL || queue_p[0] == '#' ) {
+            continue;
+        }
+        topic_p = bulk_nextToken ( &line_p );
+        if ( bulk_nextToken ( &line_p ) != NULL ) {
+            printf ( "%s:%d: expected \"<queue> [<topic>]\"\n", fileName_p, lineNum );
+            goto notInitialized;
+        }
+        common_provisioner_addMapping ( &prov, queue_p, topic_p );
+    }
+    if ( prov.numOps == 0 ) {
+        printf ( "No Queues in '%s'\n", fileName_p );
+        goto notInitialized;
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context and connect a Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    /* The provisioner is the user_p of its event callback. */
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 common_messageReceivePrintMsgCallback,
+                                                 common_provisioner_eventCallback, &prov, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    /*************************************************************************
+     * Ensure Topic to Queue mapping is supported by this client connection
+     *************************************************************************/
+
+    if ( !solClient_session_isCapable ( session_p, SOLCLIENT_SESSION_CAPABILITY_QUEUE_SUBSCRIPTIONS ) ||
+         !solClient_session_isCapable ( session_p, SOLCLIENT_SESSION_CAPABILITY_ENDPOINT_MANAGEMENT ) ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Topic To Queue Mapping or endpoint management is not supported on this client connection." );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Provision the Queues and mappings
+     *************************************************************************/
+
+    printf ( "Provisioning %u Queues and %u mappings from '%s', window %d\n", prov.numQueues,
+             prov.numOps - prov.numQueues, fileName_p, window );
+    common_provisioner_run ( &prov, session_p );
+    common_provisioner_printStats ( &prov );
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  sessionConnected:
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    common_provisioner_destroy ( &prov );
+    free ( file_p );
+    return 0;
+
+}
@@ -0,0 +1,221 @@
+
+/** @example Intro/CachePrimer.c
+ */
+
+/*
+ * This sample primes a consumer with the cached values of many topics, as
+ * at startup, using a cache primer (see common_cachePrimer_init()): up to
+ * WINDOW asynchronous cache requests are kept outstanding, requests that
+ * time out are sent again, and the total time and the latency of the
+ * requests are reported.
+ *
+ * The topics are <topic>/0 to <topic>/<TOPICS - 1>, where <topic> is given
+ * with "--topic" (default my/sample/topic). A WINDOW of 1 sends the
+ * requests one at a time, for comparison.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "solclient/solCache.h"
+#include "common.h"
+#include "cacheprimer.h"
+#include "getopt.h"
+
+#define PRIME_DEFAULT_TOPICS        20000
+#define PRIME_DEFAULT_WINDOW        256
+#define PRIME_DEFAULT_RETRIES       2
+
+/* Messages received, by the Context thread. */
+static solClient_uint64_t cachedMsgs = 0;
+static solClient_uint64_t liveMsgs = 0;
+
+
+/*****************************************************************************
+ * prime_messageReceiveCallback
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+prime_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    if ( solClient_msg_isCacheMsg ( msg_p ) != SOLCLIENT_CACHE_LIVE_MESSAGE ) {
+        cachedMsgs++;
+    } else {
+        liveMsgs++;
+    }
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             numTopics = PRIME_DEFAULT_TOPICS;
+    int             window = PRIME_DEFAULT_WINDOW;
+    int             maxRetries = PRIME_DEFAULT_RETRIES;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    /* Cache Session */
+    solClient_opaqueCacheSession_pt cacheSession_p = NULL;
+    const char     *cacheProps[3];
+
+    common_cachePrimer_t primer;
+    char           *topicNames_p = NULL;
+    const char    **topics_p = NULL;
+    size_t          topicSize;
+    int             i;
+
+    printf ( "\nCachePrimer.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK |
+                                CACHE_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                DEST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[TOPICS] [WINDOW] [RETRIES]   Request TOPICS topics (default 20000), with up to\n"
+            "\t                          WINDOW requests outstanding (default 256), sending\n"
+            "\t                          timed out requests up to RETRIES more times (default 2).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        numTopics = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        window = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        maxRetries = atoi ( argv[optind++] );
+    }
+    if ( numTopics < 1 || window < 1 || maxRetries < 0 ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    if ( commandOpts.destinationName[0] == '\0' ) {
+        strcpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC );
+    }
+
+    /* The topic names, in one block. */
+    topicSize = strlen ( commandOpts.destinationName ) + 12;
+    topicNames_p = ( char * ) malloc ( numTopics * topicSize );
+    topics_p = ( const char ** ) malloc ( numTopics * sizeof ( const char * ) );
+    if ( topicNames_p == NULL || topics_p == NULL ) {
+        printf ( "Could not allocate %d topics\n", numTopics );
+        exit(1);
+    }
+    for ( i = 0; i < numTopics; i++ ) {
+        sprintf ( &topicNames_p[i * topicSize], "%s/%d", commandOpts.destinationName, i );
+        topics_p[i] = &topicNames_p[i * topicSize];
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context, connect a Session and create a Cache Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 prime_messageReceiveCallback,
+                                                 common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    cacheProps[0] = SOLCLIENT_CACHESESSION_PROP_CACHE_NAME;
+    cacheProps[1] = commandOpts.cacheName;
+    cacheProps[2] = NULL;
+    if ( ( rc = solClient_session_createCacheSession ( cacheProps, session_p, &cacheSession_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_createCacheSession()" );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Prime
+     *************************************************************************/
+
+    if ( common_cachePrimer_init ( &primer, cacheSession_p, topics_p, ( solClient_uint32_t ) numTopics,
+                                   ( unsigned int ) window, ( unsigned int ) maxRetries ) != SOLCLIENT_OK ) {
+        goto cacheSessionCreated;
+    }
+
+    printf ( "Priming %d topics %s/0..%d from cache '%s'\n", numTopics, commandOpts.destinationName,
+             numTopics - 1, commandOpts.cacheName );
+    common_cachePrimer_run ( &primer );
+    common_cachePrimer_printStats ( &primer );
+    printf ( "Messages received: %llu cached, %llu live\n",
+             ( unsigned long long ) cachedMsgs, ( unsigned long long ) liveMsgs );
+    common_cachePrimer_destroy ( &primer );
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  cacheSessionCreated:
+    if ( ( rc = solClient_cacheSession_destroy ( &cacheSession_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cacheSession_destroy()" );
+    }
+
+  sessionConnected:
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    free ( topics_p );
+    free ( topicNames_p );
+    return 0;
+
+}
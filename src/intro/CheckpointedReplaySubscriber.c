@@ -0,0 +1,846 @@
+
+/** @example Intro/CheckpointedReplaySubscriber.c
+ */
+
+/*
+ * This sample replays a Queue from the replay log and remembers how far it
+ * got, so that a restart only replays the tail of the log instead of the
+ * whole log.
+ *
+ * While messages are processed, the newest sender timestamp and the sender
+ * sequence numbers already processed are kept in memory. They are written to
+ * a checkpoint file in batches: once CHECKPOINT_BATCH messages have been
+ * processed since the last checkpoint, or once a second, whichever comes
+ * first. Each checkpoint is written to a temporary file, synced to disk and
+ * renamed over the previous one, so there is one fsync per batch and a crash
+ * always leaves a complete checkpoint behind.
+ *
+ * On start, when the checkpoint file exists, the replay starts at
+ * "DATE:<checkpoint timestamp - OVERLAP_SECONDS>" instead of the beginning
+ * of the replay log. DATE: has a resolution of one second and the sender
+ * and router clocks differ, so some messages processed before the restart
+ * are replayed again. These are recognized by their sequence number, using
+ * a sliding bitmap of the last CKPT_WINDOW_BITS sequence numbers, and only
+ * acknowledged. If the checkpoint time is no longer in the replay log, the
+ * replay restarts from the beginning and the bitmap drops everything that
+ * was processed before.
+ *
+ * With WORKERS > 0, the receive callback only puts each message in a
+ * bounded reorder buffer, and a pool of worker threads decodes and
+ * processes the messages in parallel. Messages leave the buffer in
+ * publication order: whichever worker finishes the message at the head
+ * commits it (deduplication and replay position), acknowledges it and
+ * moves on to the next one that is ready, so checkpoints never cover a
+ * message that has not been fully processed. The buffer is bounded by the
+ * Flow's unacknowledged message limit. The replay rate and buffer
+ * occupancy are reported once a second.
+ *
+ * The publisher must send messages with a sender timestamp and a sequence
+ * number, for example with "--metadata=ts,seq"; messages without a sequence
+ * number cannot be deduplicated and are always processed. Sequence numbers
+ * are assumed to come from a single publisher.
+ *
+ * Before running this sample, message replay must be enabled in the VPN and
+ * the exclusive Queue must exist.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "getopt.h"
+
+#define CKPT_FORMAT_VERSION           1
+
+/* Sequence numbers tracked for deduplication; a multiple of 8. */
+#define CKPT_WINDOW_BITS              65536
+
+#define CKPT_DEFAULT_BATCH            1000
+#define CKPT_DEFAULT_OVERLAP_SECONDS  2
+#define CKPT_INTERVAL_MS              1000
+
+/* The replay ends when the Queue delivers nothing for this long. */
+#define CKPT_IDLE_TIMEOUT_MS          5000
+
+/* Reorder buffer slots (a power of two), and the Flow's unacknowledged limit below it. */
+#define REPLAY_REORDER_SLOTS          1024
+#define REPLAY_MAX_UNACKED            "1000"
+#define REPLAY_MAX_WORKERS            64
+
+/*
+ * The replay position. highSeq is -1 until a message with a sequence number
+ * has been processed; bit (seq % CKPT_WINDOW_BITS) of window is set when seq
+ * in (highSeq - CKPT_WINDOW_BITS, highSeq] has been processed.
+ */
+typedef struct replayCheckpoint
+{
+    solClient_int64_t lastTimestampMs;  /* Newest sender timestamp processed, 0 if none. */
+    solClient_int64_t highSeq;
+    UINT64          processed;          /* Total over all runs. */
+    unsigned char   window[CKPT_WINDOW_BITS / 8];
+} replayCheckpoint_t, *replayCheckpoint_pt;
+
+/* Shared between the Flow receive callback and the main thread. */
+typedef struct replayState
+{
+    MUTEX_T         mutex;
+    replayCheckpoint_t ckpt;
+    int             dirty;              /* Messages processed since the last checkpoint. */
+    UINT64          lastRxUs;
+    UINT64          processed;          /* This run. */
+    UINT64          duplicates;
+    UINT64          unchecked;          /* Processed without a sequence number. */
+    volatile solClient_subCode_t flowSubCode;
+} replayState_t;
+
+static replayState_t state;
+
+/*
+ * A message in the reorder buffer. Written by the Context thread on
+ * arrival, then by the worker decoding it, then read at commit.
+ */
+typedef struct replaySlot
+{
+    solClient_opaqueMsg_pt msg_p;
+    solClient_opaqueFlow_pt flow_p;
+    volatile int    done;               /* Decoded, waiting to be committed. */
+    int             hasSeq;
+    solClient_int64_t seq;
+    solClient_int64_t timestampMs;      /* 0 if none. */
+    unsigned int    checksum;
+} replaySlot_t;
+
+/*
+ * The reorder buffer. Slots between commitPos and arrivalPos hold messages
+ * in publication order; those before dispatchPos have been taken by a
+ * worker. arrivalPos is only written by the Context thread, dispatchPos
+ * under dispatchMutex and commitPos under state.mutex.
+ */
+typedef struct replayReorderBuffer
+{
+    replaySlot_t    slots[REPLAY_REORDER_SLOTS];
+    volatile unsigned int arrivalPos;
+    unsigned int    dispatchPos;
+    volatile unsigned int commitPos;
+    MUTEX_T         dispatchMutex;
+    unsigned int    peakOccupancy;      /* Reset by the main thread each report. */
+    UINT64          overflows;
+} replayReorderBuffer_t;
+
+static replayReorderBuffer_t reorder;
+static int      numWorkers = 0;
+static int      workUs = 0;
+static volatile int workersRunning = 1;
+
+
+/*****************************************************************************
+ * ckpt_isDuplicate
+ *****************************************************************************/
+static int
+ckpt_isDuplicate ( const replayCheckpoint_t * ckpt_p, solClient_int64_t seq )
+{
+    unsigned int    bit;
+
+    if ( ckpt_p->highSeq < 0 || seq > ckpt_p->highSeq ) {
+        return 0;
+    }
+    if ( ckpt_p->highSeq - seq >= CKPT_WINDOW_BITS ) {
+        /* Older than the window; Queues deliver in order, so it was processed. */
+        return 1;
+    }
+    bit = ( unsigned int ) ( seq % CKPT_WINDOW_BITS );
+    return ( ckpt_p->window[bit >> 3] >> ( bit & 7 ) ) & 1;
+}
+
+
+/*****************************************************************************
+ * ckpt_markProcessed
+ *
+ * Slide the window forward to seq if needed, clearing the bits of the
+ * sequence numbers skipped over, then mark seq.
+ *****************************************************************************/
+static void
+ckpt_markProcessed ( replayCheckpoint_t * ckpt_p, solClient_int64_t seq )
+{
+    solClient_int64_t next;
+    unsigned int    bit;
+
+    if ( seq > ckpt_p->highSeq ) {
+        if ( ckpt_p->highSeq < 0 || seq - ckpt_p->highSeq >= CKPT_WINDOW_BITS ) {
+            memset ( ckpt_p->window, 0, sizeof ( ckpt_p->window ) );
+        } else {
+            for ( next = ckpt_p->highSeq + 1; next < seq; next++ ) {
+                bit = ( unsigned int ) ( next % CKPT_WINDOW_BITS );
+                ckpt_p->window[bit >> 3] &= ( unsigned char ) ~( 1 << ( bit & 7 ) );
+            }
+        }
+        ckpt_p->highSeq = seq;
+    }
+    bit = ( unsigned int ) ( seq % CKPT_WINDOW_BITS );
+    ckpt_p->window[bit >> 3] |= ( unsigned char ) ( 1 << ( bit & 7 ) );
+}
+
+
+/*****************************************************************************
+ * ckpt_load
+ *
+ * Read a checkpoint file. Returns 0 on success, -1 if the file does not
+ * exist or is not a valid checkpoint.
+ *****************************************************************************/
+static int
+ckpt_load ( const char *path_p, replayCheckpoint_t * ckpt_p )
+{
+    FILE           *fp;
+    int             version = 0;
+    long long       timestampMs;
+    long long       highSeq;
+    unsigned long long processed;
+    unsigned int    byte;
+    size_t          i;
+    int             rc = -1;
+
+    if ( ( fp = fopen ( path_p, "r" ) ) == NULL ) {
+        return -1;
+    }
+    if ( fscanf ( fp, "replay-checkpoint %d\n", &version ) == 1 && version == CKPT_FORMAT_VERSION &&
+         fscanf ( fp, "timestamp_ms %lld\n", &timestampMs ) == 1 &&
+         fscanf ( fp, "high_seq %lld\n", &highSeq ) == 1 &&
+         fscanf ( fp, "processed %llu\n", &processed ) == 1 &&
+         fscanf ( fp, "window " ) == 0 ) {
+        for ( i = 0; i < sizeof ( ckpt_p->window ); i++ ) {
+            if ( fscanf ( fp, "%2x", &byte ) != 1 ) {
+                break;
+            }
+            ckpt_p->window[i] = ( unsigned char ) byte;
+        }
+        if ( i == sizeof ( ckpt_p->window ) ) {
+            ckpt_p->lastTimestampMs = ( solClient_int64_t ) timestampMs;
+            ckpt_p->highSeq = ( solClient_int64_t ) highSeq;
+            ckpt_p->processed = ( UINT64 ) processed;
+            rc = 0;
+        }
+    }
+    fclose ( fp );
+    if ( rc != 0 ) {
+        memset ( ckpt_p, 0, sizeof ( *ckpt_p ) );
+        ckpt_p->highSeq = -1;
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * ckpt_save
+ *
+ * Write a checkpoint to a temporary file, sync it and rename it over the
+ * checkpoint file. Returns 0 on success.
+ *****************************************************************************/
+static int
+ckpt_save ( const char *path_p, const replayCheckpoint_t * ckpt_p )
+{
+    char           *tmpPath_p;
+    FILE           *fp;
+    size_t          i;
+    int             rc = 0;
+
+    if ( ( tmpPath_p = ( char * ) malloc ( strlen ( path_p ) + sizeof ( ".tmp" ) ) ) == NULL ) {
+        return -1;
+    }
+    strcpy ( tmpPath_p, path_p );
+    strcat ( tmpPath_p, ".tmp" );
+    if ( ( fp = fopen ( tmpPath_p, "w" ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not open checkpoint file '%s'", tmpPath_p );
+        free ( tmpPath_p );
+        return -1;
+    }
+    fprintf ( fp, "replay-checkpoint %d\n", CKPT_FORMAT_VERSION );
+    fprintf ( fp, "timestamp_ms %lld\n", ( long long ) ckpt_p->lastTimestampMs );
+    fprintf ( fp, "high_seq %lld\n", ( long long ) ckpt_p->highSeq );
+    fprintf ( fp, "processed %llu\n", ( unsigned long long ) ckpt_p->processed );
+    fprintf ( fp, "window " );
+    for ( i = 0; i < sizeof ( ckpt_p->window ); i++ ) {
+        fprintf ( fp, "%02x", ckpt_p->window[i] );
+    }
+    fprintf ( fp, "\n" );
+
+    if ( ferror ( fp ) || fileSync ( fp ) != 0 ) {
+        rc = -1;
+    }
+    if ( fclose ( fp ) != 0 ) {
+        rc = -1;
+    }
+    if ( rc == 0 && fileReplace ( tmpPath_p, path_p ) != 0 ) {
+        rc = -1;
+    }
+    if ( rc != 0 ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not write checkpoint file '%s'", path_p );
+    }
+    free ( tmpPath_p );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * replay_decodeMsg
+ *
+ * The part of processing a message that does not depend on the order of
+ * messages; run on a worker thread when there are workers.
+ *****************************************************************************/
+static void
+replay_decodeMsg ( replaySlot_t * slot_p )
+{
+    void           *data_p;
+    solClient_uint32_t size;
+    solClient_uint32_t i;
+    UINT64          endUs;
+
+    slot_p->hasSeq = ( solClient_msg_getSequenceNumber ( slot_p->msg_p, &slot_p->seq ) == SOLCLIENT_OK );
+    if ( solClient_msg_getSenderTimestamp ( slot_p->msg_p, &slot_p->timestampMs ) != SOLCLIENT_OK ) {
+        slot_p->timestampMs = 0;
+    }
+    slot_p->checksum = 0;
+    if ( solClient_msg_getBinaryAttachmentPtr ( slot_p->msg_p, &data_p, &size ) == SOLCLIENT_OK ) {
+        for ( i = 0; i < size; i++ ) {
+            slot_p->checksum = slot_p->checksum * 31 + ( ( unsigned char * ) data_p )[i];
+        }
+    }
+    if ( workUs > 0 ) {
+        endUs = getTimeInUs (  ) + ( UINT64 ) workUs;
+        while ( getTimeInUs (  ) < endUs ) {
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * replay_commitMsg
+ *
+ * Apply a decoded message and advance the replay position. Must be called
+ * in publication order with state.mutex held.
+ *****************************************************************************/
+static void
+replay_commitMsg ( const replaySlot_t * slot_p )
+{
+    if ( slot_p->hasSeq && ckpt_isDuplicate ( &state.ckpt, slot_p->seq ) ) {
+        state.duplicates++;
+        return;
+    }
+    /*
+     * Apply the message here. This sample only records its position; the
+     * processing must be idempotent for messages without a sequence number
+     * and for those after the last checkpoint.
+     */
+    if ( slot_p->hasSeq ) {
+        ckpt_markProcessed ( &state.ckpt, slot_p->seq );
+    } else {
+        state.unchecked++;
+    }
+    if ( slot_p->timestampMs > state.ckpt.lastTimestampMs ) {
+        state.ckpt.lastTimestampMs = slot_p->timestampMs;
+    }
+    state.ckpt.processed++;
+    state.processed++;
+    state.dirty++;
+}
+
+
+/*****************************************************************************
+ * replay_ackMsg
+ *****************************************************************************/
+static void
+replay_ackMsg ( solClient_opaqueFlow_pt flow_p, solClient_opaqueMsg_pt msg_p )
+{
+    solClient_msgId_t msgId;
+
+    if ( solClient_msg_getMsgId ( msg_p, &msgId ) == SOLCLIENT_OK ) {
+        solClient_flow_sendAck ( flow_p, msgId );
+    }
+}
+
+
+/*****************************************************************************
+ * replay_commitReady
+ *
+ * Commit and acknowledge the decoded messages at the head of the reorder
+ * buffer, stopping at the first one still being decoded. Called by the
+ * workers after each message.
+ *****************************************************************************/
+static void
+replay_commitReady ( void )
+{
+    replaySlot_t   *slot_p;
+    solClient_opaqueMsg_pt msg_p;
+    solClient_opaqueFlow_pt flow_p;
+
+    mutexLock ( &state.mutex );
+    while ( reorder.commitPos != reorder.arrivalPos ) {
+        slot_p = &reorder.slots[reorder.commitPos & ( REPLAY_REORDER_SLOTS - 1 )];
+        if ( !slot_p->done ) {
+            break;
+        }
+        MEMORY_BARRIER (  );
+        replay_commitMsg ( slot_p );
+        msg_p = slot_p->msg_p;
+        flow_p = slot_p->flow_p;
+        slot_p->done = 0;
+
+        /* Free the slot before acknowledging, which lets the next message in. */
+        MEMORY_BARRIER (  );
+        reorder.commitPos++;
+        replay_ackMsg ( flow_p, msg_p );
+        solClient_msg_free ( &msg_p );
+    }
+    mutexUnlock ( &state.mutex );
+}
+
+
+/*****************************************************************************
+ * replay_workerThread
+ *
+ * Take the messages in arrival order, decode them in parallel, then commit
+ * whatever is ready at the head of the reorder buffer.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+replay_workerThread ( void *arg_p )
+{
+    replaySlot_t   *slot_p;
+
+    while ( workersRunning ) {
+        mutexLock ( &reorder.dispatchMutex );
+        if ( reorder.dispatchPos == reorder.arrivalPos ) {
+            mutexUnlock ( &reorder.dispatchMutex );
+            sleepInUs ( 100 );
+            continue;
+        }
+        slot_p = &reorder.slots[reorder.dispatchPos++ & ( REPLAY_REORDER_SLOTS - 1 )];
+        mutexUnlock ( &reorder.dispatchMutex );
+
+        MEMORY_BARRIER (  );
+        replay_decodeMsg ( slot_p );
+        MEMORY_BARRIER (  );
+        slot_p->done = 1;
+
+        replay_commitReady (  );
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * replay_flowRxCallback
+ *
+ * Without workers, the message is decoded and committed on the Context
+ * thread. With workers, it is only put in the reorder buffer; the Flow's
+ * unacknowledged message limit keeps the buffer from overflowing, because
+ * a message is acknowledged only once it leaves the buffer.
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+replay_flowRxCallback ( solClient_opaqueFlow_pt opaqueFlow_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    replaySlot_t    slot;
+    replaySlot_t   *slot_p;
+    unsigned int    occupancy;
+
+    state.lastRxUs = getTimeInUs (  );
+
+    if ( numWorkers == 0 ) {
+        slot.msg_p = msg_p;
+        replay_decodeMsg ( &slot );
+        mutexLock ( &state.mutex );
+        replay_commitMsg ( &slot );
+        mutexUnlock ( &state.mutex );
+        replay_ackMsg ( opaqueFlow_p, msg_p );
+        return SOLCLIENT_CALLBACK_OK;
+    }
+
+    occupancy = reorder.arrivalPos - reorder.commitPos;
+    if ( occupancy >= REPLAY_REORDER_SLOTS ) {
+        /* Cannot happen while REPLAY_MAX_UNACKED < REPLAY_REORDER_SLOTS; redelivered on rebind. */
+        reorder.overflows++;
+        return SOLCLIENT_CALLBACK_OK;
+    }
+    if ( occupancy + 1 > reorder.peakOccupancy ) {
+        reorder.peakOccupancy = occupancy + 1;
+    }
+    slot_p = &reorder.slots[reorder.arrivalPos & ( REPLAY_REORDER_SLOTS - 1 )];
+    slot_p->msg_p = msg_p;
+    slot_p->flow_p = opaqueFlow_p;
+    slot_p->done = 0;
+    MEMORY_BARRIER (  );
+    reorder.arrivalPos++;
+    return SOLCLIENT_CALLBACK_TAKE_MSG;
+}
+
+
+/*****************************************************************************
+ * replay_drain
+ *
+ * Wait until every message in the reorder buffer has been committed, so
+ * the Flow they were received on can be destroyed.
+ *****************************************************************************/
+static void
+replay_drain ( void )
+{
+    while ( reorder.commitPos != reorder.arrivalPos ) {
+        sleepInUs ( 1000 );
+    }
+}
+
+
+/*****************************************************************************
+ * replay_flowEventCallback
+ *
+ * Replay events require the Flow to be re-created, which cannot be done
+ * from the callback; the subcode is saved for the main thread.
+ *****************************************************************************/
+static void
+replay_flowEventCallback ( solClient_opaqueFlow_pt opaqueFlow_p, solClient_flow_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    if ( eventInfo_p->flowEvent == SOLCLIENT_FLOW_EVENT_DOWN_ERROR ) {
+        state.flowSubCode = solClient_getLastErrorInfo (  )->subCode;
+    }
+    common_flowEventCallback ( opaqueFlow_p, eventInfo_p, user_p );
+}
+
+
+/*****************************************************************************
+ * replay_bindFlow
+ *
+ * Bind to the Queue, starting the replay at startLocation_p, or without a
+ * client initiated replay if it is NULL.
+ *****************************************************************************/
+static          solClient_returnCode_t
+replay_bindFlow ( solClient_opaqueSession_pt session_p, const char *queueName_p,
+                  const char *startLocation_p, solClient_opaqueFlow_pt * flow_p )
+{
+    solClient_returnCode_t rc;
+    solClient_flow_createFuncInfo_t flowFuncInfo = SOLCLIENT_FLOW_CREATEFUNC_INITIALIZER;
+    const char     *flowProps[20] = {0, };
+    int             propIndex = 0;
+
+    flowFuncInfo.rxMsgInfo.callback_p = replay_flowRxCallback;
+    flowFuncInfo.eventInfo.callback_p = replay_flowEventCallback;
+
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_BLOCKING;
+    flowProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_ID;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_QUEUE;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_ACKMODE;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_ACKMODE_CLIENT;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_NAME;
+    flowProps[propIndex++] = queueName_p;
+    if ( numWorkers > 0 ) {
+        flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_MAX_UNACKED_MESSAGES;
+        flowProps[propIndex++] = REPLAY_MAX_UNACKED;
+    }
+    if ( startLocation_p != NULL ) {
+        flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_REPLAY_START_LOCATION;
+        flowProps[propIndex++] = startLocation_p;
+        printf ( "Binding to '%s', replay start location %s\n", queueName_p, startLocation_p );
+    }
+    flowProps[propIndex] = NULL;
+
+    state.flowSubCode = SOLCLIENT_SUBCODE_OK;
+    if ( ( rc = solClient_session_createFlow ( ( char ** ) flowProps, session_p, flow_p,
+                                               &flowFuncInfo, sizeof ( flowFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_createFlow()" );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    const char     *queueName_p;
+    const char     *ckptPath_p;
+    int             batch = CKPT_DEFAULT_BATCH;
+    int             overlapSeconds = CKPT_DEFAULT_OVERLAP_SECONDS;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    /* Flow */
+    solClient_opaqueFlow_pt flow_p = NULL;
+    char            startLocation[64];
+    solClient_subCode_t subCode;
+
+    /* Checkpointing */
+    replayCheckpoint_t snapshot;
+    UINT64          lastCkptUs;
+    UINT64          nowUs;
+    UINT64          syncStartUs;
+    UINT64          syncUs = 0;
+    UINT64          numCkpts = 0;
+    int             dirty;
+
+    /* Workers and reporting */
+    THREAD_T        workers[REPLAY_MAX_WORKERS];
+    int             numStarted = 0;
+    UINT64          lastReportUs;
+    UINT64          lastReportProcessed = 0;
+    UINT64          occupancySum = 0;
+    UINT64          occupancySamples = 0;
+    unsigned int    overallPeak = 0;
+    int             i;
+
+    printf ( "\nCheckpointedReplaySubscriber.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\tQUEUE CHECKPOINT_FILE [CHECKPOINT_BATCH] [OVERLAP_SECONDS] [WORKERS] [WORK_US]\n"
+            "\t    CHECKPOINT_BATCH  Messages processed between checkpoints (default 1000).\n"
+            "\t    OVERLAP_SECONDS   How far before the checkpoint a resumed replay starts (default 2).\n"
+            "\t    WORKERS           Worker threads processing messages; 0 processes them on the\n"
+            "\t                      Context thread (default 0).\n"
+            "\t    WORK_US           Simulated processing time per message in microseconds (default 0).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( argc - optind < 2 ) {
+        printf ( "Missing QUEUE or CHECKPOINT_FILE\n" );
+        exit(1);
+    }
+    queueName_p = argv[optind++];
+    ckptPath_p = argv[optind++];
+    if ( optind < argc ) {
+        batch = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        overlapSeconds = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        numWorkers = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        workUs = atoi ( argv[optind++] );
+    }
+    if ( batch < 1 || overlapSeconds < 0 || numWorkers < 0 || numWorkers > REPLAY_MAX_WORKERS || workUs < 0 ) {
+        printf ( "Invalid CHECKPOINT_BATCH, OVERLAP_SECONDS, WORKERS or WORK_US\n" );
+        exit(1);
+    }
+
+    /*************************************************************************
+     * Load the checkpoint and work out where the replay starts
+     *************************************************************************/
+
+    memset ( &state, 0, sizeof ( state ) );
+    mutexInit ( &state.mutex );
+    mutexInit ( &reorder.dispatchMutex );
+    state.ckpt.highSeq = -1;
+    strcpy ( startLocation, SOLCLIENT_FLOW_PROP_REPLAY_START_LOCATION_BEGINNING );
+    if ( ckpt_load ( ckptPath_p, &state.ckpt ) != 0 ) {
+        printf ( "No usable checkpoint in '%s', replaying from the beginning\n", ckptPath_p );
+    } else {
+        printf ( "Resuming after %llu processed messages, last sequence number %lld\n",
+                 ( unsigned long long ) state.ckpt.processed, ( long long ) state.ckpt.highSeq );
+        if ( state.ckpt.lastTimestampMs / 1000 > overlapSeconds ) {
+            sprintf ( startLocation, "DATE:%lld", ( long long ) ( state.ckpt.lastTimestampMs / 1000 - overlapSeconds ) );
+        }
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context, and connect a Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 common_messageReceivePrintMsgCallback,
+                                                 common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    if ( !solClient_session_isCapable ( session_p, SOLCLIENT_SESSION_CAPABILITY_MESSAGE_REPLAY ) ) {
+        printf ( "Message replay is not supported on this appliance.\n" );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Replay, checkpointing as messages are processed
+     *************************************************************************/
+
+    for ( numStarted = 0; numStarted < numWorkers; numStarted++ ) {
+        if ( threadCreate ( &workers[numStarted], replay_workerThread, NULL ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not start worker %d", numStarted );
+            goto workersStarted;
+        }
+    }
+
+    if ( replay_bindFlow ( session_p, queueName_p, startLocation, &flow_p ) != SOLCLIENT_OK ) {
+        goto workersStarted;
+    }
+
+    lastCkptUs = lastReportUs = state.lastRxUs = getTimeInUs (  );
+    for ( ;; ) {
+        sleepInUs ( 10000 );
+        nowUs = getTimeInUs (  );
+
+        if ( ( subCode = state.flowSubCode ) != SOLCLIENT_SUBCODE_OK ) {
+            /* The buffered messages must be acknowledged on the Flow they came from. */
+            replay_drain (  );
+            solClient_flow_destroy ( &flow_p );
+            if ( subCode == SOLCLIENT_SUBCODE_REPLAY_START_TIME_NOT_AVAILABLE ) {
+                /* The checkpoint is older than the log; the bitmap drops what was processed. */
+                printf ( "Checkpoint time is not in the replay log, replaying from the beginning\n" );
+                rc = replay_bindFlow ( session_p, queueName_p, SOLCLIENT_FLOW_PROP_REPLAY_START_LOCATION_BEGINNING, &flow_p );
+            } else if ( subCode == SOLCLIENT_SUBCODE_REPLAY_STARTED ) {
+                printf ( "Router initiated replay, re-creating the flow\n" );
+                rc = replay_bindFlow ( session_p, queueName_p, NULL, &flow_p );
+            } else {
+                printf ( "Flow went down, stopping\n" );
+                rc = SOLCLIENT_FAIL;
+            }
+            if ( rc != SOLCLIENT_OK ) {
+                flow_p = NULL;
+                break;
+            }
+            state.lastRxUs = getTimeInUs (  );
+            continue;
+        }
+
+        /* Take a consistent copy of the position, and write it outside the lock. */
+        mutexLock ( &state.mutex );
+        dirty = state.dirty;
+        if ( dirty >= batch || ( dirty > 0 && nowUs - lastCkptUs >= CKPT_INTERVAL_MS * 1000 ) ) {
+            snapshot = state.ckpt;
+            state.dirty = 0;
+        } else {
+            dirty = 0;
+        }
+        mutexUnlock ( &state.mutex );
+
+        if ( dirty > 0 ) {
+            syncStartUs = getTimeInUs (  );
+            ckpt_save ( ckptPath_p, &snapshot );
+            syncUs += getTimeInUs (  ) - syncStartUs;
+            numCkpts++;
+            lastCkptUs = nowUs;
+        }
+
+        if ( numWorkers > 0 ) {
+            occupancySum += reorder.arrivalPos - reorder.commitPos;
+            occupancySamples++;
+            if ( nowUs - lastReportUs >= 1000000 ) {
+                printf ( "Replayed %.0f msgs/s, reorder buffer %u/%d (peak %u, average %.0f)\n",
+                         ( double ) ( state.processed + state.duplicates - lastReportProcessed ) * 1000000.0 /
+                         ( double ) ( nowUs - lastReportUs ),
+                         reorder.arrivalPos - reorder.commitPos, REPLAY_REORDER_SLOTS, reorder.peakOccupancy,
+                         ( double ) occupancySum / ( double ) occupancySamples );
+                if ( reorder.peakOccupancy > overallPeak ) {
+                    overallPeak = reorder.peakOccupancy;
+                }
+                reorder.peakOccupancy = 0;
+                lastReportProcessed = state.processed + state.duplicates;
+                lastReportUs = nowUs;
+            }
+        }
+
+        if ( nowUs - state.lastRxUs >= CKPT_IDLE_TIMEOUT_MS * 1000 ) {
+            printf ( "No message for %d ms, replay done\n", CKPT_IDLE_TIMEOUT_MS );
+            break;
+        }
+    }
+
+    replay_drain (  );
+    if ( flow_p != NULL && ( rc = solClient_flow_destroy ( &flow_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_flow_destroy()" );
+    }
+
+  workersStarted:
+    workersRunning = 0;
+    for ( i = 0; i < numStarted; i++ ) {
+        threadJoin ( workers[i] );
+    }
+
+    /* Nothing can commit any more; write the final position. */
+    if ( state.dirty > 0 ) {
+        syncStartUs = getTimeInUs (  );
+        ckpt_save ( ckptPath_p, &state.ckpt );
+        syncUs += getTimeInUs (  ) - syncStartUs;
+        numCkpts++;
+    }
+
+    printf ( "Processed %llu messages (%llu without sequence number), skipped %llu duplicates\n",
+             ( unsigned long long ) state.processed, ( unsigned long long ) state.unchecked,
+             ( unsigned long long ) state.duplicates );
+    printf ( "Wrote %llu checkpoints, %.1f ms average write and sync\n", ( unsigned long long ) numCkpts,
+             numCkpts > 0 ? ( double ) syncUs / ( double ) numCkpts / 1000.0 : 0.0 );
+    if ( numWorkers > 0 ) {
+        if ( reorder.peakOccupancy > overallPeak ) {
+            overallPeak = reorder.peakOccupancy;
+        }
+        printf ( "Reorder buffer peak occupancy %u/%d, average %.1f, %llu overflows\n", overallPeak, REPLAY_REORDER_SLOTS,
+                 occupancySamples > 0 ? ( double ) occupancySum / ( double ) occupancySamples : 0.0,
+                 ( unsigned long long ) reorder.overflows );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  sessionConnected:
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    mutexDestroy ( &reorder.dispatchMutex );
+    mutexDestroy ( &state.mutex );
+    return 0;
+
+}
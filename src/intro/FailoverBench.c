@@ -0,0 +1,854 @@
+
+/** @example Intro/FailoverBench.c
+ */
+
+/*
+ * This sample measures how long a Session takes to recover when its
+ * connection fails, and what happens to the messages it publishes
+ * meanwhile.
+ *
+ * The Session under test connects through a TCP proxy run in this process,
+ * which relays to the message router given with "--cip" and can drop every
+ * connection on demand and then refuse new ones for OUTAGE_MS, as if the
+ * message router went away. The Session publishes sequence-numbered
+ * messages at "--mr" messages per second (default 1000) and holds
+ * subscriptions in a subscription registry (see common_subRegistry_init()).
+ * A second Session, connected directly, receives the messages and counts
+ * those lost or duplicated.
+ *
+ * After a steady period, each of DROPS drops measures:
+ *   - detect:   the drop to SOLCLIENT_SESSION_EVENT_RECONNECTING_NOTICE;
+ *   - reconnect: the drop to SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE;
+ *   - resubscribe: the drop until every subscription is confirmed again.
+ * A drop from which the Session does not reconnect within its reconnect
+ * retries (SOLCLIENT_SESSION_EVENT_DOWN_ERROR) counts as given up; the
+ * Session is then connected again to go on.
+ *
+ * The drops are repeated for each WAIT_MS given, the time between reconnect
+ * attempts, to sweep it; the numbers of retries are set with "--retries".
+ * MODE is "direct" or "persistent" (Guaranteed Messages, which the API
+ * sends again after a reconnect if unacknowledged).
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "subregistry.h"
+#include "getopt.h"
+
+#define FAILOVER_DEFAULT_DROPS          5
+#define FAILOVER_DEFAULT_OUTAGE_MS      0
+#define FAILOVER_DEFAULT_RATE           1000
+#define FAILOVER_MAX_WAITS              16
+#define FAILOVER_MAX_CONNS              16
+#define FAILOVER_BROKER_PORT            55555
+#define FAILOVER_RELAY_BUF_SIZE         65536
+#define FAILOVER_SUBSCRIPTIONS          1000
+#define FAILOVER_CRITICAL_SUBSCRIPTIONS 100
+#define FAILOVER_SUB_WINDOW             256
+#define FAILOVER_STEADY_MS              2000    /* Traffic before each drop. */
+#define FAILOVER_RECOVERY_TIMEOUT_MS    120000
+#define FAILOVER_DRAIN_MS               2000
+
+/*****************************************************************************
+ * The proxy
+ *****************************************************************************/
+typedef enum failover_connState
+{
+    FAILOVER_CONN_FREE = 0,
+    FAILOVER_CONN_RELAYING,
+    FAILOVER_CONN_DONE              /* The relay thread has ended; to be joined. */
+} failover_connState_t;
+
+typedef struct failover_conn
+{
+    SOCKET_T        client;
+    SOCKET_T        server;
+    THREAD_T        thread;
+    failover_connState_t state;
+} failover_conn_t;
+
+static struct
+{
+    MUTEX_T         mutex;
+    SOCKET_T        listenSock;
+    unsigned short  port;
+    char            brokerHost[256];
+    unsigned short  brokerPort;
+    THREAD_T        acceptThread;
+    volatile int    running;
+    UINT64          outageUntilUs;      /* New connections are refused until then. */
+    failover_conn_t conns[FAILOVER_MAX_CONNS];
+    solClient_uint64_t accepted;
+    solClient_uint64_t refused;
+} proxy;
+
+/*****************************************************************************
+ * The Session under test, and the messages
+ *****************************************************************************/
+static struct
+{
+    MUTEX_T         mutex;
+    UINT64          dropUs;
+    UINT64          downUs;
+    UINT64          upUs;
+    int             down;               /* Seen since the drop. */
+    int             reconnected;
+    int             gaveUp;
+    solClient_uint64_t acks;
+    solClient_uint64_t rejected;
+} recovery;
+
+static common_subRegistry_t registry;
+static solClient_opaqueSession_pt testSession_p = NULL;
+static int      persistent = 0;
+static int      msgRate = FAILOVER_DEFAULT_RATE;
+static volatile int publishing = 0;
+static solClient_uint64_t sent = 0;             /* Also the next sequence number. */
+static solClient_uint64_t sendFailures = 0;
+
+/* Received by the observer Session, in the Context thread. */
+static solClient_uint64_t nextSeq = 0;
+static solClient_uint64_t received = 0;
+static solClient_uint64_t gapLost = 0;
+static solClient_uint64_t duplicated = 0;
+
+
+/*****************************************************************************
+ * failover_parseHost
+ *
+ * The message router to relay to: the first host of --cip, without the
+ * protocol.
+ *****************************************************************************/
+static int
+failover_parseHost ( const char *target_p )
+{
+    size_t          length;
+
+    if ( strncmp ( target_p, "tcp:", 4 ) == 0 ) {
+        target_p += 4;
+    }
+    length = strcspn ( target_p, ",:" );
+    if ( length == 0 || length >= sizeof ( proxy.brokerHost ) ) {
+        return -1;
+    }
+    memcpy ( proxy.brokerHost, target_p, length );
+    proxy.brokerHost[length] = '\0';
+    proxy.brokerPort = FAILOVER_BROKER_PORT;
+    if ( target_p[length] == ':' ) {
+        proxy.brokerPort = ( unsigned short ) atoi ( &target_p[length + 1] );
+    }
+    return 0;
+}
+
+
+/*****************************************************************************
+ * failover_relayThread
+ *
+ * Relay one connection both ways until either side closes or it is
+ * dropped.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+failover_relayThread ( void *arg_p )
+{
+    failover_conn_t *conn_p = ( failover_conn_t * ) arg_p;
+    SOCKET_T        socks[2];
+    char            buf[FAILOVER_RELAY_BUF_SIZE];
+    int             ready;
+    int             length;
+    int             i;
+
+    socks[0] = conn_p->client;
+    socks[1] = conn_p->server;
+    for ( ;; ) {
+        if ( ( ready = tcpPoll ( socks, 2, 1000 ) ) < 0 ) {
+            break;
+        }
+        for ( i = 0; i < 2; i++ ) {
+            if ( ( ready & ( 1 << i ) ) == 0 ) {
+                continue;
+            }
+            if ( ( length = tcpRecv ( socks[i], buf, sizeof ( buf ) ) ) <= 0 ||
+                 tcpSendAll ( socks[1 - i], buf, length ) != 0 ) {
+                goto done;
+            }
+        }
+    }
+
+  done:
+    tcpShutdown ( conn_p->client );
+    tcpShutdown ( conn_p->server );
+    mutexLock ( &proxy.mutex );
+    conn_p->state = FAILOVER_CONN_DONE;
+    mutexUnlock ( &proxy.mutex );
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * failover_reapConns
+ *
+ * Join the relay threads that have ended and free their slots.
+ *****************************************************************************/
+static void
+failover_reapConns ( void )
+{
+    failover_conn_t *conn_p;
+    int             done;
+    int             i;
+
+    for ( i = 0; i < FAILOVER_MAX_CONNS; i++ ) {
+        conn_p = &proxy.conns[i];
+        mutexLock ( &proxy.mutex );
+        done = ( conn_p->state == FAILOVER_CONN_DONE );
+        mutexUnlock ( &proxy.mutex );
+        if ( done ) {
+            threadJoin ( conn_p->thread );
+            tcpClose ( conn_p->client );
+            tcpClose ( conn_p->server );
+            mutexLock ( &proxy.mutex );
+            conn_p->state = FAILOVER_CONN_FREE;
+            mutexUnlock ( &proxy.mutex );
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * failover_acceptThread
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+failover_acceptThread ( void *arg_p )
+{
+    failover_conn_t *conn_p;
+    SOCKET_T        client;
+    SOCKET_T        server;
+    int             refuse;
+    int             i;
+
+    while ( proxy.running ) {
+        if ( tcpAccept ( proxy.listenSock, 100, &client ) != 0 ) {
+            continue;
+        }
+        failover_reapConns (  );
+
+        mutexLock ( &proxy.mutex );
+        refuse = ( getTimeInUs (  ) < proxy.outageUntilUs );
+        mutexUnlock ( &proxy.mutex );
+        if ( refuse ) {
+            proxy.refused++;
+            tcpClose ( client );
+            continue;
+        }
+        if ( tcpConnect ( proxy.brokerHost, proxy.brokerPort, &server ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Proxy could not connect to %s:%u", proxy.brokerHost, proxy.brokerPort );
+            tcpClose ( client );
+            continue;
+        }
+
+        conn_p = NULL;
+        mutexLock ( &proxy.mutex );
+        for ( i = 0; i < FAILOVER_MAX_CONNS; i++ ) {
+            if ( proxy.conns[i].state == FAILOVER_CONN_FREE ) {
+                conn_p = &proxy.conns[i];
+                conn_p->client = client;
+                conn_p->server = server;
+                conn_p->state = FAILOVER_CONN_RELAYING;
+                break;
+            }
+        }
+        mutexUnlock ( &proxy.mutex );
+        if ( conn_p == NULL || threadCreate ( &conn_p->thread, failover_relayThread, conn_p ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Proxy cannot relay another connection" );
+            if ( conn_p != NULL ) {
+                mutexLock ( &proxy.mutex );
+                conn_p->state = FAILOVER_CONN_FREE;
+                mutexUnlock ( &proxy.mutex );
+            }
+            tcpClose ( client );
+            tcpClose ( server );
+            continue;
+        }
+        proxy.accepted++;
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * failover_dropConnections
+ *
+ * Drop every relayed connection, and refuse new ones for outageMs.
+ *****************************************************************************/
+static void
+failover_dropConnections ( int outageMs )
+{
+    int             i;
+
+    mutexLock ( &proxy.mutex );
+    proxy.outageUntilUs = getTimeInUs (  ) + ( UINT64 ) outageMs * 1000;
+    for ( i = 0; i < FAILOVER_MAX_CONNS; i++ ) {
+        if ( proxy.conns[i].state == FAILOVER_CONN_RELAYING ) {
+            tcpShutdown ( proxy.conns[i].client );
+            tcpShutdown ( proxy.conns[i].server );
+        }
+    }
+    mutexUnlock ( &proxy.mutex );
+}
+
+
+/*****************************************************************************
+ * failover_startProxy
+ *****************************************************************************/
+static int
+failover_startProxy ( void )
+{
+    mutexInit ( &proxy.mutex );
+    proxy.port = 0;
+    if ( tcpListen ( &proxy.port, &proxy.listenSock ) != 0 ) {
+        printf ( "Proxy could not listen\n" );
+        return -1;
+    }
+    proxy.running = 1;
+    if ( threadCreate ( &proxy.acceptThread, failover_acceptThread, NULL ) != 0 ) {
+        printf ( "Could not start the proxy thread\n" );
+        tcpClose ( proxy.listenSock );
+        return -1;
+    }
+    return 0;
+}
+
+
+/*****************************************************************************
+ * failover_stopProxy
+ *****************************************************************************/
+static void
+failover_stopProxy ( void )
+{
+    int             busy;
+    int             i;
+
+    proxy.running = 0;
+    threadJoin ( proxy.acceptThread );
+    tcpClose ( proxy.listenSock );
+    do {
+        failover_dropConnections ( 0 );
+        failover_reapConns (  );
+        busy = 0;
+        mutexLock ( &proxy.mutex );
+        for ( i = 0; i < FAILOVER_MAX_CONNS; i++ ) {
+            busy |= ( proxy.conns[i].state != FAILOVER_CONN_FREE );
+        }
+        mutexUnlock ( &proxy.mutex );
+        if ( busy ) {
+            sleepInUs ( 1000 );
+        }
+    } while ( busy );
+    mutexDestroy ( &proxy.mutex );
+}
+
+
+/*****************************************************************************
+ * failover_testMessageReceiveCallback
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+failover_testMessageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * failover_testEventCallback
+ *
+ * Time the Session under test going down and coming back, then pass the
+ * event on to the subscription registry.
+ *****************************************************************************/
+static void
+failover_testEventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                             solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    UINT64          nowUs = getTimeInUs (  );
+
+    if ( eventInfo_p->sessionEvent == SOLCLIENT_SESSION_EVENT_ACKNOWLEDGEMENT ) {
+        mutexLock ( &recovery.mutex );
+        recovery.acks++;
+        mutexUnlock ( &recovery.mutex );
+        return;
+    }
+
+    /* The registry starts resubscribing before the reconnect is seen. */
+    common_subRegistry_eventCallback ( opaqueSession_p, eventInfo_p, &registry );
+
+    mutexLock ( &recovery.mutex );
+    switch ( eventInfo_p->sessionEvent ) {
+        case SOLCLIENT_SESSION_EVENT_RECONNECTING_NOTICE:
+            if ( !recovery.down ) {
+                recovery.down = 1;
+                recovery.downUs = nowUs;
+            }
+            break;
+        case SOLCLIENT_SESSION_EVENT_DOWN_ERROR:
+            if ( !recovery.down ) {
+                recovery.down = 1;
+                recovery.downUs = nowUs;
+            }
+            recovery.gaveUp = 1;
+            break;
+        case SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE:
+            recovery.upUs = nowUs;
+            recovery.reconnected = 1;
+            break;
+        case SOLCLIENT_SESSION_EVENT_REJECTED_MSG_ERROR:
+            recovery.rejected++;
+            break;
+        default:
+            break;
+    }
+    mutexUnlock ( &recovery.mutex );
+}
+
+
+/*****************************************************************************
+ * failover_observerMessageReceiveCallback
+ *
+ * Count the messages lost or duplicated from their sequence numbers.
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+failover_observerMessageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    void           *data_p;
+    solClient_uint32_t size;
+    solClient_uint64_t seq;
+
+    if ( solClient_msg_getBinaryAttachmentPtr ( msg_p, &data_p, &size ) != SOLCLIENT_OK || size != sizeof ( seq ) ) {
+        return SOLCLIENT_CALLBACK_OK;
+    }
+    memcpy ( &seq, data_p, sizeof ( seq ) );
+    received++;
+    if ( seq < nextSeq ) {
+        duplicated++;
+    } else {
+        gapLost += seq - nextSeq;
+        nextSeq = seq + 1;
+    }
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * failover_publishThread
+ *
+ * Publish sequence numbers at msgRate on the Session under test. Sends
+ * block while it reconnects.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+failover_publishThread ( void *arg_p )
+{
+    solClient_opaqueMsg_pt msg_p = ( solClient_opaqueMsg_pt ) arg_p;
+    solClient_returnCode_t rc;
+    UINT64          startUs = getTimeInUs (  );
+    UINT64          dueUs;
+    UINT64          nowUs;
+    solClient_uint64_t n = 0;
+
+    while ( publishing ) {
+        dueUs = startUs + n * 1000000 / msgRate;
+        if ( ( nowUs = getTimeInUs (  ) ) < dueUs ) {
+            sleepInUs ( ( int ) ( dueUs - nowUs ) );
+        } else if ( nowUs > dueUs + 1000000 ) {
+            /* Blocked while reconnecting: go on at the rate rather than burst to catch up. */
+            startUs = nowUs;
+            n = 0;
+        }
+        n++;
+        solClient_msg_setBinaryAttachment ( msg_p, &sent, sizeof ( sent ) );
+        if ( ( rc = solClient_session_sendMsg ( testSession_p, msg_p ) ) == SOLCLIENT_OK ) {
+            sent++;
+        } else {
+            sendFailures++;
+        }
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * failover_printPercentiles
+ *****************************************************************************/
+static void
+failover_printPercentiles ( const char *name_p, solClient_uint64_t *samples_p, int numSamples )
+{
+    if ( numSamples == 0 ) {
+        printf ( "  %-12s -\n", name_p );
+        return;
+    }
+    common_sortSamples ( samples_p, numSamples );
+    printf ( "  %-12s p50 %8.1f ms  p90 %8.1f ms  max %8.1f ms\n", name_p,
+             common_getPercentile ( samples_p, numSamples, 50.0 ) / 1000.0,
+             common_getPercentile ( samples_p, numSamples, 90.0 ) / 1000.0,
+             common_getPercentile ( samples_p, numSamples, 100.0 ) / 1000.0 );
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    struct commonOptions testOpts;
+    int             numDrops = FAILOVER_DEFAULT_DROPS;
+    int             outageMs = FAILOVER_DEFAULT_OUTAGE_MS;
+    int             waitsMs[FAILOVER_MAX_WAITS];
+    int             numWaits = 0;
+    char            waitLabel[32];
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Sessions */
+    solClient_opaqueSession_pt observerSession_p;
+
+    /* Message */
+    solClient_opaqueMsg_pt msg_p = NULL;
+    solClient_destination_t destination;
+    char            trafficTopic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 1];
+    char            topic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 16];
+
+    /* Results */
+    solClient_uint64_t *detectUs_p = NULL;
+    solClient_uint64_t *reconnectUs_p = NULL;
+    solClient_uint64_t *resubscribeUs_p = NULL;
+    UINT64          resubscribedUs;
+    int             numRecovered;
+    int             numGaveUp;
+    solClient_uint64_t firstSeq;
+    solClient_uint64_t acks;
+    UINT64          deadlineUs;
+    THREAD_T        publishThread;
+    int             down;
+    int             reconnected;
+    int             gaveUp;
+    int             waitIndex;
+    int             drop;
+    int             i;
+
+    printf ( "\nFailoverBench.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( HOST_PARAM_MASK |
+                                USER_PARAM_MASK ),    /* required parameters */
+                               ( DEST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                MSG_RATE_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                RETRY_MASK ));                         /* optional parameters */
+    commandOpts.msgRate = FAILOVER_DEFAULT_RATE;
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[MODE] [DROPS] [OUTAGE_MS] [WAIT_MS ...]   Publish direct or persistent messages (default\n"
+            "\t                          direct) and drop the connection DROPS times (default 5), refusing\n"
+            "\t                          reconnects for OUTAGE_MS (default 0), for each reconnect retry\n"
+            "\t                          wait WAIT_MS (default: --retries, or the API default).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        if ( strcmp ( argv[optind], "persistent" ) == 0 ) {
+            persistent = 1;
+        } else if ( strcmp ( argv[optind], "direct" ) != 0 ) {
+            printf ( "Unknown mode '%s'\n", argv[optind] );
+            exit(1);
+        }
+        optind++;
+    }
+    if ( optind < argc ) {
+        numDrops = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        outageMs = atoi ( argv[optind++] );
+    }
+    while ( optind < argc && numWaits < FAILOVER_MAX_WAITS ) {
+        if ( ( waitsMs[numWaits++] = atoi ( argv[optind++] ) ) < 0 ) {
+            printf ( "Invalid arguments\n" );
+            exit(1);
+        }
+    }
+    if ( numWaits == 0 ) {
+        waitsMs[numWaits++] = commandOpts.reconnectRetryWaitMs;
+    }
+    msgRate = commandOpts.msgRate;
+    if ( numDrops < 1 || outageMs < 0 || msgRate < 1 ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    if ( failover_parseHost ( commandOpts.targetHost ) != 0 ) {
+        printf ( "Invalid host '%s'\n", commandOpts.targetHost );
+        exit(1);
+    }
+    if ( commandOpts.destinationName[0] == '\0' ) {
+        strcpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC );
+    }
+    if ( strlen ( commandOpts.destinationName ) + 32 > sizeof ( topic ) ) {
+        printf ( "Topic too long\n" );
+        exit(1);
+    }
+    if ( ( unsigned int ) snprintf ( trafficTopic, sizeof ( trafficTopic ), "%s/failover",
+                                     commandOpts.destinationName ) >= sizeof ( trafficTopic ) ) {
+        printf ( "Topic too long\n" );
+        exit(1);
+    }
+
+    detectUs_p = ( solClient_uint64_t * ) malloc ( numDrops * sizeof ( solClient_uint64_t ) );
+    reconnectUs_p = ( solClient_uint64_t * ) malloc ( numDrops * sizeof ( solClient_uint64_t ) );
+    resubscribeUs_p = ( solClient_uint64_t * ) malloc ( numDrops * sizeof ( solClient_uint64_t ) );
+    if ( detectUs_p == NULL || reconnectUs_p == NULL || resubscribeUs_p == NULL ) {
+        printf ( "Could not allocate results for %d drops\n", numDrops );
+        exit(1);
+    }
+    mutexInit ( &recovery.mutex );
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context, start the proxy and connect the observer Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    /* Winsock is started by solClient_initialize(). */
+    if ( failover_startProxy (  ) != 0 ) {
+        goto cleanup;
+    }
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &observerSession_p,
+                                                 failover_observerMessageReceiveCallback,
+                                                 common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto proxyStarted;
+    }
+    if ( ( rc = solClient_session_topicSubscribeExt ( observerSession_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                      trafficTopic ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicSubscribeExt()" );
+        goto observerConnected;
+    }
+
+    if ( ( rc = solClient_msg_alloc ( &msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_alloc()" );
+        goto observerConnected;
+    }
+    destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+    destination.dest = trafficTopic;
+    solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) );
+    solClient_msg_setDeliveryMode ( msg_p, persistent ? SOLCLIENT_DELIVERY_MODE_PERSISTENT : SOLCLIENT_DELIVERY_MODE_DIRECT );
+
+    printf ( "Relaying 127.0.0.1:%u to %s:%u; %s messages at %d/s to %s; %d subscriptions, %d drops, outage %d ms\n",
+             proxy.port, proxy.brokerHost, proxy.brokerPort, persistent ? "persistent" : "direct", msgRate,
+             trafficTopic, FAILOVER_SUBSCRIPTIONS, numDrops, outageMs );
+
+    /*************************************************************************
+     * For each reconnect retry wait
+     *************************************************************************/
+
+    for ( waitIndex = 0; waitIndex < numWaits; waitIndex++ ) {
+        testOpts = commandOpts;
+        snprintf ( testOpts.targetHost, sizeof ( testOpts.targetHost ), "tcp:127.0.0.1:%u", proxy.port );
+        testOpts.reapplySubscriptions = 0;
+        testOpts.reconnectRetryWaitMs = waitsMs[waitIndex];
+        if ( waitsMs[waitIndex] < 0 ) {
+            strcpy ( waitLabel, "API default" );
+        } else {
+            snprintf ( waitLabel, sizeof ( waitLabel ), "%d ms", waitsMs[waitIndex] );
+        }
+
+        if ( common_subRegistry_init ( &registry, FAILOVER_SUBSCRIPTIONS, FAILOVER_SUB_WINDOW ) != SOLCLIENT_OK ) {
+            break;
+        }
+        for ( i = 0; i < FAILOVER_SUBSCRIPTIONS; i++ ) {
+            snprintf ( topic, sizeof ( topic ), "%s/sub/%d", trafficTopic, i );
+            common_subRegistry_add ( &registry, topic, i < FAILOVER_CRITICAL_SUBSCRIPTIONS ? 1 : 0 );
+        }
+        if ( ( rc = common_createAndConnectSession ( context_p,
+                                                     &testSession_p,
+                                                     failover_testMessageReceiveCallback,
+                                                     failover_testEventCallback, NULL, &testOpts ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "common_createAndConnectSession()" );
+            common_subRegistry_destroy ( &registry );
+            break;
+        }
+        common_subRegistry_apply ( &registry, testSession_p );
+        common_subRegistry_waitApplied ( &registry, FAILOVER_RECOVERY_TIMEOUT_MS, NULL );
+
+        /* No messages are in flight between waits. */
+        nextSeq = sent;
+        received = 0;
+        gapLost = 0;
+        duplicated = 0;
+        sendFailures = 0;
+        mutexLock ( &recovery.mutex );
+        recovery.acks = 0;
+        recovery.rejected = 0;
+        mutexUnlock ( &recovery.mutex );
+        firstSeq = sent;
+
+        publishing = 1;
+        if ( threadCreate ( &publishThread, failover_publishThread, msg_p ) != 0 ) {
+            printf ( "Could not start the publishing thread\n" );
+            publishing = 0;
+            solClient_session_destroy ( &testSession_p );
+            common_subRegistry_destroy ( &registry );
+            break;
+        }
+
+        numRecovered = 0;
+        numGaveUp = 0;
+        for ( drop = 0; drop < numDrops; drop++ ) {
+            sleepInUs ( FAILOVER_STEADY_MS * 1000 );
+
+            mutexLock ( &recovery.mutex );
+            recovery.down = 0;
+            recovery.reconnected = 0;
+            recovery.gaveUp = 0;
+            recovery.dropUs = getTimeInUs (  );
+            mutexUnlock ( &recovery.mutex );
+            failover_dropConnections ( outageMs );
+
+            /* Wait for the reconnect, or for the Session to give up. */
+            deadlineUs = getTimeInUs (  ) + ( UINT64 ) FAILOVER_RECOVERY_TIMEOUT_MS * 1000;
+            do {
+                sleepInUs ( 1000 );
+                mutexLock ( &recovery.mutex );
+                down = recovery.down;
+                reconnected = recovery.reconnected;
+                gaveUp = recovery.gaveUp;
+                mutexUnlock ( &recovery.mutex );
+            } while ( !reconnected && !gaveUp && getTimeInUs (  ) < deadlineUs );
+
+            if ( reconnected &&
+                 common_subRegistry_waitApplied ( &registry, FAILOVER_RECOVERY_TIMEOUT_MS, &resubscribedUs ) == SOLCLIENT_OK ) {
+                detectUs_p[numRecovered] = recovery.downUs - recovery.dropUs;
+                reconnectUs_p[numRecovered] = recovery.upUs - recovery.dropUs;
+                resubscribeUs_p[numRecovered] = recovery.upUs - recovery.dropUs + resubscribedUs;
+                printf ( "wait %s, drop %d: detected %.1f ms, reconnected %.1f ms, resubscribed %.1f ms\n",
+                         waitLabel, drop + 1, detectUs_p[numRecovered] / 1000.0,
+                         reconnectUs_p[numRecovered] / 1000.0, resubscribeUs_p[numRecovered] / 1000.0 );
+                numRecovered++;
+                continue;
+            }
+
+            numGaveUp++;
+            printf ( "wait %s, drop %d: %s after %.1f ms; connecting again\n", waitLabel, drop + 1,
+                     gaveUp ? "gave up" : ( down ? "not reconnected" : "not detected" ),
+                     ( getTimeInUs (  ) - recovery.dropUs ) / 1000.0 );
+            if ( gaveUp ) {
+                while ( getTimeInUs (  ) < recovery.dropUs + ( UINT64 ) outageMs * 1000 ) {
+                    sleepInUs ( 10000 );
+                }
+                if ( ( rc = solClient_session_connect ( testSession_p ) ) != SOLCLIENT_OK ) {
+                    common_handleError ( rc, "solClient_session_connect()" );
+                    break;
+                }
+                common_subRegistry_apply ( &registry, testSession_p );
+                common_subRegistry_waitApplied ( &registry, FAILOVER_RECOVERY_TIMEOUT_MS, NULL );
+            }
+        }
+
+        publishing = 0;
+        threadJoin ( publishThread );
+        /* Let the last messages, and their acknowledgements, arrive. */
+        deadlineUs = getTimeInUs (  ) + ( UINT64 ) FAILOVER_DRAIN_MS * 1000;
+        do {
+            sleepInUs ( 10000 );
+            mutexLock ( &recovery.mutex );
+            acks = recovery.acks;
+            mutexUnlock ( &recovery.mutex );
+        } while ( ( nextSeq < sent || ( persistent && acks < sent - firstSeq ) ) && getTimeInUs (  ) < deadlineUs );
+
+        printf ( "\nReconnect retry wait %s: %d of %d drops recovered, %d gave up\n",
+                 waitLabel, numRecovered, numDrops, numGaveUp );
+        failover_printPercentiles ( "detect", detectUs_p, numRecovered );
+        failover_printPercentiles ( "reconnect", reconnectUs_p, numRecovered );
+        failover_printPercentiles ( "resubscribe", resubscribeUs_p, numRecovered );
+        printf ( "  messages: %llu sent, %llu not sent, %llu received, %llu lost, %llu duplicated",
+                 ( unsigned long long ) ( sent - firstSeq ), ( unsigned long long ) sendFailures,
+                 ( unsigned long long ) received, ( unsigned long long ) ( gapLost + ( sent - nextSeq ) ),
+                 ( unsigned long long ) duplicated );
+        if ( persistent ) {
+            printf ( ", %llu acknowledged, %llu rejected", ( unsigned long long ) recovery.acks,
+                     ( unsigned long long ) recovery.rejected );
+        }
+        printf ( "\n\n" );
+
+        if ( ( rc = solClient_session_disconnect ( testSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_disconnect()" );
+        }
+        if ( ( rc = solClient_session_destroy ( &testSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_destroy()" );
+        }
+        common_subRegistry_destroy ( &registry );
+    }
+    printf ( "Proxy: %llu connections relayed, %llu refused\n", ( unsigned long long ) proxy.accepted,
+             ( unsigned long long ) proxy.refused );
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+    solClient_msg_free ( &msg_p );
+
+  observerConnected:
+    if ( ( rc = solClient_session_disconnect ( observerSession_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  proxyStarted:
+    failover_stopProxy (  );
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    mutexDestroy ( &recovery.mutex );
+    free ( detectUs_p );
+    free ( reconnectUs_p );
+    free ( resubscribeUs_p );
+    return 0;
+
+}
@@ -0,0 +1,596 @@
+
+/** @example Intro/FanoutSubscriber.c
+ */
+
+/*
+ * This sample measures how receiving scales with the number of Sessions in
+ * one process, to size consumer hosts. It connects SESSIONS Sessions spread
+ * round-robin over CONTEXTS Contexts (one Context thread each), each
+ * subscribing to TOPICS topics: the same <topic>/0 to <topic>/<TOPICS - 1>
+ * for every Session ("same"), or a disjoint set per Session ("disjoint"),
+ * where <topic> is given with "--topic" (default my/sample/topic).
+ *
+ * Every Session counts its messages with common_messageReceivePerfCallback()
+ * in its own cache-line padded counter, so Context threads never write to a
+ * shared cache line. Once a second the aggregate receive rate is printed;
+ * at the end, the rate of each Session, the process CPU time per message
+ * and how busy each CPU core was.
+ *
+ * With "--mr" the sample also publishes the topics itself, round-robin at
+ * that many messages per second, on a separate Context. Its messages carry
+ * a sequence number and a send time, so the receive latency of each Session
+ * is reported, and with "same" topics the skew between the first and the
+ * last Session to receive each message. Without "--mr", publish to the
+ * topics with another tool (for example PerfPublisher).
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "getopt.h"
+
+#define FANOUT_DEFAULT_SESSIONS     8
+#define FANOUT_DEFAULT_CONTEXTS     2
+#define FANOUT_DEFAULT_TOPICS       10
+#define FANOUT_DEFAULT_SECONDS      10
+#define FANOUT_MAX_SESSIONS         256
+#define FANOUT_MAX_CONTEXTS         64
+#define FANOUT_MAX_CORES            256
+
+/* Latencies are kept for the first messages published, by sequence number. */
+#define FANOUT_LATENCY_SAMPLES      50000
+
+/* Identifies the messages published by this sample. */
+#define FANOUT_STAMP_MAGIC          0x46414e4f55540001ULL
+
+/*
+ * The payload of the messages published by this sample. The send time is
+ * from getTimeInUs(), which is only comparable within this process.
+ */
+typedef struct fanoutStamp
+{
+    solClient_uint64_t magic;
+    solClient_uint64_t seq;
+    UINT64          sentUs;
+} fanoutStamp_t;
+
+/*
+ * A receiving Session, two cache lines long. The counters are written only
+ * by the Session's Context thread; rx fills the first line, and the rest
+ * is padded out to the end of the second so that in an array of them, the
+ * next Session's counters start on a line of their own.
+ */
+typedef struct fanoutSession
+{
+    common_rxPerfCounter_t rx;
+    solClient_uint64_t timed;       /* Messages from this sample's publisher. */
+    solClient_uint32_t *latencyUs_p; /* Latency + 1 by sequence number, 0 if not received. */
+    solClient_opaqueSession_pt session_p;
+    int             context;
+    char            pad[COMMON_CACHE_LINE_SIZE - sizeof ( solClient_uint64_t ) - 2 * sizeof ( void * ) - sizeof ( int )];
+} fanoutSession_t;
+
+static fanoutSession_t *sessions_p = NULL;
+
+/* The in-process publisher. */
+static solClient_opaqueSession_pt pubSession_p = NULL;
+static volatile int publishing = 0;
+static int      msgRate = 0;
+static int      numPubTopics = 0;
+static const char *topicPrefix_p;
+static solClient_uint64_t published = 0;
+static solClient_uint64_t pubFailures = 0;
+
+
+/*****************************************************************************
+ * fanout_messageReceiveCallback
+ *
+ * Record the latency of this sample's messages, then count every message
+ * with common_messageReceivePerfCallback().
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+fanout_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    fanoutSession_t *fs_p = ( fanoutSession_t * ) user_p;
+    fanoutStamp_t   stamp;
+    void           *attachment_p;
+    solClient_uint32_t size;
+    UINT64          latencyUs;
+
+    if ( solClient_msg_getBinaryAttachmentPtr ( msg_p, &attachment_p, &size ) == SOLCLIENT_OK &&
+         size == sizeof ( stamp ) ) {
+        memcpy ( &stamp, attachment_p, sizeof ( stamp ) );
+        if ( stamp.magic == FANOUT_STAMP_MAGIC ) {
+            fs_p->timed++;
+            if ( fs_p->latencyUs_p != NULL && stamp.seq < FANOUT_LATENCY_SAMPLES ) {
+                latencyUs = getTimeInUs (  ) - stamp.sentUs;
+                fs_p->latencyUs_p[stamp.seq] = latencyUs < 0xfffffffe ? ( solClient_uint32_t ) latencyUs + 1 : 0xffffffff;
+            }
+        }
+    }
+    return common_messageReceivePerfCallback ( opaqueSession_p, msg_p, &fs_p->rx );
+}
+
+
+/*****************************************************************************
+ * fanout_publishThread
+ *
+ * Publish stamped messages round-robin over the topics at msgRate. A
+ * publisher that falls behind does not burst to catch up.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+fanout_publishThread ( void *arg_p )
+{
+    solClient_opaqueMsg_pt msg_p = NULL;
+    solClient_destination_t destination;
+    fanoutStamp_t   stamp;
+    char            topic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 16];
+    solClient_returnCode_t rc;
+    UINT64          startUs = getTimeInUs (  );
+    UINT64          dueUs;
+    UINT64          nowUs;
+    solClient_uint64_t n = 0;
+
+    if ( solClient_msg_alloc ( &msg_p ) != SOLCLIENT_OK ) {
+        return THREAD_FUNC_RETURN_VAL;
+    }
+    destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+    destination.dest = topic;
+    stamp.magic = FANOUT_STAMP_MAGIC;
+
+    while ( publishing ) {
+        dueUs = startUs + n * 1000000 / msgRate;
+        if ( ( nowUs = getTimeInUs (  ) ) < dueUs ) {
+            sleepInUs ( ( int ) ( dueUs - nowUs ) );
+        } else if ( nowUs > dueUs + 1000000 ) {
+            startUs = nowUs;
+            n = 0;
+        }
+        n++;
+
+        sprintf ( topic, "%s/%d", topicPrefix_p, ( int ) ( published % numPubTopics ) );
+        stamp.seq = published;
+        stamp.sentUs = getTimeInUs (  );
+        if ( ( rc = solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) ) ) != SOLCLIENT_OK ||
+             ( rc = solClient_msg_setBinaryAttachment ( msg_p, &stamp, sizeof ( stamp ) ) ) != SOLCLIENT_OK ||
+             ( rc = solClient_session_sendMsg ( pubSession_p, msg_p ) ) != SOLCLIENT_OK ) {
+            pubFailures++;
+        }
+        published++;
+    }
+
+    solClient_msg_free ( &msg_p );
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * fanout_getTotals
+ *****************************************************************************/
+static void
+fanout_getTotals ( int numSessions, solClient_uint64_t * msgs_p, solClient_uint64_t * bytes_p )
+{
+    int             i;
+
+    *msgs_p = 0;
+    *bytes_p = 0;
+    for ( i = 0; i < numSessions; i++ ) {
+        *msgs_p += sessions_p[i].rx.msgs;
+        *bytes_p += sessions_p[i].rx.bytes;
+    }
+}
+
+
+/*****************************************************************************
+ * fanout_printLatency
+ *
+ * Per Session receive latency percentiles, and for the same topics the skew
+ * between the first and the last Session to receive each message.
+ *****************************************************************************/
+static void
+fanout_printLatency ( int numSessions, int sameTopics, solClient_uint64_t numTimed )
+{
+    solClient_uint64_t *samples_p;
+    solClient_uint64_t minUs;
+    solClient_uint64_t maxUs;
+    solClient_uint64_t lowestP50 = 0;
+    solClient_uint64_t highestP50 = 0;
+    solClient_uint64_t p50;
+    int             numSamples;
+    int             received;
+    int             seq;
+    int             i;
+
+    if ( numTimed > FANOUT_LATENCY_SAMPLES ) {
+        numTimed = FANOUT_LATENCY_SAMPLES;
+    }
+    if ( numTimed == 0 || ( samples_p = ( solClient_uint64_t * ) malloc ( numTimed * sizeof ( solClient_uint64_t ) ) ) == NULL ) {
+        return;
+    }
+
+    printf ( "\nReceive latency of the first %d messages published (us):\n", ( int ) numTimed );
+    printf ( "%-8s %10s %10s %10s %10s\n", "Session", "Msgs", "p50", "p99", "max" );
+    for ( i = 0; i < numSessions; i++ ) {
+        numSamples = 0;
+        for ( seq = 0; seq < ( int ) numTimed; seq++ ) {
+            if ( sessions_p[i].latencyUs_p[seq] != 0 ) {
+                samples_p[numSamples++] = sessions_p[i].latencyUs_p[seq] - 1;
+            }
+        }
+        if ( numSamples == 0 ) {
+            continue;
+        }
+        common_sortSamples ( samples_p, numSamples );
+        p50 = common_getPercentile ( samples_p, numSamples, 50.0 );
+        printf ( "%-8d %10d %10llu %10llu %10llu\n", i, numSamples, ( unsigned long long ) p50,
+                 ( unsigned long long ) common_getPercentile ( samples_p, numSamples, 99.0 ),
+                 ( unsigned long long ) samples_p[numSamples - 1] );
+        if ( lowestP50 == 0 || p50 < lowestP50 ) {
+            lowestP50 = p50;
+        }
+        if ( p50 > highestP50 ) {
+            highestP50 = p50;
+        }
+    }
+    printf ( "Spread of the Session medians: %llu us\n", ( unsigned long long ) ( highestP50 - lowestP50 ) );
+
+    /* Each message went to every Session: compare their receive times. */
+    if ( sameTopics && numSessions > 1 ) {
+        numSamples = 0;
+        for ( seq = 0; seq < ( int ) numTimed; seq++ ) {
+            minUs = ( solClient_uint64_t ) -1;
+            maxUs = 0;
+            received = 0;
+            for ( i = 0; i < numSessions; i++ ) {
+                if ( sessions_p[i].latencyUs_p[seq] != 0 ) {
+                    received++;
+                    if ( sessions_p[i].latencyUs_p[seq] < minUs ) {
+                        minUs = sessions_p[i].latencyUs_p[seq];
+                    }
+                    if ( sessions_p[i].latencyUs_p[seq] > maxUs ) {
+                        maxUs = sessions_p[i].latencyUs_p[seq];
+                    }
+                }
+            }
+            if ( received == numSessions ) {
+                samples_p[numSamples++] = maxUs - minUs;
+            }
+        }
+        if ( numSamples > 0 ) {
+            common_sortSamples ( samples_p, numSamples );
+            printf ( "Skew, first to last Session, of %d messages received by all: p50 %llu us, p99 %llu us, "
+                     "max %llu us\n", numSamples,
+                     ( unsigned long long ) common_getPercentile ( samples_p, numSamples, 50.0 ),
+                     ( unsigned long long ) common_getPercentile ( samples_p, numSamples, 99.0 ),
+                     ( unsigned long long ) samples_p[numSamples - 1] );
+        }
+    }
+    free ( samples_p );
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             numSessions = FANOUT_DEFAULT_SESSIONS;
+    int             numContexts = FANOUT_DEFAULT_CONTEXTS;
+    int             numTopics = FANOUT_DEFAULT_TOPICS;
+    int             sameTopics = 1;
+    int             seconds = FANOUT_DEFAULT_SECONDS;
+
+    /* Contexts */
+    solClient_opaqueContext_pt contexts_p[FANOUT_MAX_CONTEXTS];
+    solClient_opaqueContext_pt pubContext_p = NULL;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+    int             numCreated = 0;
+    int             numConnected = 0;
+
+    char            topic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 16];
+    THREAD_T        pubThread;
+    int             pubStarted = 0;
+    UINT64          coreStartUs[FANOUT_MAX_CORES];
+    UINT64          coreEndUs[FANOUT_MAX_CORES];
+    int             numCores;
+    UINT64          userUs;
+    UINT64          systemUs;
+    UINT64          cpuStartUs;
+    UINT64          cpuUs;
+    UINT64          startUs;
+    UINT64          elapsedUs;
+    solClient_uint64_t startMsgs[FANOUT_MAX_SESSIONS];
+    solClient_uint64_t msgs;
+    solClient_uint64_t bytes;
+    solClient_uint64_t lastMsgs;
+    solClient_uint64_t lastBytes;
+    solClient_uint64_t firstMsgs;
+    solClient_uint64_t firstBytes;
+    solClient_uint64_t minMsgs;
+    solClient_uint64_t maxMsgs;
+    solClient_uint64_t timed;
+    solClient_uint64_t sessionMsgs;
+    double          busy;
+    int             i;
+    int             t;
+
+    printf ( "\nFanoutSubscriber.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                DEST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                MSG_RATE_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK |
+                                PROFILE_MASK));                          /* optional parameters */
+    commandOpts.msgRate = 0;
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[SESSIONS] [CONTEXTS] [TOPICS] [same|disjoint] [SECONDS]   Connect SESSIONS Sessions (default 8)\n"
+            "\t                          over CONTEXTS Contexts (default 2), each subscribing to TOPICS topics\n"
+            "\t                          (default 10), the same for all or disjoint (default same), and\n"
+            "\t                          receive for SECONDS (default 10). With --mr, also publish them.\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        numSessions = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        numContexts = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        numTopics = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        sameTopics = ( strcasecmp ( argv[optind++], "disjoint" ) != 0 );
+    }
+    if ( optind < argc ) {
+        seconds = atoi ( argv[optind++] );
+    }
+    if ( numSessions < 1 || numSessions > FANOUT_MAX_SESSIONS || numContexts < 1 || numContexts > FANOUT_MAX_CONTEXTS ||
+         numTopics < 1 || seconds < 1 || commandOpts.msgRate < 0 ) {
+        printf ( "Invalid arguments: 1 to %d Sessions, 1 to %d Contexts\n", FANOUT_MAX_SESSIONS, FANOUT_MAX_CONTEXTS );
+        exit(1);
+    }
+    if ( numContexts > numSessions ) {
+        numContexts = numSessions;
+    }
+    if ( commandOpts.destinationName[0] == '\0' ) {
+        strcpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC );
+    }
+    topicPrefix_p = commandOpts.destinationName;
+    msgRate = commandOpts.msgRate;
+    numPubTopics = sameTopics ? numTopics : numTopics * numSessions;
+
+    /* The Sessions' counters, each on its own cache lines. */
+    if ( ( sessions_p = ( fanoutSession_t * ) alignedAlloc ( numSessions * sizeof ( fanoutSession_t ),
+                                                              COMMON_CACHE_LINE_SIZE ) ) == NULL ) {
+        printf ( "Could not allocate %d Sessions\n", numSessions );
+        exit(1);
+    }
+    memset ( sessions_p, 0, numSessions * sizeof ( fanoutSession_t ) );
+    for ( i = 0; i < numSessions; i++ ) {
+        sessions_p[i].context = i % numContexts;
+        if ( msgRate > 0 &&
+             ( sessions_p[i].latencyUs_p = ( solClient_uint32_t * ) calloc ( FANOUT_LATENCY_SAMPLES,
+                                                                            sizeof ( solClient_uint32_t ) ) ) == NULL ) {
+            printf ( "Could not allocate the latency samples\n" );
+            exit(1);
+        }
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create the Contexts, and connect and subscribe the Sessions
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating %d solClient contexts and %d sessions", numContexts, numSessions );
+
+    for ( numCreated = 0; numCreated < numContexts; numCreated++ ) {
+        if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                               &contexts_p[numCreated], &contextFuncInfo,
+                                               sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_context_create()" );
+            goto contextsCreated;
+        }
+    }
+
+    for ( numConnected = 0; numConnected < numSessions; numConnected++ ) {
+        if ( ( rc = common_createAndConnectSession ( contexts_p[sessions_p[numConnected].context],
+                                                     &sessions_p[numConnected].session_p,
+                                                     fanout_messageReceiveCallback,
+                                                     common_eventCallback, &sessions_p[numConnected],
+                                                     &commandOpts ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "common_createAndConnectSession()" );
+            goto sessionsConnected;
+        }
+        for ( t = 0; t < numTopics; t++ ) {
+            sprintf ( topic, "%s/%d", commandOpts.destinationName, sameTopics ? t : numConnected * numTopics + t );
+            if ( ( rc = solClient_session_topicSubscribeExt ( sessions_p[numConnected].session_p,
+                                                              SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                              topic ) ) != SOLCLIENT_OK ) {
+                common_handleError ( rc, "solClient_session_topicSubscribeExt()" );
+                numConnected++;
+                goto sessionsConnected;
+            }
+        }
+    }
+
+    if ( msgRate > 0 ) {
+        if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                               &pubContext_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_context_create()" );
+            goto sessionsConnected;
+        }
+        if ( ( rc = common_createAndConnectSession ( pubContext_p, &pubSession_p,
+                                                     common_messageReceivePerfCallback,
+                                                     common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "common_createAndConnectSession()" );
+            goto sessionsConnected;
+        }
+    }
+
+    /*************************************************************************
+     * Receive
+     *************************************************************************/
+
+    printf ( "%d Sessions over %d Contexts, %d %s topics each under %s", numSessions, numContexts, numTopics,
+             sameTopics ? "same" : "disjoint", commandOpts.destinationName );
+    if ( msgRate > 0 ) {
+        printf ( ", publishing %d msgs/s over %d topics", msgRate, numPubTopics );
+    }
+    printf ( "\n\n" );
+
+    if ( msgRate > 0 ) {
+        publishing = 1;
+        if ( threadCreate ( &pubThread, fanout_publishThread, NULL ) != 0 ) {
+            printf ( "Could not start the publisher\n" );
+            publishing = 0;
+            goto sessionsConnected;
+        }
+        pubStarted = 1;
+    }
+
+    for ( i = 0; i < numSessions; i++ ) {
+        startMsgs[i] = sessions_p[i].rx.msgs;
+    }
+    fanout_getTotals ( numSessions, &firstMsgs, &firstBytes );
+    lastMsgs = firstMsgs;
+    lastBytes = firstBytes;
+    numCores = getCoreBusyTimesInUs ( coreStartUs, FANOUT_MAX_CORES );
+    getCpuTimesInUs ( &userUs, &systemUs );
+    cpuStartUs = userUs + systemUs;
+    startUs = getTimeInUs (  );
+
+    for ( t = 0; t < seconds; t++ ) {
+        sleepInUs ( 1000000 );
+        fanout_getTotals ( numSessions, &msgs, &bytes );
+        printf ( "%3d s: %10llu msgs/s %10.1f MB/s\n", t + 1, ( unsigned long long ) ( msgs - lastMsgs ),
+                 ( double ) ( bytes - lastBytes ) / ( 1024.0 * 1024.0 ) );
+        lastMsgs = msgs;
+        lastBytes = bytes;
+    }
+
+    elapsedUs = getTimeInUs (  ) - startUs;
+    getCpuTimesInUs ( &userUs, &systemUs );
+    cpuUs = userUs + systemUs - cpuStartUs;
+    if ( numCores > 0 && getCoreBusyTimesInUs ( coreEndUs, FANOUT_MAX_CORES ) != numCores ) {
+        numCores = 0;
+    }
+    fanout_getTotals ( numSessions, &msgs, &bytes );
+    msgs -= firstMsgs;
+    bytes -= firstBytes;
+
+    publishing = 0;
+    if ( pubStarted ) {
+        threadJoin ( pubThread );
+        /* Let the last published messages arrive before reading the latencies. */
+        sleepInUs ( 500000 );
+    }
+
+    /*************************************************************************
+     * Report
+     *************************************************************************/
+
+    printf ( "\n%-8s %8s %12s %12s %10s\n", "Session", "Context", "Msgs", "Msgs/s", "Timed" );
+    minMsgs = ( solClient_uint64_t ) -1;
+    maxMsgs = 0;
+    timed = 0;
+    for ( i = 0; i < numSessions; i++ ) {
+        sessionMsgs = sessions_p[i].rx.msgs - startMsgs[i];
+        printf ( "%-8d %8d %12llu %12.0f %10llu\n", i, sessions_p[i].context, ( unsigned long long ) sessionMsgs,
+                 ( double ) sessionMsgs * 1000000.0 / elapsedUs, ( unsigned long long ) sessions_p[i].timed );
+        if ( sessionMsgs < minMsgs ) {
+            minMsgs = sessionMsgs;
+        }
+        if ( sessionMsgs > maxMsgs ) {
+            maxMsgs = sessionMsgs;
+        }
+        timed += sessions_p[i].timed;
+    }
+    printf ( "\nAggregate: %.0f msgs/s, %.1f MB/s over %d Sessions (slowest %.0f, fastest %.0f msgs/s)\n",
+             ( double ) msgs * 1000000.0 / elapsedUs, ( double ) bytes / ( 1024.0 * 1024.0 ) * 1000000.0 / elapsedUs,
+             numSessions, ( double ) minMsgs * 1000000.0 / elapsedUs, ( double ) maxMsgs * 1000000.0 / elapsedUs );
+    printf ( "Process CPU: %.2f cores, %.2f us/msg\n", ( double ) cpuUs / elapsedUs,
+             msgs > 0 ? ( double ) cpuUs / msgs : 0.0 );
+    if ( numCores > 0 ) {
+        printf ( "CPU busy per core (%%):" );
+        for ( i = 0; i < numCores; i++ ) {
+            busy = ( double ) ( coreEndUs[i] - coreStartUs[i] ) * 100.0 / elapsedUs;
+            printf ( "%s %d:%.0f", ( i % 16 == 0 ) ? "\n " : "", i, busy > 100.0 ? 100.0 : busy );
+        }
+        printf ( "\n" );
+    }
+    if ( msgRate > 0 ) {
+        printf ( "Published %llu messages, %llu failed\n", ( unsigned long long ) published,
+                 ( unsigned long long ) pubFailures );
+        fanout_printLatency ( numSessions, sameTopics, published );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  sessionsConnected:
+    if ( pubSession_p != NULL ) {
+        solClient_session_disconnect ( pubSession_p );
+        solClient_session_destroy ( &pubSession_p );
+    }
+    if ( pubContext_p != NULL ) {
+        solClient_context_destroy ( &pubContext_p );
+    }
+    for ( i = 0; i < numConnected; i++ ) {
+        if ( ( rc = solClient_session_disconnect ( sessions_p[i].session_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_disconnect()" );
+        }
+        solClient_session_destroy ( &sessions_p[i].session_p );
+    }
+
+  contextsCreated:
+    for ( i = 0; i < numCreated; i++ ) {
+        solClient_context_destroy ( &contexts_p[i] );
+    }
+
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    for ( i = 0; i < numSessions; i++ ) {
+        free ( sessions_p[i].latencyUs_p );
+    }
+    alignedFree ( sessions_p );
+    return 0;
+
+}
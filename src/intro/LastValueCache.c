@@ -0,0 +1,542 @@
+
+/** @example Intro/LastValueCache.c
+ */
+
+/*
+ * This sample keeps the latest message of every topic it receives in an
+ * in-process last-value cache (see common_lvc_init()), and has reader
+ * threads read snapshots of topics from it as fast as they can, the way a
+ * GUI refreshes many fields.
+ *
+ * Reads take no lock and never wait for the network. When a Distributed
+ * Cache name is given ("--cache"), a read of a topic with no value yet sends
+ * an asynchronous cache request for it and returns; the cached message
+ * fills the entry when it arrives.
+ *
+ * In the "bench" mode, no connection is made: a writer thread updates the
+ * topics continuously while the readers read them, to measure reads per
+ * second and check that no read returns a torn snapshot, and the lock-free
+ * read is compared with copying the latest message under the lock.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "solclient/solCache.h"
+#include "common.h"
+#include "lvc.h"
+#include "getopt.h"
+
+#define LVC_DEFAULT_SECONDS         10
+#define LVC_DEFAULT_READERS         4
+#define LVC_DEFAULT_BENCH_TOPICS    10000
+#define LVC_MAX_TOPICS              100000
+#define LVC_MAX_READERS             64
+#define LVC_MAX_READ_TOPICS         64
+
+/* Binary attachment bytes kept per topic for lock-free reads. */
+#define LVC_VALUE_SIZE              256
+
+/* Attachment size of the bench mode; every byte of a value is the same. */
+#define LVC_BENCH_VALUE_SIZE        64
+
+/* Reads between checks of the running flag. */
+#define LVC_READ_BATCH              1024
+
+typedef struct lvcReader
+{
+    THREAD_T        thread;
+    int             index;
+    int             useGetMsg;      /* Copy the message under the lock instead. */
+    solClient_uint64_t reads;
+    solClient_uint64_t hits;
+    solClient_uint64_t pending;
+    solClient_uint64_t misses;
+    solClient_uint64_t torn;
+    char            pad[COMMON_CACHE_LINE_SIZE];
+} lvcReader_t;
+
+static common_lvc_t lvc;
+static volatile int running = 1;
+
+/* Topics the readers read. */
+static char   **readTopics;
+static int      numReadTopics;
+
+
+/*****************************************************************************
+ * lvc_messageReceiveCallback
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+lvc_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    common_lvc_update ( &lvc, msg_p );
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * lvc_readerThread
+ *
+ * Read the topics round robin, starting at a different one per reader. A
+ * snapshot is torn if its bytes differ, which only the bench mode's values
+ * can show.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+lvc_readerThread ( void *arg_p )
+{
+    lvcReader_t    *reader_p = ( lvcReader_t * ) arg_p;
+    unsigned char   value[LVC_VALUE_SIZE];
+    solClient_opaqueMsg_pt msg_p;
+    void           *data_p;
+    solClient_uint32_t length;
+    solClient_returnCode_t rc;
+    int             topic = reader_p->index % numReadTopics;
+    int             i;
+    solClient_uint32_t j;
+
+    while ( running ) {
+        for ( i = 0; i < LVC_READ_BATCH; i++ ) {
+            if ( reader_p->useGetMsg ) {
+                if ( ( rc = common_lvc_getMsg ( &lvc, readTopics[topic], &msg_p ) ) == SOLCLIENT_OK ) {
+                    if ( solClient_msg_getBinaryAttachmentPtr ( msg_p, &data_p, &length ) == SOLCLIENT_OK &&
+                         length <= sizeof ( value ) ) {
+                        memcpy ( value, data_p, length );
+                    }
+                    solClient_msg_free ( &msg_p );
+                }
+            } else {
+                rc = common_lvc_read ( &lvc, readTopics[topic], value, sizeof ( value ), &length );
+                if ( rc == SOLCLIENT_OK ) {
+                    for ( j = 1; j < length; j++ ) {
+                        if ( value[j] != value[0] ) {
+                            reader_p->torn++;
+                            break;
+                        }
+                    }
+                }
+            }
+            if ( rc == SOLCLIENT_OK ) {
+                reader_p->hits++;
+            } else if ( rc == SOLCLIENT_IN_PROGRESS ) {
+                reader_p->pending++;
+            } else {
+                reader_p->misses++;
+            }
+            if ( ++topic == numReadTopics ) {
+                topic = 0;
+            }
+        }
+        reader_p->reads += LVC_READ_BATCH;
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * lvc_runReaders
+ *
+ * Run the readers for a number of seconds, reporting once a second unless
+ * quiet, and return the total reads.
+ *****************************************************************************/
+static          solClient_uint64_t
+lvc_runReaders ( lvcReader_t * readers_p, int numReaders, int useGetMsg, int seconds, int quiet )
+{
+    solClient_uint64_t reads;
+    solClient_uint64_t lastReads = 0;
+    int             numStarted;
+    int             elapsed;
+    int             i;
+
+    running = 1;
+    for ( numStarted = 0; numStarted < numReaders; numStarted++ ) {
+        memset ( &readers_p[numStarted], 0, sizeof ( lvcReader_t ) );
+        readers_p[numStarted].index = numStarted;
+        readers_p[numStarted].useGetMsg = useGetMsg;
+        if ( threadCreate ( &readers_p[numStarted].thread, lvc_readerThread, &readers_p[numStarted] ) != 0 ) {
+            printf ( "Could not start reader %d\n", numStarted );
+            break;
+        }
+    }
+
+    for ( elapsed = 1; elapsed <= seconds; elapsed++ ) {
+        SLEEP ( 1 );
+        if ( quiet ) {
+            continue;
+        }
+        reads = 0;
+        for ( i = 0; i < numStarted; i++ ) {
+            reads += readers_p[i].reads;
+        }
+        printf ( "%3d s: %.2f M reads/s, %u topics cached\n", elapsed,
+                 ( double ) ( reads - lastReads ) / 1000000.0, lvc.numTopics );
+        lastReads = reads;
+    }
+
+    running = 0;
+    reads = 0;
+    for ( i = 0; i < numStarted; i++ ) {
+        threadJoin ( readers_p[i].thread );
+        reads += readers_p[i].reads;
+    }
+    return reads;
+}
+
+
+/*****************************************************************************
+ * lvc_printReaders
+ *****************************************************************************/
+static void
+lvc_printReaders ( lvcReader_t * readers_p, int numReaders )
+{
+    lvcReader_t     totals;
+    int             i;
+
+    memset ( &totals, 0, sizeof ( totals ) );
+    for ( i = 0; i < numReaders; i++ ) {
+        totals.reads += readers_p[i].reads;
+        totals.hits += readers_p[i].hits;
+        totals.pending += readers_p[i].pending;
+        totals.misses += readers_p[i].misses;
+        totals.torn += readers_p[i].torn;
+    }
+    printf ( "Reads: %llu, hits %llu, cache request outstanding %llu, misses %llu, torn %llu\n",
+             ( unsigned long long ) totals.reads, ( unsigned long long ) totals.hits,
+             ( unsigned long long ) totals.pending, ( unsigned long long ) totals.misses,
+             ( unsigned long long ) totals.torn );
+}
+
+
+/*****************************************************************************
+ * lvc_writerThread
+ *
+ * The bench mode's updates: set every byte of a topic's value to a new
+ * counter and update the cache, round robin over the topics.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+lvc_writerThread ( void *arg_p )
+{
+    solClient_opaqueMsg_pt *msgs_p = ( solClient_opaqueMsg_pt * ) arg_p;
+    unsigned char   value[LVC_BENCH_VALUE_SIZE];
+    unsigned char   counter = 0;
+    int             topic = 0;
+
+    while ( running ) {
+        memset ( value, ++counter, sizeof ( value ) );
+        solClient_msg_setBinaryAttachment ( msgs_p[topic], value, sizeof ( value ) );
+        common_lvc_update ( &lvc, msgs_p[topic] );
+        if ( ++topic == numReadTopics ) {
+            topic = 0;
+        }
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * lvc_bench
+ *****************************************************************************/
+static int
+lvc_bench ( int numTopics, int numReaders, int seconds )
+{
+    solClient_opaqueMsg_pt *msgs_p;
+    solClient_destination_t destination;
+    lvcReader_t    *readers_p;
+    THREAD_T        writer;
+    solClient_uint64_t updates;
+    solClient_uint64_t reads;
+    unsigned char   value[LVC_BENCH_VALUE_SIZE];
+    int             useGetMsg;
+    int             result = 0;
+    int             i;
+
+    msgs_p = ( solClient_opaqueMsg_pt * ) calloc ( numTopics, sizeof ( solClient_opaqueMsg_pt ) );
+    readTopics = ( char ** ) calloc ( numTopics, sizeof ( char * ) );
+    readers_p = ( lvcReader_t * ) alignedAlloc ( numReaders * sizeof ( lvcReader_t ), COMMON_CACHE_LINE_SIZE );
+    if ( msgs_p == NULL || readTopics == NULL || readers_p == NULL ||
+         common_lvc_init ( &lvc, ( unsigned int ) numTopics, LVC_VALUE_SIZE, NULL ) != SOLCLIENT_OK ) {
+        printf ( "Could not allocate the benchmark\n" );
+        free ( msgs_p );
+        free ( readTopics );
+        alignedFree ( readers_p );
+        return -1;
+    }
+
+    /* One message per topic, all filled before the readers start. */
+    memset ( value, 0, sizeof ( value ) );
+    numReadTopics = numTopics;
+    for ( i = 0; i < numTopics; i++ ) {
+        readTopics[i] = ( char * ) malloc ( 64 );
+        if ( readTopics[i] == NULL || solClient_msg_alloc ( &msgs_p[i] ) != SOLCLIENT_OK ) {
+            printf ( "Could not allocate the benchmark\n" );
+            result = -1;
+            goto cleanup;
+        }
+        sprintf ( readTopics[i], "bench/lvc/%d/%d", i % 100, i );
+        destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+        destination.dest = readTopics[i];
+        solClient_msg_setDestination ( msgs_p[i], &destination, sizeof ( destination ) );
+        solClient_msg_setBinaryAttachment ( msgs_p[i], value, sizeof ( value ) );
+        common_lvc_update ( &lvc, msgs_p[i] );
+    }
+
+    printf ( "%d topics of %d bytes, %d readers, %d s per run, one writer updating continuously\n",
+             numTopics, LVC_BENCH_VALUE_SIZE, numReaders, seconds );
+    printf ( "%-10s %14s %14s %14s\n", "Read", "M reads/s", "ns/read", "M updates/s" );
+    for ( useGetMsg = 0; useGetMsg <= 1; useGetMsg++ ) {
+        running = 1;
+        updates = lvc.stats.updates;
+        if ( threadCreate ( &writer, lvc_writerThread, msgs_p ) != 0 ) {
+            printf ( "Could not start the writer\n" );
+            result = -1;
+            goto cleanup;
+        }
+        reads = lvc_runReaders ( readers_p, numReaders, useGetMsg, seconds, 1 );
+        threadJoin ( writer );
+        updates = lvc.stats.updates - updates;
+        printf ( "%-10s %14.2f %14.1f %14.2f\n", useGetMsg ? "getMsg" : "read",
+                 ( double ) reads / seconds / 1000000.0,
+                 reads > 0 ? ( double ) seconds * 1e9 * numReaders / ( double ) reads : 0.0,
+                 ( double ) updates / seconds / 1000000.0 );
+        if ( !useGetMsg ) {
+            lvc_printReaders ( readers_p, numReaders );
+            for ( i = 0; i < numReaders; i++ ) {
+                if ( readers_p[i].torn > 0 || readers_p[i].misses > 0 ) {
+                    printf ( "Last-value cache check FAILED\n" );
+                    result = -1;
+                    break;
+                }
+            }
+        }
+    }
+    printf ( "\n" );
+    common_lvc_printStats ( &lvc );
+
+  cleanup:
+    for ( i = 0; i < numTopics; i++ ) {
+        if ( msgs_p[i] != NULL ) {
+            solClient_msg_free ( &msgs_p[i] );
+        }
+        free ( readTopics[i] );
+    }
+    common_lvc_destroy ( &lvc );
+    free ( msgs_p );
+    free ( readTopics );
+    alignedFree ( readers_p );
+    return result;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             seconds = LVC_DEFAULT_SECONDS;
+    int             numReaders = LVC_DEFAULT_READERS;
+    int             benchTopics = LVC_DEFAULT_BENCH_TOPICS;
+    int             bench = 0;
+    int             result = 0;
+    char           *topics[LVC_MAX_READ_TOPICS];
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    /* Cache Session */
+    solClient_opaqueCacheSession_pt cacheSession_p = NULL;
+    const char     *cacheProps[3];
+
+    lvcReader_t    *readers_p = NULL;
+
+    printf ( "\nLastValueCache.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               0,                      /* required parameters; --cu unless benchmarking */
+                               ( HOST_PARAM_MASK |
+                                USER_PARAM_MASK |
+                                DEST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                CACHE_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[SECONDS] [READERS] [TOPIC...]   Cache the messages received on the subscription\n"
+            "\t                          (--topic, default " COMMON_MY_SAMPLE_TOPIC "/>) for SECONDS\n"
+            "\t                          (default 10), while READERS threads (default 4) read\n"
+            "\t                          the TOPICs (default " COMMON_MY_SAMPLE_TOPIC ").\n"
+            "\tbench [TOPICS] [READERS] [SECONDS]   Benchmark the cache without connecting\n"
+            "\t                          (default 10000 topics, 4 readers, 10 s).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc && strcmp ( argv[optind], "bench" ) == 0 ) {
+        bench = 1;
+        optind++;
+        if ( optind < argc ) {
+            benchTopics = atoi ( argv[optind++] );
+        }
+        if ( optind < argc ) {
+            numReaders = atoi ( argv[optind++] );
+        }
+        if ( optind < argc ) {
+            seconds = atoi ( argv[optind++] );
+        }
+    } else {
+        if ( optind < argc ) {
+            seconds = atoi ( argv[optind++] );
+        }
+        if ( optind < argc ) {
+            numReaders = atoi ( argv[optind++] );
+        }
+        for ( numReadTopics = 0; optind < argc && numReadTopics < LVC_MAX_READ_TOPICS; numReadTopics++ ) {
+            topics[numReadTopics] = argv[optind++];
+        }
+        if ( numReadTopics == 0 ) {
+            topics[numReadTopics++] = COMMON_MY_SAMPLE_TOPIC;
+        }
+        readTopics = topics;
+    }
+    if ( seconds < 1 || numReaders < 1 || numReaders > LVC_MAX_READERS ||
+         benchTopics < 1 || benchTopics > LVC_MAX_TOPICS ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    if ( !bench && commandOpts.username[0] == '\0' && !commandOpts.useGSS ) {
+        printf ( "Missing required parameter '--cu'\n" );
+        exit(1);
+    }
+    if ( commandOpts.destinationName[0] == '\0' ) {
+        strcpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC "/>" );
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    if ( bench ) {
+        result = lvc_bench ( benchTopics, numReaders, seconds ) == 0 ? 0 : 1;
+        goto cleanup;
+    }
+
+    /*************************************************************************
+     * Create a Context, connect a Session, create a Cache Session and subscribe
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 lvc_messageReceiveCallback,
+                                                 common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    if ( commandOpts.cacheName[0] != '\0' ) {
+        cacheProps[0] = SOLCLIENT_CACHESESSION_PROP_CACHE_NAME;
+        cacheProps[1] = commandOpts.cacheName;
+        cacheProps[2] = NULL;
+        if ( ( rc = solClient_session_createCacheSession ( cacheProps, session_p, &cacheSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_createCacheSession()" );
+            goto sessionConnected;
+        }
+    }
+
+    if ( common_lvc_init ( &lvc, LVC_MAX_TOPICS, LVC_VALUE_SIZE, cacheSession_p ) != SOLCLIENT_OK ) {
+        goto cacheSessionCreated;
+    }
+
+    if ( ( rc = solClient_session_topicSubscribeExt ( session_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                      commandOpts.destinationName ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicSubscribeExt()" );
+        goto lvcCreated;
+    }
+
+    /*************************************************************************
+     * Read until the time is up
+     *************************************************************************/
+
+    if ( ( readers_p = ( lvcReader_t * ) alignedAlloc ( numReaders * sizeof ( lvcReader_t ),
+                                                        COMMON_CACHE_LINE_SIZE ) ) != NULL ) {
+        printf ( "Caching '%s', %d readers reading %d topics for %d s\n",
+                 commandOpts.destinationName, numReaders, numReadTopics, seconds );
+        lvc_runReaders ( readers_p, numReaders, 0, seconds, 0 );
+        printf ( "\n" );
+        lvc_printReaders ( readers_p, numReaders );
+        alignedFree ( readers_p );
+    }
+
+    if ( ( rc = solClient_session_topicUnsubscribeExt ( session_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                        commandOpts.destinationName ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicUnsubscribeExt()" );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  lvcCreated:
+    /* Outstanding cache requests complete when the Cache Session is destroyed, before the cache is. */
+    if ( cacheSession_p != NULL && ( rc = solClient_cacheSession_destroy ( &cacheSession_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cacheSession_destroy()" );
+    }
+    common_lvc_printStats ( &lvc );
+
+  cacheSessionCreated:
+    if ( cacheSession_p != NULL && ( rc = solClient_cacheSession_destroy ( &cacheSession_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cacheSession_destroy()" );
+    }
+
+  sessionConnected:
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+    if ( lvc.entries_p != NULL ) {
+        common_lvc_destroy ( &lvc );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    return result;
+
+}
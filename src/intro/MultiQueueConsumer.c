@@ -0,0 +1,565 @@
+
+/** @example Intro/MultiQueueConsumer.c
+ */
+
+/*
+ * This sample consumes from many Queues at once, spreading the Flows over
+ * several Sessions (each with its own Context thread) and processing
+ * messages on a pool of worker threads.
+ *
+ * M Flows are bound round-robin to the given Queues, so several Flows may
+ * bind to the same non-exclusive Queue, and are spread round-robin over K
+ * Sessions. The Flow receive callback, which runs on the Context thread,
+ * only takes the message and puts it in the Flow's ring. Each Flow is owned
+ * by one worker thread at a time, which processes, acknowledges and frees
+ * the messages in its ring, so messages of a Flow are processed in order.
+ *
+ * The Flow's maximum unacknowledged messages is set below the ring size, so
+ * the appliance stops delivering to a Flow whose worker falls behind instead
+ * of the ring overflowing.
+ *
+ * Once a second the main thread prints the per-Flow and total receive
+ * statistics (solClient_flow_getRxStats()) and the worker backlogs, and
+ * rebalances: when the most backlogged worker owns several Flows and
+ * another worker is idle, the hottest Flow is handed to the idle worker.
+ *
+ * The Queues must already exist.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "getopt.h"
+
+#define MQ_MAX_QUEUES           64
+#define MQ_MAX_FLOWS            256
+#define MQ_MAX_SESSIONS         32
+#define MQ_MAX_WORKERS          64
+
+#define MQ_DEFAULT_SESSIONS     4
+#define MQ_DEFAULT_WORKERS      4
+#define MQ_DEFAULT_SECONDS      10
+
+/* Ring size per Flow (a power of two), and the Flow's unacknowledged limit below it. */
+#define MQ_RING_SIZE            1024
+#define MQ_MAX_UNACKED          "1000"
+
+/* Messages a worker processes from one Flow before moving to its next Flow. */
+#define MQ_DRAIN_BATCH          64
+
+/* A worker with at least this backlog may give a Flow to an idle worker. */
+#define MQ_REBALANCE_MIN_BACKLOG 64
+
+/*
+ * A Flow and its ring. head is written only by the Context thread and tail
+ * only by the owning worker, so they are kept on separate cache lines.
+ */
+typedef struct mqFlow
+{
+    volatile unsigned int head;
+    char            pad1[COMMON_CACHE_LINE_SIZE - sizeof ( unsigned int )];
+    volatile unsigned int tail;
+    char            pad2[COMMON_CACHE_LINE_SIZE - sizeof ( unsigned int )];
+    solClient_opaqueMsg_pt ring[MQ_RING_SIZE];
+
+    solClient_opaqueFlow_pt flow_p;
+    const char     *queue_p;
+    int             index;
+    int             sessionIndex;
+    volatile int    owner;              /* Worker draining the ring. */
+    volatile int    nextOwner;          /* Set by the rebalancer; the owner hands over. */
+    UINT64          processed;          /* Written by the owner. */
+    UINT64          lastProcessed;      /* Written by the main thread. */
+    UINT64          overflows;          /* Written by the Context thread. */
+} mqFlow_t, *mqFlow_pt;
+
+typedef struct mqWorker
+{
+    THREAD_T        thread;
+    int             index;
+} mqWorker_t;
+
+static mqFlow_pt flows[MQ_MAX_FLOWS];
+static int      numFlows = 0;
+static mqWorker_t workers[MQ_MAX_WORKERS];
+static int      numWorkers = MQ_DEFAULT_WORKERS;
+static int      workUs = 0;
+static volatile int running = 1;
+
+
+/*****************************************************************************
+ * mq_flowRxCallback
+ *
+ * Runs on the Context thread: keep the message and queue it for the worker.
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+mq_flowRxCallback ( solClient_opaqueFlow_pt opaqueFlow_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    mqFlow_pt       flow_p = ( mqFlow_pt ) user_p;
+    unsigned int    head = flow_p->head;
+
+    if ( head - flow_p->tail >= MQ_RING_SIZE ) {
+        /* Cannot happen while MQ_MAX_UNACKED < MQ_RING_SIZE; the message is redelivered on rebind. */
+        flow_p->overflows++;
+        return SOLCLIENT_CALLBACK_OK;
+    }
+    flow_p->ring[head & ( MQ_RING_SIZE - 1 )] = msg_p;
+    MEMORY_BARRIER (  );
+    flow_p->head = head + 1;
+    return SOLCLIENT_CALLBACK_TAKE_MSG;
+}
+
+
+/*****************************************************************************
+ * mq_processMsg
+ *
+ * Simulate the application's work on a message.
+ *****************************************************************************/
+static void
+mq_processMsg ( solClient_opaqueMsg_pt msg_p )
+{
+    UINT64          endUs;
+
+    if ( workUs > 0 ) {
+        endUs = getTimeInUs (  ) + ( UINT64 ) workUs;
+        while ( getTimeInUs (  ) < endUs ) {
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * mq_workerThread
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+mq_workerThread ( void *arg_p )
+{
+    mqWorker_t     *worker_p = ( mqWorker_t * ) arg_p;
+    mqFlow_pt       flow_p;
+    solClient_opaqueMsg_pt msg_p;
+    solClient_msgId_t msgId;
+    unsigned int    tail;
+    int             drained;
+    int             didWork;
+    int             i;
+
+    while ( running ) {
+        didWork = 0;
+        for ( i = 0; i < numFlows; i++ ) {
+            flow_p = flows[i];
+            if ( flow_p->owner != worker_p->index ) {
+                continue;
+            }
+            if ( flow_p->nextOwner != worker_p->index ) {
+                /* Hand over between batches, so one worker drains the ring at a time. */
+                MEMORY_BARRIER (  );
+                flow_p->owner = flow_p->nextOwner;
+                continue;
+            }
+
+            tail = flow_p->tail;
+            for ( drained = 0; drained < MQ_DRAIN_BATCH && tail != flow_p->head; drained++ ) {
+                MEMORY_BARRIER (  );
+                msg_p = flow_p->ring[tail & ( MQ_RING_SIZE - 1 )];
+                mq_processMsg ( msg_p );
+                if ( solClient_msg_getMsgId ( msg_p, &msgId ) == SOLCLIENT_OK ) {
+                    solClient_flow_sendAck ( flow_p->flow_p, msgId );
+                }
+                solClient_msg_free ( &msg_p );
+                tail++;
+                MEMORY_BARRIER (  );
+                flow_p->tail = tail;
+            }
+            flow_p->processed += drained;
+            didWork |= ( drained != 0 );
+        }
+        if ( !didWork ) {
+            sleepInUs ( 100 );
+        }
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * mq_reportAndRebalance
+ *
+ * Print the interval statistics, then move the hottest Flow of the most
+ * backlogged worker to an idle worker if there is one.
+ *****************************************************************************/
+static void
+mq_reportAndRebalance ( double seconds, int *migrations_p )
+{
+    solClient_stats_t rxStats[SOLCLIENT_STATS_RX_NUM_STATS];
+    solClient_stats_t totals[SOLCLIENT_STATS_RX_NUM_STATS];
+    unsigned int    workerBacklog[MQ_MAX_WORKERS];
+    int             workerFlows[MQ_MAX_WORKERS];
+    unsigned int    backlog;
+    UINT64          processed;
+    UINT64          delta;
+    UINT64          totalDelta = 0;
+    int             hotWorker = 0;
+    int             idleWorker = -1;
+    int             hotFlow = -1;
+    unsigned int    hotFlowBacklog = 0;
+    int             i;
+    int             s;
+
+    memset ( totals, 0, sizeof ( totals ) );
+    memset ( workerBacklog, 0, sizeof ( workerBacklog ) );
+    memset ( workerFlows, 0, sizeof ( workerFlows ) );
+
+    printf ( "%4s %-24s %4s %6s %10s %10s %8s %8s %10s\n",
+             "Flow", "Queue", "Sess", "Worker", "Rx msgs", "Acked", "Backlog", "Msgs/s", "Overflows" );
+    for ( i = 0; i < numFlows; i++ ) {
+        if ( solClient_flow_getRxStats ( flows[i]->flow_p, rxStats, SOLCLIENT_STATS_RX_NUM_STATS ) != SOLCLIENT_OK ) {
+            memset ( rxStats, 0, sizeof ( rxStats ) );
+        }
+        for ( s = 0; s < SOLCLIENT_STATS_RX_NUM_STATS; s++ ) {
+            totals[s] += rxStats[s];
+        }
+        backlog = flows[i]->head - flows[i]->tail;
+        processed = flows[i]->processed;
+        delta = processed - flows[i]->lastProcessed;
+        flows[i]->lastProcessed = processed;
+        totalDelta += delta;
+
+        workerBacklog[flows[i]->nextOwner] += backlog;
+        workerFlows[flows[i]->nextOwner]++;
+
+        printf ( "%4d %-24.24s %4d %6d %10llu %10llu %8u %8.0f %10llu\n",
+                 i, flows[i]->queue_p, flows[i]->sessionIndex, flows[i]->nextOwner,
+                 ( unsigned long long ) ( rxStats[SOLCLIENT_STATS_RX_PERSISTENT_MSGS] +
+                                          rxStats[SOLCLIENT_STATS_RX_NONPERSISTENT_MSGS] ),
+                 ( unsigned long long ) rxStats[SOLCLIENT_STATS_RX_ACKED],
+                 backlog, ( double ) delta / seconds, ( unsigned long long ) flows[i]->overflows );
+    }
+    printf ( "%4s %-24s %4s %6s %10llu %10llu %8s %8.0f\n", "", "total", "", "",
+             ( unsigned long long ) ( totals[SOLCLIENT_STATS_RX_PERSISTENT_MSGS] +
+                                      totals[SOLCLIENT_STATS_RX_NONPERSISTENT_MSGS] ),
+             ( unsigned long long ) totals[SOLCLIENT_STATS_RX_ACKED], "", ( double ) totalDelta / seconds );
+
+    /*
+     * Rebalance. Only Flows whose hand-over has completed (owner ==
+     * nextOwner) are candidates, so a Flow moves at most once at a time.
+     */
+    for ( i = 1; i < numWorkers; i++ ) {
+        if ( workerBacklog[i] > workerBacklog[hotWorker] ) {
+            hotWorker = i;
+        }
+    }
+    for ( i = 0; i < numWorkers; i++ ) {
+        if ( i != hotWorker && workerBacklog[i] == 0 &&
+             ( idleWorker < 0 || workerFlows[i] < workerFlows[idleWorker] ) ) {
+            idleWorker = i;
+        }
+    }
+    if ( idleWorker < 0 || workerFlows[hotWorker] < 2 || workerBacklog[hotWorker] < MQ_REBALANCE_MIN_BACKLOG ) {
+        return;
+    }
+    for ( i = 0; i < numFlows; i++ ) {
+        backlog = flows[i]->head - flows[i]->tail;
+        if ( flows[i]->owner == hotWorker && flows[i]->nextOwner == hotWorker && backlog >= hotFlowBacklog ) {
+            hotFlow = i;
+            hotFlowBacklog = backlog;
+        }
+    }
+    if ( hotFlow >= 0 ) {
+        printf ( "Rebalance: flow %d (backlog %u) from worker %d to idle worker %d\n",
+                 hotFlow, hotFlowBacklog, hotWorker, idleWorker );
+        flows[hotFlow]->nextOwner = idleWorker;
+        ( *migrations_p )++;
+    }
+}
+
+
+/*****************************************************************************
+ * mq_parseList
+ *
+ * Split a comma-separated list in place.
+ *****************************************************************************/
+static int
+mq_parseList ( char *list_p, const char **items_p, int maxItems )
+{
+    int             numItems = 0;
+    char           *next_p;
+
+    while ( list_p != NULL && *list_p != ( char ) 0 && numItems < maxItems ) {
+        if ( ( next_p = strchr ( list_p, ',' ) ) != NULL ) {
+            *next_p++ = ( char ) 0;
+        }
+        items_p[numItems++] = list_p;
+        list_p = next_p;
+    }
+    return numItems;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    const char     *queues_p[MQ_MAX_QUEUES];
+    int             numQueues;
+    int             numSessions = MQ_DEFAULT_SESSIONS;
+    int             seconds = MQ_DEFAULT_SECONDS;
+    int             numPositional = 0;
+
+    /* Contexts and Sessions, one Session per Context */
+    solClient_opaqueContext_pt contexts_p[MQ_MAX_SESSIONS];
+    solClient_opaqueSession_pt sessions_p[MQ_MAX_SESSIONS];
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+    int             numConnected = 0;
+
+    /* Flows */
+    solClient_flow_createFuncInfo_t flowFuncInfo = SOLCLIENT_FLOW_CREATEFUNC_INITIALIZER;
+    const char     *props[20] = {0, };
+    int             propIndex;
+    int             numBound = 0;
+
+    int             numStarted = 0;
+    int             migrations = 0;
+    UINT64          lastReportUs;
+    UINT64          nowUs;
+    UINT64          endUs;
+    int             i;
+
+    printf ( "\nMultiQueueConsumer.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK |
+                                POOL_TUNING_MASK |
+                                PROFILE_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\tQUEUE[,QUEUE...] [FLOWS] [SESSIONS] [WORKERS] [SECONDS] [WORK_US]\n"
+            "\t    FLOWS     Flows to bind, round-robin over the Queues (default: one per Queue).\n"
+            "\t    SESSIONS  Sessions (each with its own Context thread) to spread the Flows over (default 4).\n"
+            "\t    WORKERS   Worker threads processing messages (default 4).\n"
+            "\t    SECONDS   Run time (default 10).\n"
+            "\t    WORK_US   Simulated processing time per message in microseconds (default 0).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind >= argc ) {
+        printf ( "Missing QUEUE list\n" );
+        exit(1);
+    }
+    numQueues = mq_parseList ( argv[optind++], queues_p, MQ_MAX_QUEUES );
+    numFlows = numQueues;
+    for ( ; optind < argc && numPositional < 5; optind++ ) {
+        if ( atoi ( argv[optind] ) < 0 ) {
+            printf ( "Invalid argument '%s'\n", argv[optind] );
+            exit(1);
+        }
+        switch ( numPositional++ ) {
+            case 0:
+                numFlows = atoi ( argv[optind] );
+                break;
+            case 1:
+                numSessions = atoi ( argv[optind] );
+                break;
+            case 2:
+                numWorkers = atoi ( argv[optind] );
+                break;
+            case 3:
+                seconds = atoi ( argv[optind] );
+                break;
+            default:
+                workUs = atoi ( argv[optind] );
+                break;
+        }
+    }
+    if ( numQueues == 0 || numFlows < 1 || numFlows > MQ_MAX_FLOWS || numSessions < 1 || numSessions > MQ_MAX_SESSIONS ||
+         numWorkers < 1 || numWorkers > MQ_MAX_WORKERS || seconds < 1 ) {
+        printf ( "Invalid arguments; at most %d flows, %d sessions and %d workers\n", MQ_MAX_FLOWS, MQ_MAX_SESSIONS, MQ_MAX_WORKERS );
+        exit(1);
+    }
+    if ( numSessions > numFlows ) {
+        numSessions = numFlows;
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create the Contexts and connect a Session in each
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating %d solClient contexts and sessions", numSessions );
+
+    for ( numConnected = 0; numConnected < numSessions; numConnected++ ) {
+        if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                               &contexts_p[numConnected], &contextFuncInfo,
+                                               sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_context_create()" );
+            goto sessionsConnected;
+        }
+        if ( ( rc = common_createAndConnectSession ( contexts_p[numConnected],
+                                                     &sessions_p[numConnected],
+                                                     common_messageReceivePerfCallback,
+                                                     common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "common_createAndConnectSession()" );
+            solClient_context_destroy ( &contexts_p[numConnected] );
+            goto sessionsConnected;
+        }
+    }
+
+    /*************************************************************************
+     * Bind the Flows
+     *************************************************************************/
+
+    for ( numBound = 0; numBound < numFlows; numBound++ ) {
+        if ( ( flows[numBound] = ( mqFlow_pt ) alignedAlloc ( sizeof ( mqFlow_t ), COMMON_CACHE_LINE_SIZE ) ) == NULL ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate flow %d", numBound );
+            goto flowsBound;
+        }
+        memset ( flows[numBound], 0, sizeof ( mqFlow_t ) );
+        flows[numBound]->index = numBound;
+        flows[numBound]->queue_p = queues_p[numBound % numQueues];
+        flows[numBound]->sessionIndex = numBound % numSessions;
+        flows[numBound]->owner = flows[numBound]->nextOwner = numBound % numWorkers;
+
+        flowFuncInfo.rxMsgInfo.callback_p = mq_flowRxCallback;
+        flowFuncInfo.rxMsgInfo.user_p = flows[numBound];
+        flowFuncInfo.eventInfo.callback_p = common_flowEventCallback;
+        flowFuncInfo.eventInfo.user_p = NULL;
+
+        propIndex = 0;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_BLOCKING;
+        props[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_ID;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_QUEUE;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_NAME;
+        props[propIndex++] = flows[numBound]->queue_p;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_ACKMODE;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_ACKMODE_CLIENT;
+        props[propIndex++] = SOLCLIENT_FLOW_PROP_MAX_UNACKED_MESSAGES;
+        props[propIndex++] = MQ_MAX_UNACKED;
+        props[propIndex] = NULL;
+
+        if ( ( rc = solClient_session_createFlow ( ( char ** ) props, sessions_p[flows[numBound]->sessionIndex],
+                                                   &flows[numBound]->flow_p, &flowFuncInfo,
+                                                   sizeof ( flowFuncInfo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_createFlow()" );
+            alignedFree ( flows[numBound] );
+            goto flowsBound;
+        }
+    }
+
+    /*************************************************************************
+     * Start the workers and report once a second
+     *************************************************************************/
+
+    for ( numStarted = 0; numStarted < numWorkers; numStarted++ ) {
+        workers[numStarted].index = numStarted;
+        if ( threadCreate ( &workers[numStarted].thread, mq_workerThread, &workers[numStarted] ) != 0 ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not start worker %d", numStarted );
+            goto workersStarted;
+        }
+    }
+
+    printf ( "Consuming from %d queues with %d flows over %d sessions, %d workers, for %d s\n\n",
+             numQueues, numFlows, numSessions, numWorkers, seconds );
+
+    lastReportUs = getTimeInUs (  );
+    endUs = lastReportUs + ( UINT64 ) seconds * 1000000;
+    while ( ( nowUs = getTimeInUs (  ) ) < endUs ) {
+        sleepInUs ( 1000000 );
+        nowUs = getTimeInUs (  );
+        mq_reportAndRebalance ( ( double ) ( nowUs - lastReportUs ) / 1000000.0, &migrations );
+        printf ( "\n" );
+        lastReportUs = nowUs;
+    }
+    printf ( "%d flow migrations\n", migrations );
+
+    /*
+     * Stop delivery, then let the workers process and acknowledge what is
+     * already queued before stopping them.
+     */
+    for ( i = 0; i < numBound; i++ ) {
+        solClient_flow_stop ( flows[i]->flow_p );
+    }
+    endUs = getTimeInUs (  ) + 2000000;
+    for ( i = 0; i < numBound && getTimeInUs (  ) < endUs; ) {
+        if ( flows[i]->head == flows[i]->tail ) {
+            i++;
+        } else {
+            sleepInUs ( 1000 );
+        }
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  workersStarted:
+    running = 0;
+    for ( i = 0; i < numStarted; i++ ) {
+        threadJoin ( workers[i].thread );
+    }
+
+  flowsBound:
+    for ( i = 0; i < numBound; i++ ) {
+        if ( ( rc = solClient_flow_destroy ( &flows[i]->flow_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_flow_destroy()" );
+        }
+        /* Unacknowledged messages left in the ring are redelivered to the next consumer. */
+        while ( flows[i]->tail != flows[i]->head ) {
+            solClient_msg_free ( &flows[i]->ring[flows[i]->tail++ & ( MQ_RING_SIZE - 1 )] );
+        }
+        alignedFree ( flows[i] );
+    }
+
+  sessionsConnected:
+    for ( i = 0; i < numConnected; i++ ) {
+        if ( ( rc = solClient_session_disconnect ( sessions_p[i] ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_disconnect()" );
+        }
+        if ( ( rc = solClient_session_destroy ( &sessions_p[i] ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_destroy()" );
+        }
+        if ( ( rc = solClient_context_destroy ( &contexts_p[i] ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_context_destroy()" );
+        }
+    }
+
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    return 0;
+
+}
@@ -0,0 +1,945 @@
+
+/** @example Intro/PerfPublisher.c
+ */
+
+/*
+ * This sample measures the cost of publishing messages with different
+ * publishing techniques. Each test publishes a fixed number of messages as
+ * fast as possible and reports the message rate, the byte rate and the
+ * process CPU time spent per message (application and Context threads).
+ *
+ * Tests:
+ *
+ *    payload: Publishes payloads from 100 B to 1 MB twice: once copying the
+ *             payload into the message with solClient_msg_setBinaryAttachment()
+ *             (common_publishPayload()), and once attaching a buffer from a
+ *             preallocated, cache-line aligned buffer pool by reference with
+ *             solClient_msg_setBinaryAttachmentPtr() (common_publishBuffer()).
+ *             For Guaranteed messages the pooled buffers are recycled from the
+ *             acknowledgement event, so the pool also bounds the number of
+ *             messages in flight.
+ *
+ *   profiles: Publishes a fixed payload size (1 KB by default) once with the
+ *             API defaults and once with each --profile tuning profile. The
+ *             API is cleaned up and re-initialized between runs, since the
+ *             global data buffer properties only take effect in
+ *             solClient_initialize(). Reports the message rate and the
+ *             resident set size after connecting and after publishing. As
+ *             all runs share one process, heap memory released by earlier
+ *             runs may be reused by later ones; run a single profile with
+ *             --profile for an isolated RSS figure.
+ *
+ *   metadata: Publishes a fixed payload size (1 KB by default) on Sessions
+ *             generating no metadata, each single metadata field (send
+ *             timestamp, sender ID, sequence number) and all three. The
+ *             variants are run round-robin several times and the best run of
+ *             each is kept, then the per-message cost of each field is
+ *             reported in ns relative to the no-metadata baseline.
+ *
+ *        zip: Publishes a mix of XML text, incompressible (random) and small
+ *             payloads through a zip publisher (common_zipPublisher_*) that
+ *             is uncompressed, compressed at level 9, and adaptive. The
+ *             compressed Session subscribes to the topic so the receive
+ *             compression ratio is reported as well as the transmit one.
+ *
+ * nonblocking: Publishes a fixed payload size (1 KB by default) once on a
+ *             blocking Session and once through a non-blocking send queue
+ *             (common_sendQueue_*) with each ring-full policy, or only the
+ *             one given with --sendq. Reports the rate of send calls, the
+ *             rate of messages actually sent (for the send queues, timed
+ *             until the ring has drained), the time each send call held
+ *             the publishing thread (median, 99th percentile and worst),
+ *             the deepest the ring got and the messages dropped.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "pool.h"
+#include "zip.h"
+#include "sendqueue.h"
+#include "getopt.h"
+
+/*
+ * The number of messages sent per payload size is capped so that no single
+ * run publishes more than this many bytes.
+ */
+#define PERF_MAX_BYTES_PER_RUN     ( 256 * 1024 * 1024 )
+
+/* The memory reserved for each payload buffer pool. */
+#define PERF_POOL_BYTES            ( 64 * 1024 * 1024 )
+#define PERF_POOL_MAX_BUFS         256
+
+#define PERF_DEFAULT_NUM_MSGS      10000
+#define PERF_DEFAULT_PAYLOAD_BYTES 1024
+
+/* Rounds of the metadata test; the fastest run of each variant is kept. */
+#define PERF_METADATA_ROUNDS       3
+
+/* The longest the nonblocking test waits for a send queue to empty. */
+#define PERF_SENDQ_DRAIN_MS        10000
+
+/*
+ * The longest the zero-copy test waits for an acknowledgement to return a
+ * buffer, so a Session that went down does not hang the run.
+ */
+#define PERF_ZERO_COPY_ACK_MS      10000
+
+/* Payloads of the zip test. */
+#define PERF_ZIP_LARGE_BYTES       4096
+#define PERF_ZIP_SMALL_BYTES       100
+
+static const solClient_uint32_t payloadSizes[] = { 100, 1024, 10 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+
+/*
+ * Measurements taken for one run.
+ */
+typedef struct perfResult
+{
+    int             numMsgs;
+    solClient_uint32_t payloadSize;
+    UINT64          elapsedUs;
+    UINT64          cpuUs;
+} perfResult_t;
+
+
+/*****************************************************************************
+ * perf_startRun / perf_endRun
+ *
+ * Take the wall clock and CPU readings around a run.
+ *****************************************************************************/
+static void
+perf_startRun ( perfResult_t * result_p, UINT64 * cpuStart_p )
+{
+    UINT64          userUs;
+    UINT64          systemUs;
+
+    getCpuTimesInUs ( &userUs, &systemUs );
+    *cpuStart_p = userUs + systemUs;
+    result_p->elapsedUs = getTimeInUs (  );
+}
+
+static void
+perf_endRun ( perfResult_t * result_p, UINT64 cpuStart )
+{
+    UINT64          userUs;
+    UINT64          systemUs;
+
+    result_p->elapsedUs = getTimeInUs (  ) - result_p->elapsedUs;
+    getCpuTimesInUs ( &userUs, &systemUs );
+    result_p->cpuUs = userUs + systemUs - cpuStart;
+    if ( result_p->elapsedUs == 0 ) {
+        result_p->elapsedUs = 1;
+    }
+}
+
+
+/*****************************************************************************
+ * perf_printResult
+ *****************************************************************************/
+static void
+perf_printResultHeader ( void )
+{
+    printf ( "%-12s %9s %8s %12s %10s %12s\n", "Test", "Payload", "Msgs", "Msgs/s", "MB/s", "CPU us/msg" );
+}
+
+static void
+perf_printResult ( const char *name_p, perfResult_t * result_p )
+{
+    double          seconds = ( double ) result_p->elapsedUs / 1000000.0;
+
+    printf ( "%-12s %9u %8d %12.0f %10.1f %12.2f\n",
+             name_p,
+             result_p->payloadSize,
+             result_p->numMsgs,
+             ( double ) result_p->numMsgs / seconds,
+             ( double ) result_p->numMsgs * result_p->payloadSize / ( 1024.0 * 1024.0 ) / seconds,
+             ( double ) result_p->cpuUs / result_p->numMsgs );
+}
+
+
+/*****************************************************************************
+ * perf_publishCopied
+ *
+ * Publish numMsgs messages, copying the payload into each message.
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_publishCopied ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                     solClient_uint32_t deliveryMode, const char *payload_p, perfResult_t * result_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    UINT64          cpuStart;
+    int             i;
+
+    perf_startRun ( result_p, &cpuStart );
+    for ( i = 0; i < result_p->numMsgs; i++ ) {
+        if ( ( rc = common_publishPayload ( session_p, topic_p, deliveryMode, payload_p, result_p->payloadSize ) ) != SOLCLIENT_OK ) {
+            return rc;
+        }
+    }
+    perf_endRun ( result_p, cpuStart );
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * perf_publishZeroCopy
+ *
+ * Publish numMsgs messages, each attaching a pooled buffer by reference.
+ * Guaranteed messages hold their buffer until acknowledged, so when the pool
+ * is exhausted the publisher waits for acknowledgements to return buffers.
+ * Returns SOLCLIENT_INCOMPLETE if none return within PERF_ZERO_COPY_ACK_MS.
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_publishZeroCopy ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                       solClient_uint32_t deliveryMode, common_bufPool_pt pool_p, perfResult_t * result_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    UINT64          cpuStart;
+    UINT64          deadlineUs;
+    void           *buf_p;
+    int             i;
+
+    perf_startRun ( result_p, &cpuStart );
+    for ( i = 0; i < result_p->numMsgs; i++ ) {
+        deadlineUs = 0;
+        while ( ( buf_p = common_bufPool_get ( pool_p ) ) == NULL ) {
+            if ( deadlineUs == 0 ) {
+                deadlineUs = getTimeInUs (  ) + PERF_ZERO_COPY_ACK_MS * 1000;
+            } else if ( getTimeInUs (  ) >= deadlineUs ) {
+                printf ( "No buffer returned after %d ms, %d buffers still outstanding\n",
+                         PERF_ZERO_COPY_ACK_MS, common_bufPool_getInUse ( pool_p ) );
+                return SOLCLIENT_INCOMPLETE;
+            }
+            sleepInUs ( 50 );
+        }
+        if ( ( rc = common_publishBuffer ( session_p, topic_p, deliveryMode, buf_p, result_p->payloadSize ) ) != SOLCLIENT_OK ) {
+            return rc;
+        }
+    }
+    perf_endRun ( result_p, cpuStart );
+
+    /* Outside the measurement, wait for outstanding acknowledgements. */
+    deadlineUs = getTimeInUs (  ) + PERF_ZERO_COPY_ACK_MS * 1000;
+    while ( common_bufPool_getInUse ( pool_p ) != 0 ) {
+        if ( getTimeInUs (  ) >= deadlineUs ) {
+            printf ( "%d buffers still outstanding after %d ms\n",
+                     common_bufPool_getInUse ( pool_p ), PERF_ZERO_COPY_ACK_MS );
+            return SOLCLIENT_INCOMPLETE;
+        }
+        sleepInUs ( 1000 );
+    }
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * perf_runPayloadTest
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_runPayloadTest ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                      solClient_uint32_t deliveryMode, int numMsgs )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    common_bufPool_pt pool_p = NULL;
+    perfResult_t    result;
+    char           *payload_p;
+    void           *bufs_p[PERF_POOL_MAX_BUFS];
+    size_t          sizeIndex;
+    int             numBufs;
+    int             i;
+
+    printf ( "Payload test: %s messages to '%s'\n\n",
+             ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) ? "Direct" : "Persistent", topic_p );
+    perf_printResultHeader (  );
+
+    for ( sizeIndex = 0; sizeIndex < sizeof ( payloadSizes ) / sizeof ( payloadSizes[0] ); sizeIndex++ ) {
+        result.payloadSize = payloadSizes[sizeIndex];
+        result.numMsgs = numMsgs;
+        if ( ( UINT64 ) result.numMsgs * result.payloadSize > PERF_MAX_BYTES_PER_RUN ) {
+            result.numMsgs = PERF_MAX_BYTES_PER_RUN / result.payloadSize;
+        }
+
+        /* The copied payload is built once, as an application would before publishing. */
+        if ( ( payload_p = ( char * ) malloc ( result.payloadSize ) ) == NULL ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a %u byte payload", result.payloadSize );
+            return SOLCLIENT_FAIL;
+        }
+        memset ( payload_p, 'c', result.payloadSize );
+
+        numBufs = ( int ) ( PERF_POOL_BYTES / result.payloadSize );
+        if ( numBufs > PERF_POOL_MAX_BUFS ) {
+            numBufs = PERF_POOL_MAX_BUFS;
+        }
+        if ( ( rc = common_bufPool_create ( &pool_p, result.payloadSize, numBufs ) ) != SOLCLIENT_OK ) {
+            free ( payload_p );
+            return rc;
+        }
+        /* Fill (and fault in) every pooled buffer before measuring. */
+        for ( i = 0; i < numBufs; i++ ) {
+            bufs_p[i] = common_bufPool_get ( pool_p );
+            memset ( bufs_p[i], 'z', result.payloadSize );
+        }
+        for ( i = 0; i < numBufs; i++ ) {
+            common_bufPool_release ( bufs_p[i] );
+        }
+
+        if ( ( rc = perf_publishCopied ( session_p, topic_p, deliveryMode, payload_p, &result ) ) != SOLCLIENT_OK ) {
+            goto freeRun;
+        }
+        perf_printResult ( "copy", &result );
+
+        if ( ( rc = perf_publishZeroCopy ( session_p, topic_p, deliveryMode, pool_p, &result ) ) != SOLCLIENT_OK ) {
+            goto freeRun;
+        }
+        perf_printResult ( "zero-copy", &result );
+
+      freeRun:
+        if ( rc == SOLCLIENT_INCOMPLETE ) {
+            /* A late acknowledgement would still return a buffer here, so keep the pool. */
+            pool_p = NULL;
+        }
+        common_bufPool_destroy ( &pool_p );
+        free ( payload_p );
+        if ( rc != SOLCLIENT_OK ) {
+            return rc;
+        }
+    }
+    printf ( "\n" );
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * perf_connect
+ *
+ * Create a Context and connect a Session for a test run. The API must already
+ * be initialized. common_bufPoolEventCallback() returns pooled buffers to
+ * their pool when Guaranteed messages are acknowledged;
+ * common_sendQueue_eventCallback() drains the send queue of the Session.
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_connect ( struct commonOptions *commandOpts, solClient_session_eventCallbackFunc_t eventCallback_p,
+               solClient_opaqueContext_pt * context_p, solClient_opaqueSession_pt * session_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        return rc;
+    }
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient sessions." );
+
+    if ( ( rc = common_createAndConnectSession ( *context_p,
+                                                 session_p,
+                                                 common_messageReceivePerfCallback,
+                                                 eventCallback_p, NULL, commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        return rc;
+    }
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * perf_disconnect
+ *****************************************************************************/
+static void
+perf_disconnect ( solClient_opaqueContext_pt * context_p, solClient_opaqueSession_pt * session_p )
+{
+    solClient_returnCode_t rc;
+
+    if ( ( rc = solClient_session_disconnect ( *session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+    solClient_session_destroy ( session_p );
+    solClient_context_destroy ( context_p );
+}
+
+
+/*****************************************************************************
+ * perf_runProfilesTest
+ *
+ * Unlike the other tests this one owns the API lifecycle: each run
+ * initializes the API with its profile, connects, publishes and cleans up.
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_runProfilesTest ( struct commonOptions *commandOpts, solClient_uint32_t deliveryMode,
+                       solClient_uint32_t payloadSize )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueContext_pt context_p;
+    solClient_opaqueSession_pt session_p;
+    perfResult_t    result;
+    char           *payload_p;
+    UINT64          connectedRssKb;
+    UINT64          publishedRssKb;
+    double          seconds;
+    int             profileIndex;
+
+    if ( ( payload_p = ( char * ) malloc ( payloadSize ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a %u byte payload", payloadSize );
+        return SOLCLIENT_FAIL;
+    }
+    memset ( payload_p, 'c', payloadSize );
+
+    printf ( "Profiles test: %u byte %s messages to '%s'\n\n", payloadSize,
+             ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) ? "Direct" : "Persistent",
+             commandOpts->destinationName );
+    printf ( "%-12s %8s %12s %10s %12s %14s %14s\n",
+             "Profile", "Msgs", "Msgs/s", "MB/s", "CPU us/msg", "RSS conn (KB)", "RSS pub (KB)" );
+
+    /* Index -1 is the API defaults. */
+    for ( profileIndex = -1; profileIndex < COMMON_NUM_TUNING_PROFILES; profileIndex++ ) {
+        commandOpts->profile_p = common_getTuningProfile ( profileIndex );
+
+        if ( ( rc = common_initialize ( commandOpts ) ) != SOLCLIENT_OK ) {
+            break;
+        }
+        solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts->logLevel );
+
+        if ( ( rc = perf_connect ( commandOpts, common_bufPoolEventCallback, &context_p, &session_p ) ) != SOLCLIENT_OK ) {
+            solClient_cleanup (  );
+            break;
+        }
+        connectedRssKb = getRssInKb (  );
+
+        result.payloadSize = payloadSize;
+        result.numMsgs = commandOpts->numMsgsToSend;
+        rc = perf_publishCopied ( session_p, commandOpts->destinationName, deliveryMode, payload_p, &result );
+        publishedRssKb = getRssInKb (  );
+
+        if ( rc == SOLCLIENT_OK ) {
+            seconds = ( double ) result.elapsedUs / 1000000.0;
+            printf ( "%-12s %8d %12.0f %10.1f %12.2f %14llu %14llu\n",
+                     ( commandOpts->profile_p != NULL ) ? commandOpts->profile_p->name_p : "default",
+                     result.numMsgs,
+                     ( double ) result.numMsgs / seconds,
+                     ( double ) result.numMsgs * result.payloadSize / ( 1024.0 * 1024.0 ) / seconds,
+                     ( double ) result.cpuUs / result.numMsgs, connectedRssKb, publishedRssKb );
+        }
+
+        perf_disconnect ( &context_p, &session_p );
+        /* Pooled messages belong to this API instance. */
+        common_msgPool_cleanup (  );
+        solClient_cleanup (  );
+
+        if ( rc != SOLCLIENT_OK ) {
+            break;
+        }
+    }
+    printf ( "\n" );
+
+    free ( payload_p );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * perf_runMetadataTest
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_runMetadataTest ( struct commonOptions *commandOpts, solClient_uint32_t deliveryMode,
+                       solClient_uint32_t payloadSize )
+{
+    static const struct
+    {
+        const char     *name_p;
+        int             fields;
+    } variants[] = {
+        { "none", 0 },
+        { "ts", COMMON_METADATA_SEND_TIMESTAMP },
+        { "id", COMMON_METADATA_SENDER_ID },
+        { "seq", COMMON_METADATA_SEQUENCE_NUMBER },
+        { "all", COMMON_METADATA_ALL }
+    };
+#define PERF_NUM_METADATA_VARIANTS ( int ) ( sizeof ( variants ) / sizeof ( variants[0] ) )
+
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueContext_pt context_p;
+    solClient_opaqueSession_pt session_p;
+    perfResult_t    best[PERF_NUM_METADATA_VARIANTS];
+    perfResult_t    result;
+    char           *payload_p;
+    double          nsPerMsg;
+    double          baseNsPerMsg;
+    int             savedFields = commandOpts->genMetadata;
+    int             round;
+    int             v;
+
+    if ( ( payload_p = ( char * ) malloc ( payloadSize ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a %u byte payload", payloadSize );
+        return SOLCLIENT_FAIL;
+    }
+    memset ( payload_p, 'c', payloadSize );
+    memset ( best, 0, sizeof ( best ) );
+
+    /* Interleave the variants so drift on the host affects them all alike. */
+    for ( round = 0; round < PERF_METADATA_ROUNDS; round++ ) {
+        for ( v = 0; v < PERF_NUM_METADATA_VARIANTS; v++ ) {
+            commandOpts->genMetadata = variants[v].fields;
+            if ( ( rc = perf_connect ( commandOpts, common_bufPoolEventCallback, &context_p, &session_p ) ) != SOLCLIENT_OK ) {
+                goto done;
+            }
+            result.payloadSize = payloadSize;
+            result.numMsgs = commandOpts->numMsgsToSend;
+            rc = perf_publishCopied ( session_p, commandOpts->destinationName, deliveryMode, payload_p, &result );
+            perf_disconnect ( &context_p, &session_p );
+            if ( rc != SOLCLIENT_OK ) {
+                goto done;
+            }
+            if ( best[v].elapsedUs == 0 || result.elapsedUs < best[v].elapsedUs ) {
+                best[v] = result;
+            }
+        }
+    }
+
+    printf ( "Metadata test: %u byte %s messages to '%s', best of %d rounds\n\n", payloadSize,
+             ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) ? "Direct" : "Persistent",
+             commandOpts->destinationName, PERF_METADATA_ROUNDS );
+    printf ( "%-8s %8s %12s %10s %12s %12s\n", "Fields", "Msgs", "Msgs/s", "ns/msg", "+ns/msg", "CPU us/msg" );
+
+    baseNsPerMsg = ( double ) best[0].elapsedUs * 1000.0 / best[0].numMsgs;
+    for ( v = 0; v < PERF_NUM_METADATA_VARIANTS; v++ ) {
+        nsPerMsg = ( double ) best[v].elapsedUs * 1000.0 / best[v].numMsgs;
+        printf ( "%-8s %8d %12.0f %10.1f %12.1f %12.2f\n",
+                 variants[v].name_p,
+                 best[v].numMsgs,
+                 1.0e9 / nsPerMsg, nsPerMsg, nsPerMsg - baseNsPerMsg,
+                 ( double ) best[v].cpuUs / best[v].numMsgs );
+    }
+    printf ( "\n" );
+
+  done:
+    commandOpts->genMetadata = savedFields;
+    free ( payload_p );
+    return rc;
+#undef PERF_NUM_METADATA_VARIANTS
+}
+
+
+/*****************************************************************************
+ * perf_runZipTest
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_runZipTest ( struct commonOptions *commandOpts, solClient_uint32_t deliveryMode )
+{
+    static const char xmlRecord[] =
+        "<trade><id>000123</id><sym>ACME</sym><px>101.25</px><qty>500</qty><side>B</side></trade>\n";
+    static const struct
+    {
+        const char     *name_p;
+        int             level;
+    } variants[] = {
+        { "off", 0 },
+        { "level 9", 9 },
+        { "adaptive", COMMON_ZIP_ADAPTIVE }
+    };
+
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+    common_zipPublisher_t zp;
+    struct commonOptions zipOpts = *commandOpts;
+    char            xml[PERF_ZIP_LARGE_BYTES];
+    char            noise[PERF_ZIP_LARGE_BYTES];
+    char            small[PERF_ZIP_SMALL_BYTES];
+    const char     *payloads_p[3];
+    solClient_uint32_t sizes[3];
+    perfResult_t    result;
+    UINT64          cpuStart;
+    UINT64          bytes;
+    size_t          v;
+    int             i;
+
+    for ( i = 0; i < PERF_ZIP_LARGE_BYTES; i++ ) {
+        xml[i] = xmlRecord[i % ( sizeof ( xmlRecord ) - 1 )];
+        noise[i] = ( char ) ( rand (  ) >> 3 );
+    }
+    memset ( small, 's', sizeof ( small ) );
+    payloads_p[0] = xml;
+    sizes[0] = sizeof ( xml );
+    payloads_p[1] = noise;
+    sizes[1] = sizeof ( noise );
+    payloads_p[2] = small;
+    sizes[2] = sizeof ( small );
+
+    printf ( "Zip test: XML, random and %d byte %s messages to '%s'\n\n", PERF_ZIP_SMALL_BYTES,
+             ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) ? "Direct" : "Persistent",
+             commandOpts->destinationName );
+
+    for ( v = 0; v < sizeof ( variants ) / sizeof ( variants[0] ); v++ ) {
+        if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                               &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_context_create()" );
+            return rc;
+        }
+        zipOpts.compressionLevel = variants[v].level;
+        if ( ( rc = common_zipPublisher_connect ( context_p, &zp, common_messageReceivePerfCallback,
+                                                  common_eventCallback, NULL, &zipOpts,
+                                                  xml, sizeof ( xml ) ) ) != SOLCLIENT_OK ) {
+            solClient_context_destroy ( &context_p );
+            return rc;
+        }
+        if ( zp.zipSession_p != NULL &&
+             ( rc = solClient_session_topicSubscribeExt ( zp.zipSession_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                          commandOpts->destinationName ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_topicSubscribeExt()" );
+        }
+
+        result.payloadSize = 0;
+        result.numMsgs = commandOpts->numMsgsToSend;
+        bytes = 0;
+        perf_startRun ( &result, &cpuStart );
+        for ( i = 0; i < result.numMsgs; i++ ) {
+            if ( ( rc = common_zipPublisher_publish ( &zp, commandOpts->destinationName, deliveryMode,
+                                                      payloads_p[i % 3], sizes[i % 3] ) ) != SOLCLIENT_OK ) {
+                break;
+            }
+            bytes += sizes[i % 3];
+        }
+        perf_endRun ( &result, cpuStart );
+
+        if ( rc == SOLCLIENT_OK ) {
+            printf ( "%-8s %12.0f msgs/s %10.1f MB/s %10.2f CPU us/msg\n", variants[v].name_p,
+                     ( double ) result.numMsgs * 1000000.0 / result.elapsedUs,
+                     ( double ) bytes / ( 1024.0 * 1024.0 ) * 1000000.0 / result.elapsedUs,
+                     ( double ) result.cpuUs / result.numMsgs );
+            /* Let the subscribed Session receive what was published before reading its stats. */
+            sleepInUs ( 500000 );
+            common_zipPublisher_printStats ( &zp );
+            printf ( "\n" );
+        }
+
+        common_zipPublisher_disconnect ( &zp );
+        solClient_context_destroy ( &context_p );
+        if ( rc != SOLCLIENT_OK ) {
+            return rc;
+        }
+    }
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * perf_runNonBlockingTest
+ *
+ * Each variant connects its own Session, since sending without blocking is
+ * a Session property. The time of every send call is recorded; the queue is
+ * left to empty outside the measurement.
+ *****************************************************************************/
+static          solClient_returnCode_t
+perf_runNonBlockingTest ( struct commonOptions *commandOpts, solClient_uint32_t deliveryMode,
+                          solClient_uint32_t payloadSize )
+{
+    static const struct
+    {
+        const char     *name_p;
+        int             policy;         /* -1 for a blocking Session. */
+    } variants[] = {
+        { "blocking", -1 },
+        { "drop-oldest", COMMON_SENDQ_DROP_OLDEST },
+        { "drop-newest", COMMON_SENDQ_DROP_NEWEST },
+        { "block", COMMON_SENDQ_BLOCK }
+    };
+
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueContext_pt context_p;
+    solClient_opaqueSession_pt session_p;
+    solClient_opaqueMsg_pt msg_p = NULL;
+    solClient_destination_t destination;
+    struct commonOptions runOpts;
+    common_sendQueue_t queue;
+    perfResult_t    result;
+    solClient_uint64_t *callUs_p;
+    char           *payload_p;
+    UINT64          cpuStart;
+    UINT64          startUs;
+    UINT64          endUs;
+    UINT64          sentUs;
+    UINT64          deadlineUs;
+    int             dropped;
+    int             unsent;
+    int             i;
+    size_t          v;
+
+    payload_p = ( char * ) malloc ( payloadSize );
+    callUs_p = ( solClient_uint64_t * ) malloc ( commandOpts->numMsgsToSend * sizeof ( solClient_uint64_t ) );
+    if ( payload_p == NULL || callUs_p == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate the nonblocking test buffers" );
+        free ( payload_p );
+        free ( callUs_p );
+        return SOLCLIENT_FAIL;
+    }
+    memset ( payload_p, 'c', payloadSize );
+
+    printf ( "Nonblocking test: %u byte %s messages to '%s', send queue of %d messages\n\n", payloadSize,
+             ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) ? "Direct" : "Persistent",
+             commandOpts->destinationName, commandOpts->sendQueueDepth );
+    printf ( "%-12s %8s %12s %12s %10s %10s %10s %8s %8s\n",
+             "Send", "Msgs", "Calls/s", "Sent/s", "p50 us", "p99 us", "max us", "Deepest", "Dropped" );
+
+    for ( v = 0; v < sizeof ( variants ) / sizeof ( variants[0] ); v++ ) {
+        /* With --sendq only its policy is compared with blocking sends. */
+        if ( !commandOpts->sendBlocking && variants[v].policy >= 0 && variants[v].policy != commandOpts->sendQueuePolicy ) {
+            continue;
+        }
+        runOpts = *commandOpts;
+        runOpts.sendBlocking = ( variants[v].policy < 0 );
+        if ( ( rc = perf_connect ( &runOpts, common_sendQueue_eventCallback, &context_p, &session_p ) ) != SOLCLIENT_OK ) {
+            break;
+        }
+        if ( !runOpts.sendBlocking &&
+             ( rc = common_sendQueue_init ( &queue, session_p, ( unsigned int ) runOpts.sendQueueDepth,
+                                            variants[v].policy ) ) != SOLCLIENT_OK ) {
+            perf_disconnect ( &context_p, &session_p );
+            break;
+        }
+
+        /* One message is built and sent repeatedly; the queue keeps duplicates. */
+        if ( ( rc = solClient_msg_alloc ( &msg_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_alloc()" );
+            goto disconnect;
+        }
+        destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+        destination.dest = runOpts.destinationName;
+        if ( ( rc = solClient_msg_setDeliveryMode ( msg_p, deliveryMode ) ) != SOLCLIENT_OK ||
+             ( rc = solClient_msg_setBinaryAttachment ( msg_p, payload_p, payloadSize ) ) != SOLCLIENT_OK ||
+             ( rc = solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "Building the nonblocking test message" );
+            goto disconnect;
+        }
+
+        result.payloadSize = payloadSize;
+        result.numMsgs = runOpts.numMsgsToSend;
+        dropped = 0;
+        perf_startRun ( &result, &cpuStart );
+        for ( i = 0; i < result.numMsgs; i++ ) {
+            startUs = getTimeInUs (  );
+            if ( runOpts.sendBlocking ) {
+                rc = solClient_session_sendMsg ( session_p, msg_p );
+            } else {
+                rc = common_sendQueue_send ( &queue, msg_p );
+            }
+            callUs_p[i] = getTimeInUs (  ) - startUs;
+            if ( rc == SOLCLIENT_WOULD_BLOCK ) {
+                /* Dropped by drop-newest. */
+                dropped++;
+                rc = SOLCLIENT_OK;
+            } else if ( rc != SOLCLIENT_OK ) {
+                common_handleError ( rc, "send" );
+                break;
+            }
+        }
+        perf_endRun ( &result, cpuStart );
+        endUs = getTimeInUs (  );
+
+        if ( rc == SOLCLIENT_OK ) {
+            /* Queued messages are only sent once the ring drains. */
+            sentUs = result.elapsedUs;
+            unsent = 0;
+            if ( !runOpts.sendBlocking ) {
+                deadlineUs = endUs + PERF_SENDQ_DRAIN_MS * 1000;
+                while ( ( unsent = ( int ) common_sendQueue_getDepth ( &queue ) ) > 0 && getTimeInUs (  ) < deadlineUs ) {
+                    sleepInUs ( 1000 );
+                }
+                sentUs += getTimeInUs (  ) - endUs;
+                dropped += ( int ) queue.stats.droppedOldest;
+                if ( unsent > 0 ) {
+                    printf ( "%d messages still queued after %d ms\n", unsent, PERF_SENDQ_DRAIN_MS );
+                }
+            }
+            common_sortSamples ( callUs_p, result.numMsgs );
+            printf ( "%-12s %8d %12.0f %12.0f %10llu %10llu %10llu %8u %8d\n",
+                     variants[v].name_p, result.numMsgs,
+                     ( double ) result.numMsgs * 1000000.0 / result.elapsedUs,
+                     ( double ) ( result.numMsgs - dropped - unsent ) * 1000000.0 / sentUs,
+                     ( unsigned long long ) common_getPercentile ( callUs_p, result.numMsgs, 50.0 ),
+                     ( unsigned long long ) common_getPercentile ( callUs_p, result.numMsgs, 99.0 ),
+                     ( unsigned long long ) callUs_p[result.numMsgs - 1],
+                     runOpts.sendBlocking ? 0 : queue.stats.maxDepth, dropped );
+        }
+
+      disconnect:
+        if ( msg_p != NULL ) {
+            solClient_msg_free ( &msg_p );
+        }
+        perf_disconnect ( &context_p, &session_p );
+        if ( !runOpts.sendBlocking ) {
+            common_sendQueue_destroy ( &queue );
+        }
+        if ( rc != SOLCLIENT_OK ) {
+            break;
+        }
+    }
+    printf ( "\n" );
+
+    free ( callUs_p );
+    free ( payload_p );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    const char     *test_p = "payload";
+    solClient_uint32_t deliveryMode = SOLCLIENT_DELIVERY_MODE_DIRECT;
+    solClient_uint32_t payloadSize = PERF_DEFAULT_PAYLOAD_BYTES;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    printf ( "\nPerfPublisher.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                DEST_PARAM_MASK |
+                                NUM_MSGS_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK |
+                                POOL_TUNING_MASK |
+                                PROFILE_MASK |
+                                METADATA_MASK |
+                                ZIP_ADAPTIVE_MASK |
+                                SEND_QUEUE_MASK));                      /* optional parameters */
+    commandOpts.numMsgsToSend = PERF_DEFAULT_NUM_MSGS;
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\tpayload [direct|persistent]  Compare copied and zero-copy (pooled buffer) publishing\n"
+            "\t                             for payloads from 100 B to 1 MB (default test).\n"
+            "\tprofiles [bytes] [direct|persistent]\n"
+            "\t                             Compare throughput and RSS of the API defaults and\n"
+            "\t                             each --profile (default 1024 byte payload).\n"
+            "\tmetadata [bytes] [direct|persistent]\n"
+            "\t                             Measure the per-message cost of each generated\n"
+            "\t                             metadata field (default 1024 byte payload).\n"
+            "\tzip [direct|persistent]      Compare uncompressed, level 9 and adaptive compression\n"
+            "\t                             on a mix of XML, random and small payloads.\n"
+            "\tnonblocking [bytes] [direct|persistent]\n"
+            "\t                             Compare blocking sends with a non-blocking send queue\n"
+            "\t                             for each --sendq policy (default 1024 byte payload).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        test_p = argv[optind++];
+    }
+    for ( ; optind < argc; optind++ ) {
+        if ( strcasecmp ( argv[optind], "persistent" ) == 0 ) {
+            deliveryMode = SOLCLIENT_DELIVERY_MODE_PERSISTENT;
+        } else if ( atoi ( argv[optind] ) > 0 ) {
+            payloadSize = ( solClient_uint32_t ) atoi ( argv[optind] );
+        }
+    }
+    if ( commandOpts.destinationName[0] == ( char ) 0 ) {
+        strncpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC, sizeof ( commandOpts.destinationName ) - 1 );
+    }
+
+    /* The profiles test initializes and cleans up the API once per profile. */
+    if ( strcasecmp ( test_p, "profiles" ) == 0 ) {
+        perf_runProfilesTest ( &commandOpts, deliveryMode, payloadSize );
+        goto notInitialized;
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    /*
+     * Standard logging levels can be set independently for the API and the
+     * application. In this case, the ALL category is used to set the log level for
+     * both at the same time.
+     */
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context, and create and connect a Session
+     *************************************************************************/
+
+    if ( ( rc = perf_connect ( &commandOpts, common_bufPoolEventCallback, &context_p, &session_p ) ) != SOLCLIENT_OK ) {
+        goto cleanup;
+    }
+
+    /*************************************************************************
+     * Run the test
+     *************************************************************************/
+
+    if ( strcasecmp ( test_p, "payload" ) == 0 ) {
+        perf_runPayloadTest ( session_p, commandOpts.destinationName, deliveryMode, commandOpts.numMsgsToSend );
+    } else if ( strcasecmp ( test_p, "metadata" ) == 0 ) {
+        /* Connects its own Session per variant. */
+        perf_runMetadataTest ( &commandOpts, deliveryMode, payloadSize );
+    } else if ( strcasecmp ( test_p, "zip" ) == 0 ) {
+        /* Connects its own Sessions per variant. */
+        perf_runZipTest ( &commandOpts, deliveryMode );
+    } else if ( strcasecmp ( test_p, "nonblocking" ) == 0 ) {
+        /* Connects its own Session per variant. */
+        perf_runNonBlockingTest ( &commandOpts, deliveryMode, payloadSize );
+    } else {
+        printf ( "Unknown test '%s'\n", test_p );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+    /* Report and free the pooled messages. */
+    common_msgPool_printStats (  );
+    common_msgPool_cleanup (  );
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    return 0;
+
+}
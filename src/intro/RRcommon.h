@@ -31,6 +31,58 @@ typedef enum RR_operation
 #define MY_SAMPLE_REQUEST_TE "my_sample_request_te"
 
 
+/*
+ * Fixed-layout binary wire format (--wire=binary), carried as the binary
+ * attachment instead of a structured data stream. All fields are
+ * little-endian regardless of the host byte order.
+ *
+ * Request, RR_BINARY_REQUEST_SIZE bytes:
+ *     0  magic 'R' 'Q'
+ *     2  version (RR_BINARY_VERSION)
+ *     3  operation (RR_operation_t)
+ *     4  operand1 (int32)
+ *     8  operand2 (int32)
+ *
+ * Reply, RR_BINARY_REPLY_SIZE bytes:
+ *     0  magic 'R' 'P'
+ *     2  version (RR_BINARY_VERSION)
+ *     3  status (1 when the result is valid, 0 on failure)
+ *     4  reserved (0)
+ *     8  result (IEEE 754 double)
+ */
+#define RR_BINARY_VERSION       1
+#define RR_BINARY_REQUEST_SIZE  12
+#define RR_BINARY_REPLY_SIZE    16
+
+
 const char *RR_operationToString ( RR_operation_t operation );
 
+/*
+ * Encode a binary request into buf_p, which must hold RR_BINARY_REQUEST_SIZE
+ * bytes.
+ */
+void RR_encodeBinaryRequest ( solClient_uint8_t *buf_p, RR_operation_t operation,
+                              solClient_int32_t operand1, solClient_int32_t operand2 );
+
+/*
+ * Validate and decode a binary request. Returns SOLCLIENT_NOT_FOUND when the
+ * payload is not a binary request (wrong size or magic), and SOLCLIENT_FAIL
+ * when it is one of an unsupported version.
+ */
+solClient_returnCode_t RR_decodeBinaryRequest ( const void *buf_p, solClient_uint32_t size, RR_operation_t *operation_p,
+                                                solClient_int32_t *operand1_p, solClient_int32_t *operand2_p );
+
+/*
+ * Encode a binary reply into buf_p, which must hold RR_BINARY_REPLY_SIZE
+ * bytes.
+ */
+void RR_encodeBinaryReply ( solClient_uint8_t *buf_p, solClient_bool_t resultOk, double result );
+
+/*
+ * Validate and decode a binary reply. Returns SOLCLIENT_FAIL when the
+ * payload is not a binary reply of a supported version.
+ */
+solClient_returnCode_t RR_decodeBinaryReply ( const void *buf_p, solClient_uint32_t size,
+                                              solClient_bool_t *resultOk_p, double *result_p );
+
 #endif
@@ -0,0 +1,544 @@
+
+/** @example Intro/SdtCodecBench.c
+ */
+
+/*
+ * This sample measures the cost of encoding and decoding a structured data
+ * (SDT) payload of 48 fields, as a stream and as a map, with two codecs:
+ *
+ *    baseline: an encoder and decoder written by hand with one container
+ *              call per field, as in BasicRequestor and BasicReplier. Map
+ *              fields are looked up by name.
+ *    codec:    the functions SDT_DEFINE_SCHEMA() generates (see sdtcodec.h),
+ *              which read map fields in one pass.
+ *
+ * Both create containers with the encoded size of the value, so they never
+ * grow, and neither copies strings or byte arrays out of the message. Streams
+ * are read the same way by both, so the stream figures show what the
+ * generated code costs over hand-written calls, and the map figures what
+ * reading in one pass saves.
+ *
+ * No connection is made; messages are only built and parsed locally.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "sdtcodec.h"
+#include "getopt.h"
+
+#define BENCH_DEFAULT_ITERATIONS    200000
+
+#define QUOTE_FIELDS(FIELD) \
+    FIELD ( STRING, symbol ) \
+    FIELD ( STRING, exchange ) \
+    FIELD ( STRING, currency ) \
+    FIELD ( STRING, venue ) \
+    FIELD ( STRING, traderId ) \
+    FIELD ( STRING, bookId ) \
+    FIELD ( STRING, condition ) \
+    FIELD ( STRING, source ) \
+    FIELD ( INT64, quoteTime ) \
+    FIELD ( INT64, sendTime ) \
+    FIELD ( INT64, recvTime ) \
+    FIELD ( INT64, seqNum ) \
+    FIELD ( INT64, orderId ) \
+    FIELD ( INT64, tradeId ) \
+    FIELD ( DOUBLE, bidPrice ) \
+    FIELD ( DOUBLE, askPrice ) \
+    FIELD ( DOUBLE, lastPrice ) \
+    FIELD ( DOUBLE, openPrice ) \
+    FIELD ( DOUBLE, highPrice ) \
+    FIELD ( DOUBLE, lowPrice ) \
+    FIELD ( DOUBLE, closePrice ) \
+    FIELD ( DOUBLE, vwap ) \
+    FIELD ( DOUBLE, bidYield ) \
+    FIELD ( DOUBLE, askYield ) \
+    FIELD ( DOUBLE, midPrice ) \
+    FIELD ( DOUBLE, spread ) \
+    FIELD ( INT32, bidSize ) \
+    FIELD ( INT32, askSize ) \
+    FIELD ( INT32, lastSize ) \
+    FIELD ( INT32, volume ) \
+    FIELD ( INT32, numTrades ) \
+    FIELD ( INT32, bidLevels ) \
+    FIELD ( INT32, askLevels ) \
+    FIELD ( INT32, flags ) \
+    FIELD ( INT32, openInterest ) \
+    FIELD ( INT32, lotSize ) \
+    FIELD ( UINT32, marketId ) \
+    FIELD ( UINT32, instrumentId ) \
+    FIELD ( INT16, bidCount ) \
+    FIELD ( INT16, askCount ) \
+    FIELD ( INT8, side ) \
+    FIELD ( INT8, status ) \
+    FIELD ( INT8, tick ) \
+    FIELD ( BOOL, halted ) \
+    FIELD ( BOOL, indicative ) \
+    FIELD ( BOOL, snapshot ) \
+    FIELD ( BYTES, bidBook ) \
+    FIELD ( BYTES, askBook )
+
+SDT_DEFINE_SCHEMA ( quote, QUOTE_FIELDS )
+
+#define BENCH_COUNT_(TYPE, member) + 1
+
+/* Compare a decoded member with the encoded one; strings and byte arrays by content. */
+#define BENCH_EQUAL_BOOL(a, b)      ( ( a ) == ( b ) )
+#define BENCH_EQUAL_INT8(a, b)      ( ( a ) == ( b ) )
+#define BENCH_EQUAL_INT16(a, b)     ( ( a ) == ( b ) )
+#define BENCH_EQUAL_INT32(a, b)     ( ( a ) == ( b ) )
+#define BENCH_EQUAL_INT64(a, b)     ( ( a ) == ( b ) )
+#define BENCH_EQUAL_UINT32(a, b)    ( ( a ) == ( b ) )
+#define BENCH_EQUAL_DOUBLE(a, b)    ( ( a ) == ( b ) )
+#define BENCH_EQUAL_STRING(a, b)    ( ( b ) != NULL && strcmp ( a, b ) == 0 )
+#define BENCH_EQUAL_BYTES(a, b)     ( ( a ).length == ( b ).length && \
+                                      memcmp ( ( a ).data_p, ( b ).data_p, ( a ).length ) == 0 )
+
+#define BENCH_CHECK_(TYPE, member) \
+    if ( !BENCH_EQUAL_##TYPE ( sent_p->member, quote_p->member ) ) { \
+        return #member; \
+    }
+
+
+/*
+ * The baseline: an encoder and decoder written by hand against the container
+ * API, one call per field as in BasicRequestor and BasicReplier. Map fields
+ * are named and looked up by name; stream fields are not.
+ */
+#define BASE_NAME(name_p)   ( useMap ? ( name_p ) : NULL )
+
+static          solClient_returnCode_t
+base_encode ( solClient_opaqueContainer_pt container_p, const quote_t * quote_p, int useMap )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    if ( ( rc = solClient_container_addString ( container_p, quote_p->symbol, BASE_NAME ( "symbol" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->exchange, BASE_NAME ( "exchange" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->currency, BASE_NAME ( "currency" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->venue, BASE_NAME ( "venue" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->traderId, BASE_NAME ( "traderId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->bookId, BASE_NAME ( "bookId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->condition, BASE_NAME ( "condition" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addString ( container_p, quote_p->source, BASE_NAME ( "source" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt64 ( container_p, quote_p->quoteTime, BASE_NAME ( "quoteTime" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt64 ( container_p, quote_p->sendTime, BASE_NAME ( "sendTime" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt64 ( container_p, quote_p->recvTime, BASE_NAME ( "recvTime" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt64 ( container_p, quote_p->seqNum, BASE_NAME ( "seqNum" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt64 ( container_p, quote_p->orderId, BASE_NAME ( "orderId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt64 ( container_p, quote_p->tradeId, BASE_NAME ( "tradeId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->bidPrice, BASE_NAME ( "bidPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->askPrice, BASE_NAME ( "askPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->lastPrice, BASE_NAME ( "lastPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->openPrice, BASE_NAME ( "openPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->highPrice, BASE_NAME ( "highPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->lowPrice, BASE_NAME ( "lowPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->closePrice, BASE_NAME ( "closePrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->vwap, BASE_NAME ( "vwap" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->bidYield, BASE_NAME ( "bidYield" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->askYield, BASE_NAME ( "askYield" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->midPrice, BASE_NAME ( "midPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addDouble ( container_p, quote_p->spread, BASE_NAME ( "spread" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->bidSize, BASE_NAME ( "bidSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->askSize, BASE_NAME ( "askSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->lastSize, BASE_NAME ( "lastSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->volume, BASE_NAME ( "volume" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->numTrades, BASE_NAME ( "numTrades" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->bidLevels, BASE_NAME ( "bidLevels" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->askLevels, BASE_NAME ( "askLevels" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->flags, BASE_NAME ( "flags" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->openInterest, BASE_NAME ( "openInterest" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt32 ( container_p, quote_p->lotSize, BASE_NAME ( "lotSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addUint32 ( container_p, quote_p->marketId, BASE_NAME ( "marketId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addUint32 ( container_p, quote_p->instrumentId, BASE_NAME ( "instrumentId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt16 ( container_p, quote_p->bidCount, BASE_NAME ( "bidCount" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt16 ( container_p, quote_p->askCount, BASE_NAME ( "askCount" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt8 ( container_p, quote_p->side, BASE_NAME ( "side" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt8 ( container_p, quote_p->status, BASE_NAME ( "status" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addInt8 ( container_p, quote_p->tick, BASE_NAME ( "tick" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addBoolean ( container_p, quote_p->halted, BASE_NAME ( "halted" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addBoolean ( container_p, quote_p->indicative, BASE_NAME ( "indicative" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addBoolean ( container_p, quote_p->snapshot, BASE_NAME ( "snapshot" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addByteArray ( container_p, quote_p->bidBook.data_p, quote_p->bidBook.length, BASE_NAME ( "bidBook" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_addByteArray ( container_p, quote_p->askBook.data_p, quote_p->askBook.length, BASE_NAME ( "askBook" ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "base_encode()" );
+    }
+    return rc;
+}
+
+static          solClient_returnCode_t
+base_decode ( solClient_opaqueContainer_pt container_p, quote_t * quote_p, int useMap )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    if ( ( rc = solClient_container_getStringPtr ( container_p, &quote_p->symbol, BASE_NAME ( "symbol" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->exchange, BASE_NAME ( "exchange" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->currency, BASE_NAME ( "currency" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->venue, BASE_NAME ( "venue" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->traderId, BASE_NAME ( "traderId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->bookId, BASE_NAME ( "bookId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->condition, BASE_NAME ( "condition" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getStringPtr ( container_p, &quote_p->source, BASE_NAME ( "source" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt64 ( container_p, &quote_p->quoteTime, BASE_NAME ( "quoteTime" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt64 ( container_p, &quote_p->sendTime, BASE_NAME ( "sendTime" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt64 ( container_p, &quote_p->recvTime, BASE_NAME ( "recvTime" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt64 ( container_p, &quote_p->seqNum, BASE_NAME ( "seqNum" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt64 ( container_p, &quote_p->orderId, BASE_NAME ( "orderId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt64 ( container_p, &quote_p->tradeId, BASE_NAME ( "tradeId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->bidPrice, BASE_NAME ( "bidPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->askPrice, BASE_NAME ( "askPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->lastPrice, BASE_NAME ( "lastPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->openPrice, BASE_NAME ( "openPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->highPrice, BASE_NAME ( "highPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->lowPrice, BASE_NAME ( "lowPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->closePrice, BASE_NAME ( "closePrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->vwap, BASE_NAME ( "vwap" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->bidYield, BASE_NAME ( "bidYield" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->askYield, BASE_NAME ( "askYield" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->midPrice, BASE_NAME ( "midPrice" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getDouble ( container_p, &quote_p->spread, BASE_NAME ( "spread" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->bidSize, BASE_NAME ( "bidSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->askSize, BASE_NAME ( "askSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->lastSize, BASE_NAME ( "lastSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->volume, BASE_NAME ( "volume" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->numTrades, BASE_NAME ( "numTrades" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->bidLevels, BASE_NAME ( "bidLevels" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->askLevels, BASE_NAME ( "askLevels" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->flags, BASE_NAME ( "flags" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->openInterest, BASE_NAME ( "openInterest" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt32 ( container_p, &quote_p->lotSize, BASE_NAME ( "lotSize" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getUint32 ( container_p, &quote_p->marketId, BASE_NAME ( "marketId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getUint32 ( container_p, &quote_p->instrumentId, BASE_NAME ( "instrumentId" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt16 ( container_p, &quote_p->bidCount, BASE_NAME ( "bidCount" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt16 ( container_p, &quote_p->askCount, BASE_NAME ( "askCount" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt8 ( container_p, &quote_p->side, BASE_NAME ( "side" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt8 ( container_p, &quote_p->status, BASE_NAME ( "status" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getInt8 ( container_p, &quote_p->tick, BASE_NAME ( "tick" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getBoolean ( container_p, &quote_p->halted, BASE_NAME ( "halted" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getBoolean ( container_p, &quote_p->indicative, BASE_NAME ( "indicative" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getBoolean ( container_p, &quote_p->snapshot, BASE_NAME ( "snapshot" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getByteArrayPtr ( container_p, &quote_p->bidBook.data_p, &quote_p->bidBook.length, BASE_NAME ( "bidBook" ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_container_getByteArrayPtr ( container_p, &quote_p->askBook.data_p, &quote_p->askBook.length, BASE_NAME ( "askBook" ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "base_decode()" );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * bench_fillQuote
+ *****************************************************************************/
+static void
+bench_fillQuote ( quote_t * quote_p, solClient_uint8_t *book_p, solClient_uint32_t bookSize )
+{
+    solClient_uint32_t i;
+
+    for ( i = 0; i < bookSize; i++ ) {
+        book_p[i] = ( solClient_uint8_t ) ( i * 7 );
+    }
+    memset ( quote_p, 0, sizeof ( *quote_p ) );
+    quote_p->symbol = "SOLC";
+    quote_p->exchange = "XNYS";
+    quote_p->currency = "USD";
+    quote_p->venue = "ARCA";
+    quote_p->traderId = "trader-0042";
+    quote_p->bookId = "book/equities/us/large-cap";
+    quote_p->condition = "regular";
+    quote_p->source = "feed-a";
+    quote_p->quoteTime = 1554331492000LL;
+    quote_p->sendTime = 1554331492001LL;
+    quote_p->recvTime = 1554331492002LL;
+    quote_p->seqNum = 123456789LL;
+    quote_p->orderId = 987654321LL;
+    quote_p->tradeId = 555555555LL;
+    quote_p->bidPrice = 101.25;
+    quote_p->askPrice = 101.27;
+    quote_p->lastPrice = 101.26;
+    quote_p->openPrice = 100.50;
+    quote_p->highPrice = 102.00;
+    quote_p->lowPrice = 99.75;
+    quote_p->closePrice = 100.90;
+    quote_p->vwap = 101.01;
+    quote_p->bidYield = 0.0123;
+    quote_p->askYield = 0.0121;
+    quote_p->midPrice = 101.26;
+    quote_p->spread = 0.02;
+    quote_p->bidSize = 300;
+    quote_p->askSize = 500;
+    quote_p->lastSize = 100;
+    quote_p->volume = 1234567;
+    quote_p->numTrades = 4321;
+    quote_p->bidLevels = 10;
+    quote_p->askLevels = 10;
+    quote_p->flags = 0x15;
+    quote_p->openInterest = 77;
+    quote_p->lotSize = 100;
+    quote_p->marketId = 7;
+    quote_p->instrumentId = 424242;
+    quote_p->bidCount = 12;
+    quote_p->askCount = 9;
+    quote_p->side = 1;
+    quote_p->status = 2;
+    quote_p->tick = -1;
+    quote_p->halted = 0;
+    quote_p->indicative = 0;
+    quote_p->snapshot = 1;
+    quote_p->bidBook.data_p = book_p;
+    quote_p->bidBook.length = bookSize / 2;
+    quote_p->askBook.data_p = book_p + bookSize / 2;
+    quote_p->askBook.length = bookSize / 2;
+}
+
+
+/*****************************************************************************
+ * bench_encode
+ *
+ * Build a message with the quote in a stream or map, in a container sized
+ * for the quote.
+ *****************************************************************************/
+static          solClient_returnCode_t
+bench_encode ( solClient_opaqueMsg_pt * msg_p, const quote_t * quote_p, int useMap, int useCodec )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueContainer_pt container_p;
+    solClient_uint32_t size;
+
+    if ( ( rc = solClient_msg_alloc ( msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_alloc()" );
+        return rc;
+    }
+    size = ( solClient_uint32_t ) ( useMap ? quote_mapSize ( quote_p ) : quote_streamSize ( quote_p ) );
+    if ( useMap ) {
+        rc = solClient_msg_createBinaryAttachmentMap ( *msg_p, &container_p, size );
+    } else {
+        rc = solClient_msg_createBinaryAttachmentStream ( *msg_p, &container_p, size );
+    }
+    if ( rc == SOLCLIENT_OK ) {
+        if ( !useCodec ) {
+            rc = base_encode ( container_p, quote_p, useMap );
+        } else if ( useMap ) {
+            rc = quote_encodeMap ( container_p, quote_p );
+        } else {
+            rc = quote_encodeStream ( container_p, quote_p );
+        }
+    }
+    if ( rc != SOLCLIENT_OK ) {
+        common_handleError ( rc, "bench_encode()" );
+        solClient_msg_free ( msg_p );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * bench_decode
+ *****************************************************************************/
+static          solClient_returnCode_t
+bench_decode ( solClient_opaqueMsg_pt msg_p, int useMap, int useCodec, quote_t * quote_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueContainer_pt container_p;
+    const char     *failedField_p = NULL;
+
+    if ( useMap ) {
+        rc = solClient_msg_getBinaryAttachmentMap ( msg_p, &container_p );
+    } else {
+        rc = solClient_msg_getBinaryAttachmentStream ( msg_p, &container_p );
+    }
+    if ( rc != SOLCLIENT_OK ) {
+        common_handleError ( rc, "bench_decode()" );
+        return rc;
+    }
+    if ( useCodec ) {
+        rc = useMap ? quote_decodeMap ( container_p, quote_p, &failedField_p ) :
+            quote_decodeStream ( container_p, quote_p, &failedField_p );
+        if ( rc != SOLCLIENT_OK ) {
+            common_handleError ( rc, failedField_p );
+        }
+    } else {
+        rc = base_decode ( container_p, quote_p, useMap );
+    }
+    solClient_container_closeMapStream ( &container_p );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * bench_check
+ *
+ * Compare every field a decoder returned with what was encoded, and return
+ * the first that differs, or NULL if they all match.
+ *****************************************************************************/
+static const char *
+bench_check ( const quote_t * sent_p, const quote_t * quote_p )
+{
+    QUOTE_FIELDS ( BENCH_CHECK_ )
+    return NULL;
+}
+
+
+/*****************************************************************************
+ * bench_run
+ *
+ * Time encoding (including allocating and freeing the message) and
+ * decoding, and return the nanoseconds per message of each in
+ * encodeNs_p and decodeNs_p.
+ *****************************************************************************/
+static          solClient_returnCode_t
+bench_run ( const quote_t * sent_p, int useMap, int useCodec, int iterations, double *encodeNs_p, double *decodeNs_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueMsg_pt msg_p;
+    quote_t         quote;
+    UINT64          startUs;
+    int             i;
+
+    startUs = getTimeInUs (  );
+    for ( i = 0; i < iterations; i++ ) {
+        if ( ( rc = bench_encode ( &msg_p, sent_p, useMap, useCodec ) ) != SOLCLIENT_OK ) {
+            return rc;
+        }
+        solClient_msg_free ( &msg_p );
+    }
+    *encodeNs_p = ( double ) ( getTimeInUs (  ) - startUs ) * 1000.0 / iterations;
+
+    if ( ( rc = bench_encode ( &msg_p, sent_p, useMap, useCodec ) ) != SOLCLIENT_OK ) {
+        return rc;
+    }
+    startUs = getTimeInUs (  );
+    for ( i = 0; i < iterations; i++ ) {
+        if ( ( rc = bench_decode ( msg_p, useMap, useCodec, &quote ) ) != SOLCLIENT_OK ) {
+            solClient_msg_free ( &msg_p );
+            return rc;
+        }
+    }
+    *decodeNs_p = ( double ) ( getTimeInUs (  ) - startUs ) * 1000.0 / iterations;
+    solClient_msg_free ( &msg_p );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             iterations = BENCH_DEFAULT_ITERATIONS;
+
+    quote_t         sent;
+    quote_t         quote;
+    quote_t         baseQuote;
+    solClient_uint8_t book[160];
+    solClient_opaqueMsg_pt msg_p;
+    double          baseEncodeNs;
+    double          baseDecodeNs;
+    double          codecEncodeNs;
+    double          codecDecodeNs;
+    const char     *badField_p = NULL;
+    int             useMap;
+
+    printf ( "\nSdtCodecBench.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               0,                      /* required parameters */
+                               ( LOG_LEVEL_MASK |
+                                POOL_TUNING_MASK |
+                                PROFILE_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[ITERATIONS]  Messages encoded and decoded per measurement (default 200000).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        iterations = atoi ( argv[optind++] );
+    }
+    if ( iterations < 1 ) {
+        printf ( "Invalid ITERATIONS\n" );
+        exit(1);
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    bench_fillQuote ( &sent, book, sizeof ( book ) );
+    printf ( "%d fields, %u bytes as a stream, %u bytes as a map (upper bounds), %d iterations\n\n",
+             0 QUOTE_FIELDS ( BENCH_COUNT_ ), ( unsigned int ) quote_streamSize ( &sent ),
+             ( unsigned int ) quote_mapSize ( &sent ), iterations );
+
+    /*************************************************************************
+     * Check both decoders, then time them
+     *************************************************************************/
+
+    for ( useMap = 0; useMap <= 1; useMap++ ) {
+        if ( ( rc = bench_encode ( &msg_p, &sent, useMap, 1 ) ) != SOLCLIENT_OK ) {
+            goto cleanup;
+        }
+        rc = bench_decode ( msg_p, useMap, 1, &quote );
+        if ( rc == SOLCLIENT_OK ) {
+            rc = bench_decode ( msg_p, useMap, 0, &baseQuote );
+        }
+        if ( rc == SOLCLIENT_OK && ( ( badField_p = bench_check ( &sent, &quote ) ) != NULL ||
+                                     ( badField_p = bench_check ( &sent, &baseQuote ) ) != NULL ) ) {
+            printf ( "Decoded %s field '%s' does not match what was encoded\n", useMap ? "map" : "stream", badField_p );
+            rc = SOLCLIENT_FAIL;
+        }
+        solClient_msg_free ( &msg_p );
+        if ( rc != SOLCLIENT_OK ) {
+            goto cleanup;
+        }
+    }
+
+    quote_mapFallbacks = 0;
+    printf ( "%-8s %-8s %14s %14s %9s\n", "Format", "Op", "Baseline ns", "Codec ns", "Speedup" );
+    for ( useMap = 0; useMap <= 1; useMap++ ) {
+        if ( ( rc = bench_run ( &sent, useMap, 0, iterations, &baseEncodeNs, &baseDecodeNs ) ) != SOLCLIENT_OK ||
+             ( rc = bench_run ( &sent, useMap, 1, iterations, &codecEncodeNs, &codecDecodeNs ) ) != SOLCLIENT_OK ) {
+            goto cleanup;
+        }
+        printf ( "%-8s %-8s %14.0f %14.0f %8.2fx\n", useMap ? "map" : "stream", "encode",
+                 baseEncodeNs, codecEncodeNs, codecEncodeNs > 0.0 ? baseEncodeNs / codecEncodeNs : 0.0 );
+        printf ( "%-8s %-8s %14.0f %14.0f %8.2fx\n", useMap ? "map" : "stream", "decode",
+                 baseDecodeNs, codecDecodeNs, codecDecodeNs > 0.0 ? baseDecodeNs / codecDecodeNs : 0.0 );
+    }
+    printf ( "\n%llu of %d codec map decodes fell back to lookups by name\n",
+             ( unsigned long long ) quote_mapFallbacks, iterations );
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    return 0;
+
+}
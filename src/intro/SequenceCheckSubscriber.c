@@ -0,0 +1,341 @@
+
+/** @example Intro/SequenceCheckSubscriber.c
+ */
+
+/*
+ * This sample checks the sender sequence numbers of the messages it
+ * receives on a topic, per sender, and reports gaps, duplicates and
+ * reordered messages using a sequence tracker (see common_seqTracker_init()).
+ *
+ * Publishers must send a sender ID and a sequence number with each message,
+ * which the samples do by default (see "--metadata").
+ *
+ * In the "bench" mode, no connection is made: a synthetic stream from many
+ * senders, with some messages dropped, duplicated or swapped, is fed to the
+ * tracker to measure its cost per message and check what it detects.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "seqtracker.h"
+#include "getopt.h"
+
+#define SEQCHECK_DEFAULT_SECONDS        30
+#define SEQCHECK_DEFAULT_MAX_SENDERS    4096
+#define SEQCHECK_DEFAULT_BENCH_MSGS     10000000
+
+/* Gap events printed per report; the rest are only counted. */
+#define SEQCHECK_MAX_EVENTS_PRINTED     10
+
+/* Senders printed in the final statistics. */
+#define SEQCHECK_MAX_SENDERS_PRINTED    20
+
+/* In the bench mode, one message in this many is dropped, one duplicated and one swapped. */
+#define SEQCHECK_BENCH_FAULT_RATE       1000
+
+/* The tracker is used from the Context thread and read by the main thread. */
+static common_seqTracker_t tracker;
+static MUTEX_T  trackerMutex;
+
+
+/*****************************************************************************
+ * seqcheck_messageReceiveCallback
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+seqcheck_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    mutexLock ( &trackerMutex );
+    common_seqTracker_trackMsg ( &tracker, msg_p );
+    mutexUnlock ( &trackerMutex );
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * seqcheck_printGapEvents
+ *
+ * Print the gap events recorded since the cursor. Called with the tracker
+ * locked.
+ *****************************************************************************/
+static void
+seqcheck_printGapEvents ( solClient_uint64_t *cursor_p )
+{
+    common_seqGapEvent_t event;
+    solClient_uint64_t skipped = 0;
+    int             printed = 0;
+
+    while ( common_seqTracker_nextGapEvent ( &tracker, cursor_p, &event, &skipped ) ) {
+        if ( printed < SEQCHECK_MAX_EVENTS_PRINTED ) {
+            printf ( "  Gap from '%s': %lld missing from %lld\n", event.sender_p->senderId,
+                     ( long long ) event.numMissing, ( long long ) event.firstMissing );
+            printed++;
+        } else {
+            skipped++;
+        }
+    }
+    if ( skipped > 0 ) {
+        printf ( "  ... and %llu more gaps\n", ( unsigned long long ) skipped );
+    }
+}
+
+
+/*****************************************************************************
+ * seqcheck_bench
+ *
+ * Feed a synthetic stream to the tracker. Sender IDs are prepared up front,
+ * so the timed loop only runs the tracker and a random number generator.
+ *****************************************************************************/
+static int
+seqcheck_bench ( int numSenders, int numMsgs )
+{
+    char           *senderIds_p;
+    solClient_int64_t *nextSeq_p;
+    unsigned int    random = 2463534242U;
+    int             sender;
+    int             fault;
+    int             drops = 0;
+    int             dups = 0;
+    int             swaps = 0;
+    int             i;
+    UINT64          startUs;
+    UINT64          elapsedUs;
+
+    senderIds_p = ( char * ) malloc ( ( size_t ) numSenders * COMMON_SEQ_MAX_SENDER_ID );
+    nextSeq_p = ( solClient_int64_t * ) malloc ( ( size_t ) numSenders * sizeof ( solClient_int64_t ) );
+    if ( senderIds_p == NULL || nextSeq_p == NULL ||
+         common_seqTracker_init ( &tracker, ( unsigned int ) numSenders ) != SOLCLIENT_OK ) {
+        printf ( "Could not allocate the benchmark\n" );
+        free ( senderIds_p );
+        free ( nextSeq_p );
+        return -1;
+    }
+    for ( sender = 0; sender < numSenders; sender++ ) {
+        sprintf ( &senderIds_p[sender * COMMON_SEQ_MAX_SENDER_ID], "host%04d/%d/#00000001", sender % 1000, sender );
+        nextSeq_p[sender] = 1;
+    }
+
+    startUs = getTimeInUs (  );
+    for ( i = 0; i < numMsgs; i++ ) {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        sender = ( int ) ( random % ( unsigned int ) numSenders );
+        fault = ( int ) ( ( random >> 16 ) % SEQCHECK_BENCH_FAULT_RATE );
+        if ( fault == 0 ) {
+            nextSeq_p[sender]++;
+            drops++;
+            continue;
+        }
+        if ( fault == 1 ) {
+            /* Swap with the next message from this sender: a gap, then a late arrival. */
+            common_seqTracker_track ( &tracker, &senderIds_p[sender * COMMON_SEQ_MAX_SENDER_ID], nextSeq_p[sender] + 1 );
+            common_seqTracker_track ( &tracker, &senderIds_p[sender * COMMON_SEQ_MAX_SENDER_ID], nextSeq_p[sender] );
+            nextSeq_p[sender] += 2;
+            swaps++;
+            continue;
+        }
+        common_seqTracker_track ( &tracker, &senderIds_p[sender * COMMON_SEQ_MAX_SENDER_ID], nextSeq_p[sender] );
+        if ( fault == 2 ) {
+            common_seqTracker_track ( &tracker, &senderIds_p[sender * COMMON_SEQ_MAX_SENDER_ID], nextSeq_p[sender] );
+            dups++;
+        }
+        nextSeq_p[sender]++;
+    }
+    elapsedUs = getTimeInUs (  ) - startUs;
+
+    printf ( "Tracked %llu messages from %d senders in %.3f s: %.1f M msgs/s, %.1f ns/msg\n",
+             ( unsigned long long ) tracker.totals.received, numSenders, ( double ) elapsedUs / 1000000.0,
+             elapsedUs > 0 ? ( double ) tracker.totals.received / ( double ) elapsedUs : 0.0,
+             tracker.totals.received > 0 ? ( double ) elapsedUs * 1000.0 / ( double ) tracker.totals.received : 0.0 );
+    printf ( "Injected %d drops, %d duplicates, %d swaps\n", drops, dups, swaps );
+    printf ( "Detected %llu gaps (%llu missing, of which %llu arrived late and %llu were lost), %llu duplicates\n\n",
+             ( unsigned long long ) tracker.totals.gapEvents, ( unsigned long long ) tracker.totals.missing,
+             ( unsigned long long ) tracker.totals.reordered, ( unsigned long long ) tracker.totals.lost,
+             ( unsigned long long ) tracker.totals.duplicates );
+    common_seqTracker_printStats ( &tracker, 0 );
+
+    common_seqTracker_destroy ( &tracker );
+    free ( senderIds_p );
+    free ( nextSeq_p );
+    return 0;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             seconds = SEQCHECK_DEFAULT_SECONDS;
+    int             maxSenders = SEQCHECK_DEFAULT_MAX_SENDERS;
+    int             benchMsgs = SEQCHECK_DEFAULT_BENCH_MSGS;
+    int             bench = 0;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    solClient_uint64_t eventCursor = 0;
+    int             elapsed;
+
+    printf ( "\nSequenceCheckSubscriber.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               0,                      /* required parameters; --cu unless benchmarking */
+                               ( HOST_PARAM_MASK |
+                                USER_PARAM_MASK |
+                                DEST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[SECONDS] [MAX_SENDERS]   Check the messages received on the topic (default\n"
+            "\t                          " COMMON_MY_SAMPLE_TOPIC ") for SECONDS (default 30),\n"
+            "\t                          tracking up to MAX_SENDERS senders (default 4096).\n"
+            "\tbench [SENDERS] [MSGS]    Benchmark the tracker without connecting (default 4096\n"
+            "\t                          senders, 10000000 messages).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc && strcmp ( argv[optind], "bench" ) == 0 ) {
+        bench = 1;
+        optind++;
+        if ( optind < argc ) {
+            maxSenders = atoi ( argv[optind++] );
+        }
+        if ( optind < argc ) {
+            benchMsgs = atoi ( argv[optind++] );
+        }
+    } else {
+        if ( optind < argc ) {
+            seconds = atoi ( argv[optind++] );
+        }
+        if ( optind < argc ) {
+            maxSenders = atoi ( argv[optind++] );
+        }
+    }
+    if ( seconds < 1 || maxSenders < 1 || benchMsgs < 1 ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    if ( bench ) {
+        return seqcheck_bench ( maxSenders, benchMsgs ) == 0 ? 0 : 1;
+    }
+    if ( commandOpts.username[0] == '\0' && !commandOpts.useGSS ) {
+        printf ( "Missing required parameter '--cu'\n" );
+        exit(1);
+    }
+    if ( commandOpts.destinationName[0] == '\0' ) {
+        strcpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC );
+    }
+
+    if ( common_seqTracker_init ( &tracker, ( unsigned int ) maxSenders ) != SOLCLIENT_OK ) {
+        exit(1);
+    }
+    mutexInit ( &trackerMutex );
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context, connect a Session and subscribe
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 seqcheck_messageReceiveCallback,
+                                                 common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    if ( ( rc = solClient_session_topicSubscribeExt ( session_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                      commandOpts.destinationName ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicSubscribeExt()" );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Report once a second
+     *************************************************************************/
+
+    printf ( "Checking sequence numbers on '%s' for %d s\n", commandOpts.destinationName, seconds );
+    for ( elapsed = 1; elapsed <= seconds; elapsed++ ) {
+        SLEEP ( 1 );
+        mutexLock ( &trackerMutex );
+        printf ( "%3d s: %llu received from %u senders, %llu gaps, %llu reordered, %llu lost, %llu duplicates\n",
+                 elapsed, ( unsigned long long ) tracker.totals.received, tracker.numSenders,
+                 ( unsigned long long ) tracker.totals.gapEvents, ( unsigned long long ) tracker.totals.reordered,
+                 ( unsigned long long ) tracker.totals.lost, ( unsigned long long ) tracker.totals.duplicates );
+        seqcheck_printGapEvents ( &eventCursor );
+        mutexUnlock ( &trackerMutex );
+    }
+
+    if ( ( rc = solClient_session_topicUnsubscribeExt ( session_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                        commandOpts.destinationName ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicUnsubscribeExt()" );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  sessionConnected:
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+    printf ( "\n" );
+    common_seqTracker_printStats ( &tracker, SEQCHECK_MAX_SENDERS_PRINTED );
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    mutexDestroy ( &trackerMutex );
+    common_seqTracker_destroy ( &tracker );
+    return 0;
+
+}
@@ -0,0 +1,223 @@
+
+/** @example Intro/SubscriptionRegistry.c
+ */
+
+/*
+ * This sample keeps its topic subscriptions in a subscription registry (see
+ * common_subRegistry_init()) instead of having the API reapply them when
+ * the Session reconnects. The registry subscribes again in pipelined
+ * batches of up to WINDOW confirmed subscriptions, critical topics first,
+ * and reports how long it took to be fully subscribed again.
+ *
+ * The topics are <topic>/0 to <topic>/<TOPICS - 1>, where <topic> is given
+ * with "--topic" (default my/sample/topic); the first CRITICAL of them have
+ * a higher priority. The sample runs for SECONDS; bounce its connection
+ * (for example, disable and enable the client username on the message
+ * router) to see the subscriptions reapplied.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "subregistry.h"
+#include "getopt.h"
+
+#define REGISTRY_DEFAULT_TOPICS     20000
+#define REGISTRY_DEFAULT_CRITICAL   100
+#define REGISTRY_DEFAULT_WINDOW     256
+#define REGISTRY_DEFAULT_SECONDS    60
+#define REGISTRY_PRIORITY_CRITICAL  1
+#define REGISTRY_PRIORITY_NORMAL    0
+
+/* Messages received, by the Context thread. */
+static solClient_uint64_t msgsReceived = 0;
+
+
+/*****************************************************************************
+ * registry_messageReceiveCallback
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+registry_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    msgsReceived++;
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             numTopics = REGISTRY_DEFAULT_TOPICS;
+    int             numCritical = REGISTRY_DEFAULT_CRITICAL;
+    int             window = REGISTRY_DEFAULT_WINDOW;
+    int             seconds = REGISTRY_DEFAULT_SECONDS;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    common_subRegistry_t registry;
+    char            topic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 1];
+    solClient_uint64_t runsDone;
+    int             i;
+
+    printf ( "\nSubscriptionRegistry.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                DEST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[TOPICS] [CRITICAL] [WINDOW] [SECONDS]   Subscribe to TOPICS topics (default 20000),\n"
+            "\t                          the first CRITICAL first (default 100), with up to WINDOW\n"
+            "\t                          confirmations outstanding (default 256), for SECONDS (default 60).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        numTopics = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        numCritical = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        window = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        seconds = atoi ( argv[optind++] );
+    }
+    if ( numTopics < 1 || numCritical < 0 || window < 1 || seconds < 0 ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    if ( commandOpts.destinationName[0] == '\0' ) {
+        strcpy ( commandOpts.destinationName, COMMON_MY_SAMPLE_TOPIC );
+    }
+    if ( strlen ( commandOpts.destinationName ) + 12 > sizeof ( topic ) ) {
+        printf ( "Topic too long\n" );
+        exit(1);
+    }
+    /* The registry reapplies the subscriptions, not the API. */
+    commandOpts.reapplySubscriptions = 0;
+
+    /*************************************************************************
+     * Record the subscriptions
+     *************************************************************************/
+
+    if ( common_subRegistry_init ( &registry, ( unsigned int ) numTopics, ( unsigned int ) window ) != SOLCLIENT_OK ) {
+        exit(1);
+    }
+    for ( i = 0; i < numTopics; i++ ) {
+        if ( ( unsigned int ) snprintf ( topic, sizeof ( topic ), "%s/%d", commandOpts.destinationName, i ) >= sizeof ( topic ) ) {
+            printf ( "Topic '%s' is too long\n", commandOpts.destinationName );
+            common_subRegistry_destroy ( &registry );
+            exit(1);
+        }
+        common_subRegistry_add ( &registry, topic,
+                                 i < numCritical ? REGISTRY_PRIORITY_CRITICAL : REGISTRY_PRIORITY_NORMAL );
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context and connect a Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    /* The registry is the user_p of its event callback. */
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 registry_messageReceiveCallback,
+                                                 common_subRegistry_eventCallback, &registry, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    /*************************************************************************
+     * Subscribe, then reapply on every reconnect
+     *************************************************************************/
+
+    printf ( "Subscribing to %d topics %s/0..%d, the first %d critical, window %d\n", numTopics,
+             commandOpts.destinationName, numTopics - 1, numCritical, window );
+    common_subRegistry_apply ( &registry, session_p );
+    if ( common_subRegistry_waitApplied ( &registry, 60000, NULL ) != SOLCLIENT_OK ) {
+        printf ( "Not fully subscribed after 60 s\n" );
+    }
+    common_subRegistry_printStats ( &registry );
+    runsDone = registry.stats.runsDone;
+
+    printf ( "Waiting %d seconds for reconnects\n", seconds );
+    for ( i = 0; i < seconds; i++ ) {
+        sleepInUs ( 1000000 );
+        common_subRegistry_waitApplied ( &registry, 0, NULL );
+        if ( registry.stats.runsDone != runsDone ) {
+            runsDone = registry.stats.runsDone;
+            printf ( "Reconnected and resubscribed:\n" );
+            common_subRegistry_printStats ( &registry );
+        }
+    }
+    printf ( "Messages received: %llu\n", ( unsigned long long ) msgsReceived );
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    common_subRegistry_destroy ( &registry );
+    return 0;
+
+}
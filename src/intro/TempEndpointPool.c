@@ -0,0 +1,350 @@
+
+/** @example Intro/TempEndpointPool.c
+ */
+
+/*
+ * This sample runs JOBS short-lived workflows, each of which needs its own
+ * temporary Queue: it sends MSGS persistent messages to the Queue and waits
+ * for them to come back on its Flow. With "pool" the Queues come from an
+ * endpoint pool (see common_endpointPool_init()) that keeps POOL of them
+ * bound in the background, and each is released for reuse after its job;
+ * with "ondemand" every job binds a Flow to a new temporary Queue and
+ * destroys it when done. The time per job shows what the bind round-trip
+ * adds to the critical path.
+ *
+ * Sample Requirements:
+ *  - The message router connection must allow temporary endpoints.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "endpointpool.h"
+#include "getopt.h"
+
+#define EPOOL_DEFAULT_JOBS      1000
+#define EPOOL_DEFAULT_POOL      32
+#define EPOOL_DEFAULT_MSGS      1
+#define EPOOL_JOB_TIMEOUT_US    5000000
+
+/* Messages received by the current job, by the Context thread. */
+static volatile int jobMsgsReceived = 0;
+
+
+/*****************************************************************************
+ * epool_jobMessageReceiveCallback
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+epool_jobMessageReceiveCallback ( solClient_opaqueFlow_pt opaqueFlow_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    jobMsgsReceived++;
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * epool_bindTemporaryQueue
+ *
+ * Bind a Flow to a new temporary Queue, waiting for the bind.
+ *****************************************************************************/
+static          solClient_returnCode_t
+epool_bindTemporaryQueue ( solClient_opaqueSession_pt session_p, solClient_opaqueFlow_pt * flow_p )
+{
+    solClient_returnCode_t rc;
+    solClient_flow_createFuncInfo_t flowFuncInfo = SOLCLIENT_FLOW_CREATEFUNC_INITIALIZER;
+    const char     *flowProps[20] = {0, };
+    int             propIndex = 0;
+
+    flowFuncInfo.rxMsgInfo.callback_p = epool_jobMessageReceiveCallback;
+    flowFuncInfo.eventInfo.callback_p = common_flowEventCallback;
+
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_BLOCKING;
+    flowProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_ID;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_QUEUE;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_DURABLE;
+    flowProps[propIndex++] = SOLCLIENT_PROP_DISABLE_VAL;
+    flowProps[propIndex] = NULL;
+
+    if ( ( rc = solClient_session_createFlow ( ( char ** ) flowProps, session_p, flow_p,
+                                               &flowFuncInfo, sizeof ( flowFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_createFlow()" );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * epool_runJob
+ *
+ * Send numMsgs persistent messages to a Queue and wait for them to be
+ * received.
+ *****************************************************************************/
+static          solClient_returnCode_t
+epool_runJob ( solClient_opaqueSession_pt session_p, solClient_destination_t * destination_p, int numMsgs )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt msg_p = NULL;
+    UINT64          deadlineUs;
+    int             i;
+
+    solClient_msg_alloc ( &msg_p );
+    solClient_msg_setDeliveryMode ( msg_p, SOLCLIENT_DELIVERY_MODE_PERSISTENT );
+    solClient_msg_setDestination ( msg_p, destination_p, sizeof ( *destination_p ) );
+    solClient_msg_setBinaryAttachment ( msg_p, "job", 3 );
+    for ( i = 0; i < numMsgs; i++ ) {
+        if ( ( rc = solClient_session_sendMsg ( session_p, msg_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_sendMsg()" );
+            break;
+        }
+    }
+    solClient_msg_free ( &msg_p );
+
+    deadlineUs = getTimeInUs (  ) + EPOOL_JOB_TIMEOUT_US;
+    while ( rc == SOLCLIENT_OK && jobMsgsReceived < numMsgs ) {
+        if ( getTimeInUs (  ) >= deadlineUs ) {
+            printf ( "Job timed out with %d of %d messages\n", jobMsgsReceived, numMsgs );
+            rc = SOLCLIENT_INCOMPLETE;
+            break;
+        }
+        sleepInUs ( 50 );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             numJobs = EPOOL_DEFAULT_JOBS;
+    int             poolSize = EPOOL_DEFAULT_POOL;
+    int             numMsgs = EPOOL_DEFAULT_MSGS;
+    int             usePool = 1;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    /* Endpoints */
+    common_endpointPool_t pool;
+    common_endpoint_pt endpoint_p;
+    solClient_opaqueFlow_pt flow_p = NULL;
+    solClient_destination_t destination;
+
+    solClient_uint64_t *jobUs_p = NULL;
+    solClient_uint64_t *setupUs_p = NULL;
+    int             jobsDone = 0;
+    int             jobsFailed = 0;
+    UINT64          startUs;
+    UINT64          setupUs;
+    UINT64          runStartUs;
+    int             i;
+
+    printf ( "\nTempEndpointPool.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[JOBS] [POOL] [MSGS] [pool|ondemand]   Run JOBS jobs (default 1000) of MSGS messages\n"
+            "\t                          (default 1), each on its own temporary Queue, taken from a\n"
+            "\t                          pool of POOL (default 32) or bound on demand (default pool).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        numJobs = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        poolSize = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        numMsgs = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        if ( strcmp ( argv[optind], "pool" ) == 0 ) {
+            usePool = 1;
+        } else if ( strcmp ( argv[optind], "ondemand" ) == 0 ) {
+            usePool = 0;
+        } else {
+            printf ( "Unknown mode '%s'\n", argv[optind] );
+            exit(1);
+        }
+        optind++;
+    }
+    if ( numJobs < 1 || poolSize < 1 || numMsgs < 1 ) {
+        printf ( "Invalid arguments\n" );
+        exit(1);
+    }
+    jobUs_p = ( solClient_uint64_t * ) malloc ( numJobs * sizeof ( solClient_uint64_t ) );
+    setupUs_p = ( solClient_uint64_t * ) malloc ( numJobs * sizeof ( solClient_uint64_t ) );
+    if ( jobUs_p == NULL || setupUs_p == NULL ) {
+        printf ( "Could not allocate the samples of %d jobs\n", numJobs );
+        free ( jobUs_p );
+        free ( setupUs_p );
+        exit(1);
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context and connect a Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 common_messageReceivePrintMsgCallback,
+                                                 common_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    if ( !solClient_session_isCapable ( session_p, SOLCLIENT_SESSION_CAPABILITY_TEMP_ENDPOINT ) ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Temporary endpoints are not supported on this client connection." );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Fill the pool
+     *************************************************************************/
+
+    if ( usePool ) {
+        if ( common_endpointPool_init ( &pool, session_p, ( unsigned int ) poolSize,
+                                        ( unsigned int ) poolSize * 2 ) != SOLCLIENT_OK ) {
+            goto sessionConnected;
+        }
+        startUs = getTimeInUs (  );
+        if ( common_endpointPool_waitReady ( &pool, 30000 ) != SOLCLIENT_OK ) {
+            printf ( "Pool not full after 30 s\n" );
+        }
+        printf ( "Pool of %d temporary Queues bound in %.3f ms\n", poolSize, ( getTimeInUs (  ) - startUs ) / 1000.0 );
+    }
+
+    /*************************************************************************
+     * Run the jobs
+     *************************************************************************/
+
+    printf ( "Running %d jobs of %d messages, %s\n", numJobs, numMsgs,
+             usePool ? "temporary Queues from the pool" : "binding a temporary Queue per job" );
+    runStartUs = getTimeInUs (  );
+    for ( i = 0; i < numJobs; i++ ) {
+        startUs = getTimeInUs (  );
+        jobMsgsReceived = 0;
+        endpoint_p = NULL;
+        if ( usePool ) {
+            /* Should the pool run dry, wait for the pool thread. */
+            while ( ( endpoint_p = common_endpointPool_acquire ( &pool, epool_jobMessageReceiveCallback, NULL ) ) == NULL ) {
+                sleepInUs ( COMMON_EPOOL_POLL_US );
+            }
+            destination = endpoint_p->destination;
+        } else {
+            if ( epool_bindTemporaryQueue ( session_p, &flow_p ) != SOLCLIENT_OK ||
+                 solClient_flow_getDestination ( flow_p, &destination, sizeof ( destination ) ) != SOLCLIENT_OK ) {
+                jobsFailed++;
+                if ( flow_p != NULL ) {
+                    solClient_flow_destroy ( &flow_p );
+                }
+                continue;
+            }
+        }
+        setupUs = getTimeInUs (  );
+
+        if ( ( rc = epool_runJob ( session_p, &destination, numMsgs ) ) == SOLCLIENT_OK ) {
+            setupUs_p[jobsDone] = setupUs - startUs;
+            jobUs_p[jobsDone++] = getTimeInUs (  ) - startUs;
+        } else {
+            jobsFailed++;
+        }
+
+        if ( usePool ) {
+            /* Messages left by a failed job would go to the next one. */
+            common_endpointPool_release ( endpoint_p, rc == SOLCLIENT_OK );
+        } else {
+            solClient_flow_destroy ( &flow_p );
+        }
+    }
+    printf ( "%d jobs done, %d failed in %.3f s (%.0f jobs/s)\n", jobsDone, jobsFailed,
+             ( getTimeInUs (  ) - runStartUs ) / 1000000.0,
+             jobsDone * 1000000.0 / ( getTimeInUs (  ) - runStartUs ) );
+    if ( jobsDone > 0 ) {
+        common_sortSamples ( setupUs_p, jobsDone );
+        common_sortSamples ( jobUs_p, jobsDone );
+        printf ( "Endpoint setup us: p50 %llu, p99 %llu, max %llu\n",
+                 ( unsigned long long ) common_getPercentile ( setupUs_p, jobsDone, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( setupUs_p, jobsDone, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( setupUs_p, jobsDone, 100.0 ) );
+        printf ( "Job us:            p50 %llu, p99 %llu, max %llu\n",
+                 ( unsigned long long ) common_getPercentile ( jobUs_p, jobsDone, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( jobUs_p, jobsDone, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( jobUs_p, jobsDone, 100.0 ) );
+    }
+    if ( usePool ) {
+        common_endpointPool_printStats ( &pool );
+        common_endpointPool_destroy ( &pool );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  sessionConnected:
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    free ( jobUs_p );
+    free ( setupUs_p );
+    return 0;
+
+}
@@ -0,0 +1,388 @@
+
+/** @example Intro/TimerWheelBench.c
+ */
+
+/*
+ * This sample measures the timer wheel (see common_timerWheel_init()) that
+ * the samples use for large numbers of request timeouts and periodic tasks.
+ *
+ * First, without a Context, a wheel is filled with TIMERS timers spread over
+ * ten minutes, half of them are cancelled, and the wheel is advanced tick by
+ * tick until the rest have fired. It reports the cost of each operation and
+ * checks that every timer fired on exactly its tick.
+ *
+ * Then a wheel is driven by a Context timer, with the Context created with a
+ * timer resolution of TICK_MS, and the time each of a few thousand timers
+ * fires after its deadline is reported, along with a periodic timer.
+ *
+ * No connection is made.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "timerwheel.h"
+#include "getopt.h"
+
+#define TWB_DEFAULT_TIMERS          1000000
+#define TWB_DEFAULT_TICK_MS         10
+
+/* Offline timers are spread over this span. */
+#define TWB_OFFLINE_SPAN_MS         600000
+
+/* Live timers, spread over TWB_LIVE_SPAN_MS, and the periodic timer. */
+#define TWB_LIVE_TIMERS             10000
+#define TWB_LIVE_SPAN_MS            2000
+#define TWB_PERIOD_MS               100
+
+/* Ticks processed per call to common_timerWheel_advance() offline. */
+#define TWB_ADVANCE_CHUNK           4096
+
+typedef struct twb_stats
+{
+    common_timerWheel_pt wheel_p;
+    solClient_uint64_t fired;
+    solClient_uint64_t wrongTick;
+    solClient_uint64_t *lateUs_p;   /**< Live: how late each timer fired. */
+    int             numLate;
+    UINT64          periodStartUs;
+    solClient_uint64_t periodFired;
+    UINT64          periodLateUs;   /**< Live: how late the periodic timer last fired. */
+} twb_stats_t;
+
+static twb_stats_t twbStats;
+
+/*****************************************************************************
+ * twb_random
+ *
+ * A small xorshift generator, so runs are repeatable.
+ *****************************************************************************/
+static          solClient_uint32_t
+twb_random ( solClient_uint32_t * state_p )
+{
+    solClient_uint32_t x = *state_p;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state_p = x;
+    return x;
+}
+
+/*****************************************************************************
+ * twb_offlineCallback
+ *
+ * user_p is the tick the timer is expected on.
+ *****************************************************************************/
+static void
+twb_offlineCallback ( common_timerId_t timerId, void *user_p )
+{
+    /* The wheel's now is one past the tick being processed. */
+    if ( twbStats.wheel_p->now - 1 != *( solClient_uint32_t * ) user_p ) {
+        twbStats.wrongTick++;
+    }
+    twbStats.fired++;
+}
+
+/*****************************************************************************
+ * twb_liveCallback
+ *
+ * user_p is the deadline of the timer, in us.
+ *****************************************************************************/
+static void
+twb_liveCallback ( common_timerId_t timerId, void *user_p )
+{
+    UINT64          nowUs = getTimeInUs (  );
+    UINT64          deadlineUs = *( UINT64 * ) user_p;
+
+    if ( nowUs < deadlineUs ) {
+        /* Early. */
+        twbStats.wrongTick++;
+    } else {
+        twbStats.lateUs_p[twbStats.numLate++] = nowUs - deadlineUs;
+    }
+    twbStats.fired++;
+}
+
+/*****************************************************************************
+ * twb_periodicCallback
+ *****************************************************************************/
+static void
+twb_periodicCallback ( common_timerId_t timerId, void *user_p )
+{
+    twbStats.periodFired++;
+    twbStats.periodLateUs = getTimeInUs (  ) - twbStats.periodStartUs -
+        twbStats.periodFired * TWB_PERIOD_MS * 1000;
+}
+
+/*****************************************************************************
+ * twb_runOffline
+ *****************************************************************************/
+static          solClient_returnCode_t
+twb_runOffline ( int numTimers, unsigned int tickMs )
+{
+    solClient_returnCode_t rc;
+    common_timerWheel_t wheel;
+    common_timerId_t *ids_p = NULL;
+    solClient_uint32_t *expectedTick_p = NULL;
+    solClient_uint32_t seed = 0x2545F491;
+    solClient_uint32_t delayMs;
+    solClient_uint64_t numCancelled = 0;
+    solClient_uint64_t numTicks = 0;
+    UINT64          startUs;
+    UINT64          scheduleUs;
+    UINT64          cancelUs;
+    UINT64          expireUs;
+    int             i;
+
+    if ( ( rc = common_timerWheel_init ( &wheel, ( unsigned int ) numTimers, tickMs ) ) != SOLCLIENT_OK ) {
+        return rc;
+    }
+    memset ( &twbStats, 0, sizeof ( twbStats ) );
+    twbStats.wheel_p = &wheel;
+    if ( ( ids_p = ( common_timerId_t * ) malloc ( numTimers * sizeof ( *ids_p ) ) ) == NULL ||
+         ( expectedTick_p = ( solClient_uint32_t * ) malloc ( numTimers * sizeof ( *expectedTick_p ) ) ) == NULL ) {
+        printf ( "Could not allocate %d timers\n", numTimers );
+        rc = SOLCLIENT_FAIL;
+        goto cleanup;
+    }
+
+    startUs = getTimeInUs (  );
+    for ( i = 0; i < numTimers; i++ ) {
+        delayMs = twb_random ( &seed ) % ( TWB_OFFLINE_SPAN_MS + 1 );
+        expectedTick_p[i] = ( delayMs + tickMs - 1 ) / tickMs;
+        if ( ( rc = common_timerWheel_schedule ( &wheel, delayMs, 0, twb_offlineCallback,
+                                                 &expectedTick_p[i], &ids_p[i] ) ) != SOLCLIENT_OK ) {
+            printf ( "Could not schedule timer %d\n", i );
+            goto cleanup;
+        }
+    }
+    scheduleUs = getTimeInUs (  ) - startUs;
+
+    startUs = getTimeInUs (  );
+    for ( i = 0; i < numTimers; i += 2 ) {
+        if ( common_timerWheel_cancel ( &wheel, ids_p[i] ) == SOLCLIENT_OK ) {
+            numCancelled++;
+        }
+    }
+    cancelUs = getTimeInUs (  ) - startUs;
+
+    startUs = getTimeInUs (  );
+    while ( wheel.numActive > 0 ) {
+        common_timerWheel_advance ( &wheel, TWB_ADVANCE_CHUNK );
+        numTicks += TWB_ADVANCE_CHUNK;
+    }
+    expireUs = getTimeInUs (  ) - startUs;
+
+    /* A cancelled or fired timer's ID must now be rejected. */
+    if ( common_timerWheel_cancel ( &wheel, ids_p[0] ) != SOLCLIENT_NOT_FOUND ||
+         ( numTimers > 1 && common_timerWheel_cancel ( &wheel, ids_p[1] ) != SOLCLIENT_NOT_FOUND ) ) {
+        printf ( "A stale timer ID was accepted\n" );
+        twbStats.wrongTick++;
+    }
+
+    printf ( "Offline: %d timers over %d s, %u ms ticks, %llu ticks processed\n",
+             numTimers, TWB_OFFLINE_SPAN_MS / 1000, tickMs, ( unsigned long long ) numTicks );
+    printf ( "%-10s %12s %12s\n", "Op", "Count", "ns/op" );
+    printf ( "%-10s %12d %12.1f\n", "schedule", numTimers, scheduleUs * 1000.0 / numTimers );
+    printf ( "%-10s %12llu %12.1f\n", "cancel", ( unsigned long long ) numCancelled,
+             numCancelled > 0 ? cancelUs * 1000.0 / numCancelled : 0.0 );
+    printf ( "%-10s %12llu %12.1f\n", "expire", ( unsigned long long ) twbStats.fired,
+             twbStats.fired > 0 ? expireUs * 1000.0 / twbStats.fired : 0.0 );
+    printf ( "Cascaded %llu, fired on the wrong tick %llu\n\n",
+             ( unsigned long long ) wheel.stats.cascaded, ( unsigned long long ) twbStats.wrongTick );
+    if ( twbStats.fired + numCancelled != ( solClient_uint64_t ) numTimers || twbStats.wrongTick > 0 ) {
+        printf ( "Timer wheel check FAILED\n" );
+        rc = SOLCLIENT_FAIL;
+    }
+
+  cleanup:
+    free ( expectedTick_p );
+    free ( ids_p );
+    common_timerWheel_destroy ( &wheel );
+    return rc;
+}
+
+/*****************************************************************************
+ * twb_runLive
+ *****************************************************************************/
+static          solClient_returnCode_t
+twb_runLive ( unsigned int tickMs )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+    const char     *contextProps[5];
+    char            tickMsStr[16];
+    common_timerWheel_t wheel;
+    common_timerId_t timerId;
+    common_timerId_t periodicId = COMMON_TIMER_ID_INVALID;
+    UINT64         *deadlineUs_p = NULL;
+    solClient_uint32_t seed = 0x9E3779B9;
+    solClient_uint32_t delayMs;
+    int             wait;
+    int             i;
+
+    if ( ( rc = common_timerWheel_init ( &wheel, TWB_LIVE_TIMERS + 1, tickMs ) ) != SOLCLIENT_OK ) {
+        return rc;
+    }
+    memset ( &twbStats, 0, sizeof ( twbStats ) );
+    twbStats.wheel_p = &wheel;
+    if ( ( deadlineUs_p = ( UINT64 * ) malloc ( TWB_LIVE_TIMERS * sizeof ( *deadlineUs_p ) ) ) == NULL ||
+         ( twbStats.lateUs_p = ( solClient_uint64_t * ) malloc ( TWB_LIVE_TIMERS * sizeof ( *twbStats.lateUs_p ) ) ) == NULL ) {
+        printf ( "Could not allocate %d timers\n", TWB_LIVE_TIMERS );
+        rc = SOLCLIENT_FAIL;
+        goto notCreated;
+    }
+
+    /* The Context timer resolution bounds how late the wheel's ticks run. */
+    sprintf ( tickMsStr, "%u", tickMs );
+    contextProps[0] = SOLCLIENT_CONTEXT_PROP_CREATE_THREAD;
+    contextProps[1] = SOLCLIENT_PROP_ENABLE_VAL;
+    contextProps[2] = SOLCLIENT_CONTEXT_PROP_TIME_RES_MS;
+    contextProps[3] = tickMsStr;
+    contextProps[4] = NULL;
+    if ( ( rc = solClient_context_create ( ( solClient_propertyArray_pt ) contextProps,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto notCreated;
+    }
+    if ( ( rc = common_timerWheel_start ( &wheel, context_p ) ) != SOLCLIENT_OK ) {
+        goto notStarted;
+    }
+
+    twbStats.periodStartUs = getTimeInUs (  );
+    if ( ( rc = common_timerWheel_schedule ( &wheel, TWB_PERIOD_MS, TWB_PERIOD_MS, twb_periodicCallback,
+                                             NULL, &periodicId ) ) != SOLCLIENT_OK ) {
+        goto stop;
+    }
+    for ( i = 0; i < TWB_LIVE_TIMERS; i++ ) {
+        delayMs = twb_random ( &seed ) % ( TWB_LIVE_SPAN_MS + 1 );
+        deadlineUs_p[i] = getTimeInUs (  ) + ( UINT64 ) delayMs * 1000;
+        if ( ( rc = common_timerWheel_schedule ( &wheel, delayMs, 0, twb_liveCallback,
+                                                 &deadlineUs_p[i], &timerId ) ) != SOLCLIENT_OK ) {
+            printf ( "Could not schedule timer %d\n", i );
+            goto stop;
+        }
+    }
+
+    /* Wait for every one-shot timer, and a little longer. */
+    for ( wait = 0; wait < 2 * TWB_LIVE_SPAN_MS / 100 && wheel.numActive > 1; wait++ ) {
+        sleepInUs ( 100000 );
+    }
+
+  stop:
+    common_timerWheel_cancel ( &wheel, periodicId );
+    common_timerWheel_stop ( &wheel );
+
+  notStarted:
+    /* Destroying the Context joins its thread, so no callback is running after this. */
+    solClient_context_destroy ( &context_p );
+
+    if ( rc == SOLCLIENT_OK ) {
+        common_sortSamples ( twbStats.lateUs_p, twbStats.numLate );
+        printf ( "Live: %d timers over %d s, %u ms ticks\n", TWB_LIVE_TIMERS, TWB_LIVE_SPAN_MS / 1000, tickMs );
+        printf ( "Fired %llu, early %llu, late us p50 %llu, p99 %llu, max %llu\n",
+                 ( unsigned long long ) twbStats.fired, ( unsigned long long ) twbStats.wrongTick,
+                 ( unsigned long long ) common_getPercentile ( twbStats.lateUs_p, twbStats.numLate, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( twbStats.lateUs_p, twbStats.numLate, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( twbStats.lateUs_p, twbStats.numLate, 100.0 ) );
+        printf ( "Periodic timer (%d ms) fired %llu times, last %lld us from its schedule\n",
+                 TWB_PERIOD_MS, ( unsigned long long ) twbStats.periodFired, ( long long ) twbStats.periodLateUs );
+        if ( twbStats.fired != TWB_LIVE_TIMERS || twbStats.wrongTick > 0 ) {
+            printf ( "Timer wheel check FAILED\n" );
+            rc = SOLCLIENT_FAIL;
+        }
+    }
+
+  notCreated:
+    free ( twbStats.lateUs_p );
+    free ( deadlineUs_p );
+    common_timerWheel_destroy ( &wheel );
+    return rc;
+}
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    int             numTimers = TWB_DEFAULT_TIMERS;
+    int             tickMs = TWB_DEFAULT_TICK_MS;
+
+    printf ( "\nTimerWheelBench.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               0,                      /* required parameters */
+                               ( LOG_LEVEL_MASK |
+                                PROFILE_MASK));                         /* optional parameters */
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\t[TIMERS]      Timers scheduled offline (default 1000000).\n"
+            "\t[TICK_MS]     Tick of the wheel and timer resolution of the Context, 10 or more (default 10).\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( optind < argc ) {
+        numTimers = atoi ( argv[optind++] );
+    }
+    if ( optind < argc ) {
+        tickMs = atoi ( argv[optind++] );
+    }
+    if ( numTimers < 1 ) {
+        printf ( "Invalid TIMERS\n" );
+        exit(1);
+    }
+    if ( tickMs < 10 || tickMs > 10000 ) {
+        printf ( "Invalid TICK_MS\n" );
+        exit(1);
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Run the offline and live measurements
+     *************************************************************************/
+
+    if ( twb_runOffline ( numTimers, ( unsigned int ) tickMs ) == SOLCLIENT_OK ) {
+        twb_runLive ( ( unsigned int ) tickMs );
+    }
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    return 0;
+}
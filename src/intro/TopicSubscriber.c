@@ -18,16 +18,31 @@
  *  This sample shows the basics of creating session, connecting a session,
  *  and receiving a direct message from a topic. This is meant to be a very
  *  basic example for demonstration purposes.
+ *
+ *  When a cache name is given, the sample also requests the cached messages
+ *  of the topic while receiving it live. Received messages pass through a
+ *  topic merge (see common_topicMerge_init()), so a cached copy of an
+ *  update already received live, or a live update received twice, is not
+ *  processed again.
  */
 
 #include "os.h"
 #include "solclient/solClient.h"
 #include "solclient/solClientMsg.h"
+#include "solclient/solCache.h"
+#include "common.h"
+#include "topicmerge.h"
+
+/* Topics whose sequence numbers are tracked. */
+#define TOPIC_MERGE_MAX_TOPICS 65536
 
 
 /* Message Count */
 static int msgCount = 0;
 
+/* Drops cached and live copies of updates already processed. */
+static common_topicMerge_t topicMerge;
+
 /*****************************************************************************
  * sessionMessageReceiveCallback
  *
@@ -37,6 +52,10 @@ static int msgCount = 0;
 solClient_rxMsgCallback_returnCode_t
 sessionMessageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
 {
+    if ( !common_topicMerge_accept ( &topicMerge, msg_p ) ) {
+        return SOLCLIENT_CALLBACK_OK;
+    }
+
     printf ( "Received message:\n" );
     solClient_msg_dump ( msg_p, NULL, 0 );
     printf ( "\n" );
@@ -65,6 +84,8 @@ sessionEventCallback ( solClient_opaqueSession_pt opaqueSession_p,
 int
 main ( int argc, char *argv[] )
 {
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
     /* Context */
     solClient_opaqueContext_pt context_p;
     solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
@@ -77,8 +98,16 @@ main ( int argc, char *argv[] )
     const char     *sessionProps[20] = {0, };
     int             propIndex = 0;
 
+    /* Cache Session */
+    solClient_opaqueCacheSession_pt cacheSession_p = NULL;
+    const char     *cacheProps[3] = {0, };
+
     if ( argc < 6 ) {
-        printf ( "Usage: TopicSubscriber <msg_backbone_ip:port> <vpn> <client-username> <password> <topic>\n" );
+        printf ( "Usage: TopicSubscriber <msg_backbone_ip:port> <vpn> <client-username> <password> <topic> [cache-name]\n" );
+        return -1;
+    }
+
+    if ( common_topicMerge_init ( &topicMerge, TOPIC_MERGE_MAX_TOPICS ) != SOLCLIENT_OK ) {
         return -1;
     }
 
@@ -144,6 +173,26 @@ main ( int argc, char *argv[] )
                                           SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
                                           argv[5] );
 
+    /*************************************************************************
+     * Request the cached messages, while live messages keep flowing
+     *************************************************************************/
+
+    if ( argc > 6 ) {
+        cacheProps[0] = SOLCLIENT_CACHESESSION_PROP_CACHE_NAME;
+        cacheProps[1] = argv[6];
+        /* Without the cache, the live messages are still received. */
+        if ( ( rc = solClient_session_createCacheSession ( cacheProps, session_p, &cacheSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_createCacheSession()" );
+            cacheSession_p = NULL;
+        } else if ( ( rc = solClient_cacheSession_sendCacheRequest ( cacheSession_p, argv[5], 1, common_cacheEventCallback, NULL,
+                                                                     SOLCLIENT_CACHEREQUEST_FLAGS_LIVEDATA_FLOWTHRU |
+                                                                     SOLCLIENT_CACHEREQUEST_FLAGS_NOWAIT_REPLY |
+                                                                     SOLCLIENT_CACHEREQUEST_FLAGS_NO_SUBSCRIBE, 0 ) ) != SOLCLIENT_IN_PROGRESS ) {
+            common_handleError ( rc, "solClient_cacheSession_sendCacheRequest()" );
+            solClient_cacheSession_destroy ( &cacheSession_p );
+        }
+    }
+
     /*************************************************************************
      * Wait for message
      *************************************************************************/
@@ -155,6 +204,7 @@ main ( int argc, char *argv[] )
     }
 
     printf ( "Exiting.\n" );
+    common_topicMerge_printStats ( &topicMerge );
 
     /*************************************************************************
      * Unsubscribe
@@ -168,8 +218,13 @@ main ( int argc, char *argv[] )
      * Cleanup
      *************************************************************************/
 
+    if ( cacheSession_p != NULL ) {
+        solClient_cacheSession_destroy ( &cacheSession_p );
+    }
+
     /* Cleanup solClient. */
     solClient_cleanup (  );
+    common_topicMerge_destroy ( &topicMerge );
 
     return 0;
 }
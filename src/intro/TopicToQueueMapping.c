@@ -91,7 +91,8 @@ main ( int argc, char *argv[] )
                                 PASS_PARAM_MASK |
                                 LOG_LEVEL_MASK |
                                 USE_GSS_MASK |
-                                ZIP_LEVEL_MASK));                       /* optional parameters */
+                                ZIP_LEVEL_MASK |
+                                POOL_TUNING_MASK));                     /* optional parameters */
     if ( common_parseCommandOptions ( argc, argv, &commandOpts, NULL ) == 0 ) {
         exit(1);
     }
@@ -101,8 +102,7 @@ main ( int argc, char *argv[] )
      *************************************************************************/
 
     /* solClient needs to be initialized before any other API calls are made. */
-    if ( ( rc = solClient_initialize ( SOLCLIENT_LOG_DEFAULT_FILTER, NULL ) ) != SOLCLIENT_OK ) {
-        common_handleError ( rc, "solClient_initialize()" );
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
         goto notInitialized;
     }
 
@@ -0,0 +1,557 @@
+
+/** @example Intro/TransactedPipeline.c
+ */
+
+/*
+ * This sample moves messages from one Queue to another inside Transacted
+ * Sessions, and measures how the transaction size affects throughput.
+ *
+ * Each message consumed from the source Queue is republished to the
+ * destination Queue in the same transaction, so a message is either both
+ * removed from the source and delivered to the destination, or neither. A
+ * transaction is committed after N messages, or after T milliseconds if
+ * fewer than N messages arrive in that time.
+ *
+ * When a commit is rolled back (::SOLCLIENT_ROLLBACK), the consumed messages
+ * are redelivered by the source Queue and the transaction is retried. When
+ * the commit status is unknown (::SOLCLIENT_FAIL, for example after a
+ * failover) it is also treated as a rollback, which may duplicate the
+ * messages of that transaction on the destination Queue.
+ *
+ * For each transaction size the source Queue is first filled with the
+ * number of messages given by --mn (unless 'nofill' is given), then drained
+ * through the pipeline. The sample reports commits/s, messages/s and
+ * percentiles of the commit latency (the time solClient_transactedSession_commit()
+ * takes).
+ *
+ * The destination Queue is not drained by this sample.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+/*****************************************************************************
+ *  For Windows builds, os.h should always be included first to ensure that
+ *  _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ *****************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "getopt.h"
+
+#define PIPELINE_DEFAULT_NUM_MSGS      10000
+#define PIPELINE_DEFAULT_SIZES         "1,10,50,100,250"
+#define PIPELINE_DEFAULT_MAX_MS        100
+#define PIPELINE_MAX_SIZES             16
+#define PIPELINE_PAYLOAD_BYTES         256
+
+/* Consecutive rollbacks after which a run is abandoned. */
+#define PIPELINE_MAX_RETRIES           10
+
+/* A run ends when the source Queue delivers nothing for this long. */
+#define PIPELINE_IDLE_TIMEOUT_MS       2000
+
+/* The longest a fill waits for its messages to be acknowledged or rejected. */
+#define PIPELINE_FILL_TIMEOUT_MS       10000
+
+/*
+ * Number of Guaranteed messages acknowledged and rejected on the filling
+ * Session; only updated from the Context thread.
+ */
+static volatile int fillAcks = 0;
+static volatile int fillRejects = 0;
+
+
+/*****************************************************************************
+ * pipeline_eventCallback
+ *
+ * Counts acknowledgements and rejections of the messages used to fill the
+ * source Queue.
+ *****************************************************************************/
+static void
+pipeline_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                         solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    if ( eventInfo_p->sessionEvent == SOLCLIENT_SESSION_EVENT_ACKNOWLEDGEMENT ) {
+        fillAcks++;
+    } else if ( eventInfo_p->sessionEvent == SOLCLIENT_SESSION_EVENT_REJECTED_MSG_ERROR ) {
+        fillRejects++;
+    }
+    common_eventCallback ( opaqueSession_p, eventInfo_p, user_p );
+}
+
+
+/*****************************************************************************
+ * pipeline_buildMsg
+ *
+ * Allocate a Persistent message for a Queue. The caller must free it with
+ * solClient_msg_free(). Guaranteed messages are not taken from the message
+ * pool, as for common_publishPayload().
+ *****************************************************************************/
+static          solClient_returnCode_t
+pipeline_buildMsg ( solClient_opaqueMsg_pt * msg_p, const char *queueName_p, const void *payload_p,
+                    solClient_uint32_t size )
+{
+    solClient_returnCode_t rc;
+    solClient_destination_t destination;
+
+    if ( ( rc = solClient_msg_alloc ( msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_alloc()" );
+        return rc;
+    }
+    destination.destType = SOLCLIENT_QUEUE_DESTINATION;
+    destination.dest = queueName_p;
+    if ( ( rc = solClient_msg_setDeliveryMode ( *msg_p, SOLCLIENT_DELIVERY_MODE_PERSISTENT ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_msg_setDestination ( *msg_p, &destination, sizeof ( destination ) ) ) != SOLCLIENT_OK ||
+         ( rc = solClient_msg_setBinaryAttachment ( *msg_p, payload_p, size ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "pipeline_buildMsg()" );
+        solClient_msg_free ( msg_p );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * pipeline_fillQueue
+ *
+ * Publish numMsgs Persistent messages to a Queue outside any transaction and
+ * wait until they are all acknowledged. Fails if any is rejected, as a full
+ * or shut Queue would leave the next run with fewer messages than reported,
+ * or if they are not all settled within PIPELINE_FILL_TIMEOUT_MS.
+ *****************************************************************************/
+static          solClient_returnCode_t
+pipeline_fillQueue ( solClient_opaqueSession_pt session_p, const char *queueName_p, int numMsgs )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt msg_p;
+    char            payload[PIPELINE_PAYLOAD_BYTES];
+    int             firstAck = fillAcks;
+    int             firstReject = fillRejects;
+    int             acked;
+    int             rejected;
+    UINT64          deadlineUs;
+    int             i;
+
+    memset ( payload, 'p', sizeof ( payload ) );
+    for ( i = 0; i < numMsgs; i++ ) {
+        if ( ( rc = pipeline_buildMsg ( &msg_p, queueName_p, payload, sizeof ( payload ) ) ) != SOLCLIENT_OK ) {
+            return rc;
+        }
+        rc = solClient_session_sendMsg ( session_p, msg_p );
+        solClient_msg_free ( &msg_p );
+        if ( rc != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_sendMsg()" );
+            return rc;
+        }
+    }
+    deadlineUs = getTimeInUs (  ) + PIPELINE_FILL_TIMEOUT_MS * 1000;
+    for ( ;; ) {
+        acked = fillAcks - firstAck;
+        rejected = fillRejects - firstReject;
+        if ( acked + rejected >= numMsgs ) {
+            break;
+        }
+        if ( getTimeInUs (  ) >= deadlineUs ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Fill of '%s' timed out after %d ms: %d of %d messages acknowledged",
+                            queueName_p, PIPELINE_FILL_TIMEOUT_MS, acked, numMsgs );
+            return SOLCLIENT_INCOMPLETE;
+        }
+        sleepInUs ( 1000 );
+    }
+    if ( rejected > 0 ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Fill of '%s' failed: %d of %d messages rejected",
+                        queueName_p, rejected, numMsgs );
+        return SOLCLIENT_FAIL;
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * pipeline_forwardMsg
+ *
+ * Republish a consumed message's payload to the destination Queue within the
+ * open transaction.
+ *****************************************************************************/
+static          solClient_returnCode_t
+pipeline_forwardMsg ( solClient_opaqueTransactedSession_pt txSession_p, solClient_opaqueMsg_pt rxMsg_p,
+                      const char *queueName_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueMsg_pt txMsg_p;
+    void           *payload_p = NULL;
+    solClient_uint32_t size = 0;
+
+    if ( solClient_msg_getBinaryAttachmentPtr ( rxMsg_p, &payload_p, &size ) != SOLCLIENT_OK ) {
+        size = 0;
+    }
+    if ( ( rc = pipeline_buildMsg ( &txMsg_p, queueName_p, payload_p, size ) ) != SOLCLIENT_OK ) {
+        return rc;
+    }
+    /* The message is copied to the transmit buffer, so it can be freed right away. */
+    if ( ( rc = solClient_transactedSession_sendMsg ( txSession_p, txMsg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_transactedSession_sendMsg()" );
+    }
+    solClient_msg_free ( &txMsg_p );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * pipeline_run
+ *
+ * Drain the source Queue through transactions of up to txSize messages or
+ * maxMs milliseconds, and print one result row.
+ *****************************************************************************/
+static          solClient_returnCode_t
+pipeline_run ( solClient_opaqueTransactedSession_pt txSession_p, solClient_opaqueFlow_pt flow_p,
+               const char *dstQueue_p, int txSize, int maxMs, int numMsgs )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt rxMsg_p;
+    solClient_uint64_t *latencies_p;
+    int             maxLatencies = numMsgs + PIPELINE_MAX_RETRIES;
+    int             numLatencies = 0;
+    int             moved = 0;
+    int             commits = 0;
+    int             rollbacks = 0;
+    int             unknown = 0;
+    int             retries = 0;
+    int             inTx;
+    int             waitMs;
+    UINT64          runStart;
+    UINT64          txStart;
+    UINT64          lastRx;
+    UINT64          commitStart;
+    UINT64          now;
+    double          seconds;
+
+    if ( ( latencies_p = ( solClient_uint64_t * ) malloc ( maxLatencies * sizeof ( latencies_p[0] ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate %d latency samples", maxLatencies );
+        return SOLCLIENT_FAIL;
+    }
+
+    runStart = lastRx = getTimeInUs (  );
+    while ( moved < numMsgs ) {
+        /*
+         * Fill one transaction.
+         */
+        inTx = 0;
+        txStart = getTimeInUs (  );
+        while ( inTx < txSize ) {
+            now = getTimeInUs (  );
+            waitMs = maxMs - ( int ) ( ( now - txStart ) / 1000 );
+            if ( waitMs <= 0 ) {
+                break;
+            }
+            if ( ( rc = solClient_flow_receiveMsg ( flow_p, &rxMsg_p, waitMs ) ) != SOLCLIENT_OK ) {
+                common_handleError ( rc, "solClient_flow_receiveMsg()" );
+                goto done;
+            }
+            if ( rxMsg_p == NULL ) {
+                continue;
+            }
+            lastRx = getTimeInUs (  );
+            rc = pipeline_forwardMsg ( txSession_p, rxMsg_p, dstQueue_p );
+            solClient_msg_free ( &rxMsg_p );
+            if ( rc != SOLCLIENT_OK ) {
+                goto done;
+            }
+            inTx++;
+        }
+
+        if ( inTx == 0 ) {
+            if ( ( getTimeInUs (  ) - lastRx ) / 1000 >= PIPELINE_IDLE_TIMEOUT_MS ) {
+                printf ( "Source Queue idle after %d messages.\n", moved );
+                break;
+            }
+            continue;
+        }
+
+        /*
+         * Commit it.
+         */
+        commitStart = getTimeInUs (  );
+        rc = solClient_transactedSession_commit ( txSession_p );
+        if ( numLatencies < maxLatencies ) {
+            latencies_p[numLatencies++] = getTimeInUs (  ) - commitStart;
+        }
+
+        if ( rc == SOLCLIENT_OK ) {
+            moved += inTx;
+            commits++;
+            retries = 0;
+            continue;
+        }
+        if ( rc == SOLCLIENT_ROLLBACK ) {
+            /* The consumed messages are redelivered; the transaction is simply redone. */
+            rollbacks++;
+            common_handleError ( rc, "solClient_transactedSession_commit() rolled back" );
+        } else {
+            /*
+             * The commit outcome is unknown. Redoing the transaction may
+             * duplicate its messages on the destination Queue.
+             */
+            unknown++;
+            common_handleError ( rc, "solClient_transactedSession_commit()" );
+        }
+        if ( ++retries > PIPELINE_MAX_RETRIES ) {
+            solClient_log ( SOLCLIENT_LOG_ERROR, "Giving up after %d consecutive failed commits", retries - 1 );
+            break;
+        }
+        /* Back off a little longer after each consecutive failure. */
+        sleepInUs ( retries * 10000 );
+        rc = SOLCLIENT_OK;
+    }
+
+    seconds = ( double ) ( getTimeInUs (  ) - runStart ) / 1000000.0;
+    common_sortSamples ( latencies_p, numLatencies );
+    printf ( "%7d %8d %8d %6d %6d %10.1f %10.0f %8llu %8llu %8llu %8llu\n",
+             txSize, moved, commits, rollbacks, unknown,
+             ( double ) commits / seconds, ( double ) moved / seconds,
+             ( unsigned long long ) common_getPercentile ( latencies_p, numLatencies, 50.0 ),
+             ( unsigned long long ) common_getPercentile ( latencies_p, numLatencies, 90.0 ),
+             ( unsigned long long ) common_getPercentile ( latencies_p, numLatencies, 99.0 ),
+             ( unsigned long long ) common_getPercentile ( latencies_p, numLatencies, 100.0 ) );
+
+  done:
+    free ( latencies_p );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * main
+ *
+ * The entry point to the application.
+ *****************************************************************************/
+int
+main ( int argc, char *argv[] )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    /* Command Options */
+    struct commonOptions commandOpts;
+    const char     *srcQueue_p;
+    const char     *dstQueue_p;
+    const char     *sizeList_p = PIPELINE_DEFAULT_SIZES;
+    int             txSizes[PIPELINE_MAX_SIZES];
+    int             numTxSizes = 0;
+    int             maxMs = PIPELINE_DEFAULT_MAX_MS;
+    int             fill = 1;
+    int             numPositional = 0;
+    char           *end_p;
+    int             i;
+
+    /* Context */
+    solClient_opaqueContext_pt context_p;
+    solClient_context_createFuncInfo_t contextFuncInfo = SOLCLIENT_CONTEXT_CREATEFUNC_INITIALIZER;
+
+    /* Session */
+    solClient_opaqueSession_pt session_p;
+
+    /* Transacted Session and Flow */
+    solClient_opaqueTransactedSession_pt txSession_p = NULL;
+    solClient_opaqueFlow_pt flow_p = NULL;
+    solClient_flow_createFuncInfo_t flowFuncInfo = SOLCLIENT_FLOW_CREATEFUNC_INITIALIZER;
+
+    /* Props - Properties used to create various objects */
+    const char     *props[20] = {0, };
+    int             propIndex;
+
+    printf ( "\nTransactedPipeline.c (Copyright 2019 Solace Corporation. All rights reserved.)\n" );
+
+    /*************************************************************************
+     * Parse command options
+     *************************************************************************/
+    common_initCommandOptions(&commandOpts,
+                               ( USER_PARAM_MASK ),    /* required parameters */
+                               ( HOST_PARAM_MASK |
+                                PASS_PARAM_MASK |
+                                NUM_MSGS_MASK |
+                                LOG_LEVEL_MASK |
+                                USE_GSS_MASK |
+                                ZIP_LEVEL_MASK |
+                                POOL_TUNING_MASK |
+                                PROFILE_MASK));                         /* optional parameters */
+    commandOpts.numMsgsToSend = PIPELINE_DEFAULT_NUM_MSGS;
+    if ( common_parseCommandOptions ( argc, argv, &commandOpts,
+            "\tSOURCE_QUEUE DEST_QUEUE [SIZES] [MAX_MS] [nofill]\n"
+            "\t    SIZES     Comma-separated transaction sizes to compare (default " PIPELINE_DEFAULT_SIZES ").\n"
+            "\t    MAX_MS    Commit a partial transaction after this many ms (default 100).\n"
+            "\t    nofill    Drain the messages already in SOURCE_QUEUE instead of filling it\n"
+            "\t              with --mn messages before each run.\n" ) == 0 ) {
+        exit(1);
+    }
+    if ( argc - optind < 2 ) {
+        printf ( "Missing SOURCE_QUEUE and DEST_QUEUE\n" );
+        exit(1);
+    }
+    srcQueue_p = argv[optind++];
+    dstQueue_p = argv[optind++];
+    for ( ; optind < argc; optind++ ) {
+        if ( strcasecmp ( argv[optind], "nofill" ) == 0 ) {
+            fill = 0;
+        } else if ( numPositional++ == 0 ) {
+            sizeList_p = argv[optind];
+        } else if ( ( maxMs = atoi ( argv[optind] ) ) <= 0 ) {
+            printf ( "Invalid MAX_MS '%s'\n", argv[optind] );
+            exit(1);
+        }
+    }
+    end_p = ( char * ) sizeList_p;
+    while ( *end_p != ( char ) 0 && numTxSizes < PIPELINE_MAX_SIZES ) {
+        if ( ( txSizes[numTxSizes] = ( int ) strtol ( end_p, &end_p, 10 ) ) <= 0 ) {
+            printf ( "Invalid transaction sizes '%s'\n", sizeList_p );
+            exit(1);
+        }
+        numTxSizes++;
+        if ( *end_p == ',' ) {
+            end_p++;
+        }
+    }
+
+    /*************************************************************************
+     * Initialize the API and setup logging level
+     *************************************************************************/
+
+    /* solClient needs to be initialized before any other API calls are made. */
+    if ( ( rc = common_initialize ( &commandOpts ) ) != SOLCLIENT_OK ) {
+        goto notInitialized;
+    }
+
+    common_printCCSMPversion (  );
+
+    solClient_log_setFilterLevel ( SOLCLIENT_LOG_CATEGORY_ALL, commandOpts.logLevel );
+
+    /*************************************************************************
+     * Create a Context, and create and connect a Session
+     *************************************************************************/
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient context" );
+
+    if ( ( rc = solClient_context_create ( SOLCLIENT_CONTEXT_PROPS_DEFAULT_WITH_CREATE_THREAD,
+                                           &context_p, &contextFuncInfo, sizeof ( contextFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_create()" );
+        goto cleanup;
+    }
+
+    solClient_log ( SOLCLIENT_LOG_INFO, "Creating solClient sessions." );
+
+    if ( ( rc = common_createAndConnectSession ( context_p,
+                                                 &session_p,
+                                                 common_messageReceivePerfCallback,
+                                                 pipeline_eventCallback, NULL, &commandOpts ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "common_createAndConnectSession()" );
+        goto cleanup;
+    }
+
+    if ( !solClient_session_isCapable ( session_p, SOLCLIENT_SESSION_CAPABILITY_TRANSACTED_SESSION ) ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Transacted Sessions are not supported on this client connection." );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Provision the Queues (existing Queues are kept)
+     *************************************************************************/
+
+    if ( solClient_session_isCapable ( session_p, SOLCLIENT_SESSION_CAPABILITY_ENDPOINT_MANAGEMENT ) ) {
+        if ( ( rc = common_createQueue ( session_p, srcQueue_p ) ) != SOLCLIENT_OK ||
+             ( rc = common_createQueue ( session_p, dstQueue_p ) ) != SOLCLIENT_OK ) {
+            goto sessionConnected;
+        }
+    }
+
+    /*************************************************************************
+     * Create the Transacted Session and its consumer Flow
+     *************************************************************************/
+
+    /*
+     * The Transacted Session has a publisher, and uses the default
+     * Context-bound Message Dispatcher.
+     */
+    propIndex = 0;
+    props[propIndex++] = SOLCLIENT_TRANSACTEDSESSION_PROP_HAS_PUBLISHER;
+    props[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    props[propIndex] = NULL;
+
+    if ( ( rc = solClient_session_createTransactedSession ( ( char ** ) props, session_p, &txSession_p, NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_createTransactedSession()" );
+        goto sessionConnected;
+    }
+
+    /*
+     * Without a receive callback, messages on the transacted Flow are queued
+     * in the API and pulled with solClient_flow_receiveMsg(), so the
+     * application thread controls the transaction boundaries.
+     */
+    flowFuncInfo.rxMsgInfo.callback_p = NULL;
+    flowFuncInfo.eventInfo.callback_p = common_flowEventCallback;
+
+    propIndex = 0;
+    props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_BLOCKING;
+    props[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_ID;
+    props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_QUEUE;
+    props[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_NAME;
+    props[propIndex++] = srcQueue_p;
+    props[propIndex] = NULL;
+
+    if ( ( rc = solClient_transactedSession_createFlow ( ( char ** ) props, txSession_p,
+                                                         &flow_p, &flowFuncInfo, sizeof ( flowFuncInfo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_transactedSession_createFlow()" );
+        goto sessionConnected;
+    }
+
+    /*************************************************************************
+     * Run the pipeline for each transaction size
+     *************************************************************************/
+
+    printf ( "Moving %d messages from '%s' to '%s', partial commits after %d ms\n\n",
+             commandOpts.numMsgsToSend, srcQueue_p, dstQueue_p, maxMs );
+    printf ( "%7s %8s %8s %6s %6s %10s %10s %8s %8s %8s %8s\n",
+             "TxSize", "Msgs", "Commits", "Rollbk", "Unknwn", "Commits/s", "Msgs/s",
+             "p50 us", "p90 us", "p99 us", "max us" );
+
+    for ( i = 0; i < numTxSizes; i++ ) {
+        if ( fill && ( rc = pipeline_fillQueue ( session_p, srcQueue_p, commandOpts.numMsgsToSend ) ) != SOLCLIENT_OK ) {
+            break;
+        }
+        if ( ( rc = pipeline_run ( txSession_p, flow_p, dstQueue_p, txSizes[i], maxMs,
+                                   commandOpts.numMsgsToSend ) ) != SOLCLIENT_OK ) {
+            break;
+        }
+    }
+    printf ( "\n" );
+
+    /*************************************************************************
+     * Cleanup
+     *************************************************************************/
+  sessionConnected:
+    if ( flow_p != NULL ) {
+        if ( ( rc = solClient_flow_destroy ( &flow_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_flow_destroy()" );
+        }
+    }
+    if ( txSession_p != NULL ) {
+        /* Anything not committed is rolled back. */
+        if ( ( rc = solClient_transactedSession_destroy ( &txSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_transactedSession_destroy()" );
+        }
+    }
+
+    /* Disconnect the Session. */
+    if ( ( rc = solClient_session_disconnect ( session_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_disconnect()" );
+    }
+
+  cleanup:
+    /* Cleanup solClient. */
+    if ( ( rc = solClient_cleanup (  ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_cleanup()" );
+    }
+
+  notInitialized:
+    return 0;
+
+}
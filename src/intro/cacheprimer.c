@@ -0,0 +1,277 @@
+/** example ex/cacheprimer.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Cache priming used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "solclient/solCache.h"
+#include "common.h"
+#include "cacheprimer.h"
+
+
+/*****************************************************************************
+ * common_cachePrimer_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_cachePrimer_init ( common_cachePrimer_pt primer_p, solClient_opaqueCacheSession_pt cacheSession_p,
+                          const char *const *topics_p, solClient_uint32_t numTopics,
+                          unsigned int window, unsigned int maxRetries )
+{
+    solClient_uint32_t i;
+
+    memset ( primer_p, 0, sizeof ( *primer_p ) );
+    primer_p->requests_p = ( common_cachePrimerRequest_t * ) calloc ( numTopics, sizeof ( common_cachePrimerRequest_t ) );
+    primer_p->retry_p = ( solClient_uint32_t * ) malloc ( numTopics * sizeof ( solClient_uint32_t ) );
+    primer_p->latencyUs_p = ( solClient_uint64_t * ) malloc ( numTopics * sizeof ( solClient_uint64_t ) );
+    if ( primer_p->requests_p == NULL || primer_p->retry_p == NULL || primer_p->latencyUs_p == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a cache primer for %u topics", numTopics );
+        free ( primer_p->requests_p );
+        free ( primer_p->retry_p );
+        free ( primer_p->latencyUs_p );
+        memset ( primer_p, 0, sizeof ( *primer_p ) );
+        return SOLCLIENT_FAIL;
+    }
+    for ( i = 0; i < numTopics; i++ ) {
+        primer_p->requests_p[i].topic_p = topics_p[i];
+    }
+    primer_p->cacheSession_p = cacheSession_p;
+    primer_p->numRequests = numTopics;
+    primer_p->window = window > 0 ? window : 1;
+    primer_p->maxRetries = maxRetries;
+    mutexInit ( &primer_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_cachePrimer_destroy
+ *****************************************************************************/
+void
+common_cachePrimer_destroy ( common_cachePrimer_pt primer_p )
+{
+    free ( primer_p->requests_p );
+    free ( primer_p->retry_p );
+    free ( primer_p->latencyUs_p );
+    primer_p->requests_p = NULL;
+    primer_p->retry_p = NULL;
+    primer_p->latencyUs_p = NULL;
+    mutexDestroy ( &primer_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_cachePrimerRetry
+ *
+ * Queue a request to be sent again. The ring holds every request at most
+ * once, so it cannot overflow. Called with the lock held.
+ *****************************************************************************/
+static void
+common_cachePrimerRetry ( common_cachePrimer_pt primer_p, solClient_uint32_t index )
+{
+    primer_p->requests_p[index].state = COMMON_PRIME_QUEUED;
+    primer_p->retry_p[primer_p->retryTail] = index;
+    primer_p->retryTail = ( primer_p->retryTail + 1 ) % primer_p->numRequests;
+}
+
+
+/*****************************************************************************
+ * common_cachePrimerDone
+ *
+ * Record the result of a request's last attempt. Called with the lock held.
+ *****************************************************************************/
+static void
+common_cachePrimerDone ( common_cachePrimer_pt primer_p, common_cachePrimerRequest_t * request_p,
+                         solClient_returnCode_t rc, solClient_subCode_t subCode )
+{
+    request_p->state = COMMON_PRIME_DONE;
+    request_p->rc = rc;
+    request_p->subCode = subCode;
+    primer_p->completed++;
+    if ( rc == SOLCLIENT_OK ) {
+        primer_p->stats.ok++;
+    } else if ( rc == SOLCLIENT_INCOMPLETE && subCode == SOLCLIENT_SUBCODE_CACHE_NO_DATA ) {
+        primer_p->stats.noData++;
+    } else if ( rc == SOLCLIENT_INCOMPLETE && subCode == SOLCLIENT_SUBCODE_CACHE_SUSPECT_DATA ) {
+        primer_p->stats.suspect++;
+    } else if ( rc == SOLCLIENT_INCOMPLETE && subCode == SOLCLIENT_SUBCODE_CACHE_TIMEOUT ) {
+        primer_p->stats.timedOut++;
+    } else {
+        primer_p->stats.failed++;
+    }
+}
+
+
+/*****************************************************************************
+ * common_cachePrimerEventCallback
+ *
+ * A cache request completed; user_p is the primer. The cacheRequestId is the
+ * attempt number in the high 32 bits and the request index in the low 32 bits.
+ *****************************************************************************/
+static void
+common_cachePrimerEventCallback ( solClient_opaqueSession_pt opaqueSession_p, solCache_eventCallbackInfo_pt eventInfo_p,
+                                  void *user_p )
+{
+    common_cachePrimer_pt primer_p = ( common_cachePrimer_pt ) user_p;
+    solClient_uint32_t index = ( solClient_uint32_t ) eventInfo_p->cacheRequestId;
+    solClient_uint32_t attempt = ( solClient_uint32_t ) ( eventInfo_p->cacheRequestId >> 32 );
+    common_cachePrimerRequest_t *request_p;
+    solClient_uint64_t latencyUs;
+    int             bucket;
+
+    mutexLock ( &primer_p->mutex );
+    if ( index >= primer_p->numRequests ) {
+        mutexUnlock ( &primer_p->mutex );
+        return;
+    }
+    request_p = &primer_p->requests_p[index];
+    if ( request_p->state != COMMON_PRIME_OUTSTANDING || request_p->attempt != attempt ) {
+        mutexUnlock ( &primer_p->mutex );
+        return;
+    }
+    primer_p->outstanding--;
+    if ( eventInfo_p->rc == SOLCLIENT_INCOMPLETE && eventInfo_p->subCode == SOLCLIENT_SUBCODE_CACHE_TIMEOUT &&
+         attempt <= primer_p->maxRetries ) {
+        primer_p->stats.retries++;
+        common_cachePrimerRetry ( primer_p, index );
+        mutexUnlock ( &primer_p->mutex );
+        return;
+    }
+
+    latencyUs = getTimeInUs (  ) - request_p->sentUs;
+    primer_p->latencyUs_p[primer_p->numLatencies++] = latencyUs;
+    for ( bucket = 0; bucket < COMMON_PRIME_HIST_BUCKETS - 1 && latencyUs >= ( 1000ULL << bucket ); bucket++ ) {
+    }
+    primer_p->histogram[bucket]++;
+    common_cachePrimerDone ( primer_p, request_p, eventInfo_p->rc, eventInfo_p->subCode );
+    mutexUnlock ( &primer_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_cachePrimer_run
+ *****************************************************************************/
+solClient_returnCode_t
+common_cachePrimer_run ( common_cachePrimer_pt primer_p )
+{
+    solClient_returnCode_t rc;
+    common_cachePrimerRequest_t *request_p;
+    solClient_uint64_t cacheRequestId;
+    solClient_uint32_t index;
+    UINT64          startUs = getTimeInUs (  );
+
+    mutexLock ( &primer_p->mutex );
+    while ( primer_p->completed < primer_p->numRequests ) {
+        if ( primer_p->outstanding >= primer_p->window ||
+             ( primer_p->retryHead == primer_p->retryTail && primer_p->next >= primer_p->numRequests ) ) {
+            /* Wait for completions. */
+            mutexUnlock ( &primer_p->mutex );
+            sleepInUs ( COMMON_PRIME_POLL_US );
+            mutexLock ( &primer_p->mutex );
+            continue;
+        }
+        if ( primer_p->retryHead != primer_p->retryTail ) {
+            index = primer_p->retry_p[primer_p->retryHead];
+            primer_p->retryHead = ( primer_p->retryHead + 1 ) % primer_p->numRequests;
+        } else {
+            index = primer_p->next++;
+        }
+        request_p = &primer_p->requests_p[index];
+        request_p->attempt++;
+        request_p->state = COMMON_PRIME_OUTSTANDING;
+        request_p->sentUs = getTimeInUs (  );
+        cacheRequestId = ( ( solClient_uint64_t ) request_p->attempt << 32 ) | index;
+        primer_p->outstanding++;
+        primer_p->stats.sent++;
+        mutexUnlock ( &primer_p->mutex );
+
+        rc = solClient_cacheSession_sendCacheRequest ( primer_p->cacheSession_p, request_p->topic_p, cacheRequestId,
+                                                       common_cachePrimerEventCallback, primer_p,
+                                                       SOLCLIENT_CACHEREQUEST_FLAGS_LIVEDATA_FULFILL |
+                                                       SOLCLIENT_CACHEREQUEST_FLAGS_NOWAIT_REPLY, 0 );
+
+        mutexLock ( &primer_p->mutex );
+        if ( rc == SOLCLIENT_IN_PROGRESS ) {
+            continue;
+        }
+        /* Not sent, so no completion will come. */
+        primer_p->outstanding--;
+        primer_p->stats.sent--;
+        if ( rc == SOLCLIENT_WOULD_BLOCK ) {
+            request_p->attempt--;
+            common_cachePrimerRetry ( primer_p, index );
+            mutexUnlock ( &primer_p->mutex );
+            sleepInUs ( COMMON_PRIME_POLL_US );
+            mutexLock ( &primer_p->mutex );
+        } else {
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Cache request for '%s' not sent: %s, %s", request_p->topic_p,
+                            solClient_returnCodeToString ( rc ), solClient_subCodeToString ( solClient_getLastErrorInfo (  )->subCode ) );
+            common_cachePrimerDone ( primer_p, request_p, rc, solClient_getLastErrorInfo (  )->subCode );
+        }
+    }
+    primer_p->elapsedUs = getTimeInUs (  ) - startUs;
+    mutexUnlock ( &primer_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_cachePrimer_printStats
+ *****************************************************************************/
+void
+common_cachePrimer_printStats ( common_cachePrimer_pt primer_p )
+{
+    solClient_uint64_t maxCount = 0;
+    int             bucket;
+    int             bar;
+
+    mutexLock ( &primer_p->mutex );
+    printf ( "Primed %u topics in %.3f s (%.0f topics/s), window %u: %llu requests sent, %llu retried after a timeout\n",
+             primer_p->numRequests, primer_p->elapsedUs / 1000000.0,
+             primer_p->elapsedUs > 0 ? primer_p->numRequests * 1000000.0 / primer_p->elapsedUs : 0.0,
+             primer_p->window, ( unsigned long long ) primer_p->stats.sent, ( unsigned long long ) primer_p->stats.retries );
+    printf ( "Results: %llu ok, %llu no data, %llu suspect, %llu timed out, %llu failed\n",
+             ( unsigned long long ) primer_p->stats.ok, ( unsigned long long ) primer_p->stats.noData,
+             ( unsigned long long ) primer_p->stats.suspect, ( unsigned long long ) primer_p->stats.timedOut,
+             ( unsigned long long ) primer_p->stats.failed );
+    if ( primer_p->numLatencies > 0 ) {
+        common_sortSamples ( primer_p->latencyUs_p, primer_p->numLatencies );
+        printf ( "Request latency us: p50 %llu, p90 %llu, p99 %llu, max %llu\n",
+                 ( unsigned long long ) common_getPercentile ( primer_p->latencyUs_p, primer_p->numLatencies, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( primer_p->latencyUs_p, primer_p->numLatencies, 90.0 ),
+                 ( unsigned long long ) common_getPercentile ( primer_p->latencyUs_p, primer_p->numLatencies, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( primer_p->latencyUs_p, primer_p->numLatencies, 100.0 ) );
+        for ( bucket = 0; bucket < COMMON_PRIME_HIST_BUCKETS; bucket++ ) {
+            if ( primer_p->histogram[bucket] > maxCount ) {
+                maxCount = primer_p->histogram[bucket];
+            }
+        }
+        for ( bucket = 0; bucket < COMMON_PRIME_HIST_BUCKETS; bucket++ ) {
+            if ( primer_p->histogram[bucket] == 0 ) {
+                continue;
+            }
+            if ( bucket < COMMON_PRIME_HIST_BUCKETS - 1 ) {
+                printf ( "  < %6u ms %10llu ", 1u << bucket, ( unsigned long long ) primer_p->histogram[bucket] );
+            } else {
+                printf ( "  >=%6u ms %10llu ", 1u << ( bucket - 1 ), ( unsigned long long ) primer_p->histogram[bucket] );
+            }
+            for ( bar = 0; bar < ( int ) ( primer_p->histogram[bucket] * 50 / maxCount ); bar++ ) {
+                putchar ( '#' );
+            }
+            putchar ( '\n' );
+        }
+    }
+    mutexUnlock ( &primer_p->mutex );
+}
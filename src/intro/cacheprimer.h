@@ -0,0 +1,120 @@
+/** example ex/cacheprimer.h
+ */
+
+/**
+ *
+ * file cacheprimer.h Cache priming for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef CACHEPRIMER_H_
+#define CACHEPRIMER_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor cachePrimer
+ * @name Cache priming
+ * A cache primer requests the cached values of many topics at startup.
+ * Instead of one blocking cache request after another, it keeps up to
+ * window asynchronous requests (::SOLCLIENT_CACHEREQUEST_FLAGS_NOWAIT_REPLY)
+ * outstanding on a cache session, and matches each completion reported to
+ * its cache event callback to its request by cacheRequestId. Requests
+ * that time out (::SOLCLIENT_SUBCODE_CACHE_TIMEOUT) are sent again, up to
+ * maxRetries times.
+ *
+ * Each request subscribes to its topic and completes on the cache response
+ * or the first live message (::SOLCLIENT_CACHEREQUEST_FLAGS_LIVEDATA_FULFILL).
+ * The cached messages are delivered to the Session's receive callback as
+ * usual.
+ */
+/*@{*/
+
+#define COMMON_PRIME_HIST_BUCKETS    16         /**< Latency buckets of 2^i ms, the last open-ended. */
+#define COMMON_PRIME_POLL_US         200        /**< Wait between checks for a free window slot. */
+
+typedef enum common_primeState
+{
+    COMMON_PRIME_QUEUED = 0,
+    COMMON_PRIME_OUTSTANDING,
+    COMMON_PRIME_DONE
+} common_primeState_t;
+
+typedef struct common_cachePrimerRequest
+{
+    const char     *topic_p;
+    UINT64          sentUs;         /**< getTimeInUs() when the last attempt was sent. */
+    solClient_uint32_t attempt;     /**< Attempts sent; part of the cacheRequestId. */
+    common_primeState_t state;
+    solClient_returnCode_t rc;      /**< Result of the last attempt. */
+    solClient_subCode_t subCode;
+} common_cachePrimerRequest_t;
+
+typedef struct common_cachePrimerStats
+{
+    solClient_uint64_t sent;
+    solClient_uint64_t retries;     /**< Attempts sent again after a timeout. */
+    solClient_uint64_t ok;
+    solClient_uint64_t noData;
+    solClient_uint64_t suspect;
+    solClient_uint64_t timedOut;    /**< Timed out on every attempt. */
+    solClient_uint64_t failed;
+} common_cachePrimerStats_t;
+
+typedef struct common_cachePrimer
+{
+    MUTEX_T         mutex;
+    solClient_opaqueCacheSession_pt cacheSession_p;
+    common_cachePrimerRequest_t *requests_p;
+    solClient_uint32_t numRequests;
+    solClient_uint32_t next;        /**< Next request never sent. */
+    solClient_uint32_t *retry_p;    /**< Ring of requests to send again. */
+    solClient_uint32_t retryHead;
+    solClient_uint32_t retryTail;
+    solClient_uint32_t outstanding;
+    solClient_uint32_t completed;
+    unsigned int    window;
+    unsigned int    maxRetries;
+    solClient_uint64_t *latencyUs_p;    /**< Latency of the last attempt of each completed request. */
+    int             numLatencies;
+    solClient_uint64_t histogram[COMMON_PRIME_HIST_BUCKETS];
+    UINT64          elapsedUs;
+    common_cachePrimerStats_t stats;
+} common_cachePrimer_t, *common_cachePrimer_pt;
+
+/**
+ * Initialize a cache primer for numTopics topics; the topics must remain
+ * valid until the primer is destroyed.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the primer cannot be allocated.
+ */
+solClient_returnCode_t
+    common_cachePrimer_init ( common_cachePrimer_pt primer_p, solClient_opaqueCacheSession_pt cacheSession_p,
+                              const char *const *topics_p, solClient_uint32_t numTopics,
+                              unsigned int window, unsigned int maxRetries );
+
+/**
+ * Release a cache primer. Its requests must have completed.
+ */
+void
+    common_cachePrimer_destroy ( common_cachePrimer_pt primer_p );
+
+/**
+ * Send every request, keeping at most window outstanding, and wait until
+ * all have completed. Must not be called from the Context thread.
+ * @return ::SOLCLIENT_OK once every request completed, whatever its result.
+ */
+solClient_returnCode_t
+    common_cachePrimer_run ( common_cachePrimer_pt primer_p );
+
+/**
+ * Print the results, the total time and the request latency percentiles
+ * and histogram.
+ */
+void
+    common_cachePrimer_printStats ( common_cachePrimer_pt primer_p );
+
+/*@}*/
+
+#endif /* CACHEPRIMER_H_ */
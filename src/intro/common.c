@@ -23,6 +23,50 @@
 #include "RRcommon.h"
 #include "getopt.h"
 
+/* Values returned by getopt_long() for options that only have a long form. */
+#define COMMON_OPT_POOLMEM      256
+#define COMMON_OPT_DBQUANTA     257
+#define COMMON_OPT_PROFILE      258
+#define COMMON_OPT_METADATA     259
+#define COMMON_OPT_ZIPLEVEL     260
+#define COMMON_OPT_WIRE         261
+#define COMMON_OPT_RETRIES      262
+#define COMMON_OPT_SENDQ        263
+
+/* Session property values for compression levels 0 to 9. */
+const char     *common_zipLevelStrings[10] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+
+/* --sendq policy names, by COMMON_SENDQ_* value. */
+const char     *common_sendQueuePolicyNames[3] = { "drop-oldest", "drop-newest", "block" };
+
+
+/*
+ * Tuning profiles for --profile.
+ *
+ * low-latency: Default buffer quanta with the pools kept warm, TCP no delay
+ *              and a small Session buffer so flow control kicks in early.
+ * throughput:  Large socket buffers and Session buffer, and Nagle left on so
+ *              small messages are coalesced into full segments.
+ * large-msg:   Data buffer quanta up to 16 MB so large payloads fit in one
+ *              pooled buffer, with socket and Session buffers to match.
+ * memory-lean: Small data buffer quanta and a 16 MB pool cap, with operating
+ *              system socket buffer defaults.
+ */
+static const common_tuningProfile_t common_tuningProfiles[COMMON_NUM_TUNING_PROFILES] = {
+    { "low-latency", "1073741824",
+      { "10240", "32768", "65536", "262144", "1048576" },
+      "131072", "131072", SOLCLIENT_PROP_ENABLE_VAL, "65536" },
+    { "throughput", "1073741824",
+      { "10240", "32768", "65536", "262144", "1048576" },
+      "1048576", "1048576", SOLCLIENT_PROP_DISABLE_VAL, "1048576" },
+    { "large-msg", "1073741824",
+      { "65536", "262144", "1048576", "4194304", "16777216" },
+      "4194304", "4194304", SOLCLIENT_PROP_ENABLE_VAL, "16777216" },
+    { "memory-lean", "16777216",
+      { "1024", "4096", "16384", "65536", "1048576" },
+      "0", "0", SOLCLIENT_PROP_ENABLE_VAL, "90000" }
+};
+
 /*****************************************************************************
  * common_printCCSMPversion
  *****************************************************************************/
@@ -108,11 +152,67 @@ common_initCommandOptions ( struct commonOptions *commonOpt,
         commonOpt->usingDurable = 0; //FALSE
         commonOpt->enableCompression = 0; //FALSE
         commonOpt->useGSS = 0; //FALSE
+        commonOpt->maxPoolMem[0] = ( char ) 0;
+        memset ( commonOpt->dbQuantaSize, 0, sizeof ( commonOpt->dbQuantaSize ) );
+        commonOpt->profile_p = NULL;
+        commonOpt->genMetadata = COMMON_METADATA_ALL;
+        commonOpt->compressionLevel = 0;
+        commonOpt->zipLinkBytesPerSec = COMMON_ZIP_DEFAULT_LINK_BYTES_PER_SEC;
+        commonOpt->wireFormat = COMMON_WIRE_SDT;
+        commonOpt->reapplySubscriptions = 1;
+        commonOpt->connectRetries = 3;
+        commonOpt->reconnectRetries = 3;
+        commonOpt->reconnectRetryWaitMs = -1;
+        commonOpt->sendBlocking = 1;
+        commonOpt->sendQueuePolicy = COMMON_SENDQ_DROP_OLDEST;
+        commonOpt->sendQueueDepth = COMMON_SENDQ_DEFAULT_DEPTH;
         commonOpt->requiredFields = requiredParams;
         commonOpt->optionalFields = optionals;
     }
 }
 
+/*****************************************************************************
+ * common_parseMetadataFields
+ *
+ * Parse a --metadata field list into COMMON_METADATA_* bits. Returns -1 if
+ * the list contains an unknown field.
+ *****************************************************************************/
+static int
+common_parseMetadataFields ( const char *list_p )
+{
+    char            field[16];
+    const char     *end_p;
+    size_t          len;
+    int             fields = 0;
+
+    while ( *list_p != ( char ) 0 ) {
+        if ( ( end_p = strchr ( list_p, ',' ) ) == NULL ) {
+            end_p = list_p + strlen ( list_p );
+        }
+        if ( ( len = ( size_t ) ( end_p - list_p ) ) >= sizeof ( field ) ) {
+            return -1;
+        }
+        memcpy ( field, list_p, len );
+        field[len] = ( char ) 0;
+
+        if ( strcasecmp ( field, "ts" ) == 0 ) {
+            fields |= COMMON_METADATA_SEND_TIMESTAMP;
+        } else if ( strcasecmp ( field, "id" ) == 0 ) {
+            fields |= COMMON_METADATA_SENDER_ID;
+        } else if ( strcasecmp ( field, "seq" ) == 0 ) {
+            fields |= COMMON_METADATA_SEQUENCE_NUMBER;
+        } else if ( strcasecmp ( field, "all" ) == 0 ) {
+            fields |= COMMON_METADATA_ALL;
+        } else if ( strcasecmp ( field, "none" ) != 0 ) {
+            return -1;
+        }
+
+        list_p = ( *end_p == ',' ) ? end_p + 1 : end_p;
+    }
+    return fields;
+}
+
+
 /*****************************************************************************
  * common_parseCommandOptions
  *****************************************************************************/
@@ -134,11 +234,23 @@ common_parseCommandOptions ( int argc, char **argv, struct commonOptions *common
         {"win", 1, NULL, 'w'},
         {"zip", 0, NULL, 'z'},
         {"replay", 1, NULL, 'R'},
+        {"poolmem", 1, NULL, COMMON_OPT_POOLMEM},
+        {"dbquanta", 1, NULL, COMMON_OPT_DBQUANTA},
+        {"profile", 1, NULL, COMMON_OPT_PROFILE},
+        {"metadata", 1, NULL, COMMON_OPT_METADATA},
+        {"ziplevel", 1, NULL, COMMON_OPT_ZIPLEVEL},
+        {"wire", 1, NULL, COMMON_OPT_WIRE},
+        {"retries", 1, NULL, COMMON_OPT_RETRIES},
+        {"sendq", 1, NULL, COMMON_OPT_SENDQ},
         {0, 0, 0, 0}
     };
     int             c;
     int             rc = 1;
     char           *end_p;
+    char           *quanta_p;
+    int             quantaIndex;
+    size_t          nameLen;
+    int             policy;
 
     while ( ( c = getopt_long ( argc, argv, optstring, longopts, NULL ) ) != -1 ) {
         switch ( c ) {
@@ -156,6 +268,7 @@ common_parseCommandOptions ( int argc, char **argv, struct commonOptions *common
                 break;
             case 'z':
                 commonOpt->enableCompression = 1; //TRUE
+                commonOpt->compressionLevel = 9;
                 break;
             case 'R':
                 strncpy ( commonOpt->replayStartLocation, optarg, sizeof ( commonOpt->replayStartLocation ) );
@@ -207,6 +320,116 @@ common_parseCommandOptions ( int argc, char **argv, struct commonOptions *common
                 if ( commonOpt->gdWindow <= 0 )
                     rc = 0;
                 break;
+            case COMMON_OPT_POOLMEM:
+                if ( strtol ( optarg, &end_p, 0 ) <= 0 || *end_p != ( char ) 0 ) {
+                    rc = 0;
+                    break;
+                }
+                strncpy ( commonOpt->maxPoolMem, optarg, sizeof ( commonOpt->maxPoolMem ) - 1 );
+                break;
+            case COMMON_OPT_DBQUANTA:
+                /* Five comma-separated sizes, one per API data buffer pool. */
+                quanta_p = optarg;
+                for ( quantaIndex = 0; quantaIndex < 5; quantaIndex++ ) {
+                    if ( strtol ( quanta_p, &end_p, 0 ) <= 0 || ( end_p - quanta_p ) >= ( int ) sizeof ( commonOpt->dbQuantaSize[0] ) ) {
+                        rc = 0;
+                        break;
+                    }
+                    memcpy ( commonOpt->dbQuantaSize[quantaIndex], quanta_p, end_p - quanta_p );
+                    commonOpt->dbQuantaSize[quantaIndex][end_p - quanta_p] = ( char ) 0;
+                    if ( *end_p != ',' ) {
+                        break;
+                    }
+                    quanta_p = end_p + 1;
+                }
+                if ( quantaIndex != 4 || *end_p != ( char ) 0 ) {
+                    rc = 0;
+                }
+                break;
+            case COMMON_OPT_PROFILE:
+                if ( ( commonOpt->profile_p = common_findTuningProfile ( optarg ) ) == NULL ) {
+                    printf ( "Unknown profile '%s'\n", optarg );
+                    rc = 0;
+                }
+                break;
+            case COMMON_OPT_METADATA:
+                if ( ( commonOpt->genMetadata = common_parseMetadataFields ( optarg ) ) < 0 ) {
+                    printf ( "Invalid metadata field list '%s'\n", optarg );
+                    rc = 0;
+                }
+                break;
+            case COMMON_OPT_ZIPLEVEL:
+                if ( strncasecmp ( optarg, "adaptive", 8 ) == 0 && ( optarg[8] == ( char ) 0 || optarg[8] == ',' ) ) {
+                    commonOpt->compressionLevel = COMMON_ZIP_ADAPTIVE;
+                    if ( optarg[8] == ',' ) {
+                        if ( strcasecmp ( optarg + 9, "probe" ) == 0 ) {
+                            commonOpt->zipLinkBytesPerSec = COMMON_ZIP_PROBE;
+                        } else if ( ( commonOpt->zipLinkBytesPerSec = strtod ( optarg + 9, &end_p ) * 1024.0 * 1024.0 ) <= 0.0 ||
+                                    *end_p != ( char ) 0 ) {
+                            printf ( "Invalid link throughput '%s'\n", optarg + 9 );
+                            rc = 0;
+                            break;
+                        }
+                    }
+                } else if ( strtol ( optarg, &end_p, 10 ) < 0 || strtol ( optarg, NULL, 10 ) > 9 || *end_p != ( char ) 0 ) {
+                    rc = 0;
+                    break;
+                } else {
+                    commonOpt->compressionLevel = ( int ) strtol ( optarg, NULL, 10 );
+                }
+                commonOpt->enableCompression = ( commonOpt->compressionLevel != 0 );
+                break;
+            case COMMON_OPT_WIRE:
+                if ( strcasecmp ( optarg, "sdt" ) == 0 ) {
+                    commonOpt->wireFormat = COMMON_WIRE_SDT;
+                } else if ( strcasecmp ( optarg, "binary" ) == 0 ) {
+                    commonOpt->wireFormat = COMMON_WIRE_BINARY;
+                } else {
+                    printf ( "Unknown wire format '%s'\n", optarg );
+                    rc = 0;
+                }
+                break;
+            case COMMON_OPT_RETRIES:
+                /* connect,reconnect[,waitMs] */
+                commonOpt->connectRetries = ( int ) strtol ( optarg, &end_p, 10 );
+                if ( *end_p != ',' || commonOpt->connectRetries < -1 ) {
+                    rc = 0;
+                    break;
+                }
+                commonOpt->reconnectRetries = ( int ) strtol ( end_p + 1, &end_p, 10 );
+                if ( *end_p == ',' ) {
+                    commonOpt->reconnectRetryWaitMs = ( int ) strtol ( end_p + 1, &end_p, 10 );
+                    if ( commonOpt->reconnectRetryWaitMs < 0 ) {
+                        rc = 0;
+                    }
+                }
+                if ( *end_p != ( char ) 0 || commonOpt->reconnectRetries < -1 ) {
+                    rc = 0;
+                }
+                break;
+            case COMMON_OPT_SENDQ:
+                /* policy[,depth] */
+                nameLen = ( ( end_p = strchr ( optarg, ',' ) ) != NULL ) ? ( size_t ) ( end_p - optarg ) : strlen ( optarg );
+                for ( policy = 0; policy < 3; policy++ ) {
+                    if ( strlen ( common_sendQueuePolicyNames[policy] ) == nameLen &&
+                         strncasecmp ( optarg, common_sendQueuePolicyNames[policy], nameLen ) == 0 ) {
+                        break;
+                    }
+                }
+                if ( policy == 3 ) {
+                    printf ( "Unknown send queue policy '%s'\n", optarg );
+                    rc = 0;
+                    break;
+                }
+                commonOpt->sendBlocking = 0;
+                commonOpt->sendQueuePolicy = policy;
+                if ( end_p != NULL ) {
+                    commonOpt->sendQueueDepth = ( int ) strtol ( end_p + 1, &end_p, 10 );
+                    if ( *end_p != ( char ) 0 || commonOpt->sendQueueDepth < 1 ) {
+                        rc = 0;
+                    }
+                }
+                break;
             default:
                 rc = 0;
                 break;
@@ -245,7 +468,7 @@ common_parseCommandOptions ( int argc, char **argv, struct commonOptions *common
         }
         printf (
             "Where PARAMETERS are:\n%s%s%s%s%s"
-            "Where OPTIONS are:\n%s%s%s%s%s%s%s%s%s%s%s%s%s\n",
+            "Where OPTIONS are:\n%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\n",
             ( commonOpt->requiredFields & HOST_PARAM_MASK ) ? HOST_PARAM_STRING : "",
             ( commonOpt->requiredFields & USER_PARAM_MASK ) ? USER_PARAM_STRING : "",
             ( commonOpt->requiredFields & DEST_PARAM_MASK ) ? DEST_PARAM_STRING : "",
@@ -263,7 +486,14 @@ common_parseCommandOptions ( int argc, char **argv, struct commonOptions *common
             ( commonOpt->optionalFields & LOG_LEVEL_MASK ) ? LOG_LEVEL_STRING : "",
             ( commonOpt->optionalFields & USE_GSS_MASK ) ? USE_GSS_STRING : "",
             ( commonOpt->optionalFields & ZIP_LEVEL_MASK ) ? ZIP_LEVEL_STRING : "",
-            ( commonOpt->optionalFields & REPLAY_START_MASK ) ? REPLAY_START_STRING : ""
+            ( commonOpt->optionalFields & REPLAY_START_MASK ) ? REPLAY_START_STRING : "",
+            ( commonOpt->optionalFields & POOL_TUNING_MASK ) ? POOL_TUNING_STRING : "",
+            ( commonOpt->optionalFields & PROFILE_MASK ) ? PROFILE_STRING : "",
+            ( commonOpt->optionalFields & METADATA_MASK ) ? METADATA_STRING : "",
+            ( commonOpt->optionalFields & ZIP_ADAPTIVE_MASK ) ? ZIP_ADAPTIVE_STRING : "",
+            ( commonOpt->optionalFields & WIRE_FORMAT_MASK ) ? WIRE_FORMAT_STRING : "",
+            ( commonOpt->optionalFields & RETRY_MASK ) ? RETRY_STRING : "",
+            ( commonOpt->optionalFields & SEND_QUEUE_MASK ) ? SEND_QUEUE_STRING : ""
            );
         if (positionalDesc != NULL) {
             printf (
@@ -276,6 +506,113 @@ common_parseCommandOptions ( int argc, char **argv, struct commonOptions *common
 }
 
 
+/*****************************************************************************
+ * common_getTuningProfile
+ *****************************************************************************/
+const common_tuningProfile_t *
+common_getTuningProfile ( int index )
+{
+    if ( index < 0 || index >= COMMON_NUM_TUNING_PROFILES ) {
+        return NULL;
+    }
+    return &common_tuningProfiles[index];
+}
+
+
+/*****************************************************************************
+ * common_findTuningProfile
+ *****************************************************************************/
+const common_tuningProfile_t *
+common_findTuningProfile ( const char *name_p )
+{
+    int             i;
+
+    for ( i = 0; i < COMMON_NUM_TUNING_PROFILES; i++ ) {
+        if ( strcasecmp ( name_p, common_tuningProfiles[i].name_p ) == 0 ) {
+            return &common_tuningProfiles[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*****************************************************************************
+ * common_addTuningSessionProps
+ *****************************************************************************/
+int
+common_addTuningSessionProps ( struct commonOptions *commonOpts, const char **props, int propIndex )
+{
+    const common_tuningProfile_t *profile_p = commonOpts->profile_p;
+
+    if ( profile_p == NULL ) {
+        return propIndex;
+    }
+
+    props[propIndex++] = SOLCLIENT_SESSION_PROP_SOCKET_SEND_BUF_SIZE;
+    props[propIndex++] = profile_p->socketSendBufSize_p;
+
+    props[propIndex++] = SOLCLIENT_SESSION_PROP_SOCKET_RCV_BUF_SIZE;
+    props[propIndex++] = profile_p->socketRcvBufSize_p;
+
+    props[propIndex++] = SOLCLIENT_SESSION_PROP_TCP_NODELAY;
+    props[propIndex++] = profile_p->tcpNoDelay_p;
+
+    props[propIndex++] = SOLCLIENT_SESSION_PROP_BUFFER_SIZE;
+    props[propIndex++] = profile_p->bufferSize_p;
+
+    return propIndex;
+}
+
+
+/*****************************************************************************
+ * common_initialize
+ *****************************************************************************/
+solClient_returnCode_t
+common_initialize ( struct commonOptions *commonOpts )
+{
+    static const char *dbQuantaProps[5] = {
+        SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_0,
+        SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_1,
+        SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_2,
+        SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_3,
+        SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_4
+    };
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    const char     *globalProps[20] = {0, };
+    int             propIndex = 0;
+    int             i;
+
+    /*
+     * The API keeps freed messages and data buffers in pools so that
+     * solClient_msg_alloc() rarely reaches the heap. MAXPOOLMEM caps the memory
+     * held in these pools; the DBQUANTASIZE properties set the buffer size of
+     * each of the five data buffer pools. Unset values keep the API defaults.
+     */
+    if ( commonOpts->maxPoolMem[0] ) {
+        globalProps[propIndex++] = SOLCLIENT_GLOBAL_PROP_MAXPOOLMEM;
+        globalProps[propIndex++] = commonOpts->maxPoolMem;
+    } else if ( commonOpts->profile_p != NULL ) {
+        globalProps[propIndex++] = SOLCLIENT_GLOBAL_PROP_MAXPOOLMEM;
+        globalProps[propIndex++] = commonOpts->profile_p->maxPoolMem_p;
+    }
+    for ( i = 0; i < 5; i++ ) {
+        if ( commonOpts->dbQuantaSize[i][0] ) {
+            globalProps[propIndex++] = dbQuantaProps[i];
+            globalProps[propIndex++] = commonOpts->dbQuantaSize[i];
+        } else if ( commonOpts->profile_p != NULL ) {
+            globalProps[propIndex++] = dbQuantaProps[i];
+            globalProps[propIndex++] = commonOpts->profile_p->dbQuantaSize_p[i];
+        }
+    }
+    globalProps[propIndex] = NULL;
+
+    if ( ( rc = solClient_initialize ( SOLCLIENT_LOG_DEFAULT_FILTER, ( propIndex > 0 ) ? ( char ** ) globalProps : NULL ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_initialize()" );
+    }
+    return rc;
+}
+
+
 /*****************************************************************************
  * common_createAndConnectSession
  *****************************************************************************/
@@ -295,6 +632,9 @@ common_createAndConnectSession ( solClient_opaqueContext_pt context_p,
     /* Session Properties */
     const char     *sessionProps[50] = {0, };
     int             propIndex = 0;
+    char            connectRetries[12];
+    char            reconnectRetries[12];
+    char            reconnectRetryWaitMs[12];
 
 
     /*************************************************************************
@@ -317,39 +657,59 @@ common_createAndConnectSession ( solClient_opaqueContext_pt context_p,
         sessionProps[propIndex++] = commonOpts->targetHost;
     }
 
+    /* Adaptive compression is done by common_zipPublisher_connect(); a single Session is uncompressed. */
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_COMPRESSION_LEVEL;
-    sessionProps[propIndex++] = ( commonOpts->enableCompression ) ? "9" : "0";
+    sessionProps[propIndex++] = ( commonOpts->compressionLevel > 0 ) ?
+            common_zipLevelStrings[commonOpts->compressionLevel] : "0";
 
+    sprintf ( connectRetries, "%d", commonOpts->connectRetries );
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_CONNECT_RETRIES;
-    sessionProps[propIndex++] = "3";
+    sessionProps[propIndex++] = connectRetries;
 
+    sprintf ( reconnectRetries, "%d", commonOpts->reconnectRetries );
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_RECONNECT_RETRIES;
-    sessionProps[propIndex++] = "3";
+    sessionProps[propIndex++] = reconnectRetries;
+
+    if ( commonOpts->reconnectRetryWaitMs >= 0 ) {
+        sprintf ( reconnectRetryWaitMs, "%d", commonOpts->reconnectRetryWaitMs );
+        sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_RECONNECT_RETRY_WAIT_MS;
+        sessionProps[propIndex++] = reconnectRetryWaitMs;
+    }
 
     /*
      * Note: Reapplying subscriptions allows Sessions to reconnect after failure and
      * have all their subscriptions automatically restored. For Sessions with many
      * subscriptions, this can increase the amount of time required for a successful
-     * reconnect.
+     * reconnect. A subscription registry (common_subRegistry_apply()) reapplies them
+     * itself, in priority order.
      */
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_REAPPLY_SUBSCRIPTIONS;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = commonOpts->reapplySubscriptions ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
+
+    /* A non-blocking Session is sent to through a send queue (common_sendQueue_send()). */
+    sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_SEND_BLOCKING;
+    sessionProps[propIndex++] = commonOpts->sendBlocking ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     /*
      * Note: Including meta data fields such as sender timestamp, sender ID, and sequence 
      * number can reduce the maximum attainable throughput as significant extra encoding/
      * decodingis required. This is true whether the fields are autogenerated or manually
-     * added.
+     * added. Each field can be turned off with --metadata.
      */
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SEND_TIMESTAMPS;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commonOpts->genMetadata & COMMON_METADATA_SEND_TIMESTAMP ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SENDER_ID;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commonOpts->genMetadata & COMMON_METADATA_SENDER_ID ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_GENERATE_SEQUENCE_NUMBER;
-    sessionProps[propIndex++] = SOLCLIENT_PROP_ENABLE_VAL;
+    sessionProps[propIndex++] = ( commonOpts->genMetadata & COMMON_METADATA_SEQUENCE_NUMBER ) ?
+            SOLCLIENT_PROP_ENABLE_VAL : SOLCLIENT_PROP_DISABLE_VAL;
 
     if ( commonOpts->vpn[0] ) {
         sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_VPN_NAME;
@@ -378,6 +738,8 @@ common_createAndConnectSession ( solClient_opaqueContext_pt context_p,
         sessionProps[propIndex++] = SOLCLIENT_SESSION_PROP_AUTHENTICATION_SCHEME_GSS_KRB;
     }
 
+    propIndex = common_addTuningSessionProps ( commonOpts, sessionProps, propIndex );
+
     /*************************************************************************
      * Create the Session
      *************************************************************************/
@@ -512,6 +874,212 @@ common_publishMessage ( solClient_opaqueSession_pt session_p, char *topic_p, sol
 }
 
 
+/*****************************************************************************
+ * common_sortSamples
+ *****************************************************************************/
+static int
+common_compareSamples ( const void *a_p, const void *b_p )
+{
+    solClient_uint64_t a = *( const solClient_uint64_t * ) a_p;
+    solClient_uint64_t b = *( const solClient_uint64_t * ) b_p;
+
+    return ( a < b ) ? -1 : ( a > b );
+}
+
+void
+common_sortSamples ( solClient_uint64_t *samples_p, int numSamples )
+{
+    qsort ( samples_p, ( size_t ) numSamples, sizeof ( samples_p[0] ), common_compareSamples );
+}
+
+
+/*****************************************************************************
+ * common_getPercentile
+ *****************************************************************************/
+solClient_uint64_t
+common_getPercentile ( const solClient_uint64_t *sortedSamples_p, int numSamples, double percentile )
+{
+    int             rank;
+
+    if ( numSamples <= 0 ) {
+        return 0;
+    }
+    /* Nearest rank: the smallest sample with at least percentile% of samples at or below it. */
+    rank = ( int ) ( percentile / 100.0 * numSamples + 0.999999 );
+    if ( rank < 1 ) {
+        rank = 1;
+    } else if ( rank > numSamples ) {
+        rank = numSamples;
+    }
+    return sortedSamples_p[rank - 1];
+}
+
+
+/*****************************************************************************
+ * common_hashString
+ *****************************************************************************/
+solClient_uint64_t
+common_hashString ( const char *string_p )
+{
+    solClient_uint64_t hash = 14695981039346656037ULL;
+
+    for ( ; *string_p != '\0'; string_p++ ) {
+        hash = ( hash ^ ( unsigned char ) *string_p ) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+/*****************************************************************************
+ * common_hashIndex_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_hashIndex_init ( common_hashIndex_pt index_p, unsigned int maxEntries )
+{
+    solClient_uint32_t numSlots = 16;
+
+    while ( numSlots < 2 * maxEntries ) {
+        numSlots <<= 1;
+    }
+    if ( ( index_p->slots_p = ( solClient_uint32_t * ) calloc ( numSlots, sizeof ( solClient_uint32_t ) ) ) == NULL ) {
+        index_p->slotMask = 0;
+        return SOLCLIENT_FAIL;
+    }
+    index_p->slotMask = numSlots - 1;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_hashIndex_destroy
+ *****************************************************************************/
+void
+common_hashIndex_destroy ( common_hashIndex_pt index_p )
+{
+    free ( ( void * ) index_p->slots_p );
+    index_p->slots_p = NULL;
+}
+
+
+/*****************************************************************************
+ * common_hashIndex_clear
+ *****************************************************************************/
+void
+common_hashIndex_clear ( common_hashIndex_pt index_p )
+{
+    memset ( ( void * ) index_p->slots_p, 0, ( index_p->slotMask + 1 ) * sizeof ( solClient_uint32_t ) );
+}
+
+
+/*****************************************************************************
+ * common_hashIndex_find
+ *****************************************************************************/
+solClient_uint32_t
+common_hashIndex_find ( common_hashIndex_pt index_p, solClient_uint64_t hash, const char *key_p,
+                        common_hashMatchFunc_t match_p, void *user_p, solClient_uint32_t *slot_p )
+{
+    solClient_uint32_t slot;
+    solClient_uint32_t entry;
+
+    for ( slot = ( solClient_uint32_t ) hash & index_p->slotMask;; slot = ( slot + 1 ) & index_p->slotMask ) {
+        if ( ( entry = index_p->slots_p[slot] ) == 0 ) {
+            *slot_p = slot;
+            return COMMON_HASH_NOT_FOUND;
+        }
+        /* The entry was complete before its slot was set. */
+        READ_BARRIER (  );
+        if ( match_p ( user_p, entry - 1, hash, key_p ) ) {
+            return entry - 1;
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * common_hashIndex_set
+ *****************************************************************************/
+void
+common_hashIndex_set ( common_hashIndex_pt index_p, solClient_uint32_t slot, solClient_uint32_t entry )
+{
+    MEMORY_BARRIER (  );
+    index_p->slots_p[slot] = entry + 1;
+}
+
+
+/*****************************************************************************
+ * common_hashIndex_insert
+ *****************************************************************************/
+void
+common_hashIndex_insert ( common_hashIndex_pt index_p, solClient_uint64_t hash, solClient_uint32_t entry )
+{
+    solClient_uint32_t slot;
+
+    for ( slot = ( solClient_uint32_t ) hash & index_p->slotMask; index_p->slots_p[slot] != 0;
+          slot = ( slot + 1 ) & index_p->slotMask ) {
+    }
+    common_hashIndex_set ( index_p, slot, entry );
+}
+
+
+/*****************************************************************************
+ * common_indexRing_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_indexRing_init ( common_indexRing_pt ring_p, solClient_uint32_t size )
+{
+    memset ( ring_p, 0, sizeof ( *ring_p ) );
+    if ( size == 0 ) {
+        size = 1;
+    }
+    if ( ( ring_p->entries_p = ( solClient_uint32_t * ) malloc ( size * sizeof ( solClient_uint32_t ) ) ) == NULL ) {
+        return SOLCLIENT_FAIL;
+    }
+    ring_p->size = size;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_indexRing_destroy
+ *****************************************************************************/
+void
+common_indexRing_destroy ( common_indexRing_pt ring_p )
+{
+    free ( ring_p->entries_p );
+    ring_p->entries_p = NULL;
+}
+
+
+/*****************************************************************************
+ * common_indexRing_push
+ *****************************************************************************/
+void
+common_indexRing_push ( common_indexRing_pt ring_p, solClient_uint32_t entry, int front )
+{
+    if ( front ) {
+        ring_p->head = ( ring_p->head + ring_p->size - 1 ) % ring_p->size;
+        ring_p->entries_p[ring_p->head] = entry;
+    } else {
+        ring_p->entries_p[( ring_p->head + ring_p->count ) % ring_p->size] = entry;
+    }
+    ring_p->count++;
+}
+
+
+/*****************************************************************************
+ * common_indexRing_pop
+ *****************************************************************************/
+solClient_uint32_t
+common_indexRing_pop ( common_indexRing_pt ring_p )
+{
+    solClient_uint32_t entry = ring_p->entries_p[ring_p->head];
+
+    ring_p->head = ( ring_p->head + 1 ) % ring_p->size;
+    ring_p->count--;
+    return entry;
+}
+
+
 /*****************************************************************************
  * common_cacheEventCallback
  *****************************************************************************/
@@ -823,6 +1391,17 @@ common_messageReceivePrintMsgCallback ( solClient_opaqueSession_pt opaqueSession
 solClient_rxMsgCallback_returnCode_t
 common_messageReceivePerfCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p )
 {
+    common_rxPerfCounter_t *counter_p = ( common_rxPerfCounter_t * ) user_p;
+    void           *attachment_p;
+    solClient_uint32_t size;
+
+    if ( counter_p != NULL ) {
+        counter_p->msgs++;
+        if ( solClient_msg_getBinaryAttachmentPtr ( msg_p, &attachment_p, &size ) == SOLCLIENT_OK ) {
+            counter_p->bytes += size;
+        }
+    }
+
     /* 
      * Returning SOLCLIENT_CALLBACK_OK causes the API to free the memory 
      * used by the message. This is important to avoid leaks.
@@ -856,3 +1435,101 @@ RR_operationToString ( RR_operation_t operation )
     }
 }
 
+
+/*****************************************************************************
+ * Request-Reply: Little-endian field access for the binary wire format
+ ******************************************************************************/
+static void
+RR_putUint32 ( solClient_uint8_t *buf_p, solClient_uint32_t value )
+{
+    buf_p[0] = ( solClient_uint8_t ) value;
+    buf_p[1] = ( solClient_uint8_t ) ( value >> 8 );
+    buf_p[2] = ( solClient_uint8_t ) ( value >> 16 );
+    buf_p[3] = ( solClient_uint8_t ) ( value >> 24 );
+}
+
+static          solClient_uint32_t
+RR_getUint32 ( const solClient_uint8_t *buf_p )
+{
+    return ( solClient_uint32_t ) buf_p[0] | ( ( solClient_uint32_t ) buf_p[1] << 8 ) |
+        ( ( solClient_uint32_t ) buf_p[2] << 16 ) | ( ( solClient_uint32_t ) buf_p[3] << 24 );
+}
+
+
+/*****************************************************************************
+ * Request-Reply: Encode a binary request
+ ******************************************************************************/
+void
+RR_encodeBinaryRequest ( solClient_uint8_t *buf_p, RR_operation_t operation,
+                         solClient_int32_t operand1, solClient_int32_t operand2 )
+{
+    buf_p[0] = 'R';
+    buf_p[1] = 'Q';
+    buf_p[2] = RR_BINARY_VERSION;
+    buf_p[3] = ( solClient_uint8_t ) operation;
+    RR_putUint32 ( buf_p + 4, ( solClient_uint32_t ) operand1 );
+    RR_putUint32 ( buf_p + 8, ( solClient_uint32_t ) operand2 );
+}
+
+
+/*****************************************************************************
+ * Request-Reply: Decode a binary request
+ ******************************************************************************/
+solClient_returnCode_t
+RR_decodeBinaryRequest ( const void *buf_p, solClient_uint32_t size, RR_operation_t *operation_p,
+                         solClient_int32_t *operand1_p, solClient_int32_t *operand2_p )
+{
+    const solClient_uint8_t *bytes_p = ( const solClient_uint8_t * ) buf_p;
+
+    if ( bytes_p == NULL || size != RR_BINARY_REQUEST_SIZE || bytes_p[0] != 'R' || bytes_p[1] != 'Q' ) {
+        return SOLCLIENT_NOT_FOUND;
+    }
+    if ( bytes_p[2] != RR_BINARY_VERSION ) {
+        return SOLCLIENT_FAIL;
+    }
+    *operation_p = ( RR_operation_t ) bytes_p[3];
+    *operand1_p = ( solClient_int32_t ) RR_getUint32 ( bytes_p + 4 );
+    *operand2_p = ( solClient_int32_t ) RR_getUint32 ( bytes_p + 8 );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * Request-Reply: Encode a binary reply
+ ******************************************************************************/
+void
+RR_encodeBinaryReply ( solClient_uint8_t *buf_p, solClient_bool_t resultOk, double result )
+{
+    solClient_uint64_t bits = 0;
+
+    if ( resultOk ) {
+        memcpy ( &bits, &result, sizeof ( bits ) );
+    }
+    buf_p[0] = 'R';
+    buf_p[1] = 'P';
+    buf_p[2] = RR_BINARY_VERSION;
+    buf_p[3] = resultOk ? 1 : 0;
+    RR_putUint32 ( buf_p + 4, 0 );
+    RR_putUint32 ( buf_p + 8, ( solClient_uint32_t ) bits );
+    RR_putUint32 ( buf_p + 12, ( solClient_uint32_t ) ( bits >> 32 ) );
+}
+
+
+/*****************************************************************************
+ * Request-Reply: Decode a binary reply
+ ******************************************************************************/
+solClient_returnCode_t
+RR_decodeBinaryReply ( const void *buf_p, solClient_uint32_t size, solClient_bool_t *resultOk_p, double *result_p )
+{
+    const solClient_uint8_t *bytes_p = ( const solClient_uint8_t * ) buf_p;
+    solClient_uint64_t bits;
+
+    if ( bytes_p == NULL || size != RR_BINARY_REPLY_SIZE || bytes_p[0] != 'R' || bytes_p[1] != 'P' ||
+         bytes_p[2] != RR_BINARY_VERSION || bytes_p[3] > 1 ) {
+        return SOLCLIENT_FAIL;
+    }
+    *resultOk_p = bytes_p[3];
+    bits = ( solClient_uint64_t ) RR_getUint32 ( bytes_p + 8 ) | ( ( solClient_uint64_t ) RR_getUint32 ( bytes_p + 12 ) << 32 );
+    memcpy ( result_p, &bits, sizeof ( *result_p ) );
+    return SOLCLIENT_OK;
+}
@@ -40,6 +40,8 @@
 #define COMMON_DMQ_NAME          "#DEAD_MSG_QUEUE"         /**< Name of a Dead Message Queue (DMQ). */
 
 #define COMMON_ATTACHMENT_TEXT   "my attached data"        /**< Sample attachment. */
+
+#define COMMON_CACHE_LINE_SIZE   64                        /**< Alignment of pooled buffers and padded counters. */
         
 /*@}*/
 
@@ -84,6 +86,13 @@ enum flowMode
 #define USE_GSS_MASK           0x0400      /**< Enable Kerberos option. */
 #define ZIP_LEVEL_MASK         0x0800      /**< Zip Compression Level option. */
 #define REPLAY_START_MASK      0x1000      /**< Replay Start Location option. */
+#define POOL_TUNING_MASK       0x2000      /**< API global pool tuning options. */
+#define PROFILE_MASK           0x4000      /**< Buffer tuning profile option. */
+#define METADATA_MASK          0x8000      /**< Generated message metadata option. */
+#define ZIP_ADAPTIVE_MASK      0x10000     /**< Compression level and adaptive compression option. */
+#define WIRE_FORMAT_MASK       0x20000     /**< Request-Reply payload format option. */
+#define RETRY_MASK             0x40000     /**< Connect and reconnect retry option. */
+#define SEND_QUEUE_MASK        0x80000     /**< Non-blocking send queue option. */
 
 /*@}*/
 
@@ -110,9 +119,100 @@ enum flowMode
 #define USE_GSS_STRING           "\t-g, --gss           Use GSS (Kerberos) authentication. When specified the '--cu' option is ignored.\n"
 #define ZIP_LEVEL_STRING         "\t-z, --zip           Enable compression (set compress level=9 for SolOS-TR appliances only).\n"
 #define REPLAY_START_STRING      "\t-R, --replay=replay Replay Start Location String (BEGINNING or RFC3339 time stamp).\n"
+#define POOL_TUNING_STRING       "\t    --poolmem=bytes Maximum memory the API keeps in its message and data buffer pools.\n"\
+                                 "\t    --dbquanta=s0,s1,s2,s3,s4 Sizes (in bytes) of the API's five data buffer pools.\n"
+#define PROFILE_STRING           "\t    --profile=name  Buffer tuning profile (low-latency, throughput, large-msg, memory-lean).\n"
+#define METADATA_STRING          "\t    --metadata=list Comma-separated metadata fields the API generates for each sent message:\n"\
+                                 "\t                    ts (send timestamp), id (sender ID), seq (sequence number), all or none\n"\
+                                 "\t                    (default: all).\n"
+#define ZIP_ADAPTIVE_STRING      "\t    --ziplevel=level Compression level 0-9, or 'adaptive[,link]' to choose a level from the payload\n"\
+                                 "\t                    and link throughput and route messages by size and entropy. link is the\n"\
+                                 "\t                    throughput in MB/s (default 12), or 'probe' to measure it with a short burst.\n"
+#define WIRE_FORMAT_STRING       "\t    --wire=format   Request and reply payload format: sdt (structured data stream) or\n"\
+                                 "\t                    binary (fixed-layout struct, see RRcommon.h) (default: sdt).\n"
+#define RETRY_STRING             "\t    --retries=c,r[,w] Connect retries c and reconnect retries r (-1 for forever, default 3,3),\n"\
+                                 "\t                    waiting w ms between attempts (default: the API default, 3000).\n"
+#define SEND_QUEUE_STRING        "\t    --sendq=policy[,depth] Send without blocking, queueing messages that would block in a local\n"\
+                                 "\t                    ring of depth messages (default 10000). When the ring is full: drop-oldest,\n"\
+                                 "\t                    drop-newest or block the sending thread.\n"
+
+/*@}*/
+
+/**
+ * @name Generated metadata fields
+ * Bits of commonOptions.genMetadata, each selecting one Solace-defined field
+ * the API adds to every message sent on Sessions created by
+ * common_createAndConnectSession().
+ */
+/*@{*/
+#define COMMON_METADATA_SEND_TIMESTAMP   0x1    /**< ::SOLCLIENT_SESSION_PROP_GENERATE_SEND_TIMESTAMPS */
+#define COMMON_METADATA_SENDER_ID        0x2    /**< ::SOLCLIENT_SESSION_PROP_GENERATE_SENDER_ID */
+#define COMMON_METADATA_SEQUENCE_NUMBER  0x4    /**< ::SOLCLIENT_SESSION_PROP_GENERATE_SEQUENCE_NUMBER */
+#define COMMON_METADATA_ALL              0x7
+/*@}*/
+
+/**
+ * @name Request-Reply wire formats
+ * Values of commonOptions.wireFormat, selected with --wire.
+ */
+/*@{*/
+#define COMMON_WIRE_SDT                  0      /**< Structured data stream payload. */
+#define COMMON_WIRE_BINARY               1      /**< Fixed-layout binary payload. */
+/*@}*/
+
+/**
+ * @name Send queue policies
+ * Values of commonOptions.sendQueuePolicy, selected with --sendq: what a
+ * non-blocking send queue (common_sendQueue_init()) does with a message
+ * when its ring is full.
+ */
+/*@{*/
+#define COMMON_SENDQ_DROP_OLDEST         0      /**< Free the oldest queued message to make room. */
+#define COMMON_SENDQ_DROP_NEWEST         1      /**< Discard the message being sent. */
+#define COMMON_SENDQ_BLOCK               2      /**< Wait for room; never in the Context thread. */
+#define COMMON_SENDQ_DEFAULT_DEPTH       10000  /**< commonOptions.sendQueueDepth unless given with --sendq. */
+
+/** --sendq policy names, by COMMON_SENDQ_* value. */
+extern const char *common_sendQueuePolicyNames[3];
+/*@}*/
+
+/**
+ * @name Compression options
+ * Values of commonOptions.compressionLevel and commonOptions.zipLinkBytesPerSec,
+ * selected with --ziplevel. Adaptive compression is done by a zip publisher
+ * (common_zipPublisher_connect()).
+ */
+/*@{*/
+#define COMMON_ZIP_ADAPTIVE          ( -1 )     /**< commonOptions.compressionLevel for adaptive compression. */
+#define COMMON_ZIP_PROBE             ( -1.0 )   /**< commonOptions.zipLinkBytesPerSec to probe the link. */
+#define COMMON_ZIP_DEFAULT_LINK_BYTES_PER_SEC ( 12.0 * 1024.0 * 1024.0 ) /**< About 100 Mb/s, a typical WAN link. */
 
+/** Session property values for compression levels 0 to 9. */
+extern const char *common_zipLevelStrings[10];
 /*@}*/
 
+/**
+ * @struct common_tuningProfile
+ * A vetted set of API global data buffer properties and matching Session
+ * socket and buffer properties, selected with --profile. Explicit --poolmem
+ * and --dbquanta values take precedence over the profile.
+ */
+typedef struct common_tuningProfile
+{
+    const char     *name_p;
+    const char     *maxPoolMem_p;               /**< ::SOLCLIENT_GLOBAL_PROP_MAXPOOLMEM */
+    const char     *dbQuantaSize_p[5];          /**< ::SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_0 to _4 */
+    const char     *socketSendBufSize_p;        /**< ::SOLCLIENT_SESSION_PROP_SOCKET_SEND_BUF_SIZE */
+    const char     *socketRcvBufSize_p;         /**< ::SOLCLIENT_SESSION_PROP_SOCKET_RCV_BUF_SIZE */
+    const char     *tcpNoDelay_p;               /**< ::SOLCLIENT_SESSION_PROP_TCP_NODELAY */
+    const char     *bufferSize_p;               /**< ::SOLCLIENT_SESSION_PROP_BUFFER_SIZE */
+} common_tuningProfile_t;
+
+/**
+ * The number of tuning profiles available through common_getTuningProfile().
+ */
+#define COMMON_NUM_TUNING_PROFILES 4
+
 /**
  * @struct commonOptions
  * The structure used to store common options. Most of these options are
@@ -138,6 +238,20 @@ struct commonOptions
     int             usingDurable;
     int             enableCompression;
     int             useGSS;
+    char            maxPoolMem[32];             /* Empty for the API default. */
+    char            dbQuantaSize[5][16];        /* Empty for the API default. */
+    const common_tuningProfile_t *profile_p;    /* NULL when no profile is selected. */
+    int             genMetadata;                /* COMMON_METADATA_* bits. */
+    int             compressionLevel;           /* 0-9, or COMMON_ZIP_ADAPTIVE. */
+    double          zipLinkBytesPerSec;         /* Link throughput for COMMON_ZIP_ADAPTIVE, or COMMON_ZIP_PROBE. */
+    int             wireFormat;                 /* COMMON_WIRE_SDT or COMMON_WIRE_BINARY. */
+    int             reapplySubscriptions;       /* 0 when a common_subRegistry_t reapplies them. */
+    int             connectRetries;
+    int             reconnectRetries;
+    int             reconnectRetryWaitMs;       /* -1 for the API default. */
+    int             sendBlocking;               /* 0 to send with a common_sendQueue_t. */
+    int             sendQueuePolicy;            /* COMMON_SENDQ_* */
+    int             sendQueueDepth;
 };
 
 
@@ -189,6 +303,44 @@ int
     common_parseCommandOptions ( int argc, char **argv, struct commonOptions *copt, const char *positionalDesc );
 
 
+/**
+ * Returns a tuning profile by index (0 to COMMON_NUM_TUNING_PROFILES - 1), or
+ * NULL if the index is out of range.
+ */
+const common_tuningProfile_t *
+    common_getTuningProfile ( int index );
+
+/**
+ * Returns the tuning profile with the given name, or NULL if there is none.
+ */
+const common_tuningProfile_t *
+    common_findTuningProfile ( const char *name_p );
+
+/**
+ * This function appends the Session properties of the selected tuning
+ * profile (if any) to a Session property array.
+ * @param commonOpts A pointer to the sample's commonOptions struct.
+ * @param props The Session property array.
+ * @param propIndex The index of the next free entry in props.
+ * @return The index of the next free entry after the added properties.
+ */
+int
+    common_addTuningSessionProps ( struct commonOptions *commonOpts, const char **props, int propIndex );
+
+
+/**
+ * This function initializes the API with solClient_initialize(). The global
+ * properties that tune the API's internal message and data buffer pools
+ * (::SOLCLIENT_GLOBAL_PROP_MAXPOOLMEM and ::SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_0
+ * to ::SOLCLIENT_GLOBAL_PROP_DBQUANTASIZE_4) are taken from the command options,
+ * falling back to the selected tuning profile.
+ * @param commonOpts A pointer to the sample's commonOptions struct.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL
+ */
+solClient_returnCode_t
+    common_initialize ( struct commonOptions *commonOpts );
+
+
 /**
  * This function creates a SolClient session and connects the Session.
  * @param context_p A pointer to the Context in which the Session is to be
@@ -237,6 +389,149 @@ solClient_returnCode_t
     common_publishMessage ( solClient_opaqueSession_pt session_p, char *topic_p, solClient_uint32_t deliveryMode );
 
 
+/**
+ * @anchor latencySamples
+ * @name Latency percentiles
+ * Helpers for reporting percentiles of latency samples recorded in
+ * microseconds.
+ */
+/*@{*/
+
+/**
+ * Sort latency samples in place, in ascending order.
+ */
+void
+    common_sortSamples ( solClient_uint64_t *samples_p, int numSamples );
+
+/**
+ * Returns the given percentile (0 to 100) of samples sorted with
+ * common_sortSamples(), using the nearest-rank method. Returns 0 when there
+ * are no samples.
+ */
+solClient_uint64_t
+    common_getPercentile ( const solClient_uint64_t *sortedSamples_p, int numSamples, double percentile );
+
+/*@}*/
+
+
+/**
+ * @anchor hashIndex
+ * @name Hash indexes and index rings
+ * The sequence tracker, topic merge, last-value cache, subscription registry
+ * and provisioner modules keep their entries in arrays, numbered from 0, and
+ * find them by name through a hash index: an open-addressing table of entry
+ * numbers with linear probing. An index has at least twice as many slots
+ * as entries, so it is at most half full: probe sequences stay short and
+ * always end at an empty slot. Entries are not removed from an index; it
+ * is cleared and rebuilt instead.
+ *
+ * A slot is set last, once its entry is complete, and does not change until
+ * the index is cleared, so lookups may run without the lock that serializes
+ * additions.
+ *
+ * An index ring is a first-in first-out queue of entry numbers, sized for
+ * every entry, in which its owner keeps each entry at most once.
+ */
+/*@{*/
+
+#define COMMON_HASH_NOT_FOUND        0xFFFFFFFFu    /**< common_hashIndex_find() result for a key not in the index. */
+
+typedef struct common_hashIndex
+{
+    volatile solClient_uint32_t *slots_p;   /**< Entry number + 1, 0 for an empty slot. */
+    solClient_uint32_t slotMask;            /**< Number of slots - 1. */
+} common_hashIndex_t, *common_hashIndex_pt;
+
+/**
+ * Returns non-zero if an entry has the given hash and key.
+ */
+typedef int     ( *common_hashMatchFunc_t ) ( void *user_p, solClient_uint32_t entry, solClient_uint64_t hash,
+                                              const char *key_p );
+
+typedef struct common_indexRing
+{
+    solClient_uint32_t *entries_p;
+    solClient_uint32_t size;
+    solClient_uint32_t head;
+    solClient_uint32_t count;
+} common_indexRing_t, *common_indexRing_pt;
+
+/**
+ * FNV-1a hash of a string.
+ */
+solClient_uint64_t
+    common_hashString ( const char *string_p );
+
+/**
+ * Initialize a hash index for up to maxEntries entries.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the slots cannot be allocated.
+ */
+solClient_returnCode_t
+    common_hashIndex_init ( common_hashIndex_pt index_p, unsigned int maxEntries );
+
+/**
+ * Release the slots of a hash index.
+ */
+void
+    common_hashIndex_destroy ( common_hashIndex_pt index_p );
+
+/**
+ * Empty a hash index, to rebuild it with common_hashIndex_insert().
+ */
+void
+    common_hashIndex_clear ( common_hashIndex_pt index_p );
+
+/**
+ * Find the entry of a key, calling match_p for the entries with a slot on
+ * the key's probe sequence.
+ * @return The entry number, or ::COMMON_HASH_NOT_FOUND with the empty slot
+ * for the key in *slot_p.
+ */
+solClient_uint32_t
+    common_hashIndex_find ( common_hashIndex_pt index_p, solClient_uint64_t hash, const char *key_p,
+                            common_hashMatchFunc_t match_p, void *user_p, solClient_uint32_t *slot_p );
+
+/**
+ * Point the empty slot returned by common_hashIndex_find() at a complete
+ * entry.
+ */
+void
+    common_hashIndex_set ( common_hashIndex_pt index_p, solClient_uint32_t slot, solClient_uint32_t entry );
+
+/**
+ * Add an entry known not to be in the index.
+ */
+void
+    common_hashIndex_insert ( common_hashIndex_pt index_p, solClient_uint64_t hash, solClient_uint32_t entry );
+
+/**
+ * Initialize an index ring for entries 0 to size - 1.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the ring cannot be allocated.
+ */
+solClient_returnCode_t
+    common_indexRing_init ( common_indexRing_pt ring_p, solClient_uint32_t size );
+
+/**
+ * Release the ring of entries.
+ */
+void
+    common_indexRing_destroy ( common_indexRing_pt ring_p );
+
+/**
+ * Queue an entry at the back, or at the front to take it again next.
+ */
+void
+    common_indexRing_push ( common_indexRing_pt ring_p, solClient_uint32_t entry, int front );
+
+/**
+ * Take the entry at the front of a ring that is not empty.
+ */
+solClient_uint32_t
+    common_indexRing_pop ( common_indexRing_pt ring_p );
+
+/*@}*/
+
+
 /**
  * A callback for cache events. The callback is given when making non-blocking
  * cache requests to perform actions when a cache event occurs.
@@ -402,16 +697,28 @@ solClient_rxMsgCallback_returnCode_t
     common_messageReceivePrintMsgCallback ( solClient_opaqueSession_pt opaqueSession_p, solClient_opaqueMsg_pt msg_p, void *user_p );
 
 
+/**
+ * Receive counters for common_messageReceivePerfCallback(), padded to a
+ * cache line so that the counters of Sessions served by different Context
+ * threads never share one. Allocate arrays of them with alignedAlloc().
+ */
+typedef struct common_rxPerfCounter
+{
+    volatile solClient_uint64_t msgs;
+    volatile solClient_uint64_t bytes;      /**< Binary attachment bytes. */
+    char            pad[COMMON_CACHE_LINE_SIZE - 2 * sizeof ( solClient_uint64_t )];
+} common_rxPerfCounter_t;
+
 /**
  * A callback for received messages by a Session. The callback is registered
  * for a Session and is called whenever a message is received.
- * This callback does nothing.
+ * This callback only counts the message, when user_p is not NULL.
  * @param opaqueSession_p A pointer to the session receiving the message.
  * This pointer is never NULL.
  * @param msg_p A pointer to the received message. This pointer is never
  * NULL.
- * @param user_p A pointer to opaque user data provided when the callback is 
- * registered.
+ * @param user_p NULL, or a common_rxPerfCounter_t written only by the
+ * Session's Context thread.
  * @return ::SOLCLIENT_CALLBACK_OK
  */
 solClient_rxMsgCallback_returnCode_t
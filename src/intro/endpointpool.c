@@ -0,0 +1,390 @@
+/** example ex/endpointpool.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Temporary endpoint pool used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "endpointpool.h"
+
+
+/*****************************************************************************
+ * common_endpointPoolReadyPush
+ *
+ * Make an endpoint ready. Called with the lock held.
+ *****************************************************************************/
+static void
+common_endpointPoolReadyPush ( common_endpointPool_pt pool_p, common_endpoint_pt endpoint_p )
+{
+    endpoint_p->state = COMMON_EPOOL_READY;
+    endpoint_p->readyPos = pool_p->numReady;
+    pool_p->ready_p[pool_p->numReady++] = ( solClient_uint32_t ) ( endpoint_p - pool_p->endpoints_p );
+}
+
+
+/*****************************************************************************
+ * common_endpointPoolReadyRemove
+ *
+ * Take an endpoint out of the ready stack, moving the top one into its
+ * place. Called with the lock held.
+ *****************************************************************************/
+static void
+common_endpointPoolReadyRemove ( common_endpointPool_pt pool_p, common_endpoint_pt endpoint_p )
+{
+    solClient_uint32_t top = pool_p->ready_p[--pool_p->numReady];
+
+    pool_p->ready_p[endpoint_p->readyPos] = top;
+    pool_p->endpoints_p[top].readyPos = endpoint_p->readyPos;
+}
+
+
+/*****************************************************************************
+ * common_endpointPoolRxCallback
+ *
+ * Give a message to the lease of its endpoint, or drop it.
+ *****************************************************************************/
+static          solClient_rxMsgCallback_returnCode_t
+common_endpointPoolRxCallback ( solClient_opaqueFlow_pt opaqueFlow_p, solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    common_endpoint_pt endpoint_p = ( common_endpoint_pt ) user_p;
+    common_endpointPool_pt pool_p = endpoint_p->pool_p;
+    solClient_flow_rxMsgCallbackFunc_t callback_p = NULL;
+    void           *leaseUser_p = NULL;
+
+    mutexLock ( &pool_p->mutex );
+    if ( endpoint_p->state == COMMON_EPOOL_LEASED ) {
+        callback_p = endpoint_p->callback_p;
+        leaseUser_p = endpoint_p->user_p;
+    } else {
+        pool_p->stats.strayMsgs++;
+    }
+    mutexUnlock ( &pool_p->mutex );
+    if ( callback_p != NULL ) {
+        return callback_p ( opaqueFlow_p, msg_p, leaseUser_p );
+    }
+    return SOLCLIENT_CALLBACK_OK;
+}
+
+
+/*****************************************************************************
+ * common_endpointPoolEventCallback
+ *
+ * Track the binds of the pool's Flows. A Flow that is up again after a
+ * reconnect keeps its state.
+ *****************************************************************************/
+static void
+common_endpointPoolEventCallback ( solClient_opaqueFlow_pt opaqueFlow_p, solClient_flow_eventCallbackInfo_pt eventInfo_p,
+                                   void *user_p )
+{
+    common_endpoint_pt endpoint_p = ( common_endpoint_pt ) user_p;
+    common_endpointPool_pt pool_p = endpoint_p->pool_p;
+    solClient_destination_t destination;
+    UINT64          bindUs;
+
+    mutexLock ( &pool_p->mutex );
+    switch ( eventInfo_p->flowEvent ) {
+        case SOLCLIENT_FLOW_EVENT_UP_NOTICE:
+            if ( endpoint_p->state != COMMON_EPOOL_BINDING ) {
+                break;
+            }
+            pool_p->numBinding--;
+            if ( solClient_flow_getDestination ( opaqueFlow_p, &destination, sizeof ( destination ) ) != SOLCLIENT_OK ) {
+                endpoint_p->state = COMMON_EPOOL_DEAD;
+                pool_p->stats.bindFailed++;
+                break;
+            }
+            strncpy ( endpoint_p->queueName, destination.dest, sizeof ( endpoint_p->queueName ) - 1 );
+            endpoint_p->queueName[sizeof ( endpoint_p->queueName ) - 1] = '\0';
+            endpoint_p->destination.destType = destination.destType;
+            endpoint_p->destination.dest = endpoint_p->queueName;
+            bindUs = getTimeInUs (  ) - endpoint_p->bindStartUs;
+            pool_p->stats.bound++;
+            pool_p->stats.bindUsTotal += bindUs;
+            if ( bindUs > pool_p->stats.bindUsMax ) {
+                pool_p->stats.bindUsMax = bindUs;
+            }
+            common_endpointPoolReadyPush ( pool_p, endpoint_p );
+            break;
+
+        case SOLCLIENT_FLOW_EVENT_BIND_FAILED_ERROR:
+        case SOLCLIENT_FLOW_EVENT_DOWN_ERROR:
+            if ( endpoint_p->state == COMMON_EPOOL_BINDING ) {
+                pool_p->numBinding--;
+                pool_p->stats.bindFailed++;
+                endpoint_p->state = COMMON_EPOOL_DEAD;
+            } else if ( endpoint_p->state == COMMON_EPOOL_READY ) {
+                common_endpointPoolReadyRemove ( pool_p, endpoint_p );
+                pool_p->stats.wentDown++;
+                endpoint_p->state = COMMON_EPOOL_DEAD;
+            } else if ( endpoint_p->state == COMMON_EPOOL_LEASED ) {
+                /* Replaced when released. */
+                pool_p->stats.wentDown++;
+                endpoint_p->down = 1;
+            }
+            break;
+
+        default:
+            break;
+    }
+    mutexUnlock ( &pool_p->mutex );
+    common_flowEventCallback ( opaqueFlow_p, eventInfo_p, NULL );
+}
+
+
+/*****************************************************************************
+ * common_endpointPoolThread
+ *
+ * Destroy the Flows of dead endpoints and bind new ones until target are
+ * ready or binding. Flows are created and destroyed without the lock, and
+ * only here, so an endpoint's Flow pointer does not change under it.
+ *****************************************************************************/
+static          THREAD_FUNC_RETURN_T
+common_endpointPoolThread ( void *user_p )
+{
+    common_endpointPool_pt pool_p = ( common_endpointPool_pt ) user_p;
+    common_endpoint_pt endpoint_p;
+    solClient_flow_createFuncInfo_t flowFuncInfo = SOLCLIENT_FLOW_CREATEFUNC_INITIALIZER;
+    const char     *flowProps[20] = {0, };
+    int             propIndex = 0;
+    solClient_returnCode_t rc;
+    solClient_uint32_t i;
+
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_BLOCKING;
+    flowProps[propIndex++] = SOLCLIENT_PROP_DISABLE_VAL;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_ID;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_QUEUE;
+    flowProps[propIndex++] = SOLCLIENT_FLOW_PROP_BIND_ENTITY_DURABLE;
+    flowProps[propIndex++] = SOLCLIENT_PROP_DISABLE_VAL;
+    flowProps[propIndex] = NULL;
+    flowFuncInfo.rxMsgInfo.callback_p = common_endpointPoolRxCallback;
+    flowFuncInfo.eventInfo.callback_p = common_endpointPoolEventCallback;
+
+    while ( !pool_p->stop ) {
+        mutexLock ( &pool_p->mutex );
+        for ( i = 0; i < pool_p->maxEndpoints && !pool_p->stop; i++ ) {
+            endpoint_p = &pool_p->endpoints_p[i];
+            if ( endpoint_p->state == COMMON_EPOOL_DEAD ) {
+                mutexUnlock ( &pool_p->mutex );
+                if ( endpoint_p->flow_p != NULL ) {
+                    solClient_flow_destroy ( &endpoint_p->flow_p );
+                }
+                mutexLock ( &pool_p->mutex );
+                endpoint_p->flow_p = NULL;
+                endpoint_p->state = COMMON_EPOOL_EMPTY;
+                pool_p->stats.destroyed++;
+            }
+            if ( endpoint_p->state != COMMON_EPOOL_EMPTY || pool_p->numReady + pool_p->numBinding >= pool_p->target ||
+                 pool_p->numBinding >= COMMON_EPOOL_BIND_WINDOW ) {
+                continue;
+            }
+            endpoint_p->state = COMMON_EPOOL_BINDING;
+            endpoint_p->down = 0;
+            endpoint_p->uses = 0;
+            endpoint_p->queueName[0] = '\0';
+            endpoint_p->bindStartUs = getTimeInUs (  );
+            pool_p->numBinding++;
+            mutexUnlock ( &pool_p->mutex );
+
+            flowFuncInfo.rxMsgInfo.user_p = endpoint_p;
+            flowFuncInfo.eventInfo.user_p = endpoint_p;
+            rc = solClient_session_createFlow ( ( char ** ) flowProps, pool_p->session_p, &endpoint_p->flow_p,
+                                                &flowFuncInfo, sizeof ( flowFuncInfo ) );
+
+            mutexLock ( &pool_p->mutex );
+            if ( rc != SOLCLIENT_OK && rc != SOLCLIENT_IN_PROGRESS && endpoint_p->state == COMMON_EPOOL_BINDING ) {
+                /* No event will come. */
+                solClient_log ( SOLCLIENT_LOG_WARNING, "Temporary Queue Flow not created: %s, %s",
+                                solClient_returnCodeToString ( rc ),
+                                solClient_subCodeToString ( solClient_getLastErrorInfo (  )->subCode ) );
+                pool_p->numBinding--;
+                pool_p->stats.bindFailed++;
+                endpoint_p->state = COMMON_EPOOL_DEAD;
+                break;
+            }
+        }
+        mutexUnlock ( &pool_p->mutex );
+        sleepInUs ( COMMON_EPOOL_POLL_US );
+    }
+    return THREAD_FUNC_RETURN_VAL;
+}
+
+
+/*****************************************************************************
+ * common_endpointPool_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_endpointPool_init ( common_endpointPool_pt pool_p, solClient_opaqueSession_pt session_p,
+                           unsigned int target, unsigned int maxEndpoints )
+{
+    solClient_uint32_t i;
+
+    memset ( pool_p, 0, sizeof ( *pool_p ) );
+    if ( maxEndpoints < target ) {
+        maxEndpoints = target;
+    }
+    if ( maxEndpoints == 0 ) {
+        maxEndpoints = 1;
+    }
+    pool_p->endpoints_p = ( common_endpoint_t * ) calloc ( maxEndpoints, sizeof ( common_endpoint_t ) );
+    pool_p->ready_p = ( solClient_uint32_t * ) malloc ( maxEndpoints * sizeof ( solClient_uint32_t ) );
+    if ( pool_p->endpoints_p == NULL || pool_p->ready_p == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate an endpoint pool of %u endpoints", maxEndpoints );
+        free ( pool_p->endpoints_p );
+        free ( pool_p->ready_p );
+        memset ( pool_p, 0, sizeof ( *pool_p ) );
+        return SOLCLIENT_FAIL;
+    }
+    for ( i = 0; i < maxEndpoints; i++ ) {
+        pool_p->endpoints_p[i].pool_p = pool_p;
+    }
+    pool_p->session_p = session_p;
+    pool_p->maxEndpoints = maxEndpoints;
+    pool_p->target = target;
+    mutexInit ( &pool_p->mutex );
+    if ( threadCreate ( &pool_p->thread, common_endpointPoolThread, pool_p ) != 0 ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not start the endpoint pool thread" );
+        mutexDestroy ( &pool_p->mutex );
+        free ( pool_p->endpoints_p );
+        free ( pool_p->ready_p );
+        memset ( pool_p, 0, sizeof ( *pool_p ) );
+        return SOLCLIENT_FAIL;
+    }
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_endpointPool_destroy
+ *****************************************************************************/
+void
+common_endpointPool_destroy ( common_endpointPool_pt pool_p )
+{
+    solClient_uint32_t i;
+
+    if ( pool_p->endpoints_p == NULL ) {
+        return;
+    }
+    pool_p->stop = 1;
+    threadJoin ( pool_p->thread );
+    for ( i = 0; i < pool_p->maxEndpoints; i++ ) {
+        if ( pool_p->endpoints_p[i].flow_p != NULL ) {
+            solClient_flow_destroy ( &pool_p->endpoints_p[i].flow_p );
+        }
+    }
+    free ( pool_p->endpoints_p );
+    free ( pool_p->ready_p );
+    pool_p->endpoints_p = NULL;
+    pool_p->ready_p = NULL;
+    mutexDestroy ( &pool_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_endpointPool_waitReady
+ *****************************************************************************/
+solClient_returnCode_t
+common_endpointPool_waitReady ( common_endpointPool_pt pool_p, int timeoutMs )
+{
+    UINT64          deadlineUs = getTimeInUs (  ) + ( UINT64 ) timeoutMs * 1000;
+    solClient_uint32_t numReady;
+
+    for ( ;; ) {
+        mutexLock ( &pool_p->mutex );
+        numReady = pool_p->numReady;
+        mutexUnlock ( &pool_p->mutex );
+        if ( numReady >= pool_p->target ) {
+            return SOLCLIENT_OK;
+        }
+        if ( getTimeInUs (  ) >= deadlineUs ) {
+            return SOLCLIENT_INCOMPLETE;
+        }
+        sleepInUs ( COMMON_EPOOL_POLL_US );
+    }
+}
+
+
+/*****************************************************************************
+ * common_endpointPool_acquire
+ *****************************************************************************/
+common_endpoint_pt
+common_endpointPool_acquire ( common_endpointPool_pt pool_p, solClient_flow_rxMsgCallbackFunc_t callback_p, void *user_p )
+{
+    common_endpoint_pt endpoint_p;
+
+    mutexLock ( &pool_p->mutex );
+    if ( pool_p->numReady == 0 ) {
+        pool_p->stats.empty++;
+        mutexUnlock ( &pool_p->mutex );
+        return NULL;
+    }
+    endpoint_p = &pool_p->endpoints_p[pool_p->ready_p[--pool_p->numReady]];
+    endpoint_p->state = COMMON_EPOOL_LEASED;
+    endpoint_p->callback_p = callback_p;
+    endpoint_p->user_p = user_p;
+    if ( endpoint_p->uses++ > 0 ) {
+        pool_p->stats.reused++;
+    }
+    pool_p->numLeased++;
+    pool_p->stats.acquired++;
+    mutexUnlock ( &pool_p->mutex );
+    return endpoint_p;
+}
+
+
+/*****************************************************************************
+ * common_endpointPool_release
+ *****************************************************************************/
+void
+common_endpointPool_release ( common_endpoint_pt endpoint_p, int reuse )
+{
+    common_endpointPool_pt pool_p = endpoint_p->pool_p;
+
+    mutexLock ( &pool_p->mutex );
+    if ( endpoint_p->state == COMMON_EPOOL_LEASED ) {
+        endpoint_p->callback_p = NULL;
+        endpoint_p->user_p = NULL;
+        pool_p->numLeased--;
+        if ( reuse && !endpoint_p->down ) {
+            common_endpointPoolReadyPush ( pool_p, endpoint_p );
+        } else {
+            endpoint_p->state = COMMON_EPOOL_DEAD;
+        }
+    }
+    mutexUnlock ( &pool_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_endpointPool_printStats
+ *****************************************************************************/
+void
+common_endpointPool_printStats ( common_endpointPool_pt pool_p )
+{
+    mutexLock ( &pool_p->mutex );
+    printf ( "Endpoint pool: %u ready, %u binding, %u leased of %u, target %u; %llu acquired (%llu reused), "
+             "%llu found none ready\n",
+             pool_p->numReady, pool_p->numBinding, pool_p->numLeased, pool_p->maxEndpoints, pool_p->target,
+             ( unsigned long long ) pool_p->stats.acquired, ( unsigned long long ) pool_p->stats.reused,
+             ( unsigned long long ) pool_p->stats.empty );
+    printf ( "Endpoint Flows: %llu bound (mean %.3f ms, max %.3f ms), %llu failed to bind, %llu went down, "
+             "%llu destroyed, %llu messages dropped while not leased\n",
+             ( unsigned long long ) pool_p->stats.bound,
+             pool_p->stats.bound > 0 ? pool_p->stats.bindUsTotal / 1000.0 / pool_p->stats.bound : 0.0,
+             pool_p->stats.bindUsMax / 1000.0, ( unsigned long long ) pool_p->stats.bindFailed,
+             ( unsigned long long ) pool_p->stats.wentDown, ( unsigned long long ) pool_p->stats.destroyed,
+             ( unsigned long long ) pool_p->stats.strayMsgs );
+    mutexUnlock ( &pool_p->mutex );
+}
@@ -0,0 +1,149 @@
+/** example ex/endpointpool.h
+ */
+
+/**
+ *
+ * file endpointpool.h Temporary endpoint pool for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef ENDPOINTPOOL_H_
+#define ENDPOINTPOOL_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor endpointPool
+ * @name Temporary endpoint pool
+ * An endpoint pool keeps a number of temporary Queues ready, each with a
+ * Flow bound to it, so that short-lived workflows (a reply Queue for a
+ * request, a per-job consumer) do not wait for a bind round-trip.
+ * solClient_session_endpointProvision() only provisions durable endpoints,
+ * so the temporary Queues are created by binding non-blocking Flows with
+ * ::SOLCLIENT_FLOW_PROP_BIND_ENTITY_DURABLE disabled, letting the message
+ * router name them.
+ *
+ * A pool thread binds Flows in the background, up to
+ * ::COMMON_EPOOL_BIND_WINDOW at a time, until target endpoints are ready,
+ * and destroys the Flows of endpoints that went down or were released for
+ * good. common_endpointPool_acquire() takes a ready endpoint in constant
+ * time and directs its messages to the given callback;
+ * common_endpointPool_release() gives it back for reuse with its Flow still
+ * bound, or has it replaced. Messages that arrive on an endpoint that is
+ * not leased are counted and dropped.
+ */
+/*@{*/
+
+#define COMMON_EPOOL_BIND_WINDOW     32         /**< Flows being bound at once by the pool thread. */
+#define COMMON_EPOOL_POLL_US         1000       /**< Wait between the pool thread's passes. */
+
+typedef enum common_endpointState
+{
+    COMMON_EPOOL_EMPTY = 0,         /**< No Flow. */
+    COMMON_EPOOL_BINDING,
+    COMMON_EPOOL_READY,
+    COMMON_EPOOL_LEASED,
+    COMMON_EPOOL_DEAD               /**< Its Flow is to be destroyed by the pool thread. */
+} common_endpointState_t;
+
+typedef struct common_endpoint
+{
+    struct common_endpointPool *pool_p;
+    solClient_opaqueFlow_pt flow_p;
+    solClient_flow_rxMsgCallbackFunc_t callback_p;  /**< Of the lease. */
+    void           *user_p;
+    common_endpointState_t state;
+    int             down;           /**< The Flow went down while leased. */
+    solClient_uint32_t readyPos;    /**< Position in the ready stack. */
+    solClient_uint32_t uses;        /**< Leases of this Flow. */
+    UINT64          bindStartUs;
+    solClient_destination_t destination;    /**< The temporary Queue, naming queueName. */
+    char            queueName[SOLCLIENT_BUFINFO_MAX_QUEUENAME_SIZE + 1];
+} common_endpoint_t, *common_endpoint_pt;
+
+typedef struct common_endpointPoolStats
+{
+    solClient_uint64_t bound;
+    solClient_uint64_t bindFailed;
+    solClient_uint64_t acquired;
+    solClient_uint64_t reused;      /**< Leases of an endpoint leased before. */
+    solClient_uint64_t empty;       /**< Acquires that found no endpoint ready. */
+    solClient_uint64_t wentDown;
+    solClient_uint64_t destroyed;
+    solClient_uint64_t strayMsgs;   /**< Received while not leased. */
+    UINT64          bindUsTotal;
+    UINT64          bindUsMax;
+} common_endpointPoolStats_t;
+
+typedef struct common_endpointPool
+{
+    MUTEX_T         mutex;
+    solClient_opaqueSession_pt session_p;
+    common_endpoint_t *endpoints_p;
+    solClient_uint32_t maxEndpoints;
+    solClient_uint32_t target;
+    solClient_uint32_t *ready_p;    /**< Stack of ready endpoints. */
+    solClient_uint32_t numReady;
+    solClient_uint32_t numBinding;
+    solClient_uint32_t numLeased;
+    THREAD_T        thread;
+    volatile int    stop;
+    common_endpointPoolStats_t stats;
+} common_endpointPool_t, *common_endpointPool_pt;
+
+/**
+ * Initialize a pool of up to maxEndpoints temporary Queues on a connected
+ * Session, and start binding target of them. Endpoints that are leased
+ * count towards maxEndpoints but not towards target.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the pool cannot be allocated
+ * or its thread started.
+ */
+solClient_returnCode_t
+    common_endpointPool_init ( common_endpointPool_pt pool_p, solClient_opaqueSession_pt session_p,
+                               unsigned int target, unsigned int maxEndpoints );
+
+/**
+ * Stop the pool thread and destroy every Flow, leased or not. Must not be
+ * called from the Context thread.
+ */
+void
+    common_endpointPool_destroy ( common_endpointPool_pt pool_p );
+
+/**
+ * Wait up to timeoutMs for target endpoints to be ready.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_INCOMPLETE on timeout.
+ */
+solClient_returnCode_t
+    common_endpointPool_waitReady ( common_endpointPool_pt pool_p, int timeoutMs );
+
+/**
+ * Lease a ready endpoint. Its messages are given to callback_p with user_p
+ * from the Context thread until it is released. The Queue to send to or
+ * reply to is in destination and the Flow, for acknowledgements, in flow_p.
+ * @return The endpoint, or NULL if none is ready.
+ */
+common_endpoint_pt
+    common_endpointPool_acquire ( common_endpointPool_pt pool_p, solClient_flow_rxMsgCallbackFunc_t callback_p,
+                                  void *user_p );
+
+/**
+ * End a lease. With reuse set, and the Flow still up, the endpoint goes
+ * back to the pool as it is; messages still on its Queue will go to the
+ * next lease. Otherwise its Flow is destroyed, deleting the Queue, and a
+ * new one is bound. May be called from the endpoint's callback; a
+ * callback already running for the endpoint can complete after it returns.
+ */
+void
+    common_endpointPool_release ( common_endpoint_pt endpoint_p, int reuse );
+
+/**
+ * Print the pool counters and the bind time of its Flows.
+ */
+void
+    common_endpointPool_printStats ( common_endpointPool_pt pool_p );
+
+/*@}*/
+
+#endif /* ENDPOINTPOOL_H_ */
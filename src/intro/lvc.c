@@ -0,0 +1,375 @@
+/** example ex/lvc.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Last-value cache used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "solclient/solCache.h"
+#include "common.h"
+#include "lvc.h"
+
+
+/*****************************************************************************
+ * common_lvcMatch
+ *****************************************************************************/
+static int
+common_lvcMatch ( void *user_p, solClient_uint32_t entry, solClient_uint64_t hash, const char *topic_p )
+{
+    const common_lvcEntry_t *entry_p = &( ( common_lvc_pt ) user_p )->entries_p[entry];
+
+    return entry_p->hash == hash && strcmp ( entry_p->topic, topic_p ) == 0;
+}
+
+
+/*****************************************************************************
+ * common_lvcFind
+ *
+ * Find the entry of a topic, with the empty slot for it in *slot_p if it
+ * has none. Safe without the lock: an entry is complete before it is
+ * indexed, and its topic never changes.
+ *****************************************************************************/
+static common_lvcEntry_t *
+common_lvcFind ( common_lvc_pt lvc_p, const char *topic_p, solClient_uint64_t hash, solClient_uint32_t * slot_p )
+{
+    solClient_uint32_t entry;
+
+    if ( ( entry = common_hashIndex_find ( &lvc_p->index, hash, topic_p, common_lvcMatch, lvc_p, slot_p ) ) ==
+         COMMON_HASH_NOT_FOUND ) {
+        return NULL;
+    }
+    return &lvc_p->entries_p[entry];
+}
+
+
+/*****************************************************************************
+ * common_lvcAdd
+ *
+ * Find the entry of a topic, adding it if there is room. Called with the
+ * lock held.
+ *****************************************************************************/
+static common_lvcEntry_t *
+common_lvcAdd ( common_lvc_pt lvc_p, const char *topic_p, solClient_uint64_t hash )
+{
+    common_lvcEntry_t *entry_p;
+    solClient_uint32_t slot;
+
+    if ( ( entry_p = common_lvcFind ( lvc_p, topic_p, hash, &slot ) ) != NULL ) {
+        return entry_p;
+    }
+    if ( lvc_p->numTopics >= lvc_p->maxTopics ) {
+        lvc_p->stats.full++;
+        return NULL;
+    }
+    entry_p = &lvc_p->entries_p[lvc_p->numTopics];
+    entry_p->length = COMMON_LVC_NO_VALUE;
+    entry_p->hash = hash;
+    strcpy ( entry_p->topic, topic_p );
+    common_hashIndex_set ( &lvc_p->index, slot, lvc_p->numTopics );
+    lvc_p->numTopics++;
+    return entry_p;
+}
+
+
+/*****************************************************************************
+ * common_lvc_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_lvc_init ( common_lvc_pt lvc_p, unsigned int maxTopics, unsigned int valueSize,
+                  solClient_opaqueCacheSession_pt cacheSession_p )
+{
+    size_t          valueStride;
+    unsigned int    i;
+
+    memset ( lvc_p, 0, sizeof ( *lvc_p ) );
+    /* Values start on their own cache line, so readers of one do not share a line with updates of another. */
+    valueStride = ( valueSize + COMMON_CACHE_LINE_SIZE - 1 ) & ~( size_t ) ( COMMON_CACHE_LINE_SIZE - 1 );
+    lvc_p->entries_p = ( common_lvcEntry_t * ) alignedAlloc ( maxTopics * sizeof ( common_lvcEntry_t ), COMMON_CACHE_LINE_SIZE );
+    lvc_p->values_p = ( char * ) alignedAlloc ( maxTopics * valueStride + 1, COMMON_CACHE_LINE_SIZE );
+    if ( lvc_p->entries_p == NULL || lvc_p->values_p == NULL ||
+         common_hashIndex_init ( &lvc_p->index, maxTopics ) != SOLCLIENT_OK ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a last-value cache for %u topics", maxTopics );
+        alignedFree ( lvc_p->entries_p );
+        alignedFree ( lvc_p->values_p );
+        memset ( lvc_p, 0, sizeof ( *lvc_p ) );
+        return SOLCLIENT_FAIL;
+    }
+    memset ( lvc_p->entries_p, 0, maxTopics * sizeof ( common_lvcEntry_t ) );
+    for ( i = 0; i < maxTopics; i++ ) {
+        lvc_p->entries_p[i].value_p = lvc_p->values_p + i * valueStride;
+    }
+    lvc_p->maxTopics = maxTopics;
+    lvc_p->valueSize = valueSize;
+    lvc_p->cacheSession_p = cacheSession_p;
+    mutexInit ( &lvc_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_lvc_destroy
+ *****************************************************************************/
+void
+common_lvc_destroy ( common_lvc_pt lvc_p )
+{
+    solClient_uint32_t i;
+
+    for ( i = 0; i < lvc_p->numTopics; i++ ) {
+        if ( lvc_p->entries_p[i].msg_p != NULL ) {
+            solClient_msg_free ( &lvc_p->entries_p[i].msg_p );
+        }
+    }
+    mutexDestroy ( &lvc_p->mutex );
+    alignedFree ( lvc_p->entries_p );
+    alignedFree ( lvc_p->values_p );
+    common_hashIndex_destroy ( &lvc_p->index );
+    lvc_p->entries_p = NULL;
+    lvc_p->values_p = NULL;
+}
+
+
+/*****************************************************************************
+ * common_lvc_update
+ *****************************************************************************/
+solClient_returnCode_t
+common_lvc_update ( common_lvc_pt lvc_p, solClient_opaqueMsg_pt msg_p )
+{
+    solClient_returnCode_t rc;
+    solClient_destination_t destination;
+    common_lvcEntry_t *entry_p;
+    solClient_opaqueMsg_pt copy_p = NULL;
+    solClient_opaqueMsg_pt old_p;
+    void           *data_p = NULL;
+    solClient_uint32_t length = 0;
+    int             isCacheMsg;
+
+    if ( solClient_msg_getDestination ( msg_p, &destination, sizeof ( destination ) ) != SOLCLIENT_OK ||
+         destination.destType != SOLCLIENT_TOPIC_DESTINATION ) {
+        return SOLCLIENT_OK;
+    }
+    if ( solClient_msg_getBinaryAttachmentPtr ( msg_p, &data_p, &length ) != SOLCLIENT_OK ) {
+        length = 0;
+    }
+    isCacheMsg = solClient_msg_isCacheMsg ( msg_p ) != SOLCLIENT_CACHE_LIVE_MESSAGE;
+    /* Copy before taking the lock. */
+    if ( ( rc = solClient_msg_dup ( msg_p, &copy_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_dup()" );
+        return rc;
+    }
+
+    mutexLock ( &lvc_p->mutex );
+    if ( ( entry_p = common_lvcAdd ( lvc_p, destination.dest, common_hashString ( destination.dest ) ) ) == NULL ) {
+        mutexUnlock ( &lvc_p->mutex );
+        solClient_msg_free ( &copy_p );
+        return SOLCLIENT_FAIL;
+    }
+    if ( isCacheMsg && entry_p->length != COMMON_LVC_NO_VALUE ) {
+        /* Live data arrived before the cache response; it is newer. */
+        lvc_p->stats.staleCacheMsgs++;
+        mutexUnlock ( &lvc_p->mutex );
+        solClient_msg_free ( &copy_p );
+        return SOLCLIENT_OK;
+    }
+    old_p = entry_p->msg_p;
+    entry_p->msg_p = copy_p;
+
+    entry_p->seq++;
+    MEMORY_BARRIER (  );
+    if ( length <= lvc_p->valueSize ) {
+        memcpy ( entry_p->value_p, data_p, length );
+    } else {
+        lvc_p->stats.oversize++;
+    }
+    entry_p->length = length;
+    MEMORY_BARRIER (  );
+    entry_p->seq++;
+
+    entry_p->updates++;
+    entry_p->updateUs = getTimeInUs (  );
+    lvc_p->stats.updates++;
+    if ( isCacheMsg ) {
+        lvc_p->stats.cacheUpdates++;
+    }
+    mutexUnlock ( &lvc_p->mutex );
+
+    if ( old_p != NULL ) {
+        solClient_msg_free ( &old_p );
+    }
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_lvcCacheEventCallback
+ *****************************************************************************/
+static void
+common_lvcCacheEventCallback ( solClient_opaqueSession_pt opaqueSession_p, solCache_eventCallbackInfo_pt eventInfo_p,
+                               void *user_p )
+{
+    common_lvc_pt   lvc_p = ( common_lvc_pt ) user_p;
+    common_lvcEntry_t *entry_p;
+    solClient_uint32_t slot;
+
+    mutexLock ( &lvc_p->mutex );
+    if ( ( entry_p = common_lvcFind ( lvc_p, eventInfo_p->topic, common_hashString ( eventInfo_p->topic ), &slot ) ) != NULL ) {
+        entry_p->requestPending = 0;
+    }
+    if ( eventInfo_p->rc != SOLCLIENT_OK ) {
+        lvc_p->stats.cacheRequestsFailed++;
+    }
+    mutexUnlock ( &lvc_p->mutex );
+    if ( eventInfo_p->rc != SOLCLIENT_OK ) {
+        solClient_log ( SOLCLIENT_LOG_INFO, "Cache request for '%s' completed: %s, %s", eventInfo_p->topic,
+                        solClient_returnCodeToString ( eventInfo_p->rc ), solClient_subCodeToString ( eventInfo_p->subCode ) );
+    }
+}
+
+
+/*****************************************************************************
+ * common_lvcRequest
+ *
+ * The miss path of common_lvc_read(): send a cache request for the topic,
+ * unless one is outstanding or failed recently.
+ *****************************************************************************/
+static solClient_returnCode_t
+common_lvcRequest ( common_lvc_pt lvc_p, const char *topic_p, solClient_uint64_t hash )
+{
+    solClient_returnCode_t rc;
+    common_lvcEntry_t *entry_p;
+    solClient_uint64_t cacheRequestId;
+    UINT64          nowUs;
+
+    if ( lvc_p->cacheSession_p == NULL || strlen ( topic_p ) > SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE ) {
+        return SOLCLIENT_NOT_FOUND;
+    }
+    nowUs = getTimeInUs (  );
+    mutexLock ( &lvc_p->mutex );
+    if ( ( entry_p = common_lvcAdd ( lvc_p, topic_p, hash ) ) == NULL ) {
+        mutexUnlock ( &lvc_p->mutex );
+        return SOLCLIENT_NOT_FOUND;
+    }
+    if ( entry_p->requestPending || entry_p->length != COMMON_LVC_NO_VALUE ) {
+        /* Another reader got here first. */
+        mutexUnlock ( &lvc_p->mutex );
+        return SOLCLIENT_IN_PROGRESS;
+    }
+    if ( entry_p->requestUs != 0 && nowUs - entry_p->requestUs < COMMON_LVC_RETRY_MS * 1000 ) {
+        mutexUnlock ( &lvc_p->mutex );
+        return SOLCLIENT_NOT_FOUND;
+    }
+    entry_p->requestPending = 1;
+    entry_p->requestUs = nowUs;
+    cacheRequestId = ++lvc_p->nextCacheRequestId;
+    lvc_p->stats.cacheRequests++;
+    mutexUnlock ( &lvc_p->mutex );
+
+    /* The topic of an entry never changes, so it can be used without the lock. */
+    rc = solClient_cacheSession_sendCacheRequest ( lvc_p->cacheSession_p, entry_p->topic, cacheRequestId,
+                                                   common_lvcCacheEventCallback, lvc_p,
+                                                   SOLCLIENT_CACHEREQUEST_FLAGS_LIVEDATA_FULFILL |
+                                                   SOLCLIENT_CACHEREQUEST_FLAGS_NOWAIT_REPLY, 0 );
+    if ( rc != SOLCLIENT_IN_PROGRESS ) {
+        common_handleError ( rc, "solClient_cacheSession_sendCacheRequest()" );
+        mutexLock ( &lvc_p->mutex );
+        entry_p->requestPending = 0;
+        lvc_p->stats.cacheRequestsFailed++;
+        mutexUnlock ( &lvc_p->mutex );
+        return SOLCLIENT_NOT_FOUND;
+    }
+    return SOLCLIENT_IN_PROGRESS;
+}
+
+
+/*****************************************************************************
+ * common_lvc_read
+ *****************************************************************************/
+solClient_returnCode_t
+common_lvc_read ( common_lvc_pt lvc_p, const char *topic_p, void *buf_p, solClient_uint32_t bufSize,
+                  solClient_uint32_t * length_p )
+{
+    common_lvcEntry_t *entry_p;
+    solClient_uint64_t hash = common_hashString ( topic_p );
+    solClient_uint32_t slot;
+    solClient_uint32_t seq;
+    solClient_uint32_t length;
+    int             fits;
+
+    *length_p = 0;
+    if ( ( entry_p = common_lvcFind ( lvc_p, topic_p, hash, &slot ) ) != NULL ) {
+        for ( ;; ) {
+            seq = entry_p->seq;
+            READ_BARRIER (  );
+            if ( seq & 1 ) {
+                /* An update is in progress; it is short. */
+                continue;
+            }
+            if ( ( length = entry_p->length ) == COMMON_LVC_NO_VALUE ) {
+                break;
+            }
+            fits = length <= bufSize && length <= lvc_p->valueSize;
+            if ( fits ) {
+                memcpy ( buf_p, entry_p->value_p, length );
+            }
+            READ_BARRIER (  );
+            if ( entry_p->seq == seq ) {
+                *length_p = length;
+                return fits ? SOLCLIENT_OK : SOLCLIENT_FAIL;
+            }
+        }
+        if ( entry_p->requestPending ) {
+            return SOLCLIENT_IN_PROGRESS;
+        }
+    }
+    return common_lvcRequest ( lvc_p, topic_p, hash );
+}
+
+
+/*****************************************************************************
+ * common_lvc_getMsg
+ *****************************************************************************/
+solClient_returnCode_t
+common_lvc_getMsg ( common_lvc_pt lvc_p, const char *topic_p, solClient_opaqueMsg_pt * msg_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_NOT_FOUND;
+    common_lvcEntry_t *entry_p;
+    solClient_uint32_t slot;
+
+    mutexLock ( &lvc_p->mutex );
+    entry_p = common_lvcFind ( lvc_p, topic_p, common_hashString ( topic_p ), &slot );
+    if ( entry_p != NULL && entry_p->msg_p != NULL &&
+         ( rc = solClient_msg_dup ( entry_p->msg_p, msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_dup()" );
+    }
+    mutexUnlock ( &lvc_p->mutex );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * common_lvc_printStats
+ *****************************************************************************/
+void
+common_lvc_printStats ( common_lvc_pt lvc_p )
+{
+    mutexLock ( &lvc_p->mutex );
+    printf ( "Last-value cache: %u of %u topics, %llu updates (%llu from the cache, %llu stale cache messages, "
+             "%llu oversize), %llu topics not added\n",
+             lvc_p->numTopics, lvc_p->maxTopics, ( unsigned long long ) lvc_p->stats.updates,
+             ( unsigned long long ) lvc_p->stats.cacheUpdates, ( unsigned long long ) lvc_p->stats.staleCacheMsgs,
+             ( unsigned long long ) lvc_p->stats.oversize, ( unsigned long long ) lvc_p->stats.full );
+    printf ( "Cache requests: %llu sent, %llu failed\n",
+             ( unsigned long long ) lvc_p->stats.cacheRequests, ( unsigned long long ) lvc_p->stats.cacheRequestsFailed );
+    mutexUnlock ( &lvc_p->mutex );
+}
@@ -0,0 +1,143 @@
+/** example ex/lvc.h
+ */
+
+/**
+ *
+ * file lvc.h Last-value cache for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef LVC_H_
+#define LVC_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor lastValueCache
+ * @name Last-value cache
+ * An in-process cache of the latest message received on each topic, for
+ * applications that read snapshots of many topics far more often than the
+ * topics are updated.
+ *
+ * Messages are added from the receive callback with common_lvc_update(),
+ * which keeps a copy (solClient_msg_dup()) of the latest message per topic
+ * and a snapshot of its binary attachment. Topics are kept in an array of
+ * entries with a hash index (see @ref hashIndex), allocated for maxTopics
+ * when the cache is initialized; topics are never removed. Updates are
+ * serialized by a lock, but common_lvc_read() takes no lock: each entry is a
+ * sequence lock, and a reader copies the snapshot and retries if an update
+ * overlapped the copy.
+ *
+ * When a topic is read that has no value yet and the cache has a cache
+ * session (see solClient_session_createCacheSession()), the read sends an
+ * asynchronous cache request for the topic
+ * (::SOLCLIENT_CACHEREQUEST_FLAGS_NOWAIT_REPLY) and returns at once.
+ * Further reads of the topic do not send requests until it completes, and
+ * the cached message fills the entry when it is passed to
+ * common_lvc_update() like any other. The request subscribes to the topic,
+ * so it is kept up to date by live messages from then on.
+ */
+/*@{*/
+
+#define COMMON_LVC_NO_VALUE          0xFFFFFFFFu    /**< Entry length until the topic has a value. */
+#define COMMON_LVC_RETRY_MS          1000       /**< Least time between cache requests for a topic after one fails. */
+
+typedef struct common_lvcEntry
+{
+    volatile solClient_uint32_t seq;    /**< Odd while the snapshot is being updated. */
+    volatile solClient_uint32_t length; /**< Attachment length, or COMMON_LVC_NO_VALUE. */
+    solClient_uint64_t updates;
+    UINT64          updateUs;           /**< getTimeInUs() of the last update. */
+    char           *value_p;            /**< valueSize bytes. */
+    solClient_opaqueMsg_pt msg_p;       /**< Latest message; protected by the cache's lock. */
+    volatile int    requestPending;     /**< A cache request for the topic is outstanding. */
+    UINT64          requestUs;          /**< getTimeInUs() of the last cache request. */
+    solClient_uint64_t hash;            /**< Of the topic. */
+    char            topic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 1];
+} common_lvcEntry_t;
+
+typedef struct common_lvcStats
+{
+    solClient_uint64_t updates;
+    solClient_uint64_t cacheUpdates;    /**< Updates from cache responses. */
+    solClient_uint64_t staleCacheMsgs;  /**< Cached messages ignored because live data arrived first. */
+    solClient_uint64_t oversize;        /**< Updates larger than valueSize; read with common_lvc_getMsg(). */
+    solClient_uint64_t full;            /**< Topics not added because maxTopics topics were cached. */
+    solClient_uint64_t cacheRequests;
+    solClient_uint64_t cacheRequestsFailed;
+} common_lvcStats_t;
+
+typedef struct common_lvc
+{
+    MUTEX_T         mutex;
+    common_hashIndex_t index;           /**< Entries by topic. */
+    solClient_uint32_t maxTopics;
+    volatile solClient_uint32_t numTopics;
+    common_lvcEntry_t *entries_p;
+    char           *values_p;
+    solClient_uint32_t valueSize;
+    solClient_opaqueCacheSession_pt cacheSession_p;
+    solClient_uint64_t nextCacheRequestId;
+    common_lvcStats_t stats;
+} common_lvc_t, *common_lvc_pt;
+
+/**
+ * Initialize a last-value cache for up to maxTopics topics, keeping up to
+ * valueSize bytes of binary attachment per topic for common_lvc_read().
+ * cacheSession_p is used for cache requests on misses, and may be NULL.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the cache cannot be allocated.
+ */
+solClient_returnCode_t
+    common_lvc_init ( common_lvc_pt lvc_p, unsigned int maxTopics, unsigned int valueSize,
+                      solClient_opaqueCacheSession_pt cacheSession_p );
+
+/**
+ * Free the messages kept and release the cache. No cache request may be
+ * outstanding: destroy the cache session first.
+ */
+void
+    common_lvc_destroy ( common_lvc_pt lvc_p );
+
+/**
+ * Update the cache with a received message, which is not kept: the cache
+ * keeps a copy. Messages to queues are ignored. A cached message
+ * (solClient_msg_isCacheMsg()) only fills a topic that has no value yet.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the message has a new topic
+ * and the cache is full, or cannot be copied.
+ */
+solClient_returnCode_t
+    common_lvc_update ( common_lvc_pt lvc_p, solClient_opaqueMsg_pt msg_p );
+
+/**
+ * Copy the latest binary attachment on a topic into buf_p, without taking
+ * a lock. *length_p is set to the attachment length, also when it does not
+ * fit in bufSize. Safe to call from any number of threads.
+ * @return ::SOLCLIENT_OK when copied, ::SOLCLIENT_FAIL when it does not fit
+ * (or is larger than valueSize), ::SOLCLIENT_IN_PROGRESS when the topic has
+ * no value yet and a cache request for it is outstanding,
+ * ::SOLCLIENT_NOT_FOUND when the topic has no value and no cache request
+ * could be sent.
+ */
+solClient_returnCode_t
+    common_lvc_read ( common_lvc_pt lvc_p, const char *topic_p, void *buf_p, solClient_uint32_t bufSize,
+                      solClient_uint32_t * length_p );
+
+/**
+ * Get a copy of the latest message on a topic, which the caller must free.
+ * Takes the cache's lock; common_lvc_read() is much cheaper.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_NOT_FOUND, ::SOLCLIENT_FAIL.
+ */
+solClient_returnCode_t
+    common_lvc_getMsg ( common_lvc_pt lvc_p, const char *topic_p, solClient_opaqueMsg_pt * msg_p );
+
+/**
+ * Print the topic count and the update and cache request statistics.
+ */
+void
+    common_lvc_printStats ( common_lvc_pt lvc_p );
+
+/*@}*/
+
+#endif /* LVC_H_ */
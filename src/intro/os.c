@@ -0,0 +1,488 @@
+
+/** @example Intro/os.c
+ */
+
+/*
+ * OS-specific methods for abstracting.
+ * Copyright 2008-2019 Solace Corporation. All rights reserved.
+ */
+
+#include "os.h"
+
+#ifdef WIN32
+#include <psapi.h>
+#include <io.h>
+#pragma comment(lib, "psapi.lib")
+/* For the tcp* functions; Winsock is started by solClient_initialize(). */
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+
+/*****************************************************************************
+ * getTimeInUs
+ *****************************************************************************/
+UINT64
+getTimeInUs ( void )
+{
+#ifdef WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER   now;
+
+    if ( freq.QuadPart == 0 ) {
+        QueryPerformanceFrequency ( &freq );
+    }
+    QueryPerformanceCounter ( &now );
+    return ( UINT64 ) ( now.QuadPart / ( freq.QuadPart / 1000000 ) );
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec now;
+
+    clock_gettime ( CLOCK_MONOTONIC, &now );
+    return ( UINT64 ) now.tv_sec * 1000000 + ( UINT64 ) ( now.tv_nsec / 1000 );
+#else
+    struct timeval  now;
+
+    gettimeofday ( &now, NULL );
+    return ( UINT64 ) now.tv_sec * 1000000 + ( UINT64 ) now.tv_usec;
+#endif
+}
+
+
+/*****************************************************************************
+ * sleepInUs
+ *****************************************************************************/
+void
+sleepInUs ( int us )
+{
+#ifdef WIN32
+    Sleep ( ( us + 999 ) / 1000 );
+#else
+    usleep ( us );
+#endif
+}
+
+
+/*****************************************************************************
+ * getCpuTimesInUs
+ *****************************************************************************/
+void
+getCpuTimesInUs ( UINT64 * userUs_p, UINT64 * systemUs_p )
+{
+#ifdef WIN32
+    FILETIME        creationTime;
+    FILETIME        exitTime;
+    FILETIME        kernelTime;
+    FILETIME        userTime;
+
+    GetProcessTimes ( GetCurrentProcess (  ), &creationTime, &exitTime, &kernelTime, &userTime );
+    /* FILETIME is in 100 ns units. */
+    *userUs_p = ( ( ( UINT64 ) userTime.dwHighDateTime << 32 ) | userTime.dwLowDateTime ) / 10;
+    *systemUs_p = ( ( ( UINT64 ) kernelTime.dwHighDateTime << 32 ) | kernelTime.dwLowDateTime ) / 10;
+#else
+    struct rusage   usage;
+
+    getrusage ( RUSAGE_SELF, &usage );
+    *userUs_p = ( UINT64 ) usage.ru_utime.tv_sec * 1000000 + ( UINT64 ) usage.ru_utime.tv_usec;
+    *systemUs_p = ( UINT64 ) usage.ru_stime.tv_sec * 1000000 + ( UINT64 ) usage.ru_stime.tv_usec;
+#endif
+}
+
+
+/*****************************************************************************
+ * getRssInKb
+ *****************************************************************************/
+UINT64
+getRssInKb ( void )
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if ( !GetProcessMemoryInfo ( GetCurrentProcess (  ), &counters, sizeof ( counters ) ) ) {
+        return 0;
+    }
+    return ( UINT64 ) counters.WorkingSetSize / 1024;
+#elif defined(__APPLE__)
+    struct mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if ( task_info ( mach_task_self (  ), MACH_TASK_BASIC_INFO, ( task_info_t ) & info, &count ) != KERN_SUCCESS ) {
+        return 0;
+    }
+    return ( UINT64 ) info.resident_size / 1024;
+#else
+    FILE           *fp;
+    unsigned long   sizePages = 0;
+    unsigned long   residentPages = 0;
+
+    /* Linux: the second field of statm is the resident page count. */
+    if ( ( fp = fopen ( "/proc/self/statm", "r" ) ) == NULL ) {
+        return 0;
+    }
+    if ( fscanf ( fp, "%lu %lu", &sizePages, &residentPages ) != 2 ) {
+        residentPages = 0;
+    }
+    fclose ( fp );
+    return ( UINT64 ) residentPages * ( UINT64 ) sysconf ( _SC_PAGESIZE ) / 1024;
+#endif
+}
+
+
+/*****************************************************************************
+ * getCoreBusyTimesInUs
+ *****************************************************************************/
+int
+getCoreBusyTimesInUs ( UINT64 * busyUs_p, int maxCores )
+{
+#ifdef WIN32
+    return 0;
+#elif defined(__APPLE__)
+    natural_t       numCpus = 0;
+    processor_cpu_load_info_t load_p;
+    mach_msg_type_number_t count;
+    int             core;
+
+    if ( host_processor_info ( mach_host_self (  ), PROCESSOR_CPU_LOAD_INFO, &numCpus,
+                               ( processor_info_array_t * ) & load_p, &count ) != KERN_SUCCESS ) {
+        return 0;
+    }
+    for ( core = 0; core < ( int ) numCpus && core < maxCores; core++ ) {
+        busyUs_p[core] = ( UINT64 ) ( load_p[core].cpu_ticks[CPU_STATE_USER] + load_p[core].cpu_ticks[CPU_STATE_SYSTEM] +
+                                      load_p[core].cpu_ticks[CPU_STATE_NICE] ) * 1000000 / sysconf ( _SC_CLK_TCK );
+    }
+    vm_deallocate ( mach_task_self (  ), ( vm_address_t ) load_p, count * sizeof ( integer_t ) );
+    return core;
+#else
+    FILE           *fp;
+    char            line[256];
+    unsigned long long ticks[7];
+    int             core = 0;
+
+    /* Linux: the cpuN lines of /proc/stat, in clock ticks. */
+    if ( ( fp = fopen ( "/proc/stat", "r" ) ) == NULL ) {
+        return 0;
+    }
+    while ( core < maxCores && fgets ( line, sizeof ( line ), fp ) != NULL ) {
+        if ( strncmp ( line, "cpu", 3 ) != 0 || line[3] < '0' || line[3] > '9' ) {
+            continue;
+        }
+        /* user nice system idle iowait irq softirq */
+        if ( sscanf ( line + 3, "%*d %llu %llu %llu %llu %llu %llu %llu", &ticks[0], &ticks[1], &ticks[2],
+                      &ticks[3], &ticks[4], &ticks[5], &ticks[6] ) != 7 ) {
+            break;
+        }
+        busyUs_p[core++] = ( UINT64 ) ( ticks[0] + ticks[1] + ticks[2] + ticks[5] + ticks[6] ) * 1000000 /
+                sysconf ( _SC_CLK_TCK );
+    }
+    fclose ( fp );
+    return core;
+#endif
+}
+
+
+/*****************************************************************************
+ * alignedAlloc
+ *****************************************************************************/
+void           *
+alignedAlloc ( size_t size, size_t align )
+{
+#ifdef WIN32
+    return _aligned_malloc ( size, align );
+#else
+    void           *ptr = NULL;
+
+    if ( posix_memalign ( &ptr, align, size ) != 0 ) {
+        return NULL;
+    }
+    return ptr;
+#endif
+}
+
+
+/*****************************************************************************
+ * alignedFree
+ *****************************************************************************/
+void
+alignedFree ( void *ptr )
+{
+#ifdef WIN32
+    _aligned_free ( ptr );
+#else
+    free ( ptr );
+#endif
+}
+
+
+/*****************************************************************************
+ * Mutex
+ *****************************************************************************/
+void
+mutexInit ( MUTEX_T * mutex_p )
+{
+#ifdef WIN32
+    InitializeCriticalSection ( mutex_p );
+#else
+    pthread_mutex_init ( mutex_p, NULL );
+#endif
+}
+
+void
+mutexDestroy ( MUTEX_T * mutex_p )
+{
+#ifdef WIN32
+    DeleteCriticalSection ( mutex_p );
+#else
+    pthread_mutex_destroy ( mutex_p );
+#endif
+}
+
+void
+mutexLock ( MUTEX_T * mutex_p )
+{
+#ifdef WIN32
+    EnterCriticalSection ( mutex_p );
+#else
+    pthread_mutex_lock ( mutex_p );
+#endif
+}
+
+void
+mutexUnlock ( MUTEX_T * mutex_p )
+{
+#ifdef WIN32
+    LeaveCriticalSection ( mutex_p );
+#else
+    pthread_mutex_unlock ( mutex_p );
+#endif
+}
+
+
+/*****************************************************************************
+ * Threads
+ *****************************************************************************/
+int
+threadCreate ( THREAD_T * thread_p, THREAD_FUNC_T func_p, void *arg_p )
+{
+#ifdef WIN32
+    if ( ( *thread_p = CreateThread ( NULL, 0, func_p, arg_p, 0, NULL ) ) == NULL ) {
+        return -1;
+    }
+    return 0;
+#else
+    return pthread_create ( thread_p, NULL, func_p, arg_p );
+#endif
+}
+
+void
+threadJoin ( THREAD_T thread )
+{
+#ifdef WIN32
+    WaitForSingleObject ( thread, INFINITE );
+    CloseHandle ( thread );
+#else
+    pthread_join ( thread, NULL );
+#endif
+}
+
+
+/*****************************************************************************
+ * Files
+ *****************************************************************************/
+int
+fileSync ( FILE * fp )
+{
+    if ( fflush ( fp ) != 0 ) {
+        return -1;
+    }
+#ifdef WIN32
+    return _commit ( _fileno ( fp ) );
+#else
+    return fsync ( fileno ( fp ) );
+#endif
+}
+
+int
+fileReplace ( const char *fromPath, const char *toPath )
+{
+#ifdef WIN32
+    return MoveFileExA ( fromPath, toPath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) ? 0 : -1;
+#else
+    return rename ( fromPath, toPath );
+#endif
+}
+
+
+/*****************************************************************************
+ * TCP
+ *****************************************************************************/
+#ifdef WIN32
+typedef int socklen_t;
+#define TCP_SHUT_BOTH SD_BOTH
+#define TCP_SEND_FLAGS 0
+#else
+#define TCP_SHUT_BOTH SHUT_RDWR
+#ifdef MSG_NOSIGNAL
+#define TCP_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define TCP_SEND_FLAGS 0
+#endif
+#endif
+
+/* No Nagle delay, and no SIGPIPE where it is a socket option. */
+static void
+tcpSetOptions ( SOCKET_T sock )
+{
+    int             on = 1;
+
+    setsockopt ( sock, IPPROTO_TCP, TCP_NODELAY, ( const char * ) &on, sizeof ( on ) );
+#ifdef SO_NOSIGPIPE
+    setsockopt ( sock, SOL_SOCKET, SO_NOSIGPIPE, ( const char * ) &on, sizeof ( on ) );
+#endif
+}
+
+int
+tcpListen ( unsigned short *port_p, SOCKET_T * sock_p )
+{
+    struct sockaddr_in addr;
+    socklen_t       addrLen = sizeof ( addr );
+    int             on = 1;
+    SOCKET_T        sock;
+
+    if ( ( sock = socket ( AF_INET, SOCK_STREAM, 0 ) ) == INVALID_SOCKET_T ) {
+        return -1;
+    }
+    setsockopt ( sock, SOL_SOCKET, SO_REUSEADDR, ( const char * ) &on, sizeof ( on ) );
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl ( INADDR_LOOPBACK );
+    addr.sin_port = htons ( *port_p );
+    if ( bind ( sock, ( struct sockaddr * ) &addr, sizeof ( addr ) ) != 0 || listen ( sock, 16 ) != 0 ||
+         getsockname ( sock, ( struct sockaddr * ) &addr, &addrLen ) != 0 ) {
+        tcpClose ( sock );
+        return -1;
+    }
+    *port_p = ntohs ( addr.sin_port );
+    *sock_p = sock;
+    return 0;
+}
+
+int
+tcpAccept ( SOCKET_T listenSock, int timeoutMs, SOCKET_T * sock_p )
+{
+    int             ready = tcpPoll ( &listenSock, 1, timeoutMs );
+
+    if ( ready <= 0 ) {
+        return ready == 0 ? 1 : -1;
+    }
+    if ( ( *sock_p = accept ( listenSock, NULL, NULL ) ) == INVALID_SOCKET_T ) {
+        return -1;
+    }
+    tcpSetOptions ( *sock_p );
+    return 0;
+}
+
+int
+tcpConnect ( const char *host_p, unsigned short port, SOCKET_T * sock_p )
+{
+    struct sockaddr_in addr;
+    struct hostent *hostEntry_p;
+    SOCKET_T        sock;
+
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons ( port );
+    if ( ( addr.sin_addr.s_addr = inet_addr ( host_p ) ) == INADDR_NONE ) {
+        if ( ( hostEntry_p = gethostbyname ( host_p ) ) == NULL || hostEntry_p->h_addrtype != AF_INET ) {
+            return -1;
+        }
+        memcpy ( &addr.sin_addr, hostEntry_p->h_addr_list[0], sizeof ( addr.sin_addr ) );
+    }
+    if ( ( sock = socket ( AF_INET, SOCK_STREAM, 0 ) ) == INVALID_SOCKET_T ) {
+        return -1;
+    }
+    if ( connect ( sock, ( struct sockaddr * ) &addr, sizeof ( addr ) ) != 0 ) {
+        tcpClose ( sock );
+        return -1;
+    }
+    tcpSetOptions ( sock );
+    *sock_p = sock;
+    return 0;
+}
+
+int
+tcpPoll ( const SOCKET_T * socks_p, int numSocks, int timeoutMs )
+{
+    fd_set          readSet;
+    struct timeval  timeout;
+    int             maxFd = 0;
+    int             ready = 0;
+    int             i;
+
+    FD_ZERO ( &readSet );
+    for ( i = 0; i < numSocks; i++ ) {
+        FD_SET ( socks_p[i], &readSet );
+        if ( ( int ) socks_p[i] > maxFd ) {
+            maxFd = ( int ) socks_p[i];
+        }
+    }
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = ( timeoutMs % 1000 ) * 1000;
+    if ( select ( maxFd + 1, &readSet, NULL, NULL, &timeout ) < 0 ) {
+        return -1;
+    }
+    for ( i = 0; i < numSocks; i++ ) {
+        if ( FD_ISSET ( socks_p[i], &readSet ) ) {
+            ready |= 1 << i;
+        }
+    }
+    return ready;
+}
+
+int
+tcpRecv ( SOCKET_T sock, void *buf_p, int bufSize )
+{
+    return ( int ) recv ( sock, ( char * ) buf_p, bufSize, 0 );
+}
+
+int
+tcpSendAll ( SOCKET_T sock, const void *buf_p, int length )
+{
+    const char     *data_p = ( const char * ) buf_p;
+    int             sent;
+
+    while ( length > 0 ) {
+        if ( ( sent = ( int ) send ( sock, data_p, length, TCP_SEND_FLAGS ) ) <= 0 ) {
+            return -1;
+        }
+        data_p += sent;
+        length -= sent;
+    }
+    return 0;
+}
+
+void
+tcpShutdown ( SOCKET_T sock )
+{
+    shutdown ( sock, TCP_SHUT_BOTH );
+}
+
+void
+tcpClose ( SOCKET_T sock )
+{
+#ifdef WIN32
+    closesocket ( sock );
+#else
+    close ( sock );
+#endif
+}
@@ -28,13 +28,139 @@ extern          "C"
 #define SLEEP(sec)  Sleep ( (sec) * 1000 )
 #define strcasecmp (_stricmp)
 #define strncasecmp (_strnicmp)
+#if _MSC_VER < 1900
+/* Returns -1 when the output is truncated, and then does not terminate it. */
+#define snprintf _snprintf
+#endif
+
+typedef CRITICAL_SECTION MUTEX_T;
+typedef HANDLE THREAD_T;
+typedef DWORD ( WINAPI * THREAD_FUNC_T ) ( LPVOID arg_p );
+#define THREAD_FUNC_RETURN_T DWORD WINAPI
+#define THREAD_FUNC_RETURN_VAL 0
+typedef SOCKET SOCKET_T;
+#define INVALID_SOCKET_T INVALID_SOCKET
+
+#define THREAD_LOCAL __declspec(thread)
+#define MEMORY_BARRIER() MemoryBarrier ( )
+#define READ_BARRIER() MemoryBarrier ( )
+#define ATOMIC_CAS_PTR(ptr_p, oldVal, newVal) \
+    ( InterlockedCompareExchangePointer ( ( PVOID volatile * ) ( ptr_p ), ( newVal ), ( oldVal ) ) == ( oldVal ) )
+#define ATOMIC_ADD_INT(ptr_p, val) \
+    ( InterlockedExchangeAdd ( ( LONG volatile * ) ( ptr_p ), ( val ) ) + ( val ) )
+#define ATOMIC_CAS_INT(ptr_p, oldVal, newVal) \
+    ( InterlockedCompareExchange ( ( LONG volatile * ) ( ptr_p ), ( newVal ), ( oldVal ) ) == ( oldVal ) )
 #else
 #include <unistd.h>
+#include <pthread.h>
 
 #define SLEEP(sec) sleep ( (sec) )
+
+typedef unsigned long long UINT64;
+typedef pthread_mutex_t MUTEX_T;
+typedef pthread_t THREAD_T;
+typedef void   *( *THREAD_FUNC_T ) ( void *arg_p );
+#define THREAD_FUNC_RETURN_T void *
+#define THREAD_FUNC_RETURN_VAL NULL
+typedef int SOCKET_T;
+#define INVALID_SOCKET_T (-1)
+
+#define THREAD_LOCAL __thread
+#define MEMORY_BARRIER() __sync_synchronize ( )
+/* Orders loads only; no instruction on x86. */
+#define READ_BARRIER() __atomic_thread_fence ( __ATOMIC_ACQUIRE )
+#define ATOMIC_CAS_PTR(ptr_p, oldVal, newVal) __sync_bool_compare_and_swap ( ( ptr_p ), ( oldVal ), ( newVal ) )
+/* Returns the new value. */
+#define ATOMIC_ADD_INT(ptr_p, val) __sync_add_and_fetch ( ( ptr_p ), ( val ) )
+#define ATOMIC_CAS_INT(ptr_p, oldVal, newVal) __sync_bool_compare_and_swap ( ( ptr_p ), ( oldVal ), ( newVal ) )
 #endif
 
 
+/**
+ * Returns a monotonically increasing time stamp in microseconds. Only the
+ * difference between two time stamps is meaningful.
+ */
+UINT64          getTimeInUs ( void );
+
+/**
+ * Suspends the calling thread for the given number of microseconds.
+ */
+void            sleepInUs ( int us );
+
+/**
+ * Returns the user and system CPU time consumed by the process so far, in
+ * microseconds.
+ */
+void            getCpuTimesInUs ( UINT64 * userUs_p, UINT64 * systemUs_p );
+
+/**
+ * Returns the current resident set size of the process in kilobytes, or 0 if
+ * it cannot be determined.
+ */
+UINT64          getRssInKb ( void );
+
+/**
+ * Fills busyUs_p with the time each CPU core has spent busy (not idle) since
+ * boot, in microseconds, for up to maxCores cores. Returns the number of
+ * cores filled, or 0 if it cannot be determined.
+ */
+int             getCoreBusyTimesInUs ( UINT64 * busyUs_p, int maxCores );
+
+/**
+ * Allocates size bytes aligned on an align byte boundary (align must be a
+ * power of two). Memory must be released with alignedFree(). Returns NULL
+ * on failure.
+ */
+void           *alignedAlloc ( size_t size, size_t align );
+void            alignedFree ( void *ptr );
+
+/* Simple non-recursive mutex. */
+void            mutexInit ( MUTEX_T * mutex_p );
+void            mutexDestroy ( MUTEX_T * mutex_p );
+void            mutexLock ( MUTEX_T * mutex_p );
+void            mutexUnlock ( MUTEX_T * mutex_p );
+
+/*
+ * Threads. Thread functions are declared as
+ *     static THREAD_FUNC_RETURN_T myThread ( void *arg_p )
+ * and return THREAD_FUNC_RETURN_VAL. threadCreate() returns 0 on success.
+ */
+int             threadCreate ( THREAD_T * thread_p, THREAD_FUNC_T func_p, void *arg_p );
+void            threadJoin ( THREAD_T thread );
+
+/**
+ * Flushes a stdio stream and forces its data to stable storage. Returns 0 on
+ * success.
+ */
+int             fileSync ( FILE * fp );
+
+/**
+ * Renames fromPath to toPath, replacing toPath if it exists. Returns 0 on
+ * success.
+ */
+int             fileReplace ( const char *fromPath, const char *toPath );
+
+/*
+ * Minimal blocking TCP over IPv4, for test tools. On Windows, Winsock must
+ * already be started (solClient_initialize() does it).
+ *
+ * tcpListen() listens on the loopback interface, on *port_p or on any free
+ * port if it is 0, and returns the port in *port_p. tcpAccept() and
+ * tcpPoll() wait up to timeoutMs: tcpAccept() returns 1 on a timeout, and
+ * tcpPoll() returns a bit mask of the sockets readable or closed. Except
+ * for tcpRecv() (bytes received, 0 when closed), the functions return 0 on
+ * success and -1 on error. tcpShutdown() ends both directions of a
+ * connection, waking any thread blocked on it; it must still be closed.
+ */
+int             tcpListen ( unsigned short *port_p, SOCKET_T * sock_p );
+int             tcpAccept ( SOCKET_T listenSock, int timeoutMs, SOCKET_T * sock_p );
+int             tcpConnect ( const char *host_p, unsigned short port, SOCKET_T * sock_p );
+int             tcpPoll ( const SOCKET_T * socks_p, int numSocks, int timeoutMs );
+int             tcpRecv ( SOCKET_T sock, void *buf_p, int bufSize );
+int             tcpSendAll ( SOCKET_T sock, const void *buf_p, int length );
+void            tcpShutdown ( SOCKET_T sock );
+void            tcpClose ( SOCKET_T sock );
+
 
 #ifdef __cplusplus
 }
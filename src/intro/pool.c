@@ -0,0 +1,485 @@
+/** example ex/pool.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Message and payload buffer pools used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "pool.h"
+
+
+/*****************************************************************************
+ * common_publishPayload
+ *****************************************************************************/
+solClient_returnCode_t
+common_publishPayload ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                        solClient_uint32_t deliveryMode, const void *payload_p, solClient_uint32_t size )
+{
+    /* Return code */
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_returnCode_t rcFreeMsg = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt msg_p = NULL;
+    solClient_destination_t destination;
+
+    /*
+     * Direct messages come from the thread's message pool. A sent Guaranteed
+     * message may still be held by the API, so it is allocated and freed.
+     */
+    if ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) {
+        if ( ( rc = common_msgPool_get ( &msg_p ) ) != SOLCLIENT_OK ) {
+            return rc;
+        }
+    } else if ( ( rc = solClient_msg_alloc ( &msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_alloc()" );
+        return rc;
+    }
+
+    /* Set the message delivery mode. */
+    if ( ( rc = solClient_msg_setDeliveryMode ( msg_p, deliveryMode ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setDeliveryMode()" );
+        goto freeMessage;
+    }
+
+    /* attach a payload; the API copies it into the message */
+    if ( ( rc = solClient_msg_setBinaryAttachment ( msg_p, payload_p, size ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setBinaryAttachment()" );
+        goto freeMessage;
+    }
+
+    /* Set the destination. */
+    destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+    destination.dest = topic_p;
+    if ( ( rc = solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setDestination()" );
+        goto freeMessage;
+    }
+
+    /* Send the message. */
+    if ( ( rc = solClient_session_sendMsg ( session_p, msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_sendMsg()" );
+        goto freeMessage;
+    }
+
+  freeMessage:
+    if ( deliveryMode == SOLCLIENT_DELIVERY_MODE_DIRECT ) {
+        common_msgPool_release ( &msg_p );
+    } else if ( ( rcFreeMsg = solClient_msg_free ( &msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rcFreeMsg, "solClient_msg_free()" );
+    }
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * Message Pool
+ *
+ * Each thread owns a small stack of reset messages. A thread's pool is
+ * created on first use and pushed onto a global list so the counters of all
+ * threads can be reported; entries are never removed from the list.
+ *
+ * A message may be released on another thread than the one it was taken on,
+ * so the in-use count and its high-water mark are global rather than per
+ * thread.
+ *****************************************************************************/
+typedef struct common_msgPool
+{
+    struct common_msgPool *next_p;
+    int             count;
+    solClient_opaqueMsg_pt msgs[COMMON_MSGPOOL_SIZE];
+    common_msgPoolStats_t stats;
+} common_msgPool_t;
+
+static common_msgPool_t *volatile common_msgPoolList_p = NULL;
+static THREAD_LOCAL common_msgPool_t *common_threadMsgPool_p = NULL;
+static volatile int common_msgPoolInUse = 0;
+static volatile int common_msgPoolHighWater = 0;
+
+static common_msgPool_t *
+common_msgPool_getThreadPool ( void )
+{
+    common_msgPool_t *pool_p = common_threadMsgPool_p;
+
+    if ( pool_p == NULL ) {
+        if ( ( pool_p = ( common_msgPool_t * ) calloc ( 1, sizeof ( *pool_p ) ) ) == NULL ) {
+            return NULL;
+        }
+        do {
+            pool_p->next_p = common_msgPoolList_p;
+        } while ( !ATOMIC_CAS_PTR ( &common_msgPoolList_p, pool_p->next_p, pool_p ) );
+        common_threadMsgPool_p = pool_p;
+    }
+    return pool_p;
+}
+
+/*****************************************************************************
+ * common_msgPool_get
+ *****************************************************************************/
+solClient_returnCode_t
+common_msgPool_get ( solClient_opaqueMsg_pt * msg_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    common_msgPool_t *pool_p = common_msgPool_getThreadPool (  );
+    int             inUse;
+    int             highWater;
+
+    if ( pool_p != NULL && pool_p->count > 0 ) {
+        *msg_p = pool_p->msgs[--pool_p->count];
+        pool_p->stats.hits++;
+    } else {
+        if ( ( rc = solClient_msg_alloc ( msg_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_alloc()" );
+            return rc;
+        }
+        if ( pool_p == NULL ) {
+            return rc;
+        }
+        pool_p->stats.misses++;
+    }
+
+    inUse = ATOMIC_ADD_INT ( &common_msgPoolInUse, 1 );
+    while ( inUse > ( highWater = common_msgPoolHighWater ) &&
+            !ATOMIC_CAS_INT ( &common_msgPoolHighWater, highWater, inUse ) ) {
+    }
+    return rc;
+}
+
+/*****************************************************************************
+ * common_msgPool_release
+ *****************************************************************************/
+void
+common_msgPool_release ( solClient_opaqueMsg_pt * msg_p )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    common_msgPool_t *pool_p = common_msgPool_getThreadPool (  );
+
+    if ( *msg_p == NULL ) {
+        return;
+    }
+    if ( pool_p != NULL ) {
+        ATOMIC_ADD_INT ( &common_msgPoolInUse, -1 );
+        if ( pool_p->count < COMMON_MSGPOOL_SIZE ) {
+            if ( ( rc = solClient_msg_reset ( *msg_p ) ) == SOLCLIENT_OK ) {
+                pool_p->msgs[pool_p->count++] = *msg_p;
+                *msg_p = NULL;
+                return;
+            }
+            common_handleError ( rc, "solClient_msg_reset()" );
+        } else {
+            pool_p->stats.overflows++;
+        }
+    }
+    if ( ( rc = solClient_msg_free ( msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_free()" );
+    }
+}
+
+/*****************************************************************************
+ * common_msgPool_getStats
+ *****************************************************************************/
+void
+common_msgPool_getStats ( common_msgPoolStats_pt stats_p )
+{
+    common_msgPool_t *pool_p;
+
+    memset ( stats_p, 0, sizeof ( *stats_p ) );
+    for ( pool_p = common_msgPoolList_p; pool_p != NULL; pool_p = pool_p->next_p ) {
+        stats_p->hits += pool_p->stats.hits;
+        stats_p->misses += pool_p->stats.misses;
+        stats_p->overflows += pool_p->stats.overflows;
+    }
+    stats_p->inUse = common_msgPoolInUse;
+    stats_p->highWater = common_msgPoolHighWater;
+}
+
+/*****************************************************************************
+ * common_msgPool_printStats
+ *****************************************************************************/
+void
+common_msgPool_printStats ( void )
+{
+    common_msgPoolStats_t stats;
+
+    common_msgPool_getStats ( &stats );
+    printf ( "Message pool: hits %llu, misses %llu, overflows %llu, in use %d, high-water %d\n",
+             stats.hits, stats.misses, stats.overflows, stats.inUse, stats.highWater );
+}
+
+/*****************************************************************************
+ * common_msgPool_cleanup
+ *****************************************************************************/
+void
+common_msgPool_cleanup ( void )
+{
+    common_msgPool_t *pool_p;
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+
+    for ( pool_p = common_msgPoolList_p; pool_p != NULL; pool_p = pool_p->next_p ) {
+        while ( pool_p->count > 0 ) {
+            if ( ( rc = solClient_msg_free ( &pool_p->msgs[--pool_p->count] ) ) != SOLCLIENT_OK ) {
+                common_handleError ( rc, "solClient_msg_free()" );
+            }
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * Payload Buffer Pool
+ *
+ * Each buffer is preceded by a header occupying one cache line, so the
+ * payload handed to the application is cache-line aligned and the pool can
+ * be found from the payload pointer alone (which is what comes back in the
+ * correlation pointer of an acknowledgement event).
+ *****************************************************************************/
+typedef struct common_bufHdr
+{
+    struct common_bufHdr *next_p;
+    common_bufPool_pt pool_p;
+} common_bufHdr_t;
+
+#define COMMON_BUF_HDR_SIZE     COMMON_CACHE_LINE_SIZE
+#define COMMON_BUF_HDR(buf_p)   ( ( common_bufHdr_t * ) ( ( char * ) ( buf_p ) - COMMON_BUF_HDR_SIZE ) )
+#define COMMON_BUF_DATA(hdr_p)  ( ( void * ) ( ( char * ) ( hdr_p ) + COMMON_BUF_HDR_SIZE ) )
+
+struct common_bufPool
+{
+    MUTEX_T         mutex;
+    common_bufHdr_t *free_p;
+    char           *mem_p;
+    size_t          bufSize;
+    int             numBufs;
+    int             inUse;
+};
+
+/*****************************************************************************
+ * common_bufPool_create
+ *****************************************************************************/
+solClient_returnCode_t
+common_bufPool_create ( common_bufPool_pt * pool_p, size_t bufSize, int numBufs )
+{
+    common_bufPool_pt pool;
+    common_bufHdr_t *hdr_p;
+    size_t          stride;
+    int             i;
+
+    if ( bufSize == 0 || numBufs <= 0 ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "common_bufPool_create() invalid bufSize %u or numBufs %d",
+                        ( unsigned int ) bufSize, numBufs );
+        return SOLCLIENT_FAIL;
+    }
+
+    if ( ( pool = ( common_bufPool_pt ) malloc ( sizeof ( *pool ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "common_bufPool_create() could not allocate pool" );
+        return SOLCLIENT_FAIL;
+    }
+
+    /* Round each buffer up to whole cache lines so every header stays aligned. */
+    stride = COMMON_BUF_HDR_SIZE + ( ( bufSize + COMMON_CACHE_LINE_SIZE - 1 ) & ~( size_t ) ( COMMON_CACHE_LINE_SIZE - 1 ) );
+    if ( ( pool->mem_p = ( char * ) alignedAlloc ( stride * numBufs, COMMON_CACHE_LINE_SIZE ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "common_bufPool_create() could not allocate %d buffers of %u bytes",
+                        numBufs, ( unsigned int ) bufSize );
+        free ( pool );
+        return SOLCLIENT_FAIL;
+    }
+
+    mutexInit ( &pool->mutex );
+    pool->bufSize = bufSize;
+    pool->numBufs = numBufs;
+    pool->inUse = 0;
+    pool->free_p = NULL;
+    for ( i = numBufs - 1; i >= 0; i-- ) {
+        hdr_p = ( common_bufHdr_t * ) ( pool->mem_p + stride * i );
+        hdr_p->pool_p = pool;
+        hdr_p->next_p = pool->free_p;
+        pool->free_p = hdr_p;
+    }
+
+    *pool_p = pool;
+    return SOLCLIENT_OK;
+}
+
+/*****************************************************************************
+ * common_bufPool_destroy
+ *****************************************************************************/
+void
+common_bufPool_destroy ( common_bufPool_pt * pool_p )
+{
+    common_bufPool_pt pool = *pool_p;
+
+    if ( pool == NULL ) {
+        return;
+    }
+    if ( pool->inUse != 0 ) {
+        solClient_log ( SOLCLIENT_LOG_WARNING, "common_bufPool_destroy() called with %d buffers in use", pool->inUse );
+    }
+    mutexDestroy ( &pool->mutex );
+    alignedFree ( pool->mem_p );
+    free ( pool );
+    *pool_p = NULL;
+}
+
+/*****************************************************************************
+ * common_bufPool_get
+ *****************************************************************************/
+void           *
+common_bufPool_get ( common_bufPool_pt pool_p )
+{
+    common_bufHdr_t *hdr_p;
+
+    mutexLock ( &pool_p->mutex );
+    if ( ( hdr_p = pool_p->free_p ) != NULL ) {
+        pool_p->free_p = hdr_p->next_p;
+        pool_p->inUse++;
+    }
+    mutexUnlock ( &pool_p->mutex );
+
+    return ( hdr_p != NULL ) ? COMMON_BUF_DATA ( hdr_p ) : NULL;
+}
+
+/*****************************************************************************
+ * common_bufPool_release
+ *****************************************************************************/
+void
+common_bufPool_release ( void *buf_p )
+{
+    common_bufHdr_t *hdr_p = COMMON_BUF_HDR ( buf_p );
+    common_bufPool_pt pool_p = hdr_p->pool_p;
+
+    mutexLock ( &pool_p->mutex );
+    hdr_p->next_p = pool_p->free_p;
+    pool_p->free_p = hdr_p;
+    pool_p->inUse--;
+    mutexUnlock ( &pool_p->mutex );
+}
+
+/*****************************************************************************
+ * common_bufPool_getBufSize
+ *****************************************************************************/
+size_t
+common_bufPool_getBufSize ( common_bufPool_pt pool_p )
+{
+    return pool_p->bufSize;
+}
+
+/*****************************************************************************
+ * common_bufPool_getInUse
+ *****************************************************************************/
+int
+common_bufPool_getInUse ( common_bufPool_pt pool_p )
+{
+    int             inUse;
+
+    mutexLock ( &pool_p->mutex );
+    inUse = pool_p->inUse;
+    mutexUnlock ( &pool_p->mutex );
+    return inUse;
+}
+
+
+/*****************************************************************************
+ * common_publishBuffer
+ *****************************************************************************/
+solClient_returnCode_t
+common_publishBuffer ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                       solClient_uint32_t deliveryMode, void *buf_p, solClient_uint32_t size )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    solClient_returnCode_t rcFreeMsg = SOLCLIENT_OK;
+    solClient_opaqueMsg_pt msg_p = NULL;
+    solClient_destination_t destination;
+    int             releaseOnAck = ( deliveryMode != SOLCLIENT_DELIVERY_MODE_DIRECT );
+
+    if ( !releaseOnAck ) {
+        rc = common_msgPool_get ( &msg_p );
+    } else if ( ( rc = solClient_msg_alloc ( &msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_alloc()" );
+    }
+    if ( rc != SOLCLIENT_OK ) {
+        common_bufPool_release ( buf_p );
+        return rc;
+    }
+
+    if ( ( rc = solClient_msg_setDeliveryMode ( msg_p, deliveryMode ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setDeliveryMode()" );
+        goto freeMessage;
+    }
+
+    /* Attach the payload by reference; the API does not copy it. */
+    if ( ( rc = solClient_msg_setBinaryAttachmentPtr ( msg_p, buf_p, size ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setBinaryAttachmentPtr()" );
+        goto freeMessage;
+    }
+
+    /*
+     * A Guaranteed message's payload must remain untouched until it is
+     * acknowledged, so the buffer itself is carried as the correlation tag
+     * and released from the acknowledgement event.
+     */
+    if ( releaseOnAck ) {
+        if ( ( rc = solClient_msg_setCorrelationTagPtr ( msg_p, buf_p, 0 ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_msg_setCorrelationTagPtr()" );
+            goto freeMessage;
+        }
+    }
+
+    destination.destType = SOLCLIENT_TOPIC_DESTINATION;
+    destination.dest = topic_p;
+    if ( ( rc = solClient_msg_setDestination ( msg_p, &destination, sizeof ( destination ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setDestination()" );
+        goto freeMessage;
+    }
+
+    if ( ( rc = solClient_session_sendMsg ( session_p, msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_sendMsg()" );
+        goto freeMessage;
+    }
+
+  freeMessage:
+    /* The message can be freed right away; only the buffer must outlive it. */
+    if ( !releaseOnAck ) {
+        common_msgPool_release ( &msg_p );
+    } else if ( ( rcFreeMsg = solClient_msg_free ( &msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rcFreeMsg, "solClient_msg_free()" );
+    }
+    if ( !releaseOnAck || rc != SOLCLIENT_OK ) {
+        common_bufPool_release ( buf_p );
+    }
+
+    return rc;
+}
+
+
+/*****************************************************************************
+ * common_bufPoolEventCallback
+ *****************************************************************************/
+void
+common_bufPoolEventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                              solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    switch ( eventInfo_p->sessionEvent ) {
+        case SOLCLIENT_SESSION_EVENT_ACKNOWLEDGEMENT:
+        case SOLCLIENT_SESSION_EVENT_REJECTED_MSG_ERROR:
+            /* The correlation pointer is the pooled payload buffer. */
+            if ( eventInfo_p->correlation_p != NULL ) {
+                common_bufPool_release ( eventInfo_p->correlation_p );
+            }
+            break;
+        default:
+            break;
+    }
+    common_eventCallback ( opaqueSession_p, eventInfo_p, user_p );
+}
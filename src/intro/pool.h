@@ -0,0 +1,200 @@
+/** example ex/pool.h
+ */
+
+/**
+ *
+ * file pool.h Message and payload buffer pools for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include "common.h"
+
+
+/**
+ * This function publishes a message with the given payload to the Topic
+ * provided, using the provided session. The payload is copied into the
+ * message by solClient_msg_setBinaryAttachment().
+ * @param session_p     A pointer to the Session.
+ * @param topic_p       The Topic to publish on.
+ * @param deliveryMode  The message delivery mode.
+ * @param payload_p     The payload to copy into the binary attachment.
+ * @param size          The number of payload bytes.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL
+ */
+solClient_returnCode_t
+    common_publishPayload ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                            solClient_uint32_t deliveryMode, const void *payload_p, solClient_uint32_t size );
+
+
+/**
+ * @anchor messagePool
+ * @name Message Pool
+ * A thread-local pool of message objects. Messages taken from the pool have
+ * been reset with solClient_msg_reset() and are ready to be built. Releasing
+ * a message resets it and keeps it for reuse by the releasing thread, so a
+ * thread that repeatedly takes and releases messages makes no calls to
+ * solClient_msg_alloc() or solClient_msg_free() once the pool is warm.
+ *
+ * Only Direct messages should be returned to the pool once sent. A sent
+ * Guaranteed message may still be referenced by the API until it is
+ * acknowledged, so it must be released with solClient_msg_free() instead
+ * (the API recycles it in its own pools, tuned with --poolmem and --dbquanta).
+ */
+
+/*@{*/
+
+#define COMMON_MSGPOOL_SIZE      64         /**< Messages kept per thread. */
+
+/**
+ * Message pool counters.
+ */
+typedef struct common_msgPoolStats
+{
+    solClient_uint64_t hits;            /**< Messages handed out from the pool. */
+    solClient_uint64_t misses;          /**< Messages allocated because the pool was empty. */
+    solClient_uint64_t overflows;       /**< Released messages freed because the pool was full. */
+    int             inUse;              /**< Messages currently taken from the pools of all threads. */
+    int             highWater;          /**< Maximum value of inUse. */
+} common_msgPoolStats_t, *common_msgPoolStats_pt;
+
+/**
+ * Take a reset message from the calling thread's pool, allocating one if the
+ * pool is empty.
+ * @param msg_p Set to the message on success.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL
+ */
+solClient_returnCode_t
+    common_msgPool_get ( solClient_opaqueMsg_pt * msg_p );
+
+/**
+ * Reset a message and return it to the calling thread's pool. The message is
+ * freed if the pool is full. *msg_p is set to NULL.
+ */
+void
+    common_msgPool_release ( solClient_opaqueMsg_pt * msg_p );
+
+/**
+ * Sum the counters of the pools of all threads. The hit, miss and overflow
+ * counters are per thread and updated without locking, so totals read while
+ * other threads are active are approximate. inUse and highWater are global,
+ * since a message may be released on another thread than it was taken on.
+ */
+void
+    common_msgPool_getStats ( common_msgPoolStats_pt stats_p );
+
+/**
+ * Print the summed message pool counters to STDOUT.
+ */
+void
+    common_msgPool_printStats ( void );
+
+/**
+ * Free the messages held by all thread pools. Call once no other thread is
+ * using the pools, before solClient_cleanup().
+ */
+void
+    common_msgPool_cleanup ( void );
+
+/*@}*/
+
+
+/**
+ * @anchor bufferPool
+ * @name Payload Buffer Pool
+ * A pool of preallocated, cache-line aligned payload buffers that can be
+ * attached to messages by reference (solClient_msg_setBinaryAttachmentPtr())
+ * so the API does not copy the payload into the message. Buffers are
+ * returned to the pool once solClient_session_sendMsg() returns for Direct
+ * messages, or when the message is acknowledged for Guaranteed messages.
+ * Buffers may be taken and released from different threads.
+ */
+
+/*@{*/
+
+typedef struct common_bufPool common_bufPool_t, *common_bufPool_pt;
+
+/**
+ * Create a pool of numBufs buffers of bufSize bytes each.
+ * @param pool_p   Set to the new pool on success.
+ * @param bufSize  The usable size of each buffer.
+ * @param numBufs  The number of buffers preallocated in the pool.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL
+ */
+solClient_returnCode_t
+    common_bufPool_create ( common_bufPool_pt * pool_p, size_t bufSize, int numBufs );
+
+/**
+ * Destroy a pool. All buffers must have been released first.
+ */
+void
+    common_bufPool_destroy ( common_bufPool_pt * pool_p );
+
+/**
+ * Take a buffer from the pool. Returns NULL when all buffers are in use,
+ * e.g. when Guaranteed messages are still waiting to be acknowledged.
+ */
+void           *
+    common_bufPool_get ( common_bufPool_pt pool_p );
+
+/**
+ * Return a buffer obtained from common_bufPool_get() to its pool.
+ */
+void
+    common_bufPool_release ( void *buf_p );
+
+/**
+ * Returns the usable size of each buffer in the pool.
+ */
+size_t
+    common_bufPool_getBufSize ( common_bufPool_pt pool_p );
+
+/**
+ * Returns the number of buffers currently taken from the pool.
+ */
+int
+    common_bufPool_getInUse ( common_bufPool_pt pool_p );
+
+/*@}*/
+
+
+/**
+ * This function publishes a message whose payload is a buffer taken from a
+ * payload buffer pool. The buffer is attached by reference, so no copy is
+ * made. For Direct messages the buffer is released back to the pool before
+ * returning. For Guaranteed messages the buffer is set as the message
+ * correlation tag, and must be released by common_bufPoolEventCallback()
+ * when the message is acknowledged or rejected. On failure the buffer is
+ * always released.
+ * @param session_p     A pointer to the Session.
+ * @param topic_p       The Topic to publish on.
+ * @param deliveryMode  The message delivery mode.
+ * @param buf_p         A buffer obtained from common_bufPool_get().
+ * @param size          The number of payload bytes in the buffer.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL
+ */
+solClient_returnCode_t
+    common_publishBuffer ( solClient_opaqueSession_pt session_p, const char *topic_p,
+                           solClient_uint32_t deliveryMode, void *buf_p, solClient_uint32_t size );
+
+
+/**
+ * A callback for Session events used by Sessions that publish Guaranteed
+ * messages with common_publishBuffer(). The pooled payload buffer carried
+ * in the correlation pointer is released when the message is acknowledged
+ * or rejected. All events are then passed to common_eventCallback().
+ * @param opaqueSession_p A pointer to the session to which the event applies.
+ * This pointer is never NULL.
+ * @param evenInfo_p A pointer to information about the event, such as
+ * the event type. This pointer is never NULL.
+ * @param user_p A pointer to opaque user data provided when the callback is
+ * registered.
+ */
+void
+    common_bufPoolEventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                            solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p );
+
+#endif /* POOL_H_ */
@@ -0,0 +1,435 @@
+/** example ex/provisioner.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Bulk Queue provisioning used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "provisioner.h"
+
+
+/*****************************************************************************
+ * common_provisioner_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_provisioner_init ( common_provisioner_pt prov_p, unsigned int maxOps, unsigned int window )
+{
+    memset ( prov_p, 0, sizeof ( *prov_p ) );
+    if ( maxOps == 0 ) {
+        maxOps = 1;
+    }
+    prov_p->ops_p = ( common_provisionerOp_t * ) calloc ( maxOps, sizeof ( common_provisionerOp_t ) );
+    prov_p->latencyUs_p = ( solClient_uint64_t * ) malloc ( maxOps * sizeof ( solClient_uint64_t ) );
+    if ( prov_p->ops_p == NULL || prov_p->latencyUs_p == NULL ||
+         common_hashIndex_init ( &prov_p->index, maxOps ) != SOLCLIENT_OK ||
+         common_indexRing_init ( &prov_p->ready, maxOps ) != SOLCLIENT_OK ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a provisioner for %u operations", maxOps );
+        free ( prov_p->ops_p );
+        free ( prov_p->latencyUs_p );
+        common_hashIndex_destroy ( &prov_p->index );
+        memset ( prov_p, 0, sizeof ( *prov_p ) );
+        return SOLCLIENT_FAIL;
+    }
+    prov_p->maxOps = maxOps;
+    prov_p->window = window > 0 ? window : 1;
+    mutexInit ( &prov_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_provisioner_destroy
+ *****************************************************************************/
+void
+common_provisioner_destroy ( common_provisioner_pt prov_p )
+{
+    free ( prov_p->ops_p );
+    free ( prov_p->latencyUs_p );
+    prov_p->ops_p = NULL;
+    prov_p->latencyUs_p = NULL;
+    common_hashIndex_destroy ( &prov_p->index );
+    common_indexRing_destroy ( &prov_p->ready );
+    mutexDestroy ( &prov_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_provisionerMatch
+ *****************************************************************************/
+static int
+common_provisionerMatch ( void *user_p, solClient_uint32_t index, solClient_uint64_t hash, const char *queue_p )
+{
+    const common_provisionerOp_t *op_p = &( ( common_provisioner_pt ) user_p )->ops_p[index];
+
+    return op_p->hash == hash && strcmp ( op_p->queue_p, queue_p ) == 0;
+}
+
+
+/*****************************************************************************
+ * common_provisioner_addMapping
+ *****************************************************************************/
+solClient_returnCode_t
+common_provisioner_addMapping ( common_provisioner_pt prov_p, const char *queue_p, const char *topic_p )
+{
+    common_provisionerOp_t *op_p;
+    common_provisionerOp_t *queueOp_p = NULL;
+    solClient_uint64_t hash = common_hashString ( queue_p );
+    solClient_uint32_t slot;
+    solClient_uint32_t index;
+
+    /* Only the Queue operations are indexed. */
+    if ( ( index = common_hashIndex_find ( &prov_p->index, hash, queue_p, common_provisionerMatch,
+                                           prov_p, &slot ) ) != COMMON_HASH_NOT_FOUND ) {
+        queueOp_p = &prov_p->ops_p[index];
+    }
+    if ( prov_p->numOps + ( queueOp_p == NULL ) + ( topic_p != NULL ) > prov_p->maxOps ) {
+        return SOLCLIENT_FAIL;
+    }
+    if ( queueOp_p == NULL ) {
+        queueOp_p = &prov_p->ops_p[prov_p->numOps++];
+        queueOp_p->queue_p = queue_p;
+        queueOp_p->hash = hash;
+        common_hashIndex_set ( &prov_p->index, slot, prov_p->numOps - 1 );
+        prov_p->numQueues++;
+    }
+    if ( topic_p != NULL ) {
+        op_p = &prov_p->ops_p[prov_p->numOps++];
+        op_p->queue_p = queue_p;
+        op_p->topic_p = topic_p;
+        op_p->hash = hash;
+        /* Chained in file order behind its Queue. */
+        if ( queueOp_p->last == 0 ) {
+            queueOp_p->next = prov_p->numOps;
+        } else {
+            prov_p->ops_p[queueOp_p->last - 1].next = prov_p->numOps;
+        }
+        queueOp_p->last = prov_p->numOps;
+    }
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_provisionerReady
+ *
+ * Mark an operation ready to send, at the front to send it again next. Only
+ * operations that are not ready already are passed in. Called with the lock
+ * held.
+ *****************************************************************************/
+static void
+common_provisionerReady ( common_provisioner_pt prov_p, solClient_uint32_t index, int front )
+{
+    prov_p->ops_p[index].state = COMMON_PROV_READY;
+    common_indexRing_push ( &prov_p->ready, index, front );
+}
+
+
+/*****************************************************************************
+ * common_provisionerDone
+ *
+ * Record the result of an operation. The mappings of a provisioned Queue
+ * become ready; those of a Queue that failed are skipped. Called with the
+ * lock held.
+ *****************************************************************************/
+static void
+common_provisionerDone ( common_provisioner_pt prov_p, solClient_uint32_t index,
+                         solClient_returnCode_t rc, solClient_subCode_t subCode )
+{
+    common_provisionerOp_t *op_p = &prov_p->ops_p[index];
+    solClient_uint32_t next;
+
+    op_p->state = COMMON_PROV_DONE;
+    op_p->rc = rc;
+    op_p->subCode = subCode;
+    prov_p->completed++;
+    if ( op_p->topic_p != NULL ) {
+        if ( rc == SOLCLIENT_OK ) {
+            prov_p->stats.mappingsOk++;
+        } else {
+            prov_p->stats.mappingsFailed++;
+        }
+        return;
+    }
+    if ( rc == SOLCLIENT_OK ) {
+        prov_p->stats.queuesOk++;
+    } else {
+        prov_p->stats.queuesFailed++;
+    }
+    for ( next = op_p->next; next != 0; next = prov_p->ops_p[next - 1].next ) {
+        if ( rc == SOLCLIENT_OK ) {
+            common_provisionerReady ( prov_p, next - 1, 0 );
+        } else {
+            prov_p->ops_p[next - 1].state = COMMON_PROV_DONE;
+            prov_p->ops_p[next - 1].rc = SOLCLIENT_FAIL;
+            prov_p->completed++;
+            prov_p->stats.mappingsSkipped++;
+        }
+    }
+}
+
+
+/*****************************************************************************
+ * common_provisionerSend
+ *
+ * Start an operation with its index + 1 as the correlation tag.
+ *****************************************************************************/
+static          solClient_returnCode_t
+common_provisionerSend ( common_provisioner_pt prov_p, common_provisionerOp_t * op_p, solClient_uint32_t index )
+{
+    const char     *props[40] = {0, };
+    int             propIndex = 0;
+
+    props[propIndex++] = SOLCLIENT_ENDPOINT_PROP_ID;
+    props[propIndex++] = SOLCLIENT_ENDPOINT_PROP_QUEUE;
+    props[propIndex++] = SOLCLIENT_ENDPOINT_PROP_NAME;
+    props[propIndex++] = op_p->queue_p;
+    if ( op_p->topic_p != NULL ) {
+        return solClient_session_endpointTopicSubscribe ( ( char ** ) props, prov_p->session_p,
+                                                          SOLCLIENT_SUBSCRIBE_FLAGS_REQUEST_CONFIRM,
+                                                          op_p->topic_p, ( void * ) ( size_t ) ( index + 1 ) );
+    }
+    /* As common_createQueue(), but confirmed by a Session event. */
+    props[propIndex++] = SOLCLIENT_ENDPOINT_PROP_PERMISSION;
+    props[propIndex++] = SOLCLIENT_ENDPOINT_PERM_DELETE;
+    props[propIndex++] = SOLCLIENT_ENDPOINT_PROP_QUOTA_MB;
+    props[propIndex++] = "100";
+    return solClient_session_endpointProvision ( ( char ** ) props, prov_p->session_p,
+                                                 SOLCLIENT_PROVISION_FLAGS_IGNORE_EXIST_ERRORS,
+                                                 ( void * ) ( size_t ) ( index + 1 ), NULL, 0 );
+}
+
+
+/*****************************************************************************
+ * common_provisioner_run
+ *****************************************************************************/
+solClient_returnCode_t
+common_provisioner_run ( common_provisioner_pt prov_p, solClient_opaqueSession_pt session_p )
+{
+    solClient_returnCode_t rc;
+    solClient_subCode_t subCode;
+    common_provisionerOp_t *op_p;
+    solClient_uint32_t index;
+    UINT64          startUs = getTimeInUs (  );
+
+    mutexLock ( &prov_p->mutex );
+    prov_p->session_p = session_p;
+    /* The Queues first, in file order; their mappings follow as they are confirmed. */
+    for ( index = 0; index < prov_p->numOps; index++ ) {
+        if ( prov_p->ops_p[index].topic_p == NULL && prov_p->ops_p[index].state == COMMON_PROV_WAITING ) {
+            common_provisionerReady ( prov_p, index, 0 );
+        }
+    }
+    while ( prov_p->completed < prov_p->numOps ) {
+        if ( prov_p->outstanding >= prov_p->window || prov_p->ready.count == 0 ) {
+            /* Wait for completions. */
+            mutexUnlock ( &prov_p->mutex );
+            sleepInUs ( COMMON_PROV_POLL_US );
+            mutexLock ( &prov_p->mutex );
+            continue;
+        }
+        index = common_indexRing_pop ( &prov_p->ready );
+        op_p = &prov_p->ops_p[index];
+        op_p->state = COMMON_PROV_OUTSTANDING;
+        op_p->sentUs = getTimeInUs (  );
+        prov_p->outstanding++;
+        mutexUnlock ( &prov_p->mutex );
+
+        rc = common_provisionerSend ( prov_p, op_p, index );
+        subCode = solClient_getLastErrorInfo (  )->subCode;
+
+        mutexLock ( &prov_p->mutex );
+        if ( rc == SOLCLIENT_OK || rc == SOLCLIENT_IN_PROGRESS || op_p->state != COMMON_PROV_OUTSTANDING ) {
+            continue;
+        }
+        /* Refused by the API: it leaves the window at once. */
+        prov_p->outstanding--;
+        if ( rc == SOLCLIENT_WOULD_BLOCK || rc == SOLCLIENT_NOT_READY ) {
+            prov_p->stats.wouldBlock++;
+            common_provisionerReady ( prov_p, index, 1 );
+            mutexUnlock ( &prov_p->mutex );
+            sleepInUs ( COMMON_PROV_POLL_US );
+            mutexLock ( &prov_p->mutex );
+        } else {
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Provisioning of '%s'%s%s not sent: %s, %s", op_p->queue_p,
+                            op_p->topic_p != NULL ? " topic " : "", op_p->topic_p != NULL ? op_p->topic_p : "",
+                            solClient_returnCodeToString ( rc ), solClient_subCodeToString ( subCode ) );
+            common_provisionerDone ( prov_p, index, rc, subCode );
+        }
+    }
+    prov_p->elapsedUs = getTimeInUs (  ) - startUs;
+    mutexUnlock ( &prov_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_provisionerComplete
+ *
+ * An operation was confirmed or rejected. Returns 0 if the correlation tag
+ * is not an outstanding operation of the provisioner.
+ *****************************************************************************/
+static int
+common_provisionerComplete ( common_provisioner_pt prov_p, void *correlation_p, int isTopic,
+                             solClient_returnCode_t rc, solClient_subCode_t subCode )
+{
+    solClient_uint32_t index = ( solClient_uint32_t ) ( size_t ) correlation_p;
+    common_provisionerOp_t *op_p;
+
+    mutexLock ( &prov_p->mutex );
+    if ( index == 0 || ( size_t ) correlation_p > prov_p->numOps ) {
+        mutexUnlock ( &prov_p->mutex );
+        return 0;
+    }
+    op_p = &prov_p->ops_p[--index];
+    if ( op_p->state != COMMON_PROV_OUTSTANDING || ( op_p->topic_p != NULL ) != isTopic ) {
+        mutexUnlock ( &prov_p->mutex );
+        return 0;
+    }
+    prov_p->outstanding--;
+    prov_p->latencyUs_p[prov_p->numLatencies++] = getTimeInUs (  ) - op_p->sentUs;
+    common_provisionerDone ( prov_p, index, rc, subCode );
+    mutexUnlock ( &prov_p->mutex );
+    return 1;
+}
+
+
+/*****************************************************************************
+ * common_provisionerReset
+ *
+ * The Session reconnected, and the outstanding operations may never be
+ * confirmed: send them again, which is harmless as existing Queues and
+ * mappings count as done. On a Session failure, fail everything left so
+ * that common_provisioner_run() returns.
+ *****************************************************************************/
+static void
+common_provisionerReset ( common_provisioner_pt prov_p, int down )
+{
+    common_provisionerOp_t *op_p;
+    solClient_uint32_t index;
+
+    mutexLock ( &prov_p->mutex );
+    if ( down ) {
+        prov_p->ready.count = 0;
+    }
+    for ( index = 0; index < prov_p->numOps; index++ ) {
+        op_p = &prov_p->ops_p[index];
+        if ( op_p->state == COMMON_PROV_OUTSTANDING ) {
+            prov_p->outstanding--;
+        } else if ( op_p->state == COMMON_PROV_DONE || !down ) {
+            continue;
+        }
+        /* A Queue failing skips its waiting mappings, which come after it. */
+        if ( down ) {
+            common_provisionerDone ( prov_p, index, SOLCLIENT_FAIL, SOLCLIENT_SUBCODE_COMMUNICATION_ERROR );
+        } else {
+            common_provisionerReady ( prov_p, index, 1 );
+        }
+    }
+    mutexUnlock ( &prov_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_provisioner_eventCallback
+ *****************************************************************************/
+void
+common_provisioner_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                   solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    common_provisioner_pt prov_p = ( common_provisioner_pt ) user_p;
+    solClient_subCode_t subCode;
+
+    switch ( eventInfo_p->sessionEvent ) {
+        case SOLCLIENT_SESSION_EVENT_PROVISION_OK:
+            if ( common_provisionerComplete ( prov_p, eventInfo_p->correlation_p, 0, SOLCLIENT_OK, SOLCLIENT_SUBCODE_OK ) ) {
+                return;
+            }
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_SUBSCRIPTION_OK:
+            if ( common_provisionerComplete ( prov_p, eventInfo_p->correlation_p, 1, SOLCLIENT_OK, SOLCLIENT_SUBCODE_OK ) ) {
+                return;
+            }
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_PROVISION_ERROR:
+            /* An existing Queue counts as provisioned. */
+            subCode = solClient_getLastErrorInfo (  )->subCode;
+            if ( common_provisionerComplete ( prov_p, eventInfo_p->correlation_p, 0,
+                                              subCode == SOLCLIENT_SUBCODE_ENDPOINT_ALREADY_EXISTS ?
+                                              SOLCLIENT_OK : SOLCLIENT_FAIL, subCode ) ) {
+                if ( subCode != SOLCLIENT_SUBCODE_ENDPOINT_ALREADY_EXISTS ) {
+                    solClient_log ( SOLCLIENT_LOG_WARNING, "Queue not provisioned: %s, %s", eventInfo_p->info_p,
+                                    solClient_subCodeToString ( subCode ) );
+                }
+                return;
+            }
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_SUBSCRIPTION_ERROR:
+            /* An existing mapping counts as added. */
+            subCode = solClient_getLastErrorInfo (  )->subCode;
+            if ( common_provisionerComplete ( prov_p, eventInfo_p->correlation_p, 1,
+                                              subCode == SOLCLIENT_SUBCODE_SUBSCRIPTION_ALREADY_PRESENT ?
+                                              SOLCLIENT_OK : SOLCLIENT_FAIL, subCode ) ) {
+                if ( subCode != SOLCLIENT_SUBCODE_SUBSCRIPTION_ALREADY_PRESENT ) {
+                    solClient_log ( SOLCLIENT_LOG_WARNING, "Queue mapping rejected: %s, %s", eventInfo_p->info_p,
+                                    solClient_subCodeToString ( subCode ) );
+                }
+                return;
+            }
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE:
+            common_provisionerReset ( prov_p, 0 );
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_DOWN_ERROR:
+            common_provisionerReset ( prov_p, 1 );
+            break;
+
+        default:
+            break;
+    }
+    common_eventCallback ( opaqueSession_p, eventInfo_p, NULL );
+}
+
+
+/*****************************************************************************
+ * common_provisioner_printStats
+ *****************************************************************************/
+void
+common_provisioner_printStats ( common_provisioner_pt prov_p )
+{
+    mutexLock ( &prov_p->mutex );
+    printf ( "Provisioned %u Queues and %u mappings in %.3f s (%.0f operations/s), window %u\n",
+             prov_p->numQueues, prov_p->numOps - prov_p->numQueues, prov_p->elapsedUs / 1000000.0,
+             prov_p->elapsedUs > 0 ? prov_p->completed * 1000000.0 / prov_p->elapsedUs : 0.0, prov_p->window );
+    printf ( "Results: Queues %llu ok, %llu failed; mappings %llu ok, %llu failed, %llu skipped; "
+             "%llu sent again after flow control\n",
+             ( unsigned long long ) prov_p->stats.queuesOk, ( unsigned long long ) prov_p->stats.queuesFailed,
+             ( unsigned long long ) prov_p->stats.mappingsOk, ( unsigned long long ) prov_p->stats.mappingsFailed,
+             ( unsigned long long ) prov_p->stats.mappingsSkipped, ( unsigned long long ) prov_p->stats.wouldBlock );
+    if ( prov_p->numLatencies > 0 ) {
+        common_sortSamples ( prov_p->latencyUs_p, prov_p->numLatencies );
+        printf ( "Operation latency us: p50 %llu, p90 %llu, p99 %llu, max %llu\n",
+                 ( unsigned long long ) common_getPercentile ( prov_p->latencyUs_p, prov_p->numLatencies, 50.0 ),
+                 ( unsigned long long ) common_getPercentile ( prov_p->latencyUs_p, prov_p->numLatencies, 90.0 ),
+                 ( unsigned long long ) common_getPercentile ( prov_p->latencyUs_p, prov_p->numLatencies, 99.0 ),
+                 ( unsigned long long ) common_getPercentile ( prov_p->latencyUs_p, prov_p->numLatencies, 100.0 ) );
+    }
+    mutexUnlock ( &prov_p->mutex );
+}
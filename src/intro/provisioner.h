@@ -0,0 +1,139 @@
+/** example ex/provisioner.h
+ */
+
+/**
+ *
+ * file provisioner.h Bulk Queue provisioning for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef PROVISIONER_H_
+#define PROVISIONER_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor provisioner
+ * @name Bulk Queue provisioning
+ * A provisioner creates many Queues and adds Topic subscriptions to them
+ * (topic to Queue mappings) without waiting for each operation in turn.
+ * Queues are provisioned without ::SOLCLIENT_PROVISION_FLAGS_WAITFORCONFIRM
+ * and topics added with ::SOLCLIENT_SUBSCRIBE_FLAGS_REQUEST_CONFIRM, keeping
+ * up to window operations outstanding; each completion is matched to its
+ * operation by the correlation tag in its Session event. The mappings of a
+ * Queue are sent once the Queue is confirmed, and skipped if it could not
+ * be provisioned. Queues that already exist count as provisioned, and
+ * mappings already present as added.
+ *
+ * The Session event callback must be common_provisioner_eventCallback(),
+ * with the provisioner as user_p. Create the Session with
+ * reapplySubscriptions cleared in the commonOptions, or the API keeps every
+ * mapping to add it again on reconnect.
+ */
+/*@{*/
+
+#define COMMON_PROV_POLL_US          200        /**< Wait between checks for a free window slot. */
+
+typedef enum common_provState
+{
+    COMMON_PROV_WAITING = 0,        /**< A mapping waiting for its Queue. */
+    COMMON_PROV_READY,
+    COMMON_PROV_OUTSTANDING,
+    COMMON_PROV_DONE
+} common_provState_t;
+
+typedef struct common_provisionerOp
+{
+    const char     *queue_p;
+    const char     *topic_p;        /**< NULL to provision the Queue. */
+    solClient_uint64_t hash;        /**< Of the Queue name. */
+    solClient_uint32_t next;        /**< A Queue's first mapping, or a mapping's next one; index + 1, 0 for none. */
+    solClient_uint32_t last;        /**< A Queue's last mapping, index + 1. */
+    UINT64          sentUs;
+    common_provState_t state;
+    solClient_returnCode_t rc;
+    solClient_subCode_t subCode;
+} common_provisionerOp_t;
+
+typedef struct common_provisionerStats
+{
+    solClient_uint64_t queuesOk;
+    solClient_uint64_t queuesFailed;
+    solClient_uint64_t mappingsOk;
+    solClient_uint64_t mappingsFailed;
+    solClient_uint64_t mappingsSkipped;     /**< Their Queue could not be provisioned. */
+    solClient_uint64_t wouldBlock;          /**< Operations sent again after flow control. */
+} common_provisionerStats_t;
+
+typedef struct common_provisioner
+{
+    MUTEX_T         mutex;
+    solClient_opaqueSession_pt session_p;
+    common_provisionerOp_t *ops_p;
+    solClient_uint32_t numOps;
+    solClient_uint32_t maxOps;
+    solClient_uint32_t numQueues;
+    common_hashIndex_t index;       /**< Queue operations by name. */
+    common_indexRing_t ready;       /**< Operations to send. */
+    solClient_uint32_t outstanding;
+    solClient_uint32_t completed;
+    unsigned int    window;
+    solClient_uint64_t *latencyUs_p;    /**< Latency of each confirmed operation. */
+    int             numLatencies;
+    UINT64          elapsedUs;
+    common_provisionerStats_t stats;
+} common_provisioner_t, *common_provisioner_pt;
+
+/**
+ * Initialize a provisioner for up to maxOps Queues and mappings in total.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the provisioner cannot be
+ * allocated.
+ */
+solClient_returnCode_t
+    common_provisioner_init ( common_provisioner_pt prov_p, unsigned int maxOps, unsigned int window );
+
+/**
+ * Release a provisioner. Its operations must have completed.
+ */
+void
+    common_provisioner_destroy ( common_provisioner_pt prov_p );
+
+/**
+ * Record a topic to Queue mapping, and the Queue if it is new. With a NULL
+ * topic_p only the Queue is recorded. The names must remain valid until the
+ * provisioner is destroyed.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the provisioner is full.
+ */
+solClient_returnCode_t
+    common_provisioner_addMapping ( common_provisioner_pt prov_p, const char *queue_p, const char *topic_p );
+
+/**
+ * Provision every Queue and add every mapping on a Session, keeping at most
+ * window operations outstanding, and wait until all have completed. Must not be
+ * called from the Context thread.
+ * @return ::SOLCLIENT_OK once every operation completed, whatever its
+ * result.
+ */
+solClient_returnCode_t
+    common_provisioner_run ( common_provisioner_pt prov_p, solClient_opaqueSession_pt session_p );
+
+/**
+ * The Session event callback of a provisioner, given as user_p. Events
+ * other than the completions of its operations are passed to
+ * common_eventCallback().
+ */
+void
+    common_provisioner_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                       solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p );
+
+/**
+ * Print the results, the rate and the operation latency percentiles.
+ */
+void
+    common_provisioner_printStats ( common_provisioner_pt prov_p );
+
+/*@}*/
+
+#endif /* PROVISIONER_H_ */
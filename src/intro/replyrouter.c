@@ -0,0 +1,256 @@
+/** example ex/replyrouter.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Shared reply routing used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "replyrouter.h"
+
+
+/*****************************************************************************
+ * Reply slot states. A slot is claimed from NULL, then names the generation
+ * of its use in the bits above the step.
+ *****************************************************************************/
+#define COMMON_REPLY_CLAIMED        ( ( void * ) ( size_t ) 1 )
+#define COMMON_REPLY_WAITING(gen)   ( ( void * ) ( ( ( size_t ) ( gen ) << 2 ) | 1 ) )
+#define COMMON_REPLY_STORING(gen)   ( ( void * ) ( ( ( size_t ) ( gen ) << 2 ) | 2 ) )
+#define COMMON_REPLY_DONE(gen)      ( ( void * ) ( ( ( size_t ) ( gen ) << 2 ) | 3 ) )
+#define COMMON_REPLY_GEN_MASK       0x3fffffff
+
+
+/*****************************************************************************
+ * common_replyRouter_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_replyRouter_init ( common_replyRouter_pt router_p, unsigned int numSlots )
+{
+    solClient_uint32_t tableSize = 1;
+
+    memset ( router_p, 0, sizeof ( *router_p ) );
+    while ( tableSize < numSlots ) {
+        tableSize <<= 1;
+    }
+    if ( ( router_p->slots_p = ( common_replySlot_t * ) alignedAlloc ( tableSize * sizeof ( common_replySlot_t ),
+                                                                      COMMON_CACHE_LINE_SIZE ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a reply router of %u slots", tableSize );
+        return SOLCLIENT_FAIL;
+    }
+    memset ( router_p->slots_p, 0, tableSize * sizeof ( common_replySlot_t ) );
+    router_p->slotMask = tableSize - 1;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_replyRouter_start
+ *****************************************************************************/
+solClient_returnCode_t
+common_replyRouter_start ( common_replyRouter_pt router_p, solClient_opaqueSession_pt session_p )
+{
+    solClient_returnCode_t rc;
+
+    if ( ( rc = solClient_session_createTemporaryTopicName ( session_p, router_p->replyTopic,
+                                                             sizeof ( router_p->replyTopic ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_createTemporaryTopicName()" );
+        return rc;
+    }
+    if ( ( rc = solClient_session_topicSubscribeExt ( session_p, SOLCLIENT_SUBSCRIBE_FLAGS_WAITFORCONFIRM,
+                                                      router_p->replyTopic ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicSubscribeExt()" );
+        return rc;
+    }
+    router_p->replyTo.destType = SOLCLIENT_TOPIC_DESTINATION;
+    router_p->replyTo.dest = router_p->replyTopic;
+    router_p->session_p = session_p;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_replyRouter_destroy
+ *****************************************************************************/
+void
+common_replyRouter_destroy ( common_replyRouter_pt router_p )
+{
+    solClient_opaqueMsg_pt reply_p;
+    solClient_uint32_t i;
+
+    if ( router_p->slots_p == NULL ) {
+        return;
+    }
+    for ( i = 0; i <= router_p->slotMask; i++ ) {
+        if ( ( reply_p = router_p->slots_p[i].reply_p ) != NULL ) {
+            solClient_msg_free ( &reply_p );
+        }
+    }
+    alignedFree ( router_p->slots_p );
+    router_p->slots_p = NULL;
+}
+
+
+/*****************************************************************************
+ * common_replyRouter_initRequester
+ *****************************************************************************/
+void
+common_replyRouter_initRequester ( common_replyRouter_pt router_p, common_replyRequester_pt requester_p,
+                                   unsigned int index )
+{
+    memset ( requester_p, 0, sizeof ( *requester_p ) );
+    requester_p->router_p = router_p;
+    /* Spread the threads over the table. */
+    requester_p->nextSlot = ( index * 0x9e3779b1u ) & router_p->slotMask;
+}
+
+
+/*****************************************************************************
+ * common_replyRouterTake
+ *
+ * Take the reply out of a slot in the done state and free the slot.
+ *****************************************************************************/
+static          solClient_opaqueMsg_pt
+common_replyRouterTake ( common_replySlot_t * slot_p )
+{
+    solClient_opaqueMsg_pt reply_p;
+
+    READ_BARRIER (  );
+    reply_p = slot_p->reply_p;
+    slot_p->reply_p = NULL;
+    MEMORY_BARRIER (  );
+    slot_p->state = NULL;
+    return reply_p;
+}
+
+
+/*****************************************************************************
+ * common_replyRouter_request
+ *****************************************************************************/
+solClient_returnCode_t
+common_replyRouter_request ( common_replyRequester_pt requester_p, solClient_opaqueMsg_pt msg_p,
+                             solClient_opaqueMsg_pt * reply_p, int timeoutMs )
+{
+    common_replyRouter_pt router_p = requester_p->router_p;
+    common_replySlot_t *slot_p;
+    solClient_returnCode_t rc;
+    solClient_uint32_t index = requester_p->nextSlot;
+    solClient_uint32_t generation;
+    char            correlationId[32];
+    UINT64          deadlineUs;
+
+    *reply_p = NULL;
+
+    /* Claim a free slot. */
+    for ( ;; index = ( index + 1 ) & router_p->slotMask ) {
+        slot_p = &router_p->slots_p[index];
+        if ( slot_p->state == NULL && ATOMIC_CAS_PTR ( &slot_p->state, NULL, COMMON_REPLY_CLAIMED ) ) {
+            break;
+        }
+        requester_p->claimProbes++;
+    }
+    requester_p->nextSlot = ( index + 1 ) & router_p->slotMask;
+    if ( ( generation = ( slot_p->generation + 1 ) & COMMON_REPLY_GEN_MASK ) == 0 ) {
+        generation = 1;
+    }
+    slot_p->generation = generation;
+    sprintf ( correlationId, COMMON_REPLY_CORRELATION "%x.%x", index, generation );
+
+    if ( ( rc = solClient_msg_setReplyTo ( msg_p, &router_p->replyTo, sizeof ( router_p->replyTo ) ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setReplyTo()" );
+        goto freeSlot;
+    }
+    if ( ( rc = solClient_msg_setCorrelationId ( msg_p, correlationId ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_setCorrelationId()" );
+        goto freeSlot;
+    }
+
+    /* Waiting before the send, as the reply can come before it returns. */
+    MEMORY_BARRIER (  );
+    slot_p->state = COMMON_REPLY_WAITING ( generation );
+    requester_p->requests++;
+    if ( ( rc = solClient_session_sendMsg ( router_p->session_p, msg_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_sendMsg()" );
+        if ( ATOMIC_CAS_PTR ( &slot_p->state, COMMON_REPLY_WAITING ( generation ), COMMON_REPLY_CLAIMED ) ) {
+            goto freeSlot;
+        }
+        /* A reply came anyway. */
+        rc = SOLCLIENT_OK;
+    }
+
+    deadlineUs = getTimeInUs (  ) + ( UINT64 ) timeoutMs * 1000;
+    while ( slot_p->state != COMMON_REPLY_DONE ( generation ) ) {
+        if ( slot_p->state == COMMON_REPLY_WAITING ( generation ) && getTimeInUs (  ) >= deadlineUs &&
+             ATOMIC_CAS_PTR ( &slot_p->state, COMMON_REPLY_WAITING ( generation ), NULL ) ) {
+            /* Given up; a late reply no longer matches the slot. */
+            requester_p->timeouts++;
+            return SOLCLIENT_INCOMPLETE;
+        }
+        sleepInUs ( COMMON_REPLY_POLL_US );
+    }
+    *reply_p = common_replyRouterTake ( slot_p );
+    requester_p->replies++;
+    return SOLCLIENT_OK;
+
+  freeSlot:
+    requester_p->failed++;
+    slot_p->state = NULL;
+    return rc;
+}
+
+
+/*****************************************************************************
+ * common_replyRouter_messageReceiveCallback
+ *****************************************************************************/
+solClient_rxMsgCallback_returnCode_t
+common_replyRouter_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                            solClient_opaqueMsg_pt msg_p, void *user_p )
+{
+    common_replyRouter_pt router_p = ( common_replyRouter_pt ) user_p;
+    common_replySlot_t *slot_p;
+    const char     *correlationId_p;
+    unsigned int    index;
+    unsigned int    generation;
+
+    if ( router_p->slots_p == NULL ||
+         solClient_msg_getCorrelationId ( msg_p, &correlationId_p ) != SOLCLIENT_OK ||
+         sscanf ( correlationId_p, COMMON_REPLY_CORRELATION "%x.%x", &index, &generation ) != 2 ||
+         index > router_p->slotMask || generation == 0 || generation > COMMON_REPLY_GEN_MASK ) {
+        router_p->stats.unmatched++;
+        return SOLCLIENT_CALLBACK_OK;
+    }
+    slot_p = &router_p->slots_p[index];
+    if ( !ATOMIC_CAS_PTR ( &slot_p->state, COMMON_REPLY_WAITING ( generation ), COMMON_REPLY_STORING ( generation ) ) ) {
+        router_p->stats.late++;
+        return SOLCLIENT_CALLBACK_OK;
+    }
+    slot_p->reply_p = msg_p;
+    MEMORY_BARRIER (  );
+    slot_p->state = COMMON_REPLY_DONE ( generation );
+    router_p->stats.replies++;
+    /* The requester frees the reply. */
+    return SOLCLIENT_CALLBACK_TAKE_MSG;
+}
+
+
+/*****************************************************************************
+ * common_replyRouter_printStats
+ *****************************************************************************/
+void
+common_replyRouter_printStats ( common_replyRouter_pt router_p )
+{
+    printf ( "Reply router: topic %s, %u slots; %llu replies, %llu late, %llu unmatched messages\n",
+             router_p->replyTopic, router_p->slotMask + 1, ( unsigned long long ) router_p->stats.replies,
+             ( unsigned long long ) router_p->stats.late, ( unsigned long long ) router_p->stats.unmatched );
+}
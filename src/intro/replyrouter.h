@@ -0,0 +1,136 @@
+/** example ex/replyrouter.h
+ */
+
+/**
+ *
+ * file replyrouter.h Shared reply routing for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef REPLYROUTER_H_
+#define REPLYROUTER_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor replyRouter
+ * @name Shared reply routing
+ * A reply router lets many threads make requests through one Session
+ * without solClient_session_sendRequest(). Every request carries the same
+ * ReplyTo, a temporary topic the router subscribes to, and a correlation ID
+ * naming a slot of the router's table and the generation of the slot's
+ * current use. The Session's message receive callback,
+ * common_replyRouter_messageReceiveCallback() with the router as user_p,
+ * puts each reply in its slot, and the requesting thread takes it from
+ * there.
+ *
+ * The table takes no lock. A requester claims a free slot with a
+ * compare-and-swap, starting after the slot it used last, so threads
+ * rarely meet; the slot state carries the generation, so a reply that
+ * arrives after its request timed out cannot land in a later use of the
+ * slot. Each thread uses its own common_replyRequester_t, which also holds
+ * its counters.
+ */
+/*@{*/
+
+#define COMMON_REPLY_DEFAULT_SLOTS   4096
+#define COMMON_REPLY_POLL_US         10         /**< Wait between checks for a reply. */
+#define COMMON_REPLY_CORRELATION     "#RR"      /**< Prefix of the router's correlation IDs. */
+
+typedef struct common_replySlot
+{
+    void           *volatile state; /**< NULL when free, else the claim or the generation and its step. */
+    solClient_opaqueMsg_pt volatile reply_p;
+    solClient_uint32_t generation;
+    char            pad[COMMON_CACHE_LINE_SIZE - 2 * sizeof ( void * ) - sizeof ( solClient_uint32_t )];
+} common_replySlot_t;
+
+typedef struct common_replyRouterStats
+{
+    solClient_uint64_t replies;     /**< Put in their slot. */
+    solClient_uint64_t late;        /**< For a request no longer waiting. */
+    solClient_uint64_t unmatched;   /**< Without a correlation ID of the router. */
+} common_replyRouterStats_t;
+
+typedef struct common_replyRouter
+{
+    solClient_opaqueSession_pt session_p;
+    common_replySlot_t *slots_p;
+    solClient_uint32_t slotMask;
+    solClient_destination_t replyTo;
+    char            replyTopic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 1];
+    common_replyRouterStats_t stats;   /**< Counted by the Context thread only. */
+} common_replyRouter_t, *common_replyRouter_pt;
+
+typedef struct common_replyRequester
+{
+    common_replyRouter_pt router_p;
+    solClient_uint32_t nextSlot;
+    solClient_uint64_t requests;
+    solClient_uint64_t replies;
+    solClient_uint64_t timeouts;
+    solClient_uint64_t failed;
+    solClient_uint64_t claimProbes; /**< Slots found in use while claiming. */
+} common_replyRequester_t, *common_replyRequester_pt;
+
+/**
+ * Initialize a router with numSlots slots, rounded up to a power of two;
+ * at most that many requests can wait at once. Call before creating the
+ * Session, as the router is its receive callback's user_p.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the table cannot be allocated.
+ */
+solClient_returnCode_t
+    common_replyRouter_init ( common_replyRouter_pt router_p, unsigned int numSlots );
+
+/**
+ * Create the temporary reply topic of a connected Session and subscribe to
+ * it, waiting for the confirmation.
+ * @return ::SOLCLIENT_OK, or the failure of the API call.
+ */
+solClient_returnCode_t
+    common_replyRouter_start ( common_replyRouter_pt router_p, solClient_opaqueSession_pt session_p );
+
+/**
+ * Free the table and any replies still in it. No request may be waiting.
+ */
+void
+    common_replyRouter_destroy ( common_replyRouter_pt router_p );
+
+/**
+ * Initialize the requester of one thread, index spreading where the
+ * threads start claiming.
+ */
+void
+    common_replyRouter_initRequester ( common_replyRouter_pt router_p, common_replyRequester_pt requester_p,
+                                       unsigned int index );
+
+/**
+ * Send a request, setting its ReplyTo and correlation ID, and wait up to
+ * timeoutMs for the reply, which the caller frees with solClient_msg_free().
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_INCOMPLETE on timeout, or the failure
+ * of the send.
+ */
+solClient_returnCode_t
+    common_replyRouter_request ( common_replyRequester_pt requester_p, solClient_opaqueMsg_pt msg_p,
+                                 solClient_opaqueMsg_pt * reply_p, int timeoutMs );
+
+/**
+ * The Session message receive callback of a router, given as user_p. Takes
+ * the replies to the router's requests; other messages are counted and
+ * dropped.
+ */
+solClient_rxMsgCallback_returnCode_t
+    common_replyRouter_messageReceiveCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                                solClient_opaqueMsg_pt msg_p, void *user_p );
+
+/**
+ * Print the reply counters of the Context thread.
+ */
+void
+    common_replyRouter_printStats ( common_replyRouter_pt router_p );
+
+/*@}*/
+
+#endif /* REPLYROUTER_H_ */
@@ -0,0 +1,240 @@
+/** example Intro/sdtcodec.h
+ */
+
+/**
+ *
+ * file sdtcodec.h Include file for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ * A schema-compiled codec for structured data (SDT) payloads. A message
+ * schema is written once as a field list macro, and SDT_DEFINE_SCHEMA()
+ * expands it into a C structure and encode and decode functions specialized
+ * for that schema, with one typed container call per field:
+ *
+ *     #define QUOTE_FIELDS(FIELD) \
+ *         FIELD ( STRING, symbol ) \
+ *         FIELD ( INT64,  quoteTime ) \
+ *         FIELD ( DOUBLE, bidPrice ) \
+ *         FIELD ( INT32,  bidSize )
+ *
+ *     SDT_DEFINE_SCHEMA ( quote, QUOTE_FIELDS )
+ *
+ * defines quote_t and:
+ *
+ *     quote_encodeStream ( container_p, &quote )
+ *     quote_decodeStream ( container_p, &quote, &failedField_p )
+ *     quote_encodeMap    ( container_p, &quote )
+ *     quote_decodeMap    ( container_p, &quote, &failedField_p )
+ *     quote_streamSize   ( &quote )   / quote_mapSize ( &quote )
+ *
+ * Field types are BOOL, INT8, INT16, INT32, INT64, UINT32, DOUBLE, STRING
+ * and BYTES. Streams carry the fields in schema order without names; maps
+ * carry the member names as field names.
+ *
+ * Decoding does not copy: STRING and BYTES members point into the message,
+ * and remain valid until the container is closed or the message is freed.
+ * Map decoding reads the fields in one pass with
+ * solClient_container_getNextField() while they arrive in schema order, and
+ * only falls back to a lookup by name (a scan of the map per field) from
+ * the first field that does not. The counter quote_mapFallbacks counts the
+ * decodes that fell back, so a benchmark can show the single pass was taken;
+ * it is a diagnostic and is not updated atomically. The size functions
+ * return the encoded size of a value, to create the container with a buffer
+ * large enough that it never has to grow.
+ */
+
+#ifndef _SDTCODEC_H_
+#define _SDTCODEC_H_
+
+#include <string.h>
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+
+#if defined(__GNUC__)
+#define SDT_CODEC_FUNC static __attribute__ ( ( unused ) )
+#else
+#define SDT_CODEC_FUNC static
+#endif
+
+/* A BYTES member: a byte array and its length. */
+typedef struct sdt_bytes
+{
+    solClient_uint8_t *data_p;
+    solClient_uint32_t length;
+} sdt_bytes_t;
+
+/* Upper bound on the type and length header of one encoded field. */
+#define SDT_FIELD_OVERHEAD  6
+
+/* Member types. */
+#define SDT_CTYPE_BOOL      solClient_bool_t
+#define SDT_CTYPE_INT8      solClient_int8_t
+#define SDT_CTYPE_INT16     solClient_int16_t
+#define SDT_CTYPE_INT32     solClient_int32_t
+#define SDT_CTYPE_INT64     solClient_int64_t
+#define SDT_CTYPE_UINT32    solClient_uint32_t
+#define SDT_CTYPE_DOUBLE    double
+#define SDT_CTYPE_STRING    const char *
+#define SDT_CTYPE_BYTES     sdt_bytes_t
+
+/* Encoded value sizes. */
+#define SDT_SIZE_BOOL(v)    1
+#define SDT_SIZE_INT8(v)    1
+#define SDT_SIZE_INT16(v)   2
+#define SDT_SIZE_INT32(v)   4
+#define SDT_SIZE_INT64(v)   8
+#define SDT_SIZE_UINT32(v)  4
+#define SDT_SIZE_DOUBLE(v)  8
+#define SDT_SIZE_STRING(v)  ( ( v ) != NULL ? strlen ( v ) + 1 : 1 )
+#define SDT_SIZE_BYTES(v)   ( ( v ).length )
+
+/* Add a value; name is NULL for a stream. */
+#define SDT_ADD_BOOL(c, v, name)    solClient_container_addBoolean ( c, v, name )
+#define SDT_ADD_INT8(c, v, name)    solClient_container_addInt8 ( c, v, name )
+#define SDT_ADD_INT16(c, v, name)   solClient_container_addInt16 ( c, v, name )
+#define SDT_ADD_INT32(c, v, name)   solClient_container_addInt32 ( c, v, name )
+#define SDT_ADD_INT64(c, v, name)   solClient_container_addInt64 ( c, v, name )
+#define SDT_ADD_UINT32(c, v, name)  solClient_container_addUint32 ( c, v, name )
+#define SDT_ADD_DOUBLE(c, v, name)  solClient_container_addDouble ( c, v, name )
+#define SDT_ADD_STRING(c, v, name)  solClient_container_addString ( c, ( v ) != NULL ? ( v ) : "", name )
+#define SDT_ADD_BYTES(c, v, name)   solClient_container_addByteArray ( c, ( v ).data_p, ( v ).length, name )
+
+/* Get a value, without copying strings and byte arrays; name is NULL for a stream. */
+#define SDT_GET_BOOL(c, v, name)    solClient_container_getBoolean ( c, &( v ), name )
+#define SDT_GET_INT8(c, v, name)    solClient_container_getInt8 ( c, &( v ), name )
+#define SDT_GET_INT16(c, v, name)   solClient_container_getInt16 ( c, &( v ), name )
+#define SDT_GET_INT32(c, v, name)   solClient_container_getInt32 ( c, &( v ), name )
+#define SDT_GET_INT64(c, v, name)   solClient_container_getInt64 ( c, &( v ), name )
+#define SDT_GET_UINT32(c, v, name)  solClient_container_getUint32 ( c, &( v ), name )
+#define SDT_GET_DOUBLE(c, v, name)  solClient_container_getDouble ( c, &( v ), name )
+#define SDT_GET_STRING(c, v, name)  solClient_container_getStringPtr ( c, &( v ), name )
+#define SDT_GET_BYTES(c, v, name)   solClient_container_getByteArrayPtr ( c, &( v ).data_p, &( v ).length, name )
+
+/* Field types, and taking a value from a solClient_field_t of that type. */
+#define SDT_FIELDTYPE_BOOL          SOLCLIENT_BOOL
+#define SDT_FIELDTYPE_INT8          SOLCLIENT_INT8
+#define SDT_FIELDTYPE_INT16         SOLCLIENT_INT16
+#define SDT_FIELDTYPE_INT32         SOLCLIENT_INT32
+#define SDT_FIELDTYPE_INT64         SOLCLIENT_INT64
+#define SDT_FIELDTYPE_UINT32        SOLCLIENT_UINT32
+#define SDT_FIELDTYPE_DOUBLE        SOLCLIENT_DOUBLE
+#define SDT_FIELDTYPE_STRING        SOLCLIENT_STRING
+#define SDT_FIELDTYPE_BYTES         SOLCLIENT_BYTEARRAY
+
+#define SDT_FROM_FIELD_BOOL(v, f)   ( v ) = ( f ).value.boolean
+#define SDT_FROM_FIELD_INT8(v, f)   ( v ) = ( f ).value.int8
+#define SDT_FROM_FIELD_INT16(v, f)  ( v ) = ( f ).value.int16
+#define SDT_FROM_FIELD_INT32(v, f)  ( v ) = ( f ).value.int32
+#define SDT_FROM_FIELD_INT64(v, f)  ( v ) = ( f ).value.int64
+#define SDT_FROM_FIELD_UINT32(v, f) ( v ) = ( f ).value.uint32
+#define SDT_FROM_FIELD_DOUBLE(v, f) ( v ) = ( f ).value.float64
+#define SDT_FROM_FIELD_STRING(v, f) ( v ) = ( f ).value.string
+#define SDT_FROM_FIELD_BYTES(v, f)  ( ( v ).data_p = ( f ).value.bytearray, ( v ).length = ( f ).length )
+
+/* Per-field expansions used by SDT_DEFINE_SCHEMA(). */
+#define SDT_MEMBER_(TYPE, member) \
+    SDT_CTYPE_##TYPE member;
+
+#define SDT_STREAM_SIZE_(TYPE, member) \
+    + SDT_FIELD_OVERHEAD + SDT_SIZE_##TYPE ( value_p->member )
+
+#define SDT_MAP_SIZE_(TYPE, member) \
+    + 2 * SDT_FIELD_OVERHEAD + sizeof ( #member ) + SDT_SIZE_##TYPE ( value_p->member )
+
+#define SDT_ENCODE_STREAM_(TYPE, member) \
+    if ( ( rc = SDT_ADD_##TYPE ( container_p, value_p->member, NULL ) ) != SOLCLIENT_OK ) { \
+        return rc; \
+    }
+
+#define SDT_ENCODE_MAP_(TYPE, member) \
+    if ( ( rc = SDT_ADD_##TYPE ( container_p, value_p->member, #member ) ) != SOLCLIENT_OK ) { \
+        return rc; \
+    }
+
+#define SDT_DECODE_STREAM_(TYPE, member) \
+    if ( ( rc = SDT_GET_##TYPE ( container_p, value_p->member, NULL ) ) != SOLCLIENT_OK ) { \
+        *failedField_p = #member; \
+        return rc; \
+    }
+
+#define SDT_DECODE_MAP_(TYPE, member) \
+    if ( inOrder && \
+         solClient_container_getNextField ( container_p, &field, sizeof ( field ), &name_p ) == SOLCLIENT_OK && \
+         field.type == SDT_FIELDTYPE_##TYPE && name_p != NULL && strcmp ( name_p, #member ) == 0 ) { \
+        SDT_FROM_FIELD_##TYPE ( value_p->member, field ); \
+    } else { \
+        inOrder = 0; \
+        if ( ( rc = SDT_GET_##TYPE ( container_p, value_p->member, #member ) ) != SOLCLIENT_OK ) { \
+            *failedField_p = #member; \
+            return rc; \
+        } \
+    }
+
+/*
+ * Define the structure name_t, its codec functions and the counter
+ * name_mapFallbacks from a field list macro FIELDS(FIELD), which applies
+ * FIELD ( TYPE, member ) to each field. Decode functions set *failedField_p
+ * to the member that could not be decoded when they fail.
+ */
+#define SDT_DEFINE_SCHEMA(name, FIELDS) \
+    typedef struct name \
+    { \
+        FIELDS ( SDT_MEMBER_ ) \
+    } name##_t; \
+    \
+    static solClient_uint64_t name##_mapFallbacks = 0; \
+    \
+    SDT_CODEC_FUNC size_t \
+    name##_streamSize ( const name##_t * value_p ) \
+    { \
+        return 0 FIELDS ( SDT_STREAM_SIZE_ ); \
+    } \
+    \
+    SDT_CODEC_FUNC size_t \
+    name##_mapSize ( const name##_t * value_p ) \
+    { \
+        return 0 FIELDS ( SDT_MAP_SIZE_ ); \
+    } \
+    \
+    SDT_CODEC_FUNC solClient_returnCode_t \
+    name##_encodeStream ( solClient_opaqueContainer_pt container_p, const name##_t * value_p ) \
+    { \
+        solClient_returnCode_t rc; \
+        FIELDS ( SDT_ENCODE_STREAM_ ) \
+        return SOLCLIENT_OK; \
+    } \
+    \
+    SDT_CODEC_FUNC solClient_returnCode_t \
+    name##_encodeMap ( solClient_opaqueContainer_pt container_p, const name##_t * value_p ) \
+    { \
+        solClient_returnCode_t rc; \
+        FIELDS ( SDT_ENCODE_MAP_ ) \
+        return SOLCLIENT_OK; \
+    } \
+    \
+    SDT_CODEC_FUNC solClient_returnCode_t \
+    name##_decodeStream ( solClient_opaqueContainer_pt container_p, name##_t * value_p, \
+                          const char **failedField_p ) \
+    { \
+        solClient_returnCode_t rc; \
+        FIELDS ( SDT_DECODE_STREAM_ ) \
+        return SOLCLIENT_OK; \
+    } \
+    \
+    SDT_CODEC_FUNC solClient_returnCode_t \
+    name##_decodeMap ( solClient_opaqueContainer_pt container_p, name##_t * value_p, \
+                       const char **failedField_p ) \
+    { \
+        solClient_returnCode_t rc; \
+        solClient_field_t field; \
+        const char     *name_p; \
+        int             inOrder = 1; \
+        FIELDS ( SDT_DECODE_MAP_ ) \
+        if ( !inOrder ) { \
+            name##_mapFallbacks++; \
+        } \
+        return SOLCLIENT_OK; \
+    }
+
+#endif
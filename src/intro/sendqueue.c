@@ -0,0 +1,384 @@
+/** example ex/sendqueue.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Non-blocking send queue used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "sendqueue.h"
+
+
+/*****************************************************************************
+ * common_sendQueues
+ *
+ * The registered send queues, found by Session from
+ * common_sendQueue_eventCallback().
+ * A slot is claimed with a compare-and-swap and cleared on destroy. Its
+ * user count is raised while the event callback uses the queue, and
+ * destroy waits for it to drop; the counts are never freed, so raising one
+ * is safe while the queue is being destroyed.
+ *****************************************************************************/
+static common_sendQueue_pt volatile common_sendQueues[COMMON_SENDQ_MAX];
+static volatile int common_sendQueueUsers[COMMON_SENDQ_MAX];
+
+
+/*****************************************************************************
+ * common_sendQueue_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_sendQueue_init ( common_sendQueue_pt queue_p, solClient_opaqueSession_pt session_p,
+                        unsigned int depth, int policy )
+{
+    int             slot;
+
+    memset ( queue_p, 0, sizeof ( *queue_p ) );
+    if ( depth == 0 ) {
+        depth = COMMON_SENDQ_DEFAULT_DEPTH;
+    }
+    if ( ( queue_p->ring_p = ( solClient_opaqueMsg_pt * ) malloc ( depth * sizeof ( solClient_opaqueMsg_pt ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a send queue of %u messages", depth );
+        return SOLCLIENT_FAIL;
+    }
+    queue_p->session_p = session_p;
+    queue_p->depth = depth;
+    queue_p->policy = policy;
+    mutexInit ( &queue_p->mutex );
+
+    /* Visible to the Context thread only once initialized. */
+    MEMORY_BARRIER (  );
+    for ( slot = 0; slot < COMMON_SENDQ_MAX; slot++ ) {
+        if ( ATOMIC_CAS_PTR ( &common_sendQueues[slot], ( common_sendQueue_pt ) NULL, queue_p ) ) {
+            return SOLCLIENT_OK;
+        }
+    }
+    solClient_log ( SOLCLIENT_LOG_ERROR, "Could not register a send queue, %d exist", COMMON_SENDQ_MAX );
+    mutexDestroy ( &queue_p->mutex );
+    free ( queue_p->ring_p );
+    memset ( queue_p, 0, sizeof ( *queue_p ) );
+    return SOLCLIENT_FAIL;
+}
+
+
+/*****************************************************************************
+ * common_sendQueue_destroy
+ *****************************************************************************/
+void
+common_sendQueue_destroy ( common_sendQueue_pt queue_p )
+{
+    int             slot;
+
+    for ( slot = 0; slot < COMMON_SENDQ_MAX; slot++ ) {
+        if ( common_sendQueues[slot] == queue_p ) {
+            common_sendQueues[slot] = NULL;
+            MEMORY_BARRIER (  );
+            /* An event callback that found the queue before it was cleared. */
+            while ( common_sendQueueUsers[slot] != 0 ) {
+                sleepInUs ( 100 );
+            }
+        }
+    }
+    while ( queue_p->count > 0 ) {
+        solClient_msg_free ( &queue_p->ring_p[queue_p->head] );
+        queue_p->head = ( queue_p->head + 1 ) % queue_p->depth;
+        queue_p->count--;
+    }
+    free ( queue_p->ring_p );
+    queue_p->ring_p = NULL;
+    mutexDestroy ( &queue_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_sendQueuePush
+ *
+ * Queue a duplicate of a message at the tail, or at the head when it is
+ * older than everything queued. The caller has checked there is room.
+ * Called with the lock held.
+ *****************************************************************************/
+static          solClient_returnCode_t
+common_sendQueuePush ( common_sendQueue_pt queue_p, solClient_opaqueMsg_pt msg_p, int atHead )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueMsg_pt dup_p;
+
+    if ( ( rc = solClient_msg_dup ( msg_p, &dup_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_msg_dup()" );
+        queue_p->stats.failed++;
+        return rc;
+    }
+    if ( atHead ) {
+        queue_p->head = ( queue_p->head + queue_p->depth - 1 ) % queue_p->depth;
+        queue_p->ring_p[queue_p->head] = dup_p;
+    } else {
+        queue_p->ring_p[( queue_p->head + queue_p->count ) % queue_p->depth] = dup_p;
+    }
+    queue_p->count++;
+    queue_p->stats.queued++;
+    if ( queue_p->count > queue_p->stats.maxDepth ) {
+        queue_p->stats.maxDepth = queue_p->count;
+    }
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_sendQueueRequeue
+ *
+ * Put messages taken from the head back, in order. Their room was kept
+ * while they were in flight. Called with the lock held.
+ *****************************************************************************/
+static void
+common_sendQueueRequeue ( common_sendQueue_pt queue_p, solClient_opaqueMsg_pt * msgs_p, solClient_uint32_t numMsgs )
+{
+    while ( numMsgs > 0 ) {
+        queue_p->head = ( queue_p->head + queue_p->depth - 1 ) % queue_p->depth;
+        queue_p->ring_p[queue_p->head] = msgs_p[--numMsgs];
+        queue_p->count++;
+    }
+}
+
+
+/*****************************************************************************
+ * common_sendQueueRun
+ *
+ * Send queued messages in batches until the ring is empty or the Session
+ * pushes back. Called with the lock held by the busy thread; the lock is
+ * released around each send.
+ *****************************************************************************/
+static void
+common_sendQueueRun ( common_sendQueue_pt queue_p )
+{
+    solClient_opaqueMsg_pt msgs[SOLCLIENT_SESSION_SEND_MULTIPLE_LIMIT];
+    solClient_returnCode_t rc;
+    solClient_errorInfo_pt errorInfo_p;
+    solClient_uint32_t numMsgs;
+    solClient_uint32_t written;
+    solClient_uint32_t i;
+
+    while ( queue_p->count > 0 ) {
+        queue_p->pending = 0;
+        numMsgs = queue_p->count < SOLCLIENT_SESSION_SEND_MULTIPLE_LIMIT ?
+                queue_p->count : SOLCLIENT_SESSION_SEND_MULTIPLE_LIMIT;
+        for ( i = 0; i < numMsgs; i++ ) {
+            msgs[i] = queue_p->ring_p[queue_p->head];
+            queue_p->head = ( queue_p->head + 1 ) % queue_p->depth;
+        }
+        queue_p->count -= numMsgs;
+        queue_p->inFlight = numMsgs;
+        mutexUnlock ( &queue_p->mutex );
+
+        written = 0;
+        rc = solClient_session_sendMultipleMsg ( queue_p->session_p, msgs, numMsgs, &written );
+        for ( i = 0; i < written; i++ ) {
+            solClient_msg_free ( &msgs[i] );
+        }
+
+        mutexLock ( &queue_p->mutex );
+        queue_p->inFlight = 0;
+        queue_p->stats.drained += written;
+        if ( rc == SOLCLIENT_OK ) {
+            continue;
+        }
+        if ( rc == SOLCLIENT_WOULD_BLOCK || rc == SOLCLIENT_NOT_READY ) {
+            common_sendQueueRequeue ( queue_p, &msgs[written], numMsgs - written );
+            if ( rc == SOLCLIENT_WOULD_BLOCK ) {
+                queue_p->stats.wouldBlock++;
+            } else {
+                queue_p->stats.notReady++;
+            }
+            /* The next CAN_SEND or reconnect drains the rest. */
+            if ( !queue_p->pending ) {
+                break;
+            }
+            continue;
+        }
+        /* The first unwritten message was refused; drop it and go on. */
+        errorInfo_p = solClient_getLastErrorInfo (  );
+        solClient_log ( SOLCLIENT_LOG_WARNING, "Dropping a queued message: %s, %s",
+                        solClient_returnCodeToString ( rc ), solClient_subCodeToString ( errorInfo_p->subCode ) );
+        solClient_msg_free ( &msgs[written] );
+        queue_p->stats.failed++;
+        common_sendQueueRequeue ( queue_p, &msgs[written + 1], numMsgs - written - 1 );
+    }
+}
+
+
+/*****************************************************************************
+ * common_sendQueue_send
+ *****************************************************************************/
+solClient_returnCode_t
+common_sendQueue_send ( common_sendQueue_pt queue_p, solClient_opaqueMsg_pt msg_p )
+{
+    solClient_returnCode_t rc;
+    int             waited = 0;
+    int             pushedBack = 0;
+
+    mutexLock ( &queue_p->mutex );
+
+    /* Behind queued or in flight messages: queue it, making room as the policy says. */
+    while ( queue_p->busy || queue_p->count > 0 ) {
+        if ( queue_p->count + queue_p->inFlight < queue_p->depth ) {
+            rc = common_sendQueuePush ( queue_p, msg_p, 0 );
+            mutexUnlock ( &queue_p->mutex );
+            return rc;
+        }
+        if ( queue_p->policy == COMMON_SENDQ_DROP_OLDEST && queue_p->count > 0 ) {
+            solClient_msg_free ( &queue_p->ring_p[queue_p->head] );
+            queue_p->head = ( queue_p->head + 1 ) % queue_p->depth;
+            queue_p->count--;
+            queue_p->stats.droppedOldest++;
+            continue;
+        }
+        /* Dropping the oldest cannot free in flight messages, so drop this one. */
+        if ( queue_p->policy != COMMON_SENDQ_BLOCK ) {
+            queue_p->stats.droppedNewest++;
+            mutexUnlock ( &queue_p->mutex );
+            return SOLCLIENT_WOULD_BLOCK;
+        }
+        if ( !waited ) {
+            waited = 1;
+            queue_p->stats.waits++;
+        }
+        mutexUnlock ( &queue_p->mutex );
+        sleepInUs ( COMMON_SENDQ_POLL_US );
+        mutexLock ( &queue_p->mutex );
+    }
+
+    /* Nothing is queued: send it at once. */
+    queue_p->busy = 1;
+    queue_p->inFlight = 1;
+    mutexUnlock ( &queue_p->mutex );
+    rc = solClient_session_sendMsg ( queue_p->session_p, msg_p );
+    mutexLock ( &queue_p->mutex );
+    queue_p->inFlight = 0;
+
+    if ( rc == SOLCLIENT_OK ) {
+        queue_p->stats.sent++;
+    } else if ( rc == SOLCLIENT_WOULD_BLOCK || rc == SOLCLIENT_NOT_READY ) {
+        if ( rc == SOLCLIENT_WOULD_BLOCK ) {
+            queue_p->stats.wouldBlock++;
+        } else {
+            queue_p->stats.notReady++;
+        }
+        /* Older than anything queued while it was being sent. */
+        rc = common_sendQueuePush ( queue_p, msg_p, 1 );
+        pushedBack = 1;
+    } else {
+        common_handleError ( rc, "solClient_session_sendMsg()" );
+        queue_p->stats.failed++;
+    }
+
+    /* Send what was queued meanwhile, unless the Session pushed back since. */
+    if ( queue_p->count > 0 && ( !pushedBack || queue_p->pending ) ) {
+        common_sendQueueRun ( queue_p );
+    }
+    queue_p->busy = 0;
+    queue_p->pending = 0;
+    mutexUnlock ( &queue_p->mutex );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * common_sendQueue_drain
+ *****************************************************************************/
+void
+common_sendQueue_drain ( common_sendQueue_pt queue_p )
+{
+    mutexLock ( &queue_p->mutex );
+    if ( queue_p->busy ) {
+        /* The busy thread sends again before it returns. */
+        queue_p->pending = 1;
+    } else if ( queue_p->count > 0 ) {
+        queue_p->busy = 1;
+        common_sendQueueRun ( queue_p );
+        queue_p->busy = 0;
+        queue_p->pending = 0;
+    }
+    mutexUnlock ( &queue_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_sendQueue_eventCallback
+ *****************************************************************************/
+void
+common_sendQueue_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                 solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    common_sendQueue_pt queue_p;
+    int             slot;
+
+    /* Drain the send queue of the Session, if it has one, when it can take messages again. */
+    if ( eventInfo_p->sessionEvent == SOLCLIENT_SESSION_EVENT_CAN_SEND ||
+         eventInfo_p->sessionEvent == SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE ) {
+        for ( slot = 0; slot < COMMON_SENDQ_MAX; slot++ ) {
+            if ( common_sendQueues[slot] == NULL ) {
+                continue;
+            }
+            /* Counted before the slot is read again, so destroy waits for the drain. */
+            ATOMIC_ADD_INT ( &common_sendQueueUsers[slot], 1 );
+            queue_p = common_sendQueues[slot];
+            if ( queue_p != NULL && queue_p->session_p == opaqueSession_p ) {
+                mutexLock ( &queue_p->mutex );
+                queue_p->stats.canSend++;
+                mutexUnlock ( &queue_p->mutex );
+                common_sendQueue_drain ( queue_p );
+                ATOMIC_ADD_INT ( &common_sendQueueUsers[slot], -1 );
+                break;
+            }
+            ATOMIC_ADD_INT ( &common_sendQueueUsers[slot], -1 );
+        }
+    }
+    common_eventCallback ( opaqueSession_p, eventInfo_p, user_p );
+}
+
+
+/*****************************************************************************
+ * common_sendQueue_getDepth
+ *****************************************************************************/
+solClient_uint32_t
+common_sendQueue_getDepth ( common_sendQueue_pt queue_p )
+{
+    solClient_uint32_t depth;
+
+    mutexLock ( &queue_p->mutex );
+    depth = queue_p->count + queue_p->inFlight;
+    mutexUnlock ( &queue_p->mutex );
+    return depth;
+}
+
+
+/*****************************************************************************
+ * common_sendQueue_printStats
+ *****************************************************************************/
+void
+common_sendQueue_printStats ( common_sendQueue_pt queue_p )
+{
+    mutexLock ( &queue_p->mutex );
+    printf ( "Send queue: %u messages %s, %u queued now, deepest %u; %llu sent at once, %llu queued, "
+             "%llu sent from the queue\n",
+             queue_p->depth, common_sendQueuePolicyNames[queue_p->policy], queue_p->count + queue_p->inFlight,
+             queue_p->stats.maxDepth, ( unsigned long long ) queue_p->stats.sent,
+             ( unsigned long long ) queue_p->stats.queued, ( unsigned long long ) queue_p->stats.drained );
+    printf ( "Send queue drops: %llu oldest, %llu newest, %llu failed; %llu would block, %llu not ready, "
+             "%llu drain events, %llu sends waited for room\n",
+             ( unsigned long long ) queue_p->stats.droppedOldest, ( unsigned long long ) queue_p->stats.droppedNewest,
+             ( unsigned long long ) queue_p->stats.failed, ( unsigned long long ) queue_p->stats.wouldBlock,
+             ( unsigned long long ) queue_p->stats.notReady, ( unsigned long long ) queue_p->stats.canSend,
+             ( unsigned long long ) queue_p->stats.waits );
+    mutexUnlock ( &queue_p->mutex );
+}
@@ -0,0 +1,139 @@
+/** example ex/sendqueue.h
+ */
+
+/**
+ *
+ * file sendqueue.h Non-blocking send queue for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef SENDQUEUE_H_
+#define SENDQUEUE_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor sendQueue
+ * @name Non-blocking send queue
+ * A send queue lets a thread publish on a Session created with
+ * ::SOLCLIENT_SESSION_PROP_SEND_BLOCKING disabled (commonOptions.sendBlocking
+ * cleared) without ever waiting for the network. A message that cannot be
+ * sent at once (::SOLCLIENT_WOULD_BLOCK, or ::SOLCLIENT_NOT_READY while the
+ * Session reconnects) is duplicated into a bounded ring, and every later
+ * message is queued behind it to keep the order. The ring is drained with
+ * solClient_session_sendMultipleMsg() when common_sendQueue_eventCallback()
+ * gets ::SOLCLIENT_SESSION_EVENT_CAN_SEND or
+ * ::SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE for the Session, so the
+ * Session event callback must be, or pass its events on to,
+ * common_sendQueue_eventCallback().
+ *
+ * When the ring is full the policy (COMMON_SENDQ_*) drops the oldest queued
+ * message, drops the new one, or makes the sending thread wait for room.
+ * Only one thread at a time calls the API for a queue; the lock is never
+ * held across an API call.
+ */
+/*@{*/
+
+#define COMMON_SENDQ_MAX             16         /**< Send queues that can exist at once. */
+#define COMMON_SENDQ_POLL_US         100        /**< Wait between checks for room with ::COMMON_SENDQ_BLOCK. */
+
+typedef struct common_sendQueueStats
+{
+    solClient_uint64_t sent;        /**< Sent at once by common_sendQueue_send(). */
+    solClient_uint64_t queued;
+    solClient_uint64_t drained;     /**< Queued messages sent later. */
+    solClient_uint64_t droppedOldest;
+    solClient_uint64_t droppedNewest;
+    solClient_uint64_t failed;      /**< Dropped because the send failed. */
+    solClient_uint64_t wouldBlock;  /**< Sends refused by flow control. */
+    solClient_uint64_t notReady;    /**< Sends refused while reconnecting. */
+    solClient_uint64_t canSend;     /**< Drains started by a Session event. */
+    solClient_uint64_t waits;       /**< Sends that waited for room. */
+    solClient_uint32_t maxDepth;
+} common_sendQueueStats_t;
+
+typedef struct common_sendQueue
+{
+    MUTEX_T         mutex;
+    solClient_opaqueSession_pt session_p;
+    solClient_opaqueMsg_pt *ring_p; /**< Duplicated messages waiting to be sent. */
+    solClient_uint32_t head;
+    solClient_uint32_t count;
+    solClient_uint32_t depth;
+    solClient_uint32_t inFlight;    /**< Taken from the ring, or new, in the current API call. */
+    int             policy;
+    int             busy;           /**< A thread is calling the API for the queue. */
+    int             pending;        /**< A drain was asked for while busy. */
+    common_sendQueueStats_t stats;
+} common_sendQueue_t, *common_sendQueue_pt;
+
+/**
+ * Initialize a send queue of depth messages for a Session, and register it
+ * so common_sendQueue_eventCallback() drains it.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the ring cannot be allocated
+ * or ::COMMON_SENDQ_MAX queues exist.
+ */
+solClient_returnCode_t
+    common_sendQueue_init ( common_sendQueue_pt queue_p, solClient_opaqueSession_pt session_p,
+                            unsigned int depth, int policy );
+
+/**
+ * Unregister a send queue and free the messages still queued. Its Session
+ * must be disconnected first. Waits for a drain started by a Session event
+ * to finish, so it must not be called from the Context thread.
+ */
+void
+    common_sendQueue_destroy ( common_sendQueue_pt queue_p );
+
+/**
+ * Send a message, or queue a duplicate of it. The caller keeps ownership
+ * of msg_p and may reuse it at once. Never waits, except for room with
+ * ::COMMON_SENDQ_BLOCK.
+ * @return ::SOLCLIENT_OK if the message was sent or queued,
+ * ::SOLCLIENT_WOULD_BLOCK if it was dropped by ::COMMON_SENDQ_DROP_NEWEST,
+ * ::SOLCLIENT_FAIL if the send failed.
+ */
+solClient_returnCode_t
+    common_sendQueue_send ( common_sendQueue_pt queue_p, solClient_opaqueMsg_pt msg_p );
+
+/**
+ * Send as many queued messages as the Session accepts. Called by
+ * common_sendQueue_eventCallback(); an application may also call it.
+ */
+void
+    common_sendQueue_drain ( common_sendQueue_pt queue_p );
+
+/**
+ * A callback for Session events used by Sessions sent to through a send
+ * queue. The queue of the Session is drained on
+ * ::SOLCLIENT_SESSION_EVENT_CAN_SEND and
+ * ::SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE. All events are then passed to
+ * common_eventCallback().
+ * @param opaqueSession_p A pointer to the session to which the event applies.
+ * This pointer is never NULL.
+ * @param evenInfo_p A pointer to information about the event, such as
+ * the event type. This pointer is never NULL.
+ * @param user_p A pointer to opaque user data provided when the callback is
+ * registered.
+ */
+void
+    common_sendQueue_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                     solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p );
+
+/**
+ * Returns the number of messages queued or being sent.
+ */
+solClient_uint32_t
+    common_sendQueue_getDepth ( common_sendQueue_pt queue_p );
+
+/**
+ * Print the counts and the deepest the ring has been.
+ */
+void
+    common_sendQueue_printStats ( common_sendQueue_pt queue_p );
+
+/*@}*/
+
+#endif /* SENDQUEUE_H_ */
@@ -0,0 +1,324 @@
+/** example ex/seqtracker.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Sequence number tracking used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "seqtracker.h"
+
+
+/*****************************************************************************
+ * common_seqTracker_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_seqTracker_init ( common_seqTracker_pt tracker_p, unsigned int maxSenders )
+{
+    memset ( tracker_p, 0, sizeof ( *tracker_p ) );
+    tracker_p->senders_p = ( common_seqSender_t * ) calloc ( maxSenders > 0 ? maxSenders : 1, sizeof ( common_seqSender_t ) );
+    if ( tracker_p->senders_p == NULL || common_hashIndex_init ( &tracker_p->index, maxSenders ) != SOLCLIENT_OK ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a sequence tracker for %u senders", maxSenders );
+        free ( tracker_p->senders_p );
+        tracker_p->senders_p = NULL;
+        return SOLCLIENT_FAIL;
+    }
+    tracker_p->maxSenders = maxSenders;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_seqTracker_destroy
+ *****************************************************************************/
+void
+common_seqTracker_destroy ( common_seqTracker_pt tracker_p )
+{
+    free ( tracker_p->senders_p );
+    tracker_p->senders_p = NULL;
+    common_hashIndex_destroy ( &tracker_p->index );
+}
+
+
+/*****************************************************************************
+ * common_seqSenderMatch
+ *****************************************************************************/
+static int
+common_seqSenderMatch ( void *user_p, solClient_uint32_t entry, solClient_uint64_t hash, const char *senderId_p )
+{
+    const common_seqSender_t *sender_p = &( ( common_seqTracker_pt ) user_p )->senders_p[entry];
+
+    return sender_p->hash == hash && strncmp ( sender_p->senderId, senderId_p, COMMON_SEQ_MAX_SENDER_ID - 1 ) == 0;
+}
+
+
+/*****************************************************************************
+ * common_seqFindSender
+ *
+ * Find a sender by ID, adding it if there is room; senders are never
+ * removed. Sender IDs are compared up to the length kept.
+ *****************************************************************************/
+static common_seqSender_t *
+common_seqFindSender ( common_seqTracker_pt tracker_p, const char *senderId_p )
+{
+    char            senderId[COMMON_SEQ_MAX_SENDER_ID];
+    common_seqSender_t *sender_p;
+    solClient_uint64_t hash;
+    solClient_uint32_t entry;
+    solClient_uint32_t slot;
+
+    strncpy ( senderId, senderId_p, COMMON_SEQ_MAX_SENDER_ID - 1 );
+    senderId[COMMON_SEQ_MAX_SENDER_ID - 1] = '\0';
+    hash = common_hashString ( senderId );
+    if ( ( entry = common_hashIndex_find ( &tracker_p->index, hash, senderId, common_seqSenderMatch,
+                                           tracker_p, &slot ) ) != COMMON_HASH_NOT_FOUND ) {
+        return &tracker_p->senders_p[entry];
+    }
+    if ( tracker_p->numSenders >= tracker_p->maxSenders ) {
+        return NULL;
+    }
+    sender_p = &tracker_p->senders_p[tracker_p->numSenders];
+    sender_p->hash = hash;
+    sender_p->highSeq = -1;
+    sender_p->staleSeq = -1;
+    strcpy ( sender_p->senderId, senderId );
+    common_hashIndex_set ( &tracker_p->index, slot, tracker_p->numSenders++ );
+    return sender_p;
+}
+
+
+/*****************************************************************************
+ * common_seqCountBits
+ *****************************************************************************/
+static unsigned int
+common_seqCountBits ( solClient_uint64_t word )
+{
+    unsigned int    count = 0;
+
+    for ( ; word != 0; word &= word - 1 ) {
+        count++;
+    }
+    return count;
+}
+
+
+/*****************************************************************************
+ * common_seqSlideWindow
+ *
+ * Move the window forward over the count sequence numbers from first on,
+ * clearing their bits a word at a time. Each takes over the bit of the one
+ * COMMON_SEQ_WINDOW_BITS before it, which leaves the window and is lost if
+ * it was never received. When count is a whole window or more, the numbers
+ * between the old and new windows are lost as well. Returns the number
+ * lost.
+ *****************************************************************************/
+static solClient_uint64_t
+common_seqSlideWindow ( common_seqSender_t *sender_p, solClient_int64_t first, solClient_int64_t count )
+{
+    solClient_uint64_t lost = 0;
+    solClient_uint64_t mask;
+    unsigned int    index;
+    unsigned int    bits;
+    int             i;
+
+    if ( count >= COMMON_SEQ_WINDOW_BITS ) {
+        for ( i = 0; i < COMMON_SEQ_WINDOW_WORDS; i++ ) {
+            lost += 64 - common_seqCountBits ( sender_p->window[i] );
+            sender_p->window[i] = 0;
+        }
+        return lost + ( solClient_uint64_t ) ( count - COMMON_SEQ_WINDOW_BITS );
+    }
+    index = ( unsigned int ) ( first % COMMON_SEQ_WINDOW_BITS );
+    while ( count > 0 ) {
+        bits = 64 - ( index & 63 );
+        if ( bits > count ) {
+            bits = ( unsigned int ) count;
+        }
+        mask = ( bits == 64 ) ? ~( solClient_uint64_t ) 0 :
+                ( ( ( solClient_uint64_t ) 1 << bits ) - 1 ) << ( index & 63 );
+        lost += bits - common_seqCountBits ( sender_p->window[index >> 6] & mask );
+        sender_p->window[index >> 6] &= ~mask;
+        count -= bits;
+        index = ( index + bits ) % COMMON_SEQ_WINDOW_BITS;
+    }
+    return lost;
+}
+
+
+/*****************************************************************************
+ * common_seqTracker_track
+ *****************************************************************************/
+common_seqResult_t
+common_seqTracker_track ( common_seqTracker_pt tracker_p, const char *senderId_p, solClient_int64_t seq )
+{
+    common_seqSender_t *sender_p;
+    common_seqGapEvent_t *event_p;
+    common_seqResult_t result = COMMON_SEQ_IN_ORDER;
+    solClient_int64_t distance;
+    solClient_uint64_t bit;
+    solClient_uint64_t lost;
+    unsigned int    index;
+    int             i;
+
+    if ( ( sender_p = common_seqFindSender ( tracker_p, senderId_p ) ) == NULL ) {
+        tracker_p->untracked++;
+        return COMMON_SEQ_UNTRACKED;
+    }
+    sender_p->counters.received++;
+    tracker_p->totals.received++;
+
+    distance = seq - sender_p->highSeq;
+    if ( sender_p->highSeq >= 0 && -distance >= COMMON_SEQ_WINDOW_BITS ) {
+        /*
+         * Older than the window. A late message cannot be told from a
+         * duplicate, but a number near the start of the sequence, or one
+         * directly following the previous stale one, means the sender
+         * restarted.
+         */
+        if ( seq > COMMON_SEQ_WINDOW_BITS && seq != sender_p->staleSeq + 1 ) {
+            sender_p->staleSeq = seq;
+            sender_p->counters.stale++;
+            tracker_p->totals.stale++;
+            return COMMON_SEQ_STALE;
+        }
+        sender_p->counters.resets++;
+        tracker_p->totals.resets++;
+        result = COMMON_SEQ_RESET;
+    }
+    if ( sender_p->highSeq < 0 || result == COMMON_SEQ_RESET ) {
+        /*
+         * Start over. Everything before the new run counts as received so
+         * that it never shows up as lost, except that a restarted sender is
+         * expected from sequence number 1.
+         */
+        for ( i = 0; i < COMMON_SEQ_WINDOW_WORDS; i++ ) {
+            sender_p->window[i] = ~( solClient_uint64_t ) 0;
+        }
+        sender_p->highSeq = ( result == COMMON_SEQ_RESET && seq <= COMMON_SEQ_WINDOW_BITS ) ? 0 : seq - 1;
+        sender_p->staleSeq = -1;
+        distance = seq - sender_p->highSeq;
+    }
+
+    if ( distance > 0 ) {
+        lost = common_seqSlideWindow ( sender_p, sender_p->highSeq + 1, distance );
+        sender_p->counters.lost += lost;
+        tracker_p->totals.lost += lost;
+
+        index = ( unsigned int ) ( seq % COMMON_SEQ_WINDOW_BITS );
+        sender_p->window[index >> 6] |= ( solClient_uint64_t ) 1 << ( index & 63 );
+        if ( distance == 1 ) {
+            sender_p->highSeq = seq;
+            return result;
+        }
+
+        sender_p->counters.gapEvents++;
+        sender_p->counters.missing += ( solClient_uint64_t ) ( distance - 1 );
+        tracker_p->totals.gapEvents++;
+        tracker_p->totals.missing += ( solClient_uint64_t ) ( distance - 1 );
+        event_p = &tracker_p->gapEvents[tracker_p->numGapEvents++ & ( COMMON_SEQ_GAP_EVENTS - 1 )];
+        event_p->sender_p = sender_p;
+        event_p->firstMissing = sender_p->highSeq + 1;
+        event_p->numMissing = distance - 1;
+        sender_p->highSeq = seq;
+        return ( result == COMMON_SEQ_RESET ) ? result : COMMON_SEQ_GAP;
+    }
+
+    index = ( unsigned int ) ( seq % COMMON_SEQ_WINDOW_BITS );
+    bit = ( solClient_uint64_t ) 1 << ( index & 63 );
+    if ( ( sender_p->window[index >> 6] & bit ) != 0 ) {
+        sender_p->counters.duplicates++;
+        tracker_p->totals.duplicates++;
+        return COMMON_SEQ_DUPLICATE;
+    }
+    sender_p->window[index >> 6] |= bit;
+    sender_p->counters.reordered++;
+    tracker_p->totals.reordered++;
+    return COMMON_SEQ_REORDERED;
+}
+
+
+/*****************************************************************************
+ * common_seqTracker_trackMsg
+ *****************************************************************************/
+common_seqResult_t
+common_seqTracker_trackMsg ( common_seqTracker_pt tracker_p, solClient_opaqueMsg_pt msg_p )
+{
+    solClient_int64_t seq;
+    const char     *senderId_p;
+
+    if ( solClient_msg_getSequenceNumber ( msg_p, &seq ) != SOLCLIENT_OK ) {
+        tracker_p->untracked++;
+        return COMMON_SEQ_UNTRACKED;
+    }
+    if ( solClient_msg_getSenderId ( msg_p, &senderId_p ) != SOLCLIENT_OK ) {
+        senderId_p = "";
+    }
+    return common_seqTracker_track ( tracker_p, senderId_p, seq );
+}
+
+
+/*****************************************************************************
+ * common_seqTracker_nextGapEvent
+ *****************************************************************************/
+int
+common_seqTracker_nextGapEvent ( common_seqTracker_pt tracker_p, solClient_uint64_t *cursor_p,
+                                 common_seqGapEvent_t *event_p, solClient_uint64_t *skipped_p )
+{
+    if ( tracker_p->numGapEvents - *cursor_p > COMMON_SEQ_GAP_EVENTS ) {
+        if ( skipped_p != NULL ) {
+            *skipped_p += tracker_p->numGapEvents - COMMON_SEQ_GAP_EVENTS - *cursor_p;
+        }
+        *cursor_p = tracker_p->numGapEvents - COMMON_SEQ_GAP_EVENTS;
+    }
+    if ( *cursor_p == tracker_p->numGapEvents ) {
+        return 0;
+    }
+    *event_p = tracker_p->gapEvents[( *cursor_p )++ & ( COMMON_SEQ_GAP_EVENTS - 1 )];
+    return 1;
+}
+
+
+/*****************************************************************************
+ * common_seqTracker_printStats
+ *****************************************************************************/
+static void
+common_seqPrintCounters ( const char *name_p, const common_seqCounters_t * counters_p )
+{
+    printf ( "%-32.32s %12llu %8llu %10llu %10llu %10llu %10llu %8llu %7llu\n", name_p,
+             counters_p->received, counters_p->gapEvents, counters_p->missing, counters_p->reordered,
+             counters_p->lost, counters_p->duplicates, counters_p->stale, counters_p->resets );
+}
+
+void
+common_seqTracker_printStats ( common_seqTracker_pt tracker_p, int maxSenders )
+{
+    const common_seqSender_t *sender_p;
+    const common_seqCounters_t *counters_p;
+    unsigned int    index;
+    int             printed = 0;
+
+    printf ( "%-32s %12s %8s %10s %10s %10s %10s %8s %7s\n", "Sender", "Received", "Gaps", "Missing",
+             "Reordered", "Lost", "Duplicates", "Stale", "Resets" );
+    for ( index = 0; index < tracker_p->numSenders && printed < maxSenders; index++ ) {
+        sender_p = &tracker_p->senders_p[index];
+        counters_p = &sender_p->counters;
+        if ( counters_p->gapEvents != 0 || counters_p->duplicates != 0 || counters_p->stale != 0 ) {
+            common_seqPrintCounters ( sender_p->senderId[0] != '\0' ? sender_p->senderId : "(no sender ID)", counters_p );
+            printed++;
+        }
+    }
+    common_seqPrintCounters ( "total", &tracker_p->totals );
+    printf ( "%u senders, %llu untracked messages\n", tracker_p->numSenders, tracker_p->untracked );
+}
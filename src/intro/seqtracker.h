@@ -0,0 +1,150 @@
+/** example ex/seqtracker.h
+ */
+
+/**
+ *
+ * file seqtracker.h Sequence number tracking for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef SEQTRACKER_H_
+#define SEQTRACKER_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor seqTracker
+ * @name Sequence tracking
+ * A sequence tracker checks the sender sequence numbers
+ * (::SOLCLIENT_SESSION_PROP_GENERATE_SEQUENCE_NUMBER) of received messages
+ * per sender ID (::SOLCLIENT_SESSION_PROP_GENERATE_SENDER_ID) and classifies
+ * each message as in order, after a gap, a duplicate, a late (reordered)
+ * arrival filling an earlier gap, or too old to tell.
+ *
+ * Senders are kept in an array with a hash index (see @ref hashIndex), both
+ * sized for maxSenders when the tracker is initialized, and each sender has
+ * a bitmap of the last COMMON_SEQ_WINDOW_BITS sequence numbers. Tracking a
+ * message costs one hash lookup and a few bit operations, and never
+ * allocates memory. Gaps still open when they slide out of the window are
+ * counted as lost.
+ *
+ * A sender that restarts is recognized when its new sequence numbers are
+ * older than the window: at once if the new run starts within the first
+ * COMMON_SEQ_WINDOW_BITS numbers (the ones before it that are missing count
+ * as a gap), otherwise on its second message. A restart within the window
+ * of the old run looks like duplicates.
+ *
+ * A sequence tracker must only be used from one thread at a time.
+ */
+/*@{*/
+
+#define COMMON_SEQ_WINDOW_BITS       256        /**< Sequence numbers remembered per sender; a multiple of 64. */
+#define COMMON_SEQ_WINDOW_WORDS      ( COMMON_SEQ_WINDOW_BITS / 64 )
+#define COMMON_SEQ_MAX_SENDER_ID     64         /**< Sender ID bytes kept, including the terminating NUL. */
+#define COMMON_SEQ_GAP_EVENTS        256        /**< Most recent gap events kept; a power of two. */
+
+typedef enum common_seqResult
+{
+    COMMON_SEQ_IN_ORDER = 0,        /**< The next sequence number, or the first from this sender. */
+    COMMON_SEQ_GAP,                 /**< Newer than expected; the sequence numbers skipped are missing. */
+    COMMON_SEQ_DUPLICATE,           /**< Already received. */
+    COMMON_SEQ_REORDERED,           /**< A missing sequence number arriving late. */
+    COMMON_SEQ_STALE,               /**< Older than the window; cannot tell duplicate from late. */
+    COMMON_SEQ_RESET,               /**< Older than the window but near the start of the sequence, or following
+                                         the previous stale one; the sender restarted. */
+    COMMON_SEQ_UNTRACKED            /**< No sequence number, or the sender table is full. */
+} common_seqResult_t;
+
+/** Message counts, per sender and over all senders. */
+typedef struct common_seqCounters
+{
+    solClient_uint64_t received;
+    solClient_uint64_t gapEvents;
+    solClient_uint64_t missing;     /**< Sequence numbers skipped by gaps. */
+    solClient_uint64_t reordered;   /**< Missing sequence numbers received later. */
+    solClient_uint64_t lost;        /**< Missing sequence numbers that left the window. */
+    solClient_uint64_t duplicates;
+    solClient_uint64_t stale;
+    solClient_uint64_t resets;
+} common_seqCounters_t;
+
+typedef struct common_seqSender
+{
+    solClient_uint64_t hash;        /**< Of the sender ID. */
+    solClient_int64_t highSeq;      /**< Highest sequence number received. */
+    solClient_int64_t staleSeq;     /**< Last stale sequence number, -1 if none since the last reset. */
+    solClient_uint64_t window[COMMON_SEQ_WINDOW_WORDS];  /**< Bit (seq % COMMON_SEQ_WINDOW_BITS) set when received. */
+    common_seqCounters_t counters;
+    char            senderId[COMMON_SEQ_MAX_SENDER_ID];
+} common_seqSender_t;
+
+/** A gap: numMissing sequence numbers from firstMissing were skipped. */
+typedef struct common_seqGapEvent
+{
+    const common_seqSender_t *sender_p;
+    solClient_int64_t firstMissing;
+    solClient_int64_t numMissing;
+} common_seqGapEvent_t;
+
+typedef struct common_seqTracker
+{
+    common_seqSender_t *senders_p;  /**< In the order first seen. */
+    common_hashIndex_t index;       /**< Senders by ID. */
+    unsigned int    maxSenders;
+    unsigned int    numSenders;
+    common_seqCounters_t totals;
+    solClient_uint64_t untracked;
+    common_seqGapEvent_t gapEvents[COMMON_SEQ_GAP_EVENTS];
+    solClient_uint64_t numGapEvents;    /**< Gap events ever recorded; the newest is at (numGapEvents - 1). */
+} common_seqTracker_t, *common_seqTracker_pt;
+
+/**
+ * Initialize a sequence tracker for up to maxSenders senders. Messages from
+ * further senders are counted as untracked.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the table cannot be allocated.
+ */
+solClient_returnCode_t
+    common_seqTracker_init ( common_seqTracker_pt tracker_p, unsigned int maxSenders );
+
+/**
+ * Release the sender table of a sequence tracker.
+ */
+void
+    common_seqTracker_destroy ( common_seqTracker_pt tracker_p );
+
+/**
+ * Track one sequence number from a sender. Sender IDs longer than
+ * COMMON_SEQ_MAX_SENDER_ID - 1 bytes are compared on that prefix and their
+ * hash.
+ */
+common_seqResult_t
+    common_seqTracker_track ( common_seqTracker_pt tracker_p, const char *senderId_p, solClient_int64_t seq );
+
+/**
+ * Track a received message by its sender ID and sequence number.
+ */
+common_seqResult_t
+    common_seqTracker_trackMsg ( common_seqTracker_pt tracker_p, solClient_opaqueMsg_pt msg_p );
+
+/**
+ * Copy the next gap event after *cursor_p (start at 0) and advance the
+ * cursor. When more than COMMON_SEQ_GAP_EVENTS events were recorded since
+ * the cursor, the oldest are skipped and counted in *skipped_p (may be NULL).
+ * @return 1 if an event was copied, 0 if there are no new events.
+ */
+int
+    common_seqTracker_nextGapEvent ( common_seqTracker_pt tracker_p, solClient_uint64_t *cursor_p,
+                                     common_seqGapEvent_t *event_p, solClient_uint64_t *skipped_p );
+
+/**
+ * Print the totals and the counters of up to maxSenders senders that saw
+ * gaps, duplicates or stale messages.
+ */
+void
+    common_seqTracker_printStats ( common_seqTracker_pt tracker_p, int maxSenders );
+
+/*@}*/
+
+#endif /* SEQTRACKER_H_ */
@@ -0,0 +1,656 @@
+/** example ex/subregistry.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Subscription registry used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "subregistry.h"
+
+
+/*****************************************************************************
+ * common_subRegistry_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_subRegistry_init ( common_subRegistry_pt registry_p, unsigned int maxTopics, unsigned int window )
+{
+    memset ( registry_p, 0, sizeof ( *registry_p ) );
+    if ( maxTopics == 0 ) {
+        maxTopics = 1;
+    }
+    /* The arena grows as needed. */
+    registry_p->arenaSize = maxTopics * 32;
+    registry_p->entries_p = ( common_subEntry_t * ) calloc ( maxTopics, sizeof ( common_subEntry_t ) );
+    registry_p->arena_p = ( char * ) malloc ( registry_p->arenaSize );
+    registry_p->keys_p = ( solClient_uint64_t * ) malloc ( maxTopics * sizeof ( solClient_uint64_t ) );
+    if ( registry_p->entries_p == NULL || registry_p->arena_p == NULL || registry_p->keys_p == NULL ||
+         common_hashIndex_init ( &registry_p->index, maxTopics ) != SOLCLIENT_OK ||
+         common_indexRing_init ( &registry_p->queue, maxTopics ) != SOLCLIENT_OK ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a subscription registry for %u topics", maxTopics );
+        free ( registry_p->entries_p );
+        free ( registry_p->arena_p );
+        free ( registry_p->keys_p );
+        common_hashIndex_destroy ( &registry_p->index );
+        memset ( registry_p, 0, sizeof ( *registry_p ) );
+        return SOLCLIENT_FAIL;
+    }
+    registry_p->maxTopics = maxTopics;
+    registry_p->window = window > 0 ? window : 1;
+    mutexInit ( &registry_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_destroy
+ *****************************************************************************/
+void
+common_subRegistry_destroy ( common_subRegistry_pt registry_p )
+{
+    free ( registry_p->entries_p );
+    free ( registry_p->arena_p );
+    free ( registry_p->keys_p );
+    registry_p->entries_p = NULL;
+    registry_p->arena_p = NULL;
+    registry_p->keys_p = NULL;
+    common_hashIndex_destroy ( &registry_p->index );
+    common_indexRing_destroy ( &registry_p->queue );
+    mutexDestroy ( &registry_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_subRegistryMatch
+ *****************************************************************************/
+static int
+common_subRegistryMatch ( void *user_p, solClient_uint32_t entry, solClient_uint64_t hash, const char *topic_p )
+{
+    common_subRegistry_pt registry_p = ( common_subRegistry_pt ) user_p;
+    const common_subEntry_t *entry_p = &registry_p->entries_p[entry];
+
+    return entry_p->hash == hash && strcmp ( &registry_p->arena_p[entry_p->topic], topic_p ) == 0;
+}
+
+
+/*****************************************************************************
+ * common_subRegistryFind
+ *
+ * Find the entry of a topic. Returns numEntries if the topic is not
+ * recorded, with the free slot for it in *slot_p. Called with the lock
+ * held.
+ *****************************************************************************/
+static solClient_uint32_t
+common_subRegistryFind ( common_subRegistry_pt registry_p, const char *topic_p, solClient_uint64_t hash,
+                         solClient_uint32_t * slot_p )
+{
+    solClient_uint32_t entry;
+
+    if ( ( entry = common_hashIndex_find ( &registry_p->index, hash, topic_p, common_subRegistryMatch,
+                                           registry_p, slot_p ) ) == COMMON_HASH_NOT_FOUND ) {
+        return registry_p->numEntries;
+    }
+    return entry;
+}
+
+
+/*****************************************************************************
+ * common_subRegistryCompact
+ *
+ * Drop the removed entries and their topics, and rebuild the index. Entries
+ * are renumbered, so none may be queued, waiting for a confirmation or
+ * being subscribed. Called with the lock held.
+ *****************************************************************************/
+static void
+common_subRegistryCompact ( common_subRegistry_pt registry_p )
+{
+    common_subEntry_t *entry_p;
+    solClient_uint32_t from;
+    solClient_uint32_t to = 0;
+    solClient_uint32_t used = 0;
+    solClient_uint32_t length;
+
+    common_hashIndex_clear ( &registry_p->index );
+    for ( from = 0; from < registry_p->numEntries; from++ ) {
+        entry_p = &registry_p->entries_p[from];
+        if ( entry_p->state == COMMON_SUB_REMOVED ) {
+            continue;
+        }
+        /* The topics are in entry order, so they only move down. */
+        length = ( solClient_uint32_t ) strlen ( &registry_p->arena_p[entry_p->topic] ) + 1;
+        memmove ( &registry_p->arena_p[used], &registry_p->arena_p[entry_p->topic], length );
+        entry_p->topic = used;
+        used += length;
+        registry_p->entries_p[to] = *entry_p;
+        common_hashIndex_insert ( &registry_p->index, entry_p->hash, to );
+        to++;
+    }
+    registry_p->numEntries = to;
+    registry_p->arenaUsed = used;
+    registry_p->stats.compactions++;
+}
+
+
+/*****************************************************************************
+ * common_subRegistryQueue
+ *
+ * Queue an entry to be subscribed, unless it is queued already. Called with
+ * the lock held.
+ *****************************************************************************/
+static void
+common_subRegistryQueue ( common_subRegistry_pt registry_p, solClient_uint32_t index )
+{
+    common_subEntry_t *entry_p = &registry_p->entries_p[index];
+
+    entry_p->state = COMMON_SUB_QUEUED;
+    if ( !entry_p->inQueue ) {
+        entry_p->inQueue = 1;
+        common_indexRing_push ( &registry_p->queue, index, 0 );
+    }
+}
+
+
+/*****************************************************************************
+ * common_subRegistryFinished
+ *
+ * An entry is done with for the current apply: when it is the last of the
+ * top priority, that priority is fully subscribed. Called with the lock
+ * held.
+ *****************************************************************************/
+static void
+common_subRegistryFinished ( common_subRegistry_pt registry_p, common_subEntry_t * entry_p )
+{
+    if ( registry_p->runActive && entry_p->priority == registry_p->runTopPriority &&
+         registry_p->runTopRemaining > 0 && --registry_p->runTopRemaining == 0 ) {
+        registry_p->runTopUs = getTimeInUs (  ) - registry_p->runStartUs;
+    }
+}
+
+
+/*****************************************************************************
+ * common_subRegistryCheckDone
+ *
+ * The apply completes when nothing is queued or waiting for a
+ * confirmation. Called with the lock held.
+ *****************************************************************************/
+static void
+common_subRegistryCheckDone ( common_subRegistry_pt registry_p )
+{
+    if ( !registry_p->runActive || registry_p->queue.count > 0 || registry_p->outstanding > 0 ) {
+        return;
+    }
+    registry_p->runAllUs = getTimeInUs (  ) - registry_p->runStartUs;
+    if ( registry_p->runTopRemaining > 0 ) {
+        registry_p->runTopUs = registry_p->runAllUs;
+    }
+    if ( registry_p->runAllUs > registry_p->maxAllUs ) {
+        registry_p->maxAllUs = registry_p->runAllUs;
+    }
+    registry_p->runActive = 0;
+    registry_p->stats.runsDone++;
+}
+
+
+/*****************************************************************************
+ * common_subRegistryStart
+ *
+ * Queue every recorded topic, highest priority first and then in the order
+ * recorded, and start timing. Called with the lock held.
+ *****************************************************************************/
+static void
+common_subRegistryStart ( common_subRegistry_pt registry_p )
+{
+    common_subEntry_t *entry_p;
+    solClient_uint32_t i;
+    solClient_uint32_t index;
+    int             numKeys = 0;
+
+    for ( i = 0; i < registry_p->numEntries; i++ ) {
+        entry_p = &registry_p->entries_p[i];
+        if ( entry_p->state != COMMON_SUB_REMOVED && !entry_p->inQueue && !entry_p->inFlight ) {
+            registry_p->keys_p[numKeys++] = ( ( solClient_uint64_t ) ( ~entry_p->priority & 0xFFFFFFFFu ) << 32 ) | i;
+        }
+    }
+    common_sortSamples ( registry_p->keys_p, numKeys );
+
+    registry_p->runActive = 1;
+    registry_p->runStartUs = getTimeInUs (  );
+    registry_p->runTopics = ( solClient_uint32_t ) numKeys;
+    registry_p->runTopPriority = numKeys > 0 ? registry_p->entries_p[( solClient_uint32_t ) registry_p->keys_p[0]].priority : 0;
+    registry_p->runTopCount = 0;
+    registry_p->runTopUs = 0;
+    registry_p->runAllUs = 0;
+    for ( i = 0; i < ( solClient_uint32_t ) numKeys; i++ ) {
+        index = ( solClient_uint32_t ) registry_p->keys_p[i];
+        if ( registry_p->entries_p[index].priority == registry_p->runTopPriority ) {
+            registry_p->runTopCount++;
+        }
+        common_subRegistryQueue ( registry_p, index );
+    }
+    registry_p->runTopRemaining = registry_p->runTopCount;
+    registry_p->stats.runs++;
+    common_subRegistryCheckDone ( registry_p );
+}
+
+
+/*****************************************************************************
+ * common_subRegistryReset
+ *
+ * The Session went down: its subscriptions and outstanding confirmations
+ * are gone.
+ *****************************************************************************/
+static void
+common_subRegistryReset ( common_subRegistry_pt registry_p )
+{
+    common_subEntry_t *entry_p;
+    solClient_uint32_t i;
+
+    mutexLock ( &registry_p->mutex );
+    registry_p->live = 0;
+    registry_p->blocked = 0;
+    registry_p->runActive = 0;
+    registry_p->queue.head = 0;
+    registry_p->queue.count = 0;
+    registry_p->outstanding = 0;
+    for ( i = 0; i < registry_p->numEntries; i++ ) {
+        entry_p = &registry_p->entries_p[i];
+        entry_p->inQueue = 0;
+        entry_p->inFlight = 0;
+        if ( entry_p->state != COMMON_SUB_REMOVED ) {
+            entry_p->state = COMMON_SUB_IDLE;
+        }
+    }
+    mutexUnlock ( &registry_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_subRegistryPump
+ *
+ * Subscribe to queued topics while fewer than window confirmations are
+ * outstanding. The lock is not held while subscribing: in an application
+ * thread, a subscribe can block until the Context thread runs. The
+ * correlation tag is the entry number + 1.
+ *****************************************************************************/
+static void
+common_subRegistryPump ( common_subRegistry_pt registry_p )
+{
+    solClient_returnCode_t rc;
+    solClient_subCode_t subCode;
+    solClient_opaqueSession_pt session_p;
+    common_subEntry_t *entry_p;
+    char            topic[SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 1];
+    solClient_uint32_t index;
+    int             counted;
+
+    mutexLock ( &registry_p->mutex );
+    while ( registry_p->live && !registry_p->blocked && registry_p->queue.count > 0 &&
+            registry_p->outstanding < registry_p->window ) {
+        index = common_indexRing_pop ( &registry_p->queue );
+        entry_p = &registry_p->entries_p[index];
+        entry_p->inQueue = 0;
+        if ( entry_p->state != COMMON_SUB_QUEUED ) {
+            /* Removed while queued. */
+            common_subRegistryFinished ( registry_p, entry_p );
+            continue;
+        }
+        entry_p->state = COMMON_SUB_PENDING;
+        /* A confirmation may still be due from before a remove and add. */
+        counted = !entry_p->inFlight;
+        if ( counted ) {
+            entry_p->inFlight = 1;
+            registry_p->outstanding++;
+        }
+        registry_p->stats.sent++;
+        registry_p->sending++;
+        strcpy ( topic, &registry_p->arena_p[entry_p->topic] );
+        session_p = registry_p->session_p;
+        mutexUnlock ( &registry_p->mutex );
+
+        rc = solClient_session_topicSubscribeWithDispatch ( session_p, SOLCLIENT_SUBSCRIBE_FLAGS_REQUEST_CONFIRM,
+                                                            topic, NULL, ( void * ) ( size_t ) ( index + 1 ) );
+        subCode = solClient_getLastErrorInfo (  )->subCode;
+
+        mutexLock ( &registry_p->mutex );
+        registry_p->sending--;
+        entry_p = &registry_p->entries_p[index];
+        if ( rc == SOLCLIENT_OK || rc == SOLCLIENT_IN_PROGRESS ) {
+            if ( entry_p->state == COMMON_SUB_REMOVED ) {
+                /* Removed while subscribing; its unsubscribe may have gone first. */
+                mutexUnlock ( &registry_p->mutex );
+                solClient_session_topicUnsubscribeExt ( session_p, 0, topic );
+                mutexLock ( &registry_p->mutex );
+            }
+            continue;
+        }
+        /* Not sent, so no confirmation will come. */
+        registry_p->stats.sent--;
+        if ( counted && entry_p->inFlight ) {
+            entry_p->inFlight = 0;
+            registry_p->outstanding--;
+        }
+        if ( rc == SOLCLIENT_WOULD_BLOCK ||
+             ( rc == SOLCLIENT_FAIL && subCode == SOLCLIENT_SUBCODE_CANNOT_BLOCK_IN_CONTEXT ) ) {
+            /* Flow controlled: back to the front of the queue until CAN_SEND. */
+            registry_p->stats.wouldBlock++;
+            registry_p->blocked = 1;
+            if ( entry_p->state == COMMON_SUB_PENDING && !entry_p->inQueue ) {
+                entry_p->state = COMMON_SUB_QUEUED;
+                entry_p->inQueue = 1;
+                common_indexRing_push ( &registry_p->queue, index, 1 );
+            }
+        } else {
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Subscription to '%s' not sent: %s, %s", topic,
+                            solClient_returnCodeToString ( rc ), solClient_subCodeToString ( subCode ) );
+            registry_p->stats.failed++;
+            if ( entry_p->state == COMMON_SUB_PENDING ) {
+                entry_p->state = COMMON_SUB_FAILED;
+            }
+            common_subRegistryFinished ( registry_p, entry_p );
+        }
+    }
+    common_subRegistryCheckDone ( registry_p );
+    mutexUnlock ( &registry_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_subRegistryConfirm
+ *
+ * A subscription was confirmed or rejected. Returns 0 if the correlation
+ * tag is not the registry's.
+ *****************************************************************************/
+static int
+common_subRegistryConfirm ( common_subRegistry_pt registry_p, void *correlation_p, int ok )
+{
+    solClient_uint32_t index = ( solClient_uint32_t ) ( size_t ) correlation_p;
+    common_subEntry_t *entry_p;
+
+    mutexLock ( &registry_p->mutex );
+    if ( index == 0 || ( size_t ) correlation_p > registry_p->numEntries ) {
+        mutexUnlock ( &registry_p->mutex );
+        return 0;
+    }
+    entry_p = &registry_p->entries_p[index - 1];
+    if ( entry_p->inFlight ) {
+        entry_p->inFlight = 0;
+        registry_p->outstanding--;
+        if ( entry_p->state == COMMON_SUB_PENDING ) {
+            entry_p->state = ok ? COMMON_SUB_APPLIED : COMMON_SUB_FAILED;
+        }
+        if ( ok ) {
+            registry_p->stats.confirmed++;
+        } else {
+            registry_p->stats.failed++;
+        }
+        common_subRegistryFinished ( registry_p, entry_p );
+        common_subRegistryCheckDone ( registry_p );
+    }
+    mutexUnlock ( &registry_p->mutex );
+    return 1;
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_add
+ *****************************************************************************/
+solClient_returnCode_t
+common_subRegistry_add ( common_subRegistry_pt registry_p, const char *topic_p, unsigned int priority )
+{
+    common_subEntry_t *entry_p;
+    solClient_uint64_t hash = common_hashString ( topic_p );
+    solClient_uint32_t length = ( solClient_uint32_t ) strlen ( topic_p ) + 1;
+    solClient_uint32_t index;
+    solClient_uint32_t slot = 0;
+    solClient_uint32_t arenaSize;
+    char           *arena_p;
+
+    if ( length > SOLCLIENT_BUFINFO_MAX_TOPIC_SIZE + 1 ) {
+        solClient_log ( SOLCLIENT_LOG_WARNING, "Subscription topic too long: '%s'", topic_p );
+        return SOLCLIENT_FAIL;
+    }
+
+    mutexLock ( &registry_p->mutex );
+    index = common_subRegistryFind ( registry_p, topic_p, hash, &slot );
+    if ( index == registry_p->numEntries ) {
+        if ( registry_p->numEntries >= registry_p->maxTopics && registry_p->queue.count == 0 &&
+             registry_p->outstanding == 0 && registry_p->sending == 0 ) {
+            common_subRegistryCompact ( registry_p );
+            index = common_subRegistryFind ( registry_p, topic_p, hash, &slot );
+        }
+        arenaSize = registry_p->arenaSize;
+        while ( registry_p->arenaUsed + length > arenaSize ) {
+            arenaSize *= 2;
+        }
+        arena_p = registry_p->arena_p;
+        if ( arenaSize != registry_p->arenaSize && ( arena_p = ( char * ) realloc ( arena_p, arenaSize ) ) != NULL ) {
+            registry_p->arena_p = arena_p;
+            registry_p->arenaSize = arenaSize;
+        }
+        if ( registry_p->numEntries >= registry_p->maxTopics || arena_p == NULL ) {
+            registry_p->stats.full++;
+            mutexUnlock ( &registry_p->mutex );
+            solClient_log ( SOLCLIENT_LOG_WARNING, "Subscription registry full, '%s' not added", topic_p );
+            return SOLCLIENT_FAIL;
+        }
+        memcpy ( &registry_p->arena_p[registry_p->arenaUsed], topic_p, length );
+        entry_p = &registry_p->entries_p[index];
+        memset ( entry_p, 0, sizeof ( *entry_p ) );
+        entry_p->topic = registry_p->arenaUsed;
+        entry_p->hash = hash;
+        entry_p->state = COMMON_SUB_REMOVED;
+        registry_p->arenaUsed += length;
+        common_hashIndex_set ( &registry_p->index, slot, index );
+        registry_p->numEntries++;
+    }
+    entry_p = &registry_p->entries_p[index];
+    entry_p->priority = priority;
+    if ( entry_p->state == COMMON_SUB_REMOVED ) {
+        registry_p->stats.adds++;
+        entry_p->state = COMMON_SUB_IDLE;
+        if ( registry_p->live ) {
+            common_subRegistryQueue ( registry_p, index );
+        }
+    }
+    mutexUnlock ( &registry_p->mutex );
+    common_subRegistryPump ( registry_p );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_remove
+ *****************************************************************************/
+solClient_returnCode_t
+common_subRegistry_remove ( common_subRegistry_pt registry_p, const char *topic_p )
+{
+    solClient_returnCode_t rc;
+    solClient_opaqueSession_pt session_p;
+    common_subEntry_t *entry_p;
+    solClient_uint32_t index;
+    solClient_uint32_t slot;
+    int             subscribed;
+
+    mutexLock ( &registry_p->mutex );
+    index = common_subRegistryFind ( registry_p, topic_p, common_hashString ( topic_p ), &slot );
+    if ( index == registry_p->numEntries || registry_p->entries_p[index].state == COMMON_SUB_REMOVED ) {
+        mutexUnlock ( &registry_p->mutex );
+        return SOLCLIENT_NOT_FOUND;
+    }
+    entry_p = &registry_p->entries_p[index];
+    subscribed = registry_p->live && ( entry_p->state == COMMON_SUB_PENDING || entry_p->state == COMMON_SUB_APPLIED );
+    entry_p->state = COMMON_SUB_REMOVED;
+    registry_p->stats.removes++;
+    session_p = registry_p->session_p;
+    mutexUnlock ( &registry_p->mutex );
+
+    if ( subscribed && ( rc = solClient_session_topicUnsubscribeExt ( session_p, 0, topic_p ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_session_topicUnsubscribeExt()" );
+    }
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_apply
+ *****************************************************************************/
+void
+common_subRegistry_apply ( common_subRegistry_pt registry_p, solClient_opaqueSession_pt session_p )
+{
+    mutexLock ( &registry_p->mutex );
+    registry_p->session_p = session_p;
+    registry_p->live = 1;
+    common_subRegistryStart ( registry_p );
+    mutexUnlock ( &registry_p->mutex );
+    common_subRegistryPump ( registry_p );
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_waitApplied
+ *****************************************************************************/
+solClient_returnCode_t
+common_subRegistry_waitApplied ( common_subRegistry_pt registry_p, unsigned int timeoutMs, UINT64 * allUs_p )
+{
+    UINT64          deadlineUs = getTimeInUs (  ) + ( UINT64 ) timeoutMs * 1000;
+    int             runActive;
+
+    for ( ;; ) {
+        mutexLock ( &registry_p->mutex );
+        runActive = registry_p->runActive;
+        if ( !runActive && allUs_p != NULL ) {
+            *allUs_p = registry_p->runAllUs;
+        }
+        /*
+         * Try flow controlled subscriptions again from here, where a
+         * subscribe can block, in case no CAN_SEND comes for them.
+         */
+        registry_p->blocked = 0;
+        mutexUnlock ( &registry_p->mutex );
+        if ( !runActive ) {
+            return SOLCLIENT_OK;
+        }
+        common_subRegistryPump ( registry_p );
+        if ( getTimeInUs (  ) >= deadlineUs ) {
+            return SOLCLIENT_INCOMPLETE;
+        }
+        sleepInUs ( COMMON_SUB_POLL_US );
+    }
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_eventCallback
+ *****************************************************************************/
+void
+common_subRegistry_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                   solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p )
+{
+    common_subRegistry_pt registry_p = ( common_subRegistry_pt ) user_p;
+    solClient_subCode_t subCode;
+
+    switch ( eventInfo_p->sessionEvent ) {
+        case SOLCLIENT_SESSION_EVENT_SUBSCRIPTION_OK:
+            if ( common_subRegistryConfirm ( registry_p, eventInfo_p->correlation_p, 1 ) ) {
+                common_subRegistryPump ( registry_p );
+                return;
+            }
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_SUBSCRIPTION_ERROR:
+            /* Already subscribed counts as applied. */
+            subCode = solClient_getLastErrorInfo (  )->subCode;
+            if ( common_subRegistryConfirm ( registry_p, eventInfo_p->correlation_p,
+                                             subCode == SOLCLIENT_SUBCODE_SUBSCRIPTION_ALREADY_PRESENT ) ) {
+                if ( subCode != SOLCLIENT_SUBCODE_SUBSCRIPTION_ALREADY_PRESENT ) {
+                    solClient_log ( SOLCLIENT_LOG_WARNING, "Subscription rejected: %s, %s", eventInfo_p->info_p,
+                                    solClient_subCodeToString ( subCode ) );
+                }
+                common_subRegistryPump ( registry_p );
+                return;
+            }
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_CAN_SEND:
+            mutexLock ( &registry_p->mutex );
+            registry_p->blocked = 0;
+            mutexUnlock ( &registry_p->mutex );
+            common_subRegistryPump ( registry_p );
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_RECONNECTING_NOTICE:
+        case SOLCLIENT_SESSION_EVENT_DOWN_ERROR:
+            common_subRegistryReset ( registry_p );
+            break;
+
+        case SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE:
+            mutexLock ( &registry_p->mutex );
+            if ( registry_p->session_p != NULL ) {
+                registry_p->live = 1;
+                registry_p->blocked = 0;
+                common_subRegistryStart ( registry_p );
+            }
+            mutexUnlock ( &registry_p->mutex );
+            common_subRegistryPump ( registry_p );
+            break;
+
+        default:
+            break;
+    }
+    common_eventCallback ( opaqueSession_p, eventInfo_p, NULL );
+}
+
+
+/*****************************************************************************
+ * common_subRegistry_printStats
+ *****************************************************************************/
+void
+common_subRegistry_printStats ( common_subRegistry_pt registry_p )
+{
+    solClient_uint32_t active = 0;
+    solClient_uint32_t applied = 0;
+    solClient_uint32_t i;
+
+    mutexLock ( &registry_p->mutex );
+    for ( i = 0; i < registry_p->numEntries; i++ ) {
+        if ( registry_p->entries_p[i].state != COMMON_SUB_REMOVED ) {
+            active++;
+        }
+        if ( registry_p->entries_p[i].state == COMMON_SUB_APPLIED ) {
+            applied++;
+        }
+    }
+    printf ( "Subscription registry: %u topics (%u applied), %u bytes of topics; %llu adds, %llu removes, "
+             "%llu compactions, %llu refused\n",
+             active, applied, registry_p->arenaUsed, ( unsigned long long ) registry_p->stats.adds,
+             ( unsigned long long ) registry_p->stats.removes, ( unsigned long long ) registry_p->stats.compactions,
+             ( unsigned long long ) registry_p->stats.full );
+    printf ( "Subscriptions: %llu sent, %llu confirmed, %llu failed, %llu put back by flow control, window %u\n",
+             ( unsigned long long ) registry_p->stats.sent, ( unsigned long long ) registry_p->stats.confirmed,
+             ( unsigned long long ) registry_p->stats.failed, ( unsigned long long ) registry_p->stats.wouldBlock,
+             registry_p->window );
+    if ( registry_p->runActive ) {
+        printf ( "Applies: %llu completed; applying %u topics for %.3f ms\n",
+                 ( unsigned long long ) registry_p->stats.runsDone, registry_p->runTopics,
+                 ( getTimeInUs (  ) - registry_p->runStartUs ) / 1000.0 );
+    } else if ( registry_p->stats.runsDone > 0 ) {
+        printf ( "Applies: %llu completed; last %u topics fully subscribed in %.3f ms "
+                 "(%u of priority %u in %.3f ms), longest %.3f ms\n",
+                 ( unsigned long long ) registry_p->stats.runsDone, registry_p->runTopics,
+                 registry_p->runAllUs / 1000.0, registry_p->runTopCount, registry_p->runTopPriority,
+                 registry_p->runTopUs / 1000.0, registry_p->maxAllUs / 1000.0 );
+    }
+    mutexUnlock ( &registry_p->mutex );
+}
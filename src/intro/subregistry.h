@@ -0,0 +1,177 @@
+/** example ex/subregistry.h
+ */
+
+/**
+ *
+ * file subregistry.h Subscription registry for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef SUBREGISTRY_H_
+#define SUBREGISTRY_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor subRegistry
+ * @name Subscription registry
+ * A subscription registry keeps a Session's topic subscriptions on the
+ * client, so that after a reconnect they are applied again faster than the
+ * API does it (::SOLCLIENT_SESSION_PROP_REAPPLY_SUBSCRIPTIONS) and in
+ * priority order. Every add and remove is recorded; each topic is interned
+ * once in a single string arena and found again through a hash index, so a
+ * topic removed and added again costs nothing more. Removed topics are
+ * reclaimed by compacting the arena when the registry is full.
+ *
+ * common_subRegistry_apply() subscribes to every recorded topic, highest
+ * priority first, with up to window confirmed subscriptions
+ * (::SOLCLIENT_SUBSCRIBE_FLAGS_REQUEST_CONFIRM) outstanding. The Session
+ * event callback must be common_subRegistry_eventCallback(), with the
+ * registry as user_p: it sends the next subscriptions as the confirmations
+ * arrive and on ::SOLCLIENT_SESSION_EVENT_CAN_SEND, and applies the registry
+ * again on ::SOLCLIENT_SESSION_EVENT_RECONNECTED_NOTICE, timing how long it
+ * takes to be fully resubscribed. Create the Session with
+ * reapplySubscriptions cleared in the commonOptions so the API does not
+ * reapply them as well.
+ *
+ * The correlation tags of confirmed subscriptions on the Session belong to
+ * the registry.
+ */
+/*@{*/
+
+#define COMMON_SUB_POLL_US           1000       /**< Wait between checks in common_subRegistry_waitApplied(). */
+
+typedef enum common_subState
+{
+    COMMON_SUB_REMOVED = 0,
+    COMMON_SUB_IDLE,                /**< Recorded, not subscribed on this connection. */
+    COMMON_SUB_QUEUED,
+    COMMON_SUB_PENDING,             /**< Subscribed, waiting for the confirmation. */
+    COMMON_SUB_APPLIED,
+    COMMON_SUB_FAILED
+} common_subState_t;
+
+typedef struct common_subEntry
+{
+    solClient_uint32_t topic;       /**< Offset of the topic in the arena. */
+    solClient_uint64_t hash;
+    unsigned int    priority;       /**< Higher is applied first. */
+    common_subState_t state;
+    unsigned char   inQueue;
+    unsigned char   inFlight;       /**< A confirmation is due. */
+} common_subEntry_t;
+
+typedef struct common_subRegistryStats
+{
+    solClient_uint64_t adds;
+    solClient_uint64_t removes;
+    solClient_uint64_t sent;
+    solClient_uint64_t confirmed;
+    solClient_uint64_t failed;
+    solClient_uint64_t wouldBlock;  /**< Subscriptions put back by flow control. */
+    solClient_uint64_t full;        /**< Adds refused for lack of room. */
+    solClient_uint64_t compactions;
+    solClient_uint64_t runs;        /**< Applies started. */
+    solClient_uint64_t runsDone;    /**< Applies that completed. */
+} common_subRegistryStats_t;
+
+typedef struct common_subRegistry
+{
+    MUTEX_T         mutex;
+    solClient_opaqueSession_pt session_p;
+    common_subEntry_t *entries_p;
+    solClient_uint32_t numEntries;
+    solClient_uint32_t maxTopics;
+    common_hashIndex_t index;       /**< Entries by topic. */
+    char           *arena_p;        /**< The topics, NUL terminated. */
+    solClient_uint32_t arenaUsed;
+    solClient_uint32_t arenaSize;
+    common_indexRing_t queue;       /**< Entries to subscribe. */
+    solClient_uint64_t *keys_p;     /**< Scratch to sort by priority. */
+    solClient_uint32_t outstanding;
+    solClient_uint32_t sending;     /**< Subscribes in progress without the lock. */
+    unsigned int    window;
+    int             live;           /**< The Session is up and applied. */
+    int             blocked;        /**< Waiting for CAN_SEND. */
+    /* The current or last apply. */
+    int             runActive;
+    UINT64          runStartUs;
+    solClient_uint32_t runTopics;
+    unsigned int    runTopPriority;
+    solClient_uint32_t runTopCount;
+    solClient_uint32_t runTopRemaining;
+    UINT64          runTopUs;       /**< Until every topic of the top priority was confirmed. */
+    UINT64          runAllUs;       /**< Until every topic was confirmed. */
+    UINT64          maxAllUs;
+    common_subRegistryStats_t stats;
+} common_subRegistry_t, *common_subRegistry_pt;
+
+/**
+ * Initialize a subscription registry for up to maxTopics topics.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the registry cannot be allocated.
+ */
+solClient_returnCode_t
+    common_subRegistry_init ( common_subRegistry_pt registry_p, unsigned int maxTopics, unsigned int window );
+
+/**
+ * Release a subscription registry. Its Session must be destroyed first.
+ */
+void
+    common_subRegistry_destroy ( common_subRegistry_pt registry_p );
+
+/**
+ * Record a subscription, or change the priority of a recorded one. Once the
+ * registry is applied, the topic is also subscribed to.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the topic is too long or the
+ * registry is full.
+ */
+solClient_returnCode_t
+    common_subRegistry_add ( common_subRegistry_pt registry_p, const char *topic_p, unsigned int priority );
+
+/**
+ * Record the removal of a subscription and, if it was subscribed to,
+ * unsubscribe. May block on flow control unless called from the Context
+ * thread.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_NOT_FOUND if the topic is not recorded.
+ */
+solClient_returnCode_t
+    common_subRegistry_remove ( common_subRegistry_pt registry_p, const char *topic_p );
+
+/**
+ * Subscribe to every recorded topic on a connected Session, highest
+ * priority first; this is done again on every reconnect.
+ */
+void
+    common_subRegistry_apply ( common_subRegistry_pt registry_p, solClient_opaqueSession_pt session_p );
+
+/**
+ * Wait until the current apply completes. Must not be called from the
+ * Context thread.
+ * @param allUs_p   If not NULL, set to the time the apply took when it
+ *                  completed.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_INCOMPLETE if it did not complete
+ * within timeoutMs.
+ */
+solClient_returnCode_t
+    common_subRegistry_waitApplied ( common_subRegistry_pt registry_p, unsigned int timeoutMs, UINT64 * allUs_p );
+
+/**
+ * The Session event callback of a registry, given as user_p. Events are
+ * then passed to common_eventCallback(), except the confirmations of the
+ * registry's subscriptions.
+ */
+void
+    common_subRegistry_eventCallback ( solClient_opaqueSession_pt opaqueSession_p,
+                                       solClient_session_eventCallbackInfo_pt eventInfo_p, void *user_p );
+
+/**
+ * Print the counts and the times of the last apply.
+ */
+void
+    common_subRegistry_printStats ( common_subRegistry_pt registry_p );
+
+/*@}*/
+
+#endif /* SUBREGISTRY_H_ */
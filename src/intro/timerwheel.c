@@ -0,0 +1,366 @@
+/** example ex/timerwheel.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Hierarchical timer wheel used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "timerwheel.h"
+
+
+/*
+ * Timer wheel nodes: the list head of level l, slot i is node
+ * l * COMMON_TIMER_SLOTS + i, followed by the head of the expiring list and
+ * then the timers. Lists are circular, so unlinking never needs the head.
+ */
+#define COMMON_TIMER_EXPIRING        ( COMMON_TIMER_LEVELS * COMMON_TIMER_SLOTS )
+#define COMMON_TIMER_FIRST           ( COMMON_TIMER_EXPIRING + 1 )
+#define COMMON_TIMER_SLOT_MASK       ( COMMON_TIMER_SLOTS - 1 )
+
+/*****************************************************************************
+ * common_timerLink
+ *
+ * Append node n to the list headed by head.
+ *****************************************************************************/
+static void
+common_timerLink ( common_timerNode_t * nodes_p, solClient_uint32_t head, solClient_uint32_t n )
+{
+    solClient_uint32_t tail = nodes_p[head].prev;
+
+    nodes_p[n].prev = tail;
+    nodes_p[n].next = head;
+    nodes_p[tail].next = n;
+    nodes_p[head].prev = n;
+}
+
+
+/*****************************************************************************
+ * common_timerUnlink
+ *****************************************************************************/
+static void
+common_timerUnlink ( common_timerNode_t * nodes_p, solClient_uint32_t n )
+{
+    nodes_p[nodes_p[n].prev].next = nodes_p[n].next;
+    nodes_p[nodes_p[n].next].prev = nodes_p[n].prev;
+    nodes_p[n].prev = COMMON_TIMER_NONE;
+}
+
+
+/*****************************************************************************
+ * common_timerAdd
+ *
+ * Put a timer in the slot for its expiry tick: the lowest level whose span
+ * from now covers it.
+ *****************************************************************************/
+static void
+common_timerAdd ( common_timerWheel_pt wheel_p, solClient_uint32_t n )
+{
+    solClient_uint32_t expires = wheel_p->nodes_p[n].expires;
+    solClient_uint32_t delta = expires - wheel_p->now;
+    solClient_uint32_t head;
+
+    if ( ( solClient_int32_t ) delta < 0 ) {
+        /* Already due: the slot processed next. */
+        head = wheel_p->now & COMMON_TIMER_SLOT_MASK;
+    } else if ( delta < ( 1u << COMMON_TIMER_SLOT_BITS ) ) {
+        head = expires & COMMON_TIMER_SLOT_MASK;
+    } else if ( delta < ( 1u << ( 2 * COMMON_TIMER_SLOT_BITS ) ) ) {
+        head = COMMON_TIMER_SLOTS + ( ( expires >> COMMON_TIMER_SLOT_BITS ) & COMMON_TIMER_SLOT_MASK );
+    } else if ( delta < ( 1u << ( 3 * COMMON_TIMER_SLOT_BITS ) ) ) {
+        head = 2 * COMMON_TIMER_SLOTS + ( ( expires >> ( 2 * COMMON_TIMER_SLOT_BITS ) ) & COMMON_TIMER_SLOT_MASK );
+    } else {
+        head = 3 * COMMON_TIMER_SLOTS + ( ( expires >> ( 3 * COMMON_TIMER_SLOT_BITS ) ) & COMMON_TIMER_SLOT_MASK );
+    }
+    common_timerLink ( wheel_p->nodes_p, head, n );
+}
+
+
+/*****************************************************************************
+ * common_timerCascade
+ *
+ * Move the timers of one slot of a higher level down to the levels below,
+ * and return the slot index.
+ *****************************************************************************/
+static solClient_uint32_t
+common_timerCascade ( common_timerWheel_pt wheel_p, int level, solClient_uint32_t index )
+{
+    common_timerNode_t *nodes_p = wheel_p->nodes_p;
+    solClient_uint32_t head = level * COMMON_TIMER_SLOTS + index;
+    solClient_uint32_t n;
+
+    /* Each timer lands in a lower level, never back in this slot. */
+    while ( ( n = nodes_p[head].next ) != head ) {
+        common_timerUnlink ( nodes_p, n );
+        common_timerAdd ( wheel_p, n );
+        wheel_p->stats.cascaded++;
+    }
+    return index;
+}
+
+
+/*****************************************************************************
+ * common_timerFree
+ *****************************************************************************/
+static void
+common_timerFree ( common_timerWheel_pt wheel_p, solClient_uint32_t n )
+{
+    common_timerNode_t *node_p = &wheel_p->nodes_p[n];
+
+    node_p->generation++;
+    if ( node_p->generation == 0 ) {
+        /* Keep IDs distinct from COMMON_TIMER_ID_INVALID. */
+        node_p->generation = 1;
+    }
+    node_p->next = wheel_p->freeList;
+    wheel_p->freeList = n;
+    wheel_p->numActive--;
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_timerWheel_init ( common_timerWheel_pt wheel_p, unsigned int maxTimers, unsigned int tickMs )
+{
+    solClient_uint32_t n;
+
+    memset ( wheel_p, 0, sizeof ( *wheel_p ) );
+    wheel_p->numNodes = COMMON_TIMER_FIRST + maxTimers;
+    if ( ( wheel_p->nodes_p = ( common_timerNode_t * ) malloc ( wheel_p->numNodes * sizeof ( common_timerNode_t ) ) ) == NULL ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a timer wheel for %u timers", maxTimers );
+        return SOLCLIENT_FAIL;
+    }
+    for ( n = 0; n < COMMON_TIMER_FIRST; n++ ) {
+        wheel_p->nodes_p[n].next = n;
+        wheel_p->nodes_p[n].prev = n;
+    }
+    wheel_p->freeList = COMMON_TIMER_NONE;
+    for ( n = wheel_p->numNodes; n-- > COMMON_TIMER_FIRST; ) {
+        wheel_p->nodes_p[n].prev = COMMON_TIMER_NONE;
+        wheel_p->nodes_p[n].generation = 1;
+        wheel_p->nodes_p[n].next = wheel_p->freeList;
+        wheel_p->freeList = n;
+    }
+    wheel_p->tickMs = tickMs > 0 ? tickMs : 1;
+    wheel_p->startUs = getTimeInUs (  );
+    wheel_p->contextTimerId = SOLCLIENT_CONTEXT_TIMER_ID_INVALID;
+    mutexInit ( &wheel_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_destroy
+ *****************************************************************************/
+void
+common_timerWheel_destroy ( common_timerWheel_pt wheel_p )
+{
+    free ( wheel_p->nodes_p );
+    wheel_p->nodes_p = NULL;
+    mutexDestroy ( &wheel_p->mutex );
+}
+
+
+/*****************************************************************************
+ * common_timerWheelContextTick
+ *****************************************************************************/
+static void
+common_timerWheelContextTick ( solClient_opaqueContext_pt opaqueContext_p, void *user_p )
+{
+    common_timerWheel_advanceToNow ( ( common_timerWheel_pt ) user_p );
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_start
+ *****************************************************************************/
+solClient_returnCode_t
+common_timerWheel_start ( common_timerWheel_pt wheel_p, solClient_opaqueContext_pt context_p )
+{
+    solClient_returnCode_t rc;
+
+    wheel_p->context_p = context_p;
+    if ( ( rc = solClient_context_startTimer ( context_p, SOLCLIENT_CONTEXT_TIMER_REPEAT, wheel_p->tickMs,
+                                               common_timerWheelContextTick, wheel_p,
+                                               &wheel_p->contextTimerId ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_startTimer()" );
+    }
+    return rc;
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_stop
+ *****************************************************************************/
+void
+common_timerWheel_stop ( common_timerWheel_pt wheel_p )
+{
+    solClient_returnCode_t rc;
+
+    if ( wheel_p->contextTimerId != SOLCLIENT_CONTEXT_TIMER_ID_INVALID &&
+         ( rc = solClient_context_stopTimer ( wheel_p->context_p, &wheel_p->contextTimerId ) ) != SOLCLIENT_OK ) {
+        common_handleError ( rc, "solClient_context_stopTimer()" );
+    }
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_schedule
+ *****************************************************************************/
+solClient_returnCode_t
+common_timerWheel_schedule ( common_timerWheel_pt wheel_p, unsigned int delayMs, unsigned int periodMs,
+                             common_timerCallback_t callback_p, void *user_p, common_timerId_t * timerId_p )
+{
+    common_timerNode_t *node_p;
+    solClient_uint32_t n;
+    UINT64          tickUs = ( UINT64 ) wheel_p->tickMs * 1000;
+    UINT64          dueUs = getTimeInUs (  ) - wheel_p->startUs + ( UINT64 ) delayMs * 1000;
+
+    mutexLock ( &wheel_p->mutex );
+    if ( ( n = wheel_p->freeList ) == COMMON_TIMER_NONE ) {
+        wheel_p->stats.full++;
+        mutexUnlock ( &wheel_p->mutex );
+        return SOLCLIENT_FAIL;
+    }
+    node_p = &wheel_p->nodes_p[n];
+    wheel_p->freeList = node_p->next;
+    wheel_p->numActive++;
+    wheel_p->stats.scheduled++;
+    /* Round up, so the timer never fires early. */
+    if ( wheel_p->contextTimerId != SOLCLIENT_CONTEXT_TIMER_ID_INVALID ) {
+        /* From the clock, as the wheel may be behind it. */
+        node_p->expires = ( solClient_uint32_t ) ( ( dueUs + tickUs - 1 ) / tickUs );
+        if ( ( solClient_int32_t ) ( node_p->expires - wheel_p->now ) < 0 ) {
+            node_p->expires = wheel_p->now;
+        }
+    } else {
+        node_p->expires = wheel_p->now + ( delayMs + wheel_p->tickMs - 1 ) / wheel_p->tickMs;
+    }
+    node_p->periodTicks = periodMs > 0 ? ( periodMs + wheel_p->tickMs - 1 ) / wheel_p->tickMs : 0;
+    node_p->callback_p = callback_p;
+    node_p->user_p = user_p;
+    common_timerAdd ( wheel_p, n );
+    *timerId_p = ( ( common_timerId_t ) node_p->generation << 32 ) | n;
+    mutexUnlock ( &wheel_p->mutex );
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_cancel
+ *****************************************************************************/
+solClient_returnCode_t
+common_timerWheel_cancel ( common_timerWheel_pt wheel_p, common_timerId_t timerId )
+{
+    solClient_uint32_t n = ( solClient_uint32_t ) timerId;
+    solClient_returnCode_t rc = SOLCLIENT_NOT_FOUND;
+
+    mutexLock ( &wheel_p->mutex );
+    if ( n >= COMMON_TIMER_FIRST && n < wheel_p->numNodes &&
+         wheel_p->nodes_p[n].generation == ( solClient_uint32_t ) ( timerId >> 32 ) &&
+         wheel_p->nodes_p[n].prev != COMMON_TIMER_NONE ) {
+        common_timerUnlink ( wheel_p->nodes_p, n );
+        common_timerFree ( wheel_p, n );
+        wheel_p->stats.cancelled++;
+        rc = SOLCLIENT_OK;
+    }
+    mutexUnlock ( &wheel_p->mutex );
+    return rc;
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_advance
+ *****************************************************************************/
+solClient_uint64_t
+common_timerWheel_advance ( common_timerWheel_pt wheel_p, solClient_uint32_t numTicks )
+{
+    common_timerNode_t *nodes_p = wheel_p->nodes_p;
+    common_timerNode_t *node_p;
+    common_timerCallback_t callback_p;
+    void           *user_p;
+    common_timerId_t timerId;
+    solClient_uint32_t index;
+    solClient_uint32_t n;
+    solClient_uint64_t numFired = 0;
+
+    mutexLock ( &wheel_p->mutex );
+    while ( numTicks-- > 0 ) {
+        index = wheel_p->now & COMMON_TIMER_SLOT_MASK;
+        if ( index == 0 &&
+             common_timerCascade ( wheel_p, 1, ( wheel_p->now >> COMMON_TIMER_SLOT_BITS ) & COMMON_TIMER_SLOT_MASK ) == 0 &&
+             common_timerCascade ( wheel_p, 2, ( wheel_p->now >> ( 2 * COMMON_TIMER_SLOT_BITS ) ) & COMMON_TIMER_SLOT_MASK ) == 0 ) {
+            common_timerCascade ( wheel_p, 3, ( wheel_p->now >> ( 3 * COMMON_TIMER_SLOT_BITS ) ) & COMMON_TIMER_SLOT_MASK );
+        }
+        /*
+         * Move the due timers to the expiring list, so callbacks can cancel
+         * any of them, and schedule into this slot, while the rest fire.
+         */
+        if ( nodes_p[index].next != index ) {
+            nodes_p[COMMON_TIMER_EXPIRING].next = nodes_p[index].next;
+            nodes_p[COMMON_TIMER_EXPIRING].prev = nodes_p[index].prev;
+            nodes_p[nodes_p[index].next].prev = COMMON_TIMER_EXPIRING;
+            nodes_p[nodes_p[index].prev].next = COMMON_TIMER_EXPIRING;
+            nodes_p[index].next = index;
+            nodes_p[index].prev = index;
+        }
+        wheel_p->now++;
+
+        while ( ( n = nodes_p[COMMON_TIMER_EXPIRING].next ) != COMMON_TIMER_EXPIRING ) {
+            node_p = &nodes_p[n];
+            common_timerUnlink ( nodes_p, n );
+            callback_p = node_p->callback_p;
+            user_p = node_p->user_p;
+            timerId = ( ( common_timerId_t ) node_p->generation << 32 ) | n;
+            if ( node_p->periodTicks > 0 ) {
+                /* From the tick it was due, so periodic timers do not drift. */
+                node_p->expires += node_p->periodTicks;
+                common_timerAdd ( wheel_p, n );
+            } else {
+                common_timerFree ( wheel_p, n );
+            }
+            wheel_p->stats.fired++;
+            numFired++;
+            mutexUnlock ( &wheel_p->mutex );
+            callback_p ( timerId, user_p );
+            mutexLock ( &wheel_p->mutex );
+        }
+    }
+    mutexUnlock ( &wheel_p->mutex );
+    return numFired;
+}
+
+
+/*****************************************************************************
+ * common_timerWheel_advanceToNow
+ *****************************************************************************/
+solClient_uint64_t
+common_timerWheel_advanceToNow ( common_timerWheel_pt wheel_p )
+{
+    solClient_uint32_t target;
+    solClient_uint32_t now;
+
+    /* Tick t is processed once t whole ticks have elapsed. */
+    target = ( solClient_uint32_t ) ( ( getTimeInUs (  ) - wheel_p->startUs ) / ( ( UINT64 ) wheel_p->tickMs * 1000 ) );
+    mutexLock ( &wheel_p->mutex );
+    now = wheel_p->now;
+    mutexUnlock ( &wheel_p->mutex );
+    if ( ( solClient_int32_t ) ( target - now ) < 0 ) {
+        return 0;
+    }
+    return common_timerWheel_advance ( wheel_p, target - now + 1 );
+}
@@ -0,0 +1,157 @@
+/** example ex/timerwheel.h
+ */
+
+/**
+ *
+ * file timerwheel.h Hierarchical timer wheel for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor timerWheel
+ * @name Timer wheel
+ * A hierarchical timer wheel for large numbers of timeouts and periodic
+ * tasks, driven by a single repeating Context timer
+ * (solClient_context_startTimer()).
+ *
+ * Time is counted in ticks of tickMs. The wheel has COMMON_TIMER_LEVELS
+ * levels of COMMON_TIMER_SLOTS slots: level 0 has one slot per tick for the
+ * next 256 ticks, and each higher level covers 256 times the span of the
+ * one below. Timers are kept in doubly linked lists threaded through a node
+ * array allocated when the wheel is initialized, so scheduling and
+ * cancelling are O(1) and never allocate. Each time level 0 wraps, the next
+ * slot of level 1 is redistributed into level 0, and so on up the levels.
+ *
+ * Once started, the wheel advances to the current time on every Context
+ * timer tick, so late ticks do not accumulate into drift. Create the Context
+ * with ::SOLCLIENT_CONTEXT_PROP_TIME_RES_MS equal to tickMs (10 ms or
+ * more); with a coarser Context resolution, timers fire up to one Context
+ * tick late.
+ *
+ * Timers may be scheduled and cancelled from any thread. Callbacks run on
+ * the thread that advances the wheel (the Context thread once started),
+ * without the wheel's lock held, and may schedule and cancel timers,
+ * including their own.
+ */
+/*@{*/
+
+#define COMMON_TIMER_LEVELS          4
+#define COMMON_TIMER_SLOT_BITS       8
+#define COMMON_TIMER_SLOTS           ( 1 << COMMON_TIMER_SLOT_BITS )
+#define COMMON_TIMER_ID_INVALID      0          /**< Never returned by common_timerWheel_schedule(). */
+#define COMMON_TIMER_NONE            0xFFFFFFFFu /**< No node. */
+
+/** A timer: its generation in the high 32 bits and node index in the low 32 bits. */
+typedef solClient_uint64_t common_timerId_t;
+
+/** Called when a timer fires; timerId is the ID returned when it was scheduled. */
+typedef void    ( *common_timerCallback_t ) ( common_timerId_t timerId, void *user_p );
+
+typedef struct common_timerNode
+{
+    solClient_uint32_t next;
+    solClient_uint32_t prev;        /**< COMMON_TIMER_NONE when the node is not scheduled. */
+    solClient_uint32_t expires;     /**< Tick at which the timer fires. */
+    solClient_uint32_t periodTicks; /**< 0 for a one-shot timer. */
+    solClient_uint32_t generation;  /**< Bumped each time the node is freed, so stale IDs are rejected. */
+    common_timerCallback_t callback_p;
+    void           *user_p;
+} common_timerNode_t;
+
+typedef struct common_timerWheelStats
+{
+    solClient_uint64_t scheduled;
+    solClient_uint64_t cancelled;
+    solClient_uint64_t fired;
+    solClient_uint64_t cascaded;    /**< Timers moved down a level. */
+    solClient_uint64_t full;        /**< Schedules refused because every node was in use. */
+} common_timerWheelStats_t;
+
+typedef struct common_timerWheel
+{
+    MUTEX_T         mutex;
+    common_timerNode_t *nodes_p;    /**< A list head per slot and one for expiring timers, then the timers. */
+    solClient_uint32_t numNodes;
+    solClient_uint32_t freeList;
+    solClient_uint32_t numActive;
+    solClient_uint32_t now;         /**< The next tick to process. */
+    unsigned int    tickMs;
+    UINT64          startUs;
+    solClient_opaqueContext_pt context_p;
+    solClient_context_timerId_t contextTimerId;
+    common_timerWheelStats_t stats;
+} common_timerWheel_t, *common_timerWheel_pt;
+
+/**
+ * Initialize a timer wheel for up to maxTimers concurrent timers, with a
+ * tick of tickMs. The wheel's clock starts now.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the nodes cannot be allocated.
+ */
+solClient_returnCode_t
+    common_timerWheel_init ( common_timerWheel_pt wheel_p, unsigned int maxTimers, unsigned int tickMs );
+
+/**
+ * Release a timer wheel. The wheel must be stopped. Pending timers are
+ * dropped without being called.
+ */
+void
+    common_timerWheel_destroy ( common_timerWheel_pt wheel_p );
+
+/**
+ * Drive the wheel from a repeating Context timer of tickMs.
+ * @return The result of solClient_context_startTimer().
+ */
+solClient_returnCode_t
+    common_timerWheel_start ( common_timerWheel_pt wheel_p, solClient_opaqueContext_pt context_p );
+
+/**
+ * Stop the Context timer driving the wheel.
+ */
+void
+    common_timerWheel_stop ( common_timerWheel_pt wheel_p );
+
+/**
+ * Schedule a timer to fire after at least delayMs, and at most one tick
+ * later (plus the latency of the Context timer). Until the wheel is started,
+ * delayMs is counted in ticks from the last tick processed instead. When
+ * periodMs is not 0, the timer then fires every periodMs (rounded up to
+ * whole ticks) until it is cancelled.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if maxTimers timers are already scheduled.
+ */
+solClient_returnCode_t
+    common_timerWheel_schedule ( common_timerWheel_pt wheel_p, unsigned int delayMs, unsigned int periodMs,
+                                 common_timerCallback_t callback_p, void *user_p, common_timerId_t * timerId_p );
+
+/**
+ * Cancel a timer.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_NOT_FOUND if the timer already fired
+ * (one-shot), is firing, or was cancelled.
+ */
+solClient_returnCode_t
+    common_timerWheel_cancel ( common_timerWheel_pt wheel_p, common_timerId_t timerId );
+
+/**
+ * Process numTicks ticks, calling the timers that fire, regardless of the
+ * clock. For driving a wheel that is not started.
+ * @return The number of timers fired.
+ */
+solClient_uint64_t
+    common_timerWheel_advance ( common_timerWheel_pt wheel_p, solClient_uint32_t numTicks );
+
+/**
+ * Process every tick up to the current time.
+ * @return The number of timers fired.
+ */
+solClient_uint64_t
+    common_timerWheel_advanceToNow ( common_timerWheel_pt wheel_p );
+
+/*@}*/
+
+#endif /* TIMERWHEEL_H_ */
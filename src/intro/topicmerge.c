@@ -0,0 +1,147 @@
+/** example ex/topicmerge.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Cache and live message merging used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "topicmerge.h"
+
+
+/*****************************************************************************
+ * common_topicMerge_init
+ *****************************************************************************/
+solClient_returnCode_t
+common_topicMerge_init ( common_topicMerge_pt merge_p, unsigned int maxTopics )
+{
+    memset ( merge_p, 0, sizeof ( *merge_p ) );
+    merge_p->topics_p = ( common_topicSeq_t * ) calloc ( maxTopics > 0 ? maxTopics : 1, sizeof ( common_topicSeq_t ) );
+    if ( merge_p->topics_p == NULL || common_hashIndex_init ( &merge_p->index, maxTopics ) != SOLCLIENT_OK ) {
+        solClient_log ( SOLCLIENT_LOG_ERROR, "Could not allocate a topic merge for %u topics", maxTopics );
+        free ( merge_p->topics_p );
+        merge_p->topics_p = NULL;
+        return SOLCLIENT_FAIL;
+    }
+    merge_p->maxTopics = maxTopics;
+    return SOLCLIENT_OK;
+}
+
+
+/*****************************************************************************
+ * common_topicMerge_destroy
+ *****************************************************************************/
+void
+common_topicMerge_destroy ( common_topicMerge_pt merge_p )
+{
+    free ( merge_p->topics_p );
+    merge_p->topics_p = NULL;
+    common_hashIndex_destroy ( &merge_p->index );
+}
+
+
+/*****************************************************************************
+ * common_topicMergeMatch
+ *****************************************************************************/
+static int
+common_topicMergeMatch ( void *user_p, solClient_uint32_t entry, solClient_uint64_t hash, const char *topic_p )
+{
+    return ( ( common_topicMerge_pt ) user_p )->topics_p[entry].hash == hash;
+}
+
+
+/*****************************************************************************
+ * common_topicMergeFind
+ *
+ * Find a topic by the hash of its name, adding it if there is room. Two
+ * topics with the same 64-bit hash share a sequence number, which is
+ * unlikely enough to ignore.
+ *****************************************************************************/
+static common_topicSeq_t *
+common_topicMergeFind ( common_topicMerge_pt merge_p, const char *topic_p )
+{
+    common_topicSeq_t *topicSeq_p;
+    solClient_uint64_t hash = common_hashString ( topic_p );
+    solClient_uint32_t entry;
+    solClient_uint32_t slot;
+
+    if ( ( entry = common_hashIndex_find ( &merge_p->index, hash, topic_p, common_topicMergeMatch,
+                                           merge_p, &slot ) ) != COMMON_HASH_NOT_FOUND ) {
+        return &merge_p->topics_p[entry];
+    }
+    if ( merge_p->numTopics >= merge_p->maxTopics ) {
+        return NULL;
+    }
+    topicSeq_p = &merge_p->topics_p[merge_p->numTopics];
+    topicSeq_p->hash = hash;
+    topicSeq_p->highSeq = -1;
+    common_hashIndex_set ( &merge_p->index, slot, merge_p->numTopics++ );
+    return topicSeq_p;
+}
+
+
+/*****************************************************************************
+ * common_topicMerge_accept
+ *****************************************************************************/
+int
+common_topicMerge_accept ( common_topicMerge_pt merge_p, solClient_opaqueMsg_pt msg_p )
+{
+    solClient_destination_t destination;
+    common_topicSeq_t *topicSeq_p;
+    solClient_int64_t seq;
+    int             isCacheMsg;
+
+    isCacheMsg = solClient_msg_isCacheMsg ( msg_p ) != SOLCLIENT_CACHE_LIVE_MESSAGE;
+    if ( solClient_msg_getTopicSequenceNumber ( msg_p, &seq ) != SOLCLIENT_OK ||
+         solClient_msg_getDestination ( msg_p, &destination, sizeof ( destination ) ) != SOLCLIENT_OK ||
+         destination.destType != SOLCLIENT_TOPIC_DESTINATION ) {
+        merge_p->stats.unsequenced++;
+    } else if ( ( topicSeq_p = common_topicMergeFind ( merge_p, destination.dest ) ) == NULL ) {
+        merge_p->stats.untracked++;
+    } else if ( !isCacheMsg && seq < topicSeq_p->highSeq - COMMON_TOPIC_MERGE_WINDOW ) {
+        /* Far behind the live data: the publisher restarted. */
+        merge_p->stats.resets++;
+        topicSeq_p->highSeq = seq;
+    } else if ( seq <= topicSeq_p->highSeq ) {
+        if ( isCacheMsg ) {
+            merge_p->stats.staleCached++;
+        } else {
+            merge_p->stats.duplicateLive++;
+        }
+        return 0;
+    } else {
+        topicSeq_p->highSeq = seq;
+    }
+    merge_p->stats.accepted++;
+    if ( isCacheMsg ) {
+        merge_p->stats.acceptedCached++;
+    }
+    return 1;
+}
+
+
+/*****************************************************************************
+ * common_topicMerge_printStats
+ *****************************************************************************/
+void
+common_topicMerge_printStats ( common_topicMerge_pt merge_p )
+{
+    printf ( "Topic merge: %u topics, %llu accepted (%llu cached, %llu without a topic sequence number, "
+             "%llu untracked), dropped %llu stale cached and %llu duplicate live, %llu resets\n",
+             merge_p->numTopics, ( unsigned long long ) merge_p->stats.accepted,
+             ( unsigned long long ) merge_p->stats.acceptedCached, ( unsigned long long ) merge_p->stats.unsequenced,
+             ( unsigned long long ) merge_p->stats.untracked, ( unsigned long long ) merge_p->stats.staleCached,
+             ( unsigned long long ) merge_p->stats.duplicateLive, ( unsigned long long ) merge_p->stats.resets );
+}
@@ -0,0 +1,100 @@
+/** example ex/topicmerge.h
+ */
+
+/**
+ *
+ * file topicmerge.h Cache and live message merging for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef TOPICMERGE_H_
+#define TOPICMERGE_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor topicMerge
+ * @name Cache and live merge
+ * A topic merge drops the messages a subscriber that is both subscribed
+ * live and requesting cached data would otherwise process twice: a cached
+ * copy of an update already received live, a cached update older than the
+ * live data, or the same live update delivered again. Messages are
+ * compared by their topic sequence number
+ * (solClient_msg_getTopicSequenceNumber()); messages without one are
+ * always accepted.
+ *
+ * A publisher that restarts starts its topic sequence numbers over, so a
+ * live message more than COMMON_TOPIC_MERGE_WINDOW older than the highest
+ * one accepted is taken as a new run: it is accepted and becomes the
+ * highest, and is counted as a reset. A restart within the window of the
+ * old run looks like duplicates. Cached messages never reset a topic.
+ *
+ * Per topic, only a 64-bit hash of the topic and the highest sequence
+ * number accepted are kept, in an array with a hash index (see
+ * @ref hashIndex) sized for maxTopics when the merge is initialized. Topics
+ * are never removed.
+ *
+ * A topic merge must only be used from one thread at a time, typically the
+ * receive callback.
+ */
+/*@{*/
+
+#define COMMON_TOPIC_MERGE_WINDOW    1024       /**< Live messages older than the highest by more than this reset the topic. */
+
+typedef struct common_topicSeq
+{
+    solClient_uint64_t hash;        /**< Of the topic. */
+    solClient_int64_t highSeq;      /**< Highest topic sequence number accepted. */
+} common_topicSeq_t;
+
+typedef struct common_topicMergeStats
+{
+    solClient_uint64_t accepted;
+    solClient_uint64_t acceptedCached;  /**< Accepted messages that came from a cache. */
+    solClient_uint64_t staleCached;     /**< Cached messages dropped: not newer than the live data. */
+    solClient_uint64_t duplicateLive;   /**< Live messages dropped: not newer than a message already accepted. */
+    solClient_uint64_t resets;          /**< Live messages accepted as the start of a new run of the publisher. */
+    solClient_uint64_t unsequenced;     /**< Accepted without a topic sequence number. */
+    solClient_uint64_t untracked;       /**< Accepted because the topic array is full. */
+} common_topicMergeStats_t;
+
+typedef struct common_topicMerge
+{
+    common_topicSeq_t *topics_p;
+    common_hashIndex_t index;       /**< Topics by hash. */
+    unsigned int    maxTopics;
+    unsigned int    numTopics;
+    common_topicMergeStats_t stats;
+} common_topicMerge_t, *common_topicMerge_pt;
+
+/**
+ * Initialize a topic merge for up to maxTopics topics.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL if the array cannot be allocated.
+ */
+solClient_returnCode_t
+    common_topicMerge_init ( common_topicMerge_pt merge_p, unsigned int maxTopics );
+
+/**
+ * Release the topic array of a topic merge.
+ */
+void
+    common_topicMerge_destroy ( common_topicMerge_pt merge_p );
+
+/**
+ * Decide whether to process a received message.
+ * @return 1 to process the message, 0 if it is a stale or duplicate update.
+ */
+int
+    common_topicMerge_accept ( common_topicMerge_pt merge_p, solClient_opaqueMsg_pt msg_p );
+
+/**
+ * Print the accepted and dropped message counts.
+ */
+void
+    common_topicMerge_printStats ( common_topicMerge_pt merge_p );
+
+/*@}*/
+
+#endif /* TOPICMERGE_H_ */
@@ -0,0 +1,329 @@
+/** example ex/zip.c
+ */
+
+/**
+ * Example file for the Solace Messaging API for C.
+ *
+ * Adaptive compression used by sample code.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ *
+ */
+
+/**************************************************************************
+    For Windows builds, os.h should always be included first to ensure that
+    _WIN32_WINNT is defined before winsock2.h or windows.h get included.
+ **************************************************************************/
+#include "os.h"
+#include "solclient/solClient.h"
+#include "solclient/solClientMsg.h"
+#include "common.h"
+#include "pool.h"
+#include "zip.h"
+
+
+/*****************************************************************************
+ * Adaptive compression
+ *
+ * The per-level DEFLATE rates are rough single-core figures for text-like
+ * payloads; the compression ratio model assumes level 1 achieves about 15%
+ * less reduction than level 9 on the same data.
+ *****************************************************************************/
+#define COMMON_ZIP_PROBE_MSG_SIZE    ( 16 * 1024 )
+#define COMMON_ZIP_PROBE_MSGS        32
+
+static const double common_zipLevelBytesPerSec[10] = {
+    0.0, 90.0e6, 80.0e6, 70.0e6, 55.0e6, 40.0e6, 30.0e6, 22.0e6, 15.0e6, 10.0e6
+};
+
+/*
+ * n * log2(n) for the histogram counts of a COMMON_ZIP_SAMPLE_BYTES sample,
+ * filled in on first use. Threads that race to fill it write the same
+ * values, and the table is only read once it is marked ready.
+ */
+static double   common_zipNLog2N[COMMON_ZIP_SAMPLE_BYTES + 1];
+static volatile int common_zipNLog2NReady = 0;
+
+/*
+ * log2(x) for x >= 1 without libm: the integer part by halving, the
+ * fractional part bit by bit by squaring the mantissa.
+ */
+static double
+common_zipLog2 ( double x )
+{
+    double          result = 0.0;
+    double          bit = 0.5;
+    int             i;
+
+    while ( x >= 2.0 ) {
+        x /= 2.0;
+        result += 1.0;
+    }
+    for ( i = 0; i < 24; i++ ) {
+        x *= x;
+        if ( x >= 2.0 ) {
+            x /= 2.0;
+            result += bit;
+        }
+        bit /= 2.0;
+    }
+    return result;
+}
+
+static void
+common_zipInitialize ( void )
+{
+    int             i;
+
+    for ( i = 1; i <= COMMON_ZIP_SAMPLE_BYTES; i++ ) {
+        common_zipNLog2N[i] = ( double ) i * common_zipLog2 ( ( double ) i );
+    }
+    MEMORY_BARRIER (  );
+    common_zipNLog2NReady = 1;
+}
+
+/*****************************************************************************
+ * common_zipEstimateEntropy
+ *****************************************************************************/
+double
+common_zipEstimateEntropy ( const void *payload_p, solClient_uint32_t size )
+{
+    const unsigned char *bytes_p = ( const unsigned char * ) payload_p;
+    unsigned int    counts[256];
+    solClient_uint32_t numSamples;
+    solClient_uint32_t stride;
+    solClient_uint32_t i;
+    double          sum = 0.0;
+
+    if ( size == 0 ) {
+        return 0.0;
+    }
+    if ( !common_zipNLog2NReady ) {
+        common_zipInitialize (  );
+    }
+    READ_BARRIER (  );
+
+    numSamples = ( size < COMMON_ZIP_SAMPLE_BYTES ) ? size : COMMON_ZIP_SAMPLE_BYTES;
+    stride = size / numSamples;
+    memset ( counts, 0, sizeof ( counts ) );
+    for ( i = 0; i < numSamples; i++ ) {
+        counts[bytes_p[i * stride]]++;
+    }
+
+    /* H = log2(N) - sum(n * log2(n)) / N */
+    for ( i = 0; i < 256; i++ ) {
+        sum += common_zipNLog2N[counts[i]];
+    }
+    return common_zipNLog2N[numSamples] / numSamples - sum / numSamples;
+}
+
+/*****************************************************************************
+ * common_zipSelectLevel
+ *****************************************************************************/
+int
+common_zipSelectLevel ( double entropy, double linkBytesPerSec )
+{
+    double          ratio;
+    double          levelRatio;
+    double          rate;
+    double          bestRate;
+    int             bestLevel = 0;
+    int             level;
+
+    if ( entropy > COMMON_ZIP_MAX_ENTROPY || linkBytesPerSec <= 0.0 ) {
+        return 0;
+    }
+    ratio = entropy / 8.0;
+    if ( ratio < 0.05 ) {
+        ratio = 0.05;
+    }
+
+    /* Delivered payload rate: the slower of the compressor and the link carrying compressed bytes. */
+    bestRate = linkBytesPerSec;
+    for ( level = 1; level <= 9; level++ ) {
+        levelRatio = ratio * ( 1.15 - 0.15 * ( level - 1 ) / 8.0 );
+        if ( levelRatio > 1.0 ) {
+            levelRatio = 1.0;
+        }
+        rate = linkBytesPerSec / levelRatio;
+        if ( rate > common_zipLevelBytesPerSec[level] ) {
+            rate = common_zipLevelBytesPerSec[level];
+        }
+        /* A higher level must be at least 5% better to be worth its CPU. */
+        if ( rate > bestRate * 1.05 ) {
+            bestRate = rate;
+            bestLevel = level;
+        }
+    }
+    return bestLevel;
+}
+
+/*****************************************************************************
+ * common_zipProbeLink
+ *
+ * Estimate link throughput by publishing a 512 KB burst of Direct messages.
+ * The first half of the burst fills the socket and API buffers; once they
+ * are full, blocking sends proceed at the rate the link drains them, so only
+ * the second half is timed. Only done when asked for with
+ * --ziplevel=adaptive,probe, as the burst competes with live traffic.
+ *****************************************************************************/
+static double
+common_zipProbeLink ( solClient_opaqueSession_pt session_p )
+{
+    solClient_returnCode_t rc;
+    char           *probe_p;
+    UINT64          startUs = 0;
+    UINT64          elapsedUs;
+    int             i;
+
+    if ( ( probe_p = ( char * ) malloc ( COMMON_ZIP_PROBE_MSG_SIZE ) ) == NULL ) {
+        return 0.0;
+    }
+    memset ( probe_p, 0, COMMON_ZIP_PROBE_MSG_SIZE );
+
+    for ( i = 0; i < COMMON_ZIP_PROBE_MSGS; i++ ) {
+        if ( i == COMMON_ZIP_PROBE_MSGS / 2 ) {
+            startUs = getTimeInUs (  );
+        }
+        if ( ( rc = common_publishPayload ( session_p, COMMON_ZIP_PROBE_TOPIC, SOLCLIENT_DELIVERY_MODE_DIRECT,
+                                            probe_p, COMMON_ZIP_PROBE_MSG_SIZE ) ) != SOLCLIENT_OK ) {
+            free ( probe_p );
+            return 0.0;
+        }
+    }
+    elapsedUs = getTimeInUs (  ) - startUs;
+    free ( probe_p );
+
+    if ( elapsedUs == 0 ) {
+        elapsedUs = 1;
+    }
+    return ( double ) ( COMMON_ZIP_PROBE_MSGS / 2 ) * COMMON_ZIP_PROBE_MSG_SIZE * 1000000.0 / ( double ) elapsedUs;
+}
+
+/*****************************************************************************
+ * common_zipPublisher_connect
+ *****************************************************************************/
+solClient_returnCode_t
+common_zipPublisher_connect ( solClient_opaqueContext_pt context_p, common_zipPublisher_pt zp_p,
+                              solClient_session_rxMsgCallbackFunc_t msgCallback_p,
+                              solClient_session_eventCallbackFunc_t eventCallback_p,
+                              void *user_p, struct commonOptions *commonOpts,
+                              const void *sample_p, solClient_uint32_t sampleSize )
+{
+    solClient_returnCode_t rc = SOLCLIENT_OK;
+    struct commonOptions sessionOpts = *commonOpts;
+
+    memset ( zp_p, 0, sizeof ( *zp_p ) );
+    zp_p->minZipSize = COMMON_ZIP_MIN_SIZE;
+    zp_p->maxZipEntropy = COMMON_ZIP_MAX_ENTROPY;
+
+    sessionOpts.compressionLevel = 0;
+    if ( ( rc = common_createAndConnectSession ( context_p, &zp_p->plainSession_p, msgCallback_p,
+                                                 eventCallback_p, user_p, &sessionOpts ) ) != SOLCLIENT_OK ) {
+        return rc;
+    }
+
+    if ( commonOpts->compressionLevel == COMMON_ZIP_ADAPTIVE ) {
+        zp_p->sampleEntropy = ( sample_p != NULL ) ? common_zipEstimateEntropy ( sample_p, sampleSize ) : 8.0;
+        zp_p->linkBytesPerSec = ( commonOpts->zipLinkBytesPerSec == COMMON_ZIP_PROBE ) ?
+                common_zipProbeLink ( zp_p->plainSession_p ) : commonOpts->zipLinkBytesPerSec;
+        zp_p->level = common_zipSelectLevel ( zp_p->sampleEntropy, zp_p->linkBytesPerSec );
+        solClient_log ( SOLCLIENT_LOG_NOTICE,
+                        "Adaptive compression: sample entropy %.2f bits/byte, link %.1f MB/s, level %d",
+                        zp_p->sampleEntropy, zp_p->linkBytesPerSec / ( 1024.0 * 1024.0 ), zp_p->level );
+    } else {
+        zp_p->level = commonOpts->compressionLevel;
+    }
+
+    if ( zp_p->level > 0 ) {
+        sessionOpts.compressionLevel = zp_p->level;
+        if ( ( rc = common_createAndConnectSession ( context_p, &zp_p->zipSession_p, msgCallback_p,
+                                                     eventCallback_p, user_p, &sessionOpts ) ) != SOLCLIENT_OK ) {
+            common_zipPublisher_disconnect ( zp_p );
+            return rc;
+        }
+    }
+
+    return rc;
+}
+
+/*****************************************************************************
+ * common_zipPublisher_publish
+ *****************************************************************************/
+solClient_returnCode_t
+common_zipPublisher_publish ( common_zipPublisher_pt zp_p, const char *topic_p,
+                              solClient_uint32_t deliveryMode, const void *payload_p, solClient_uint32_t size )
+{
+    if ( zp_p->zipSession_p != NULL && size >= zp_p->minZipSize &&
+         common_zipEstimateEntropy ( payload_p, size ) <= zp_p->maxZipEntropy ) {
+        zp_p->zipMsgs++;
+        return common_publishPayload ( zp_p->zipSession_p, topic_p, deliveryMode, payload_p, size );
+    }
+    zp_p->plainMsgs++;
+    return common_publishPayload ( zp_p->plainSession_p, topic_p, deliveryMode, payload_p, size );
+}
+
+/*****************************************************************************
+ * common_zipPublisher_printStats
+ *****************************************************************************/
+static void
+common_zipPrintSessionStats ( const char *name_p, solClient_opaqueSession_pt session_p )
+{
+    solClient_stats_t rxStats[SOLCLIENT_STATS_RX_NUM_STATS];
+    solClient_stats_t txStats[SOLCLIENT_STATS_TX_NUM_STATS];
+
+    if ( session_p == NULL ) {
+        return;
+    }
+    if ( solClient_session_getRxStats ( session_p, rxStats, SOLCLIENT_STATS_RX_NUM_STATS ) != SOLCLIENT_OK ||
+         solClient_session_getTxStats ( session_p, txStats, SOLCLIENT_STATS_TX_NUM_STATS ) != SOLCLIENT_OK ) {
+        return;
+    }
+
+    printf ( "  %-6s tx %llu bytes, %llu compressed", name_p,
+             ( unsigned long long ) txStats[SOLCLIENT_STATS_TX_TOTAL_DATA_BYTES],
+             ( unsigned long long ) txStats[SOLCLIENT_STATS_TX_COMPRESSED_BYTES] );
+    if ( txStats[SOLCLIENT_STATS_TX_COMPRESSED_BYTES] != 0 ) {
+        printf ( " (ratio %.3f)", ( double ) txStats[SOLCLIENT_STATS_TX_COMPRESSED_BYTES] /
+                 ( double ) txStats[SOLCLIENT_STATS_TX_TOTAL_DATA_BYTES] );
+    }
+    printf ( "; rx %llu bytes, %llu compressed",
+             ( unsigned long long ) rxStats[SOLCLIENT_STATS_RX_TOTAL_DATA_BYTES],
+             ( unsigned long long ) rxStats[SOLCLIENT_STATS_RX_COMPRESSED_BYTES] );
+    if ( rxStats[SOLCLIENT_STATS_RX_COMPRESSED_BYTES] != 0 && rxStats[SOLCLIENT_STATS_RX_TOTAL_DATA_BYTES] != 0 ) {
+        printf ( " (ratio %.3f)", ( double ) rxStats[SOLCLIENT_STATS_RX_COMPRESSED_BYTES] /
+                 ( double ) rxStats[SOLCLIENT_STATS_RX_TOTAL_DATA_BYTES] );
+    }
+    printf ( "\n" );
+}
+
+void
+common_zipPublisher_printStats ( common_zipPublisher_pt zp_p )
+{
+    printf ( "Zip publisher: level %d, %llu messages uncompressed, %llu compressed\n", zp_p->level,
+             ( unsigned long long ) zp_p->plainMsgs, ( unsigned long long ) zp_p->zipMsgs );
+    common_zipPrintSessionStats ( "plain", zp_p->plainSession_p );
+    common_zipPrintSessionStats ( "zip", zp_p->zipSession_p );
+}
+
+/*****************************************************************************
+ * common_zipPublisher_disconnect
+ *****************************************************************************/
+void
+common_zipPublisher_disconnect ( common_zipPublisher_pt zp_p )
+{
+    solClient_returnCode_t rc;
+
+    if ( zp_p->zipSession_p != NULL ) {
+        if ( ( rc = solClient_session_disconnect ( zp_p->zipSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_disconnect()" );
+        }
+        solClient_session_destroy ( &zp_p->zipSession_p );
+    }
+    if ( zp_p->plainSession_p != NULL ) {
+        if ( ( rc = solClient_session_disconnect ( zp_p->plainSession_p ) ) != SOLCLIENT_OK ) {
+            common_handleError ( rc, "solClient_session_disconnect()" );
+        }
+        solClient_session_destroy ( &zp_p->plainSession_p );
+    }
+}
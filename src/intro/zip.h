@@ -0,0 +1,112 @@
+/** example ex/zip.h
+ */
+
+/**
+ *
+ * file zip.h Adaptive compression for the Solace C API samples.
+ *
+ * Copyright 2019 Solace Corporation. All rights reserved.
+ */
+
+#ifndef ZIP_H_
+#define ZIP_H_
+
+#include "common.h"
+
+
+/**
+ * @anchor zipPublisher
+ * @name Adaptive compression
+ * A zip publisher owns an uncompressed Session and, when compression pays
+ * off, a second Session with a compression level chosen at connect time.
+ * The level is chosen from the byte entropy of a sample payload and the link
+ * throughput, given with --ziplevel=adaptive,link or measured by a short
+ * probe burst on the uncompressed Session, using estimated DEFLATE
+ * throughput per level. Each message is then routed
+ * by its size and sampled entropy: small or high-entropy (already
+ * compressed or encrypted) payloads go uncompressed, the rest compressed.
+ * A zip publisher must only be used from one thread.
+ */
+/*@{*/
+
+#define COMMON_ZIP_MIN_SIZE          256        /**< Messages smaller than this are never compressed. */
+#define COMMON_ZIP_MAX_ENTROPY       7.0        /**< Payloads above this entropy (bits/byte) are not compressed. */
+#define COMMON_ZIP_SAMPLE_BYTES      256        /**< Bytes sampled to estimate payload entropy. */
+#define COMMON_ZIP_PROBE_TOPIC       "solclient/samples/zipprobe"
+
+typedef struct common_zipPublisher
+{
+    solClient_opaqueSession_pt plainSession_p;
+    solClient_opaqueSession_pt zipSession_p;    /**< NULL when compression was not selected. */
+    int             level;                      /**< Level of zipSession_p, 0 if none. */
+    double          sampleEntropy;              /**< Entropy of the sample payload, bits/byte. */
+    double          linkBytesPerSec;            /**< Probed link throughput, 0 if not probed. */
+    solClient_uint32_t minZipSize;              /**< Routing threshold, COMMON_ZIP_MIN_SIZE by default. */
+    double          maxZipEntropy;              /**< Routing threshold, COMMON_ZIP_MAX_ENTROPY by default. */
+    solClient_uint64_t plainMsgs;
+    solClient_uint64_t zipMsgs;
+} common_zipPublisher_t, *common_zipPublisher_pt;
+
+/**
+ * Estimate the byte entropy (0 to 8 bits per byte) of a payload from up to
+ * COMMON_ZIP_SAMPLE_BYTES bytes sampled evenly across it.
+ */
+double
+    common_zipEstimateEntropy ( const void *payload_p, solClient_uint32_t size );
+
+/**
+ * Choose a compression level (0 for none) for payloads of the given entropy
+ * on a link of the given throughput, maximizing the estimated delivered
+ * payload rate. Lower levels win ties, as they cost less CPU.
+ */
+int
+    common_zipSelectLevel ( double entropy, double linkBytesPerSec );
+
+/**
+ * Connect the Sessions of a zip publisher. When commonOpts->compressionLevel
+ * is COMMON_ZIP_ADAPTIVE the level is selected from sample_p and
+ * commonOpts->zipLinkBytesPerSec, probing the link when that is
+ * COMMON_ZIP_PROBE; otherwise the given level is used. The other connection options
+ * are taken from commonOpts as for common_createAndConnectSession().
+ * @param context_p     The Context to create the Sessions in.
+ * @param zp_p          The zip publisher to initialize.
+ * @param msgCallback_p The received message callback for both Sessions.
+ * @param eventCallback_p The event callback for both Sessions.
+ * @param user_p        The callback user pointer.
+ * @param commonOpts    The sample's command options.
+ * @param sample_p      A representative payload (may be NULL if not adaptive).
+ * @param sampleSize    The size of the sample payload.
+ * @return ::SOLCLIENT_OK, ::SOLCLIENT_FAIL
+ */
+solClient_returnCode_t
+    common_zipPublisher_connect ( solClient_opaqueContext_pt context_p, common_zipPublisher_pt zp_p,
+                                  solClient_session_rxMsgCallbackFunc_t msgCallback_p,
+                                  solClient_session_eventCallbackFunc_t eventCallback_p,
+                                  void *user_p, struct commonOptions *commonOpts,
+                                  const void *sample_p, solClient_uint32_t sampleSize );
+
+/**
+ * Publish a payload on the Session its size and entropy route it to, using
+ * common_publishPayload().
+ */
+solClient_returnCode_t
+    common_zipPublisher_publish ( common_zipPublisher_pt zp_p, const char *topic_p,
+                                  solClient_uint32_t deliveryMode, const void *payload_p, solClient_uint32_t size );
+
+/**
+ * Print the routing counts and, per Session, the compressed to total byte
+ * ratios from ::SOLCLIENT_STATS_TX_COMPRESSED_BYTES and
+ * ::SOLCLIENT_STATS_RX_COMPRESSED_BYTES.
+ */
+void
+    common_zipPublisher_printStats ( common_zipPublisher_pt zp_p );
+
+/**
+ * Disconnect and destroy the Sessions of a zip publisher.
+ */
+void
+    common_zipPublisher_disconnect ( common_zipPublisher_pt zp_p );
+
+/*@}*/
+
+#endif /* ZIP_H_ */